@@ -80,3 +80,52 @@ private:
     std::uniform_int_distribution<int> _qtyDist, _qtyChangeDist, _levelSkipDist;
     std::uniform_real_distribution<double> _changeDist{0.0, 1.0};
 };
+
+// Book on a fixed tick grid: the mid walks by whole ticks and each snapshot
+// changes the qty of a fraction of the levels
+class TickGridMarketGenerator {
+public:
+    TickGridMarketGenerator(double tickSize, int bookDepth, double changeRate)
+        : _tickSize(tickSize), _bookDepth(bookDepth), _changeRate(changeRate),
+          _midTick(1000000), _tick(0), _rng(42), _qtyDist(100, 10000), _stepDist(-1, 1) {
+        _buyQty.resize(bookDepth);
+        _sellQty.resize(bookDepth);
+        for (int i = 0; i < bookDepth; i++) {
+            _buyQty[i] = _qtyDist(_rng);
+            _sellQty[i] = _qtyDist(_rng);
+        }
+    }
+
+    void generateSnapshot(std::vector<bookElement>& buyBook, std::vector<bookElement>& sellBook) {
+        _tick++;
+        _midTick += _stepDist(_rng);
+        for (int i = 0; i < _bookDepth; i++) {
+            if (_changeDist(_rng) < _changeRate) _buyQty[i] = _qtyDist(_rng);
+            if (_changeDist(_rng) < _changeRate) _sellQty[i] = _qtyDist(_rng);
+        }
+
+        buyBook.resize(_bookDepth);
+        sellBook.resize(_bookDepth);
+        for (int i = 0; i < _bookDepth; i++) {
+            buyBook[i].price = (_midTick - 1 - i) * _tickSize;
+            buyBook[i].qty = _buyQty[i];
+            buyBook[i].time = _tick;
+            sellBook[i].price = (_midTick + 1 + i) * _tickSize;
+            sellBook[i].qty = _sellQty[i];
+            sellBook[i].time = _tick;
+        }
+    }
+
+    ORDER_TIME getTick() const { return _tick; }
+
+private:
+    double _tickSize;
+    int _bookDepth;
+    double _changeRate;
+    int64_t _midTick;
+    ORDER_TIME _tick;
+    std::mt19937 _rng;
+    std::uniform_int_distribution<int> _qtyDist, _stepDist;
+    std::uniform_real_distribution<double> _changeDist{0.0, 1.0};
+    std::vector<ORDER_QTY> _buyQty, _sellQty;
+};
@@ -1,5 +1,6 @@
 #include "market_generator.h"
 #include "src/wire_format.h"
+#include "src/shm_ring.h"
 #include <nats.h>
 #include <chrono>
 #include <thread>
@@ -10,6 +11,8 @@
 #include <algorithm>
 #include <cstdio>
 #include <cstring>
+#include <string>
+#include <unistd.h>
 
 using namespace cl::data_feed::data_feed_parser;
 using Clock = std::chrono::high_resolution_clock;
@@ -108,8 +111,7 @@ int main(int argc, char* argv[]) {
     // Warmup parser so first snapshot isn't add-all
     for (int i = 0; i < 10; i++) {
         gen.generateSnapshot(buyBook, sellBook);
-        parser.EmitOrdersAndUpdateOldBuyBook(1, buyBook, gen.getTick());
-        parser.EmitOrdersAndUpdateOldSellBook(1, sellBook, gen.getTick());
+        parser.ApplySnapshot(1, buyBook, sellBook, gen.getTick());
         parser.clearEmittedOrders();
     }
 
@@ -130,8 +132,7 @@ int main(int argc, char* argv[]) {
 
     for (int i = 0; i < latencyRounds; i++) {
         gen.generateSnapshot(buyBook, sellBook);
-        parser.EmitOrdersAndUpdateOldBuyBook(1, buyBook, gen.getTick());
-        parser.EmitOrdersAndUpdateOldSellBook(1, sellBook, gen.getTick());
+        parser.ApplySnapshot(1, buyBook, sellBook, gen.getTick());
 
         const auto& orders = parser.getEmittedOrders();
         std::vector<char> orderBuf = serializeOrders(orders);
@@ -155,9 +156,12 @@ int main(int argc, char* argv[]) {
     latStats.waitFor(latencyRounds);
     natsSubscription_Destroy(latSub);
 
+    double natsP50 = 0, natsP99 = 0;
     {
         std::lock_guard<std::mutex> lock(latStats.mu);
         std::sort(latStats.latenciesUs.begin(), latStats.latenciesUs.end());
+        natsP50 = percentile(latStats.latenciesUs, 50);
+        natsP99 = percentile(latStats.latenciesUs, 99);
         printf("  samples:  %zu\n", latStats.latenciesUs.size());
         printf("  min:      %.1f us\n", latStats.latenciesUs.front());
         printf("  p50:      %.1f us\n", percentile(latStats.latenciesUs, 50));
@@ -187,8 +191,7 @@ int main(int argc, char* argv[]) {
     pregenMsgs.reserve(batchSize);
     for (int i = 0; i < batchSize; i++) {
         gen.generateSnapshot(buyBook, sellBook);
-        parser.EmitOrdersAndUpdateOldBuyBook(1, buyBook, gen.getTick());
-        parser.EmitOrdersAndUpdateOldSellBook(1, sellBook, gen.getTick());
+        parser.ApplySnapshot(1, buyBook, sellBook, gen.getTick());
         std::vector<char> buf = serializeOrders(parser.getEmittedOrders());
         pregenMsgs.push_back(std::move(buf));
         parser.clearEmittedOrders();
@@ -254,8 +257,7 @@ int main(int argc, char* argv[]) {
 
     while (Clock::now() < pipeDeadline) {
         gen.generateSnapshot(buyBook, sellBook);
-        parser.EmitOrdersAndUpdateOldBuyBook(1, buyBook, gen.getTick());
-        parser.EmitOrdersAndUpdateOldSellBook(1, sellBook, gen.getTick());
+        parser.ApplySnapshot(1, buyBook, sellBook, gen.getTick());
 
         const auto& orders = parser.getEmittedOrders();
         std::vector<char> buf = serializeOrders(orders);
@@ -287,6 +289,85 @@ int main(int argc, char* argv[]) {
     printf("  pub MB/s:    %.2f\n", (pipeBytes / (1024.0 * 1024.0)) / pipeSec);
     printf("  recv MB/s:   %.2f\n", (pipeRecvdBytes / (1024.0 * 1024.0)) / pipeSec);
 
+    // ============================================================
+    // PHASE 4: Shared memory latency (same frames as phase 1, reader on
+    // another thread polling the ring; one frame in flight at a time)
+    // ============================================================
+    printf("\n--- Phase 4: Shared memory ring latency (%d rounds) ---\n", latencyRounds);
+
+    // Slots sized for the largest frame a diff can produce: at most one event
+    // per old and one per new level on each side. One frame is in flight at
+    // a time, so a short ring is enough.
+    std::string ringName = "buni_e2e_bench_" + std::to_string(getpid());
+    size_t maxFrameBytes = sizeof(uint64_t) + WIRE_ORDERS_HEADER_SIZE +
+                           4 * static_cast<size_t>(depth) * WIRE_ORDER_SIZE;
+    ShmRingWriter ringWriter;
+    ShmRingReader ringReader;
+    if (!ringWriter.open(ringName, 64, static_cast<uint32_t>(maxFrameBytes)) || !ringReader.open(ringName)) {
+        fprintf(stderr, "Cannot create shared memory ring %s\n", ringName.c_str());
+        natsConnection_Destroy(conn);
+        natsOptions_Destroy(opts);
+        return 1;
+    }
+
+    std::vector<double> shmLatenciesUs;
+    shmLatenciesUs.reserve(latencyRounds);
+    std::atomic<int> shmReceived{0};
+    std::atomic<bool> shmFailed{false};
+    std::thread ringThread([&]() {
+        std::vector<char> frame;
+        while (shmReceived.load(std::memory_order_relaxed) < latencyRounds &&
+               !shmFailed.load(std::memory_order_relaxed)) {
+            if (!ringReader.poll(frame)) continue;
+            auto now = Clock::now();
+            uint64_t sendTimeNs;
+            std::memcpy(&sendTimeNs, frame.data(), sizeof(uint64_t));
+            shmLatenciesUs.push_back(std::chrono::duration<double, std::micro>(
+                now.time_since_epoch() - std::chrono::nanoseconds(sendTimeNs)).count());
+            shmReceived.fetch_add(1, std::memory_order_release);
+        }
+    });
+
+    for (int i = 0; i < latencyRounds; i++) {
+        gen.generateSnapshot(buyBook, sellBook);
+        parser.ApplySnapshot(1, buyBook, sellBook, gen.getTick());
+        std::vector<char> orderBuf = serializeOrders(parser.getEmittedOrders());
+
+        uint64_t sendTimeNs = static_cast<uint64_t>(Clock::now().time_since_epoch().count());
+        std::vector<char> msg(sizeof(uint64_t) + orderBuf.size());
+        std::memcpy(msg.data(), &sendTimeNs, sizeof(uint64_t));
+        std::memcpy(msg.data() + sizeof(uint64_t), orderBuf.data(), orderBuf.size());
+        if (!ringWriter.publish(msg.data(), msg.size())) {
+            fprintf(stderr, "Frame of %zu bytes does not fit the ring slots (%zu bytes)\n",
+                    msg.size(), maxFrameBytes);
+            shmFailed.store(true, std::memory_order_relaxed);
+            break;
+        }
+
+        while (shmReceived.load(std::memory_order_acquire) <= i) {
+            std::this_thread::yield();
+        }
+        parser.clearEmittedOrders();
+    }
+    ringThread.join();
+    ringReader.close();
+    ringWriter.close();
+    ShmRingWriter::unlink(ringName);
+
+    if (shmFailed.load() || shmLatenciesUs.empty()) {
+        natsConnection_Destroy(conn);
+        natsOptions_Destroy(opts);
+        return 1;
+    }
+
+    std::sort(shmLatenciesUs.begin(), shmLatenciesUs.end());
+    printf("  samples:  %zu\n", shmLatenciesUs.size());
+    printf("  min:      %.1f us\n", shmLatenciesUs.front());
+    printf("  p50:      %.1f us   (NATS %.1f us)\n", percentile(shmLatenciesUs, 50), natsP50);
+    printf("  p95:      %.1f us\n", percentile(shmLatenciesUs, 95));
+    printf("  p99:      %.1f us   (NATS %.1f us)\n", percentile(shmLatenciesUs, 99), natsP99);
+    printf("  max:      %.1f us\n", shmLatenciesUs.back());
+
     printf("\n================================================\n");
 
     natsConnection_Destroy(conn);
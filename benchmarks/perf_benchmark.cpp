@@ -1,4 +1,5 @@
 #include "market_generator.h"
+#include "src/wire_format.h"
 #include <benchmark/benchmark.h>
 
 using namespace cl::data_feed::data_feed_parser;
@@ -13,15 +14,13 @@ static void BM_FullSnapshot(benchmark::State& state) {
     // Warmup
     for (int i = 0; i < 50; i++) {
         gen.generateSnapshot(buyBook, sellBook);
-        parser.EmitOrdersAndUpdateOldBuyBook(1, buyBook, gen.getTick());
-        parser.EmitOrdersAndUpdateOldSellBook(1, sellBook, gen.getTick());
+        parser.ApplySnapshot(1, buyBook, sellBook, gen.getTick());
         parser.clearEmittedOrders();
     }
 
     for (auto _ : state) {
         gen.generateSnapshot(buyBook, sellBook);
-        parser.EmitOrdersAndUpdateOldBuyBook(1, buyBook, gen.getTick());
-        parser.EmitOrdersAndUpdateOldSellBook(1, sellBook, gen.getTick());
+        parser.ApplySnapshot(1, buyBook, sellBook, gen.getTick());
         benchmark::DoNotOptimize(parser.getEmittedOrders().size());
         parser.clearEmittedOrders();
     }
@@ -35,6 +34,341 @@ BENCHMARK(BM_FullSnapshot)
     ->Unit(benchmark::kMicrosecond)
     ->MinTime(2.0);
 
+// Deep-book feed with a per-pair depth limit (0 = full depth)
+static void BM_DepthLimited(benchmark::State& state) {
+    int feedDepth = 1000;
+    size_t maxDepth = static_cast<size_t>(state.range(0));
+    SinusoidalMarketGenerator gen(100.0, 5.0, 0.001, 0.5, feedDepth);
+    SeekerNetBoonSnapshotParserToTBT parser({1});
+    PairConfig config;
+    config.maxDepth = maxDepth;
+    parser.SetPairConfig(1, config);
+    std::vector<bookElement> buyBook, sellBook;
+
+    // Warmup
+    for (int i = 0; i < 50; i++) {
+        gen.generateSnapshot(buyBook, sellBook);
+        parser.ApplySnapshot(1, buyBook, sellBook, gen.getTick());
+        parser.clearEmittedOrders();
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        gen.generateSnapshot(buyBook, sellBook);
+        state.ResumeTiming();
+        parser.ApplySnapshot(1, buyBook, sellBook, gen.getTick());
+        benchmark::DoNotOptimize(parser.getEmittedOrders().size());
+        parser.clearEmittedOrders();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["feedDepth"] = feedDepth;
+    state.counters["maxDepth"] = static_cast<double>(maxDepth);
+}
+
+BENCHMARK(BM_DepthLimited)
+    ->Arg(0)->Arg(10)->Arg(20)->Arg(50)
+    ->Unit(benchmark::kMicrosecond)
+    ->MinTime(2.0);
+
+// Decode + apply of a republished (unchanged) snapshot, with and without
+// fingerprint skipping
+static void BM_RepublishedSnapshot(benchmark::State& state) {
+    bool skip = state.range(0) != 0;
+    int depth = 100;
+    SinusoidalMarketGenerator gen(100.0, 5.0, 0.001, 0.5, depth);
+    SeekerNetBoonSnapshotParserToTBT parser({1});
+    PairConfig config;
+    config.skipUnchangedSides = skip;
+    parser.SetPairConfig(1, config);
+
+    std::vector<bookElement> buyBook, sellBook;
+    gen.generateSnapshot(buyBook, sellBook);
+    std::vector<char> frame = serializeSnapshot(1, gen.getTick(), buyBook, sellBook);
+
+    PAIR_ID pairId = 0;
+    ORDER_TIME ts = 0;
+    BookHashes hashes;
+    for (auto _ : state) {
+        deserializeSnapshot(frame.data(), frame.size(), pairId, ts, buyBook, sellBook, 0,
+                            skip ? &hashes : nullptr);
+        parser.ApplySnapshot(pairId, buyBook, sellBook, ts, skip ? &hashes : nullptr);
+        benchmark::DoNotOptimize(parser.getEmittedOrders().size());
+        parser.clearEmittedOrders();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["skipped"] = static_cast<double>(parser.getFingerprintStats(1).sidesSkipped);
+}
+
+BENCHMARK(BM_RepublishedSnapshot)
+    ->Arg(0)->Arg(1)
+    ->Unit(benchmark::kMicrosecond);
+
+// Tick-grid snapshots with the sorted layout (0) vs the price ladder (1),
+// parameterized by book depth
+static void BM_TickGridLayout(benchmark::State& state) {
+    bool ladder = state.range(0) != 0;
+    int depth = static_cast<int>(state.range(1));
+    TickGridMarketGenerator gen(0.01, depth, 0.1);
+    SeekerNetBoonSnapshotParserToTBT parser({1});
+    PairConfig config;
+    if (ladder) {
+        config.layout = BOOK_LAYOUT::PRICE_LADDER;
+        config.tickSize = 0.01;
+    }
+    parser.SetPairConfig(1, config);
+    std::vector<bookElement> buyBook, sellBook;
+
+    for (int i = 0; i < 50; i++) {
+        gen.generateSnapshot(buyBook, sellBook);
+        parser.ApplySnapshot(1, buyBook, sellBook, gen.getTick());
+        parser.clearEmittedOrders();
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        gen.generateSnapshot(buyBook, sellBook);
+        state.ResumeTiming();
+        parser.ApplySnapshot(1, buyBook, sellBook, gen.getTick());
+        benchmark::DoNotOptimize(parser.getEmittedOrders().size());
+        parser.clearEmittedOrders();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["depth"] = depth;
+}
+
+BENCHMARK(BM_TickGridLayout)
+    ->ArgsProduct({{0, 1}, {20, 100, 500}})
+    ->Unit(benchmark::kMicrosecond);
+
+// Full snapshot diff with and without BBO tracking (depth 20)
+static void BM_BboTracking(benchmark::State& state) {
+    bool track = state.range(0) != 0;
+    SinusoidalMarketGenerator gen(100.0, 5.0, 0.001, 0.5, 20);
+    SeekerNetBoonSnapshotParserToTBT parser({1});
+    PairConfig config;
+    config.trackBbo = track;
+    parser.SetPairConfig(1, config);
+    std::vector<std::vector<bookElement>> bids(256), asks(256);
+    for (size_t i = 0; i < bids.size(); i++) {
+        gen.generateSnapshot(bids[i], asks[i]);
+    }
+
+    ORDER_TIME tick = 0;
+    uint64_t updates = 0;
+    std::vector<bookElement> buyBook, sellBook;
+    for (auto _ : state) {
+        size_t i = tick % bids.size();
+        buyBook = bids[i];
+        sellBook = asks[i];
+        parser.ApplySnapshot(1, buyBook, sellBook, ++tick);
+        updates += parser.getBboUpdates().size();
+        benchmark::DoNotOptimize(parser.getEmittedOrders().size());
+        parser.clearEmittedOrders();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["bboPerSnapshot"] = static_cast<double>(updates) / state.iterations();
+}
+
+BENCHMARK(BM_BboTracking)
+    ->Arg(0)->Arg(1)
+    ->Unit(benchmark::kMicrosecond);
+
+// Book analytics per snapshot: 0 = off, 1 = maintained inline from the
+// level changes, 2 = naive full recompute over the book after every update
+static void BM_BookAnalytics(benchmark::State& state) {
+    int mode = static_cast<int>(state.range(0));
+    int depth = static_cast<int>(state.range(1));
+    SinusoidalMarketGenerator gen(100.0, 5.0, 0.001, 0.5, depth);
+    SeekerNetBoonSnapshotParserToTBT parser({1});
+    PairConfig config;
+    config.analyticsLevels = mode == 1 ? 5 : 0;
+    config.analyticsBandBps = 25;
+    parser.SetPairConfig(1, config);
+    std::vector<std::vector<bookElement>> bids(256), asks(256);
+    for (size_t i = 0; i < bids.size(); i++) {
+        gen.generateSnapshot(bids[i], asks[i]);
+    }
+
+    ORDER_TIME tick = 0;
+    BookAnalytics naive;
+    std::vector<bookElement> buyBook, sellBook;
+    for (auto _ : state) {
+        size_t i = tick % bids.size();
+        buyBook = bids[i];
+        sellBook = asks[i];
+        parser.ApplySnapshot(1, buyBook, sellBook, ++tick);
+        if (mode == 2) {
+            computeBookAnalytics(parser.getBuySide(1), parser.getSellSide(1), 5, 25.0, naive);
+            benchmark::DoNotOptimize(naive.weightedMid);
+        } else if (mode == 1) {
+            benchmark::DoNotOptimize(parser.getAnalytics().back().weightedMid);
+        }
+        parser.clearEmittedOrders();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_BookAnalytics)
+    ->Args({0, 20})->Args({1, 20})->Args({2, 20})
+    ->Args({0, 200})->Args({1, 200})->Args({2, 200})
+    ->Unit(benchmark::kMicrosecond);
+
+// Consolidation across venues: each iteration applies one venue's snapshot.
+// 0 = no group, 1 = incremental consolidated events and NBBO, 2 = no group
+// plus a full k-way re-merge of every venue book per update.
+static void BM_Consolidation(benchmark::State& state) {
+    int mode = static_cast<int>(state.range(0));
+    size_t venues = static_cast<size_t>(state.range(1));
+    std::vector<PAIR_ID> pairIds;
+    for (size_t v = 0; v < venues; v++) pairIds.push_back(static_cast<PAIR_ID>(v + 1));
+    SeekerNetBoonSnapshotParserToTBT parser(pairIds);
+    if (mode == 1) parser.SetConsolidationGroup(1000, pairIds);
+
+    SinusoidalMarketGenerator gen(100.0, 5.0, 0.001, 0.5, 20);
+    std::vector<std::vector<bookElement>> bids(256), asks(256);
+    for (size_t i = 0; i < bids.size(); i++) {
+        gen.generateSnapshot(bids[i], asks[i]);
+    }
+
+    ORDER_TIME tick = 0;
+    std::vector<bookElement> buyBook, sellBook, merged;
+    std::vector<const BookSide*> buySides, sellSides;
+    for (PAIR_ID pairId : pairIds) {
+        buySides.push_back(&parser.getBuySide(pairId));
+        sellSides.push_back(&parser.getSellSide(pairId));
+    }
+    for (auto _ : state) {
+        size_t i = tick % bids.size();
+        PAIR_ID pairId = pairIds[tick % venues];
+        buyBook = bids[i];
+        sellBook = asks[i];
+        parser.ApplySnapshot(pairId, buyBook, sellBook, ++tick);
+        if (mode == 2) {
+            mergeVenueBooks(buySides, true, 0, merged);
+            mergeVenueBooks(sellSides, false, 0, merged);
+            benchmark::DoNotOptimize(merged.data());
+        } else if (mode == 1) {
+            benchmark::DoNotOptimize(parser.getConsolidatedOrders().size());
+        }
+        parser.clearEmittedOrders();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_Consolidation)
+    ->Args({0, 4})->Args({1, 4})->Args({2, 4})
+    ->Args({0, 32})->Args({1, 32})->Args({2, 32})
+    ->Unit(benchmark::kMicrosecond);
+
+// Consumer SDK: TBT frames applied to a TbtBookBuilder. The frames take the
+// parser's book from one snapshot through 255 others and back, so the
+// cycle replays on a consistent local book.
+static void BM_TbtBookBuilder(benchmark::State& state) {
+    int depth = static_cast<int>(state.range(0));
+    SinusoidalMarketGenerator gen(100.0, 5.0, 0.001, 0.5, depth);
+    SeekerNetBoonSnapshotParserToTBT parser({1});
+    std::vector<std::vector<bookElement>> bids(256), asks(256);
+    for (size_t i = 0; i < bids.size(); i++) {
+        gen.generateSnapshot(bids[i], asks[i]);
+    }
+
+    TbtBookBuilder builder(false);
+    std::vector<std::vector<char>> frames;
+    std::vector<bookElement> buyBook, sellBook;
+    size_t events = 0;
+    for (size_t i = 0; i <= bids.size(); i++) {
+        buyBook = bids[i % bids.size()];
+        sellBook = asks[i % asks.size()];
+        parser.ApplySnapshot(1, buyBook, sellBook, i + 1);
+        std::vector<char> frame = serializeOrders(parser.getEmittedOrders(), i + 1);
+        parser.clearEmittedOrders();
+        if (i == 0) {
+            builder.applyFrame(frame.data(), frame.size());
+            continue;
+        }
+        OrderFrameView view;
+        view.parse(frame.data(), frame.size());
+        events += view.size();
+        frames.push_back(std::move(frame));
+    }
+
+    size_t applied = 0;
+    size_t next = 0;
+    for (auto _ : state) {
+        const std::vector<char>& frame = frames[next];
+        builder.applyFrame(frame.data(), frame.size());
+        next = next + 1 == frames.size() ? 0 : next + 1;
+        applied++;
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(applied * events / frames.size()));
+    state.counters["eventsPerFrame"] = static_cast<double>(events) / frames.size();
+    state.counters["unmatched"] = static_cast<double>(builder.getSequenceStats(1).unmatched);
+}
+
+BENCHMARK(BM_TbtBookBuilder)
+    ->Arg(20)->Arg(200)
+    ->Unit(benchmark::kMicrosecond);
+
+// Published book view under contention: thread 0 applies snapshots, every
+// other thread reads the pair's top 10 levels. Time per iteration is a
+// snapshot for the writer and a read for the readers.
+static SeekerNetBoonSnapshotParserToTBT* gViewParser = nullptr;
+static std::vector<std::vector<bookElement>> gViewBids, gViewAsks;
+
+static void BM_BookViewContention(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        SinusoidalMarketGenerator gen(100.0, 5.0, 0.001, 0.5, 20);
+        gViewParser = new SeekerNetBoonSnapshotParserToTBT({1});
+        PairConfig config;
+        config.publishLevels = 10;
+        gViewParser->SetPairConfig(1, config);
+        gViewBids.resize(256);
+        gViewAsks.resize(256);
+        for (size_t i = 0; i < gViewBids.size(); i++) {
+            gen.generateSnapshot(gViewBids[i], gViewAsks[i]);
+        }
+    }
+
+    if (state.thread_index() == 0) {
+        ORDER_TIME tick = 0;
+        std::vector<bookElement> bids, asks;
+        for (auto _ : state) {
+            size_t i = tick % gViewBids.size();
+            bids = gViewBids[i];
+            asks = gViewAsks[i];
+            gViewParser->ApplySnapshot(1, bids, asks, ++tick);
+            gViewParser->clearEmittedOrders();
+        }
+    } else {
+        BookView view;
+        uint64_t retries = 0;
+        for (auto _ : state) {
+            const PublishedBookView* published = gViewParser->getBookView(1);
+            while (!published->tryRead(view)) retries++;
+            benchmark::DoNotOptimize(view.bids[0].qty);
+        }
+        state.counters["retries"] = benchmark::Counter(static_cast<double>(retries), benchmark::Counter::kAvgThreads);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        delete gViewParser;
+        gViewParser = nullptr;
+    }
+}
+
+BENCHMARK(BM_BookViewContention)
+    ->Threads(1)->Threads(2)->Threads(4)->Threads(8)
+    ->Unit(benchmark::kNanosecond)
+    ->UseRealTime();
+
 // Incremental update benchmark (parameterized by churn rate * 100)
 static void BM_IncrementalUpdate(benchmark::State& state) {
     double changeRate = state.range(0) / 100.0;
@@ -49,16 +383,14 @@ static void BM_IncrementalUpdate(benchmark::State& state) {
     for (int i = 0; i < 50; i++) {
         gen.generateIncrementalUpdate(buyBook, sellBook, changeRate);
         auto buyCopy = buyBook, sellCopy = sellBook;
-        parser.EmitOrdersAndUpdateOldBuyBook(1, buyCopy, gen.getTick());
-        parser.EmitOrdersAndUpdateOldSellBook(1, sellCopy, gen.getTick());
+        parser.ApplySnapshot(1, buyCopy, sellCopy, gen.getTick());
         parser.clearEmittedOrders();
     }
 
     for (auto _ : state) {
         gen.generateIncrementalUpdate(buyBook, sellBook, changeRate);
         auto buyCopy = buyBook, sellCopy = sellBook;
-        parser.EmitOrdersAndUpdateOldBuyBook(1, buyCopy, gen.getTick());
-        parser.EmitOrdersAndUpdateOldSellBook(1, sellCopy, gen.getTick());
+        parser.ApplySnapshot(1, buyCopy, sellCopy, gen.getTick());
         benchmark::DoNotOptimize(parser.getEmittedOrders().size());
         parser.clearEmittedOrders();
     }
@@ -85,8 +417,7 @@ static void BM_MarketOrder(benchmark::State& state) {
     ORDER_TIME tick = 0;
 
     gen.generateSnapshot(buyBook, sellBook);
-    parser.EmitOrdersAndUpdateOldBuyBook(1, buyBook, 1);
-    parser.EmitOrdersAndUpdateOldSellBook(1, sellBook, 1);
+    parser.ApplySnapshot(1, buyBook, sellBook, 1);
     parser.clearEmittedOrders();
 
     for (auto _ : state) {
@@ -94,8 +425,7 @@ static void BM_MarketOrder(benchmark::State& state) {
         if (parser.getBuySide(1).empty() || parser.getSellSide(1).empty()) {
             state.PauseTiming();
             gen.generateSnapshot(buyBook, sellBook);
-            parser.EmitOrdersAndUpdateOldBuyBook(1, buyBook, tick);
-            parser.EmitOrdersAndUpdateOldSellBook(1, sellBook, tick);
+            parser.ApplySnapshot(1, buyBook, sellBook, tick);
             parser.clearEmittedOrders();
             state.ResumeTiming();
         }
@@ -130,8 +460,7 @@ static void BM_MixedWorkload(benchmark::State& state) {
     ORDER_TIME tick = 0;
 
     gen.generateSnapshot(buyBook, sellBook);
-    parser.EmitOrdersAndUpdateOldBuyBook(1, buyBook, 1);
-    parser.EmitOrdersAndUpdateOldSellBook(1, sellBook, 1);
+    parser.ApplySnapshot(1, buyBook, sellBook, 1);
     parser.clearEmittedOrders();
 
     int cycle = 0;
@@ -142,8 +471,7 @@ static void BM_MixedWorkload(benchmark::State& state) {
         // Every 10th operation is a snapshot update, rest are market orders
         if (cycle % 10 == 0) {
             gen.generateSnapshot(buyBook, sellBook);
-            parser.EmitOrdersAndUpdateOldBuyBook(1, buyBook, tick);
-            parser.EmitOrdersAndUpdateOldSellBook(1, sellBook, tick);
+            parser.ApplySnapshot(1, buyBook, sellBook, tick);
         } else {
             if (!parser.getBuySide(1).empty()) {
                 parser.EmitMarketOrderAndUpdateBuyBook(1, qtyDist(rng),
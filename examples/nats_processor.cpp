@@ -1,53 +1,865 @@
 #include "order_book_parser.h"
 #include "src/wire_format.h"
+#include "src/async_logger.h"
+#include "src/snapshot_conflator.h"
+#include "src/shm_ring.h"
+#ifdef BUNI_MULTICAST
+#include "src/multicast_feed.h"
+#endif
+#include "src/tbt_routing.h"
+#include "src/pair_partition.h"
+#include "src/hot_standby.h"
 #include <nats.h>
-#include <cstdio>
+#include <unistd.h>
 #include <csignal>
+#include <cstdlib>
+#include <cstring>
 #include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace cl::data_feed::data_feed_parser;
 
 static std::atomic<bool> g_running(true);
 
+static LogMessageType kDeserializeFailed(LOG_LEVEL::ERROR, 10, "Failed to deserialize snapshot (%lld bytes)");
+static LogMessageType kPublishError(LOG_LEVEL::ERROR, 10, "Publish error: %s");
+static LogMessageType kOptionsError(LOG_LEVEL::ERROR, 0, "Options error: %s");
+static LogMessageType kConnectError(LOG_LEVEL::ERROR, 0, "Connect error: %s");
+static LogMessageType kSubscribeError(LOG_LEVEL::ERROR, 0, "Subscribe error: %s");
+static LogMessageType kConnected(LOG_LEVEL::INFO, 0, "Connected to NATS");
+static LogMessageType kSubscribed(LOG_LEVEL::INFO, 0,
+    "Subscribed to orderbook.snapshots, publishing to orderbook.tbt.<pair>.<side>");
+static LogMessageType kUnknownPair(LOG_LEVEL::ERROR, 10, "Snapshot for unknown pairId=%lld dropped");
+static LogMessageType kConflationEnabled(LOG_LEVEL::INFO, 0, "Conflation enabled for pairId=%lld");
+static LogMessageType kConflationStats(LOG_LEVEL::INFO, 0,
+    "Conflation pairId=%lld offered=%llu conflated=%llu delivered=%llu");
+static LogMessageType kConflationDropped(LOG_LEVEL::WARNING, 0,
+    "Snapshot queue of pairId=%lld was full, %llu oldest snapshots dropped");
+static LogMessageType kFingerprintStats(LOG_LEVEL::INFO, 0,
+    "Fingerprint pairId=%lld skipped=%llu verified=%llu collisions=%llu");
+static LogMessageType kSnapshotStats(LOG_LEVEL::INFO, 0,
+    "Snapshots pairId=%lld applied=%llu rebuilt=%llu stale=%llu");
+static LogMessageType kShmOpenError(LOG_LEVEL::ERROR, 0, "Cannot create shared memory ring %s");
+static LogMessageType kShmEnabled(LOG_LEVEL::INFO, 0, "Publishing TBT frames to shared memory ring %s");
+static LogMessageType kShmFrameTooLarge(LOG_LEVEL::WARNING, 10,
+    "TBT frame of %llu bytes exceeds the shared memory slot size, sent over NATS only");
+static LogMessageType kMulticastError(LOG_LEVEL::ERROR, 0, "Cannot join multicast line %s");
+static LogMessageType kMulticastUnsupported(LOG_LEVEL::ERROR, 0, "MCAST_A: multicast ingest is only built on Linux");
+static LogMessageType kMulticastSubscribed(LOG_LEVEL::INFO, 0,
+    "Receiving snapshots from multicast line A %s, line B %s, publishing to orderbook.tbt.<pair>.<side>");
+static LogMessageType kMulticastStats(LOG_LEVEL::INFO, 0,
+    "Multicast delivered=%llu duplicates=%llu gaps=%llu malformed=%llu");
+static LogMessageType kMulticastLatency(LOG_LEVEL::INFO, 0,
+    "Multicast receive-to-handoff latency avg=%.1fus max=%.1fus");
+static LogMessageType kFilterError(LOG_LEVEL::ERROR, 0, "Invalid TBT_FILTER: %s");
+static LogMessageType kFilterEnabled(LOG_LEVEL::INFO, 0, "Publishing filtered events (%s) to orderbook.filtered.<pair>");
+static LogMessageType kConsolidationError(LOG_LEVEL::ERROR, 0, "Invalid CONSOLIDATE: %s");
+static LogMessageType kPairsError(LOG_LEVEL::ERROR, 0, "Invalid PAIRS: %s");
+static LogMessageType kPartitionError(LOG_LEVEL::ERROR, 0, "PARTITIONED cannot be combined with %s");
+static LogMessageType kPartitionEnabled(LOG_LEVEL::INFO, 0,
+    "Partitioned mode as replica %s, snapshots from orderbook.snapshots.<pair>");
+static LogMessageType kPartitionMembers(LOG_LEVEL::INFO, 0, "%llu replicas, this one owns %llu of %llu pairs");
+static LogMessageType kPairTakenOver(LOG_LEVEL::INFO, 0, "Took over pairId=%lld at sequence %llu");
+static LogMessageType kPairNoCheckpoint(LOG_LEVEL::WARNING, 0,
+    "No checkpoint for pairId=%lld, starting it from an empty book at sequence %llu");
+static LogMessageType kPairHandedOff(LOG_LEVEL::INFO, 0, "Handed pairId=%lld to %s at sequence %llu");
+static LogMessageType kPartitionLeft(LOG_LEVEL::INFO, 0, "Left the cluster, %llu pairs were not taken over");
+static LogMessageType kStandbyError(LOG_LEVEL::ERROR, 0, "HOT_STANDBY cannot be combined with %s");
+static LogMessageType kStandbyEnabled(LOG_LEVEL::INFO, 0,
+    "Hot standby as %s, taking over after %lldms without a primary heartbeat");
+static LogMessageType kStandbyPromoted(LOG_LEVEL::INFO, 0,
+    "No primary heartbeat for %lldms, publishing at epoch %llu, %llu held frames released");
+static LogMessageType kStandbyYielded(LOG_LEVEL::WARNING, 0, "Primary %s at epoch %llu takes precedence, standing by");
+static LogMessageType kChecksumMismatch(LOG_LEVEL::WARNING, 10,
+    "Book checksum of pairId=%lld differs from the primary's at %llu, resyncing");
+static LogMessageType kPairResynced(LOG_LEVEL::INFO, 0, "Resynced pairId=%lld from the primary at sequence %llu");
+static LogMessageType kPairNotResynced(LOG_LEVEL::WARNING, 0,
+    "No checkpoint of pairId=%lld from the primary, continuing from the local book");
+static LogMessageType kGateOverflow(LOG_LEVEL::WARNING, 10,
+    "Standby gate full on %s, oldest held frame dropped, resyncing pairId=%lld");
+static LogMessageType kPairRestarted(LOG_LEVEL::WARNING, 0,
+    "pairId=%lld still resyncing at takeover, restarting it from an empty book at sequence %llu");
+static LogMessageType kStandbyStats(LOG_LEVEL::INFO, 0,
+    "Standby checksums matched=%llu mismatched=%llu unmatched=%llu, gate overflowed=%llu");
+static LogMessageType kShuttingDown(LOG_LEVEL::INFO, 0, "Shutting down...");
+
+static const char* kHeartbeatSubject = "orderbook.cluster.heartbeat";
+static const char* kLeaveSubject = "orderbook.cluster.leave";
+static const char* kStandbyHeartbeatSubject = "orderbook.standby.heartbeat";
+static const char* kStandbyChecksumSubject = "orderbook.standby.checksum";
+
 static void signalHandler(int) {
     g_running.store(false);
 }
 
+// Output subjects of one pair, built once at startup
+struct PairOutput {
+    std::string buySubject;
+    std::string sellSubject;
+    std::string filteredSubject;
+    std::string bboSubject;
+    std::string analyticsSubject;
+    std::string tbtStream;           // outputStream() of the buy/sell subjects
+    uint64_t tbtSequence = 0;        // last frame sequence, shared by the buy and sell subjects
+    uint64_t filteredSequence = 0;
+};
+
+struct GroupOutput {
+    std::string consolidatedSubject;
+    std::string nbboSubject;
+    uint64_t consolidatedSequence = 0;
+};
+
+struct OutputRouting {
+    std::unordered_map<PAIR_ID, PairOutput> pairs;
+    std::unordered_map<PAIR_ID, GroupOutput> groups;   // CONSOLIDATE
+    EventFilterConfig filter;       // TBT_FILTER, derived stream off unless enabled()
+    bool flatSubject = true;        // TBT_FLAT_SUBJECT, also publish every event to orderbook.tbt
+    std::vector<Order> buys, sells, filtered;   // scratch, used by one parser thread at a time
+};
+
+enum class PairOwnership { INACTIVE, PENDING, ACTIVE };
+
+// PARTITIONED=1: this replica processes the pairs the ring assigns it. All
+// NATS callbacks run on one delivery thread; mutex also covers the main
+// thread's handoffs and, with conflation, its processing.
+struct PartitionContext {
+    PartitionContext(const std::string& replicaId, uint64_t memberTimeoutMs)
+        : membership(replicaId, memberTimeoutMs) {}
+
+    ClusterMembership membership;
+    HashRing ring;
+    std::mutex mutex;
+    bool membersChanged = true;
+    int64_t joinAt = 0;              // first rebalance, once peers' heartbeats had time to arrive
+    int64_t handoffTimeoutMs = 500;
+    std::unordered_map<PAIR_ID, PairOwnership> ownership;
+    std::unordered_map<PAIR_ID, natsSubscription*> subscriptions;   // snapshot subjects of owned pairs
+    std::unordered_map<PAIR_ID, std::vector<char>> pendingFrames;   // newest snapshot while PENDING
+};
+
+// HOT_STANDBY=1: a primary and a standby consume the same snapshots; the
+// standby holds its output in the gate until it takes over (src/hot_standby.h).
+// Callbacks of the main connection run on one delivery thread under mutex,
+// which also covers the main thread's takeover and resyncs. Heartbeats come
+// in on a separate connection, so a busy delivery thread does not delay them.
+struct StandbyContext {
+    std::string self;
+    natsConnection* control = nullptr;   // heartbeats
+    int64_t heartbeatMs = 5;
+    int64_t timeoutMs = 50;
+    int64_t checksumMs = 1000;
+    int64_t resyncTimeoutMs = 500;
+
+    std::mutex mutex;
+    std::atomic<bool> primary{false};
+    StandbyGate gate;
+    ChecksumVerifier verifier;
+    std::unordered_map<PAIR_ID, int64_t> lastChecksumAt;
+    // Pairs waiting for the primary's checkpoint, with the snapshots received meanwhile
+    std::unordered_map<PAIR_ID, std::vector<std::vector<char>>> syncing;
+
+    std::mutex heartbeatMutex;
+    uint64_t epoch = 0;                  // of the primary; this processor's while it is one
+    std::string primaryId;
+    int64_t lastHeartbeat = 0;
+    bool heartbeatSeen = false;
+    bool yield = false;                  // a primary that takes precedence showed up
+};
+
+struct ProcessorContext {
+    SeekerNetBoonSnapshotParserToTBT* parser;
+    SnapshotConflator* conflator;   // null unless CONFLATE_PAIRS is set
+    size_t maxDepth;                // MAX_DEPTH, 0 = full received depth
+    bool skipUnchanged;             // SKIP_UNCHANGED, hash sides while decoding
+    ShmRingWriter* shm;             // null unless SHM_RING is set
+    OutputRouting* routing;
+    PartitionContext* partition;    // null unless PARTITIONED is set
+    StandbyContext* standby;        // null unless HOT_STANDBY is set
+};
+
+// False on a standby until it takes over
+static bool isPublishing(const ProcessorContext& ctx) {
+    return !ctx.standby || ctx.standby->primary.load(std::memory_order_relaxed);
+}
+
+static void publishFrame(natsConnection* nc, const char* subject, const char* data, size_t len) {
+    natsStatus s = natsConnection_Publish(nc, subject, data, static_cast<int>(len));
+    if (s != NATS_OK) {
+        AsyncLogger::instance().log(kPublishError, natsStatus_GetText(s));
+    }
+}
+
+static void startResync(StandbyContext& standby, PAIR_ID pairId);
+
+// Frames are numbered per stream so consumers can detect loss (TbtBookBuilder).
+// A standby numbers them the same way and holds them in its gate; after a
+// takeover it still skips those the old primary had published. A full gate
+// loses the stream's oldest frame, so the pair is resynced from the primary.
+static void publishOrders(natsConnection* nc, ProcessorContext& ctx, const std::string& subject,
+                          const std::string& stream, const std::vector<Order>& orders, uint64_t& sequence) {
+    if (orders.empty()) return;
+    std::vector<char> outBuf = serializeOrders(orders, ++sequence);
+    if (ctx.standby && ctx.standby->gate.published(stream) >= sequence) return;
+    if (isPublishing(ctx)) {
+        publishFrame(nc, subject.c_str(), outBuf.data(), outBuf.size());
+    } else if (!ctx.standby->gate.hold(stream, subject, sequence, outBuf.data(), outBuf.size()) &&
+               ctx.standby->syncing.count(orders[0].pairId) == 0) {
+        AsyncLogger::instance().log(kGateOverflow, stream.c_str(), orders[0].pairId);
+        startResync(*ctx.standby, orders[0].pairId);
+    }
+}
+
+static void checksumSnapshot(natsConnection* nc, ProcessorContext& ctx, PAIR_ID pairId);
+
+static void processSnapshot(natsConnection* nc, ProcessorContext& ctx,
+                            PAIR_ID pairId, ORDER_TIME timestamp,
+                            std::vector<bookElement>& buyBook, std::vector<bookElement>& sellBook,
+                            const BookHashes* hashes = nullptr) {
+    SeekerNetBoonSnapshotParserToTBT& parser = *ctx.parser;
+    parser.ApplySnapshot(pairId, buyBook, sellBook, timestamp, hashes);
+    bool publishing = isPublishing(ctx);
+
+    const auto& orders = parser.getEmittedOrders();
+    if (!orders.empty()) {
+        OutputRouting& routing = *ctx.routing;
+        PairOutput& output = routing.pairs.at(pairId);
+        routing.buys.clear();
+        routing.sells.clear();
+        splitBySide(orders, routing.buys, routing.sells);
+        publishOrders(nc, ctx, output.buySubject, output.tbtStream, routing.buys, output.tbtSequence);
+        publishOrders(nc, ctx, output.sellSubject, output.tbtStream, routing.sells, output.tbtSequence);
+
+        if (routing.filter.enabled()) {
+            routing.filtered.clear();
+            filterEvents(routing.filter, orders, parser.getBuySide(pairId), parser.getSellSide(pairId),
+                         routing.filtered);
+            publishOrders(nc, ctx, output.filteredSubject, output.filteredSubject, routing.filtered,
+                          output.filteredSequence);
+        }
+
+        if (publishing && (routing.flatSubject || ctx.shm)) {
+            std::vector<char> outBuf = serializeOrders(orders);
+            if (routing.flatSubject) {
+                publishFrame(nc, "orderbook.tbt", outBuf.data(), outBuf.size());
+            }
+            if (ctx.shm && !ctx.shm->publish(outBuf.data(), outBuf.size())) {
+                AsyncLogger::instance().log(kShmFrameTooLarge, outBuf.size());
+            }
+        }
+    }
+
+    // Unsequenced streams: a standby drops them, consumers take the next update
+    for (const Bbo& bbo : parser.getBboUpdates()) {
+        if (!publishing) break;
+        char bboBuf[WIRE_BBO_SIZE];
+        serializeBbo(bbo, bboBuf);
+        publishFrame(nc, ctx.routing->pairs.at(bbo.pairId).bboSubject.c_str(), bboBuf, WIRE_BBO_SIZE);
+    }
+
+    // A snapshot updates at most one consolidation group
+    const auto& consolidated = parser.getConsolidatedOrders();
+    if (!consolidated.empty()) {
+        GroupOutput& group = ctx.routing->groups.at(consolidated.front().pairId);
+        publishOrders(nc, ctx, group.consolidatedSubject, group.consolidatedSubject, consolidated,
+                      group.consolidatedSequence);
+    }
+    for (const Bbo& nbbo : parser.getNbboUpdates()) {
+        if (!publishing) break;
+        char nbboBuf[WIRE_BBO_SIZE];
+        serializeBbo(nbbo, nbboBuf);
+        publishFrame(nc, ctx.routing->groups.at(nbbo.pairId).nbboSubject.c_str(), nbboBuf, WIRE_BBO_SIZE);
+    }
+
+    // Metrics follow the event batch of the snapshot they describe
+    for (const BookAnalytics& analytics : parser.getAnalytics()) {
+        if (!publishing) break;
+        char analyticsBuf[WIRE_ANALYTICS_SIZE];
+        serializeAnalytics(analytics, analyticsBuf);
+        publishFrame(nc, ctx.routing->pairs.at(analytics.pairId).analyticsSubject.c_str(), analyticsBuf,
+                     WIRE_ANALYTICS_SIZE);
+    }
+
+    parser.clearEmittedOrders();
+    if (ctx.standby) checksumSnapshot(nc, ctx, pairId);
+}
+
+// Decodes one snapshot frame and hands it to the conflator or the parser
+static void handleSnapshotFrame(natsConnection* nc, ProcessorContext* ctx, const char* data, int dataLen) {
+    PAIR_ID pairId;
+    ORDER_TIME timestamp;
+    static thread_local std::vector<bookElement> buyBook, sellBook;
+    BookHashes hashes;
+    bool hashWhileDecoding = ctx->skipUnchanged && !ctx->conflator;
+
+    if (!deserializeSnapshot(data, static_cast<size_t>(dataLen), pairId, timestamp, buyBook, sellBook,
+                             ctx->maxDepth, hashWhileDecoding ? &hashes : nullptr)) {
+        AsyncLogger::instance().log(kDeserializeFailed, dataLen);
+        return;
+    }
+
+    if (ctx->conflator) {
+        if (!ctx->conflator->Offer(pairId, timestamp, buyBook, sellBook)) {
+            AsyncLogger::instance().log(kUnknownPair, pairId);
+        }
+    } else if (ctx->routing->pairs.count(pairId) == 0) {
+        AsyncLogger::instance().log(kUnknownPair, pairId);
+    } else {
+        processSnapshot(nc, *ctx, pairId, timestamp, buyBook, sellBook,
+                        hashWhileDecoding ? &hashes : nullptr);
+    }
+}
+
 static void onMessage(natsConnection* nc, natsSubscription*, natsMsg* msg, void* closure) {
-    auto* parser = static_cast<SeekerNetBoonSnapshotParserToTBT*>(closure);
+    handleSnapshotFrame(nc, static_cast<ProcessorContext*>(closure),
+                        natsMsg_GetData(msg), natsMsg_GetDataLength(msg));
+    natsMsg_Destroy(msg);
+}
 
+// Partitioned mode: snapshots of one owned pair. Frames of a pair being
+// taken over wait for its checkpoint; the newest one is kept.
+static void onPartitionedSnapshot(natsConnection* nc, natsSubscription*, natsMsg* msg, void* closure) {
+    ProcessorContext* ctx = static_cast<ProcessorContext*>(closure);
+    PartitionContext& partition = *ctx->partition;
     const char* data = natsMsg_GetData(msg);
     int dataLen = natsMsg_GetDataLength(msg);
+    if (dataLen < static_cast<int>(WIRE_SNAPSHOT_HEADER_SIZE)) {
+        AsyncLogger::instance().log(kDeserializeFailed, dataLen);
+        natsMsg_Destroy(msg);
+        return;
+    }
+    PAIR_ID pairId = static_cast<PAIR_ID>(wire_detail::read_i64_le(data));
+    {
+        std::lock_guard<std::mutex> lock(partition.mutex);
+        auto it = partition.ownership.find(pairId);
+        if (it != partition.ownership.end() && it->second == PairOwnership::ACTIVE) {
+            handleSnapshotFrame(nc, ctx, data, dataLen);
+        } else if (it != partition.ownership.end() && it->second == PairOwnership::PENDING) {
+            partition.pendingFrames[pairId].assign(data, data + dataLen);
+        }
+    }
+    natsMsg_Destroy(msg);
+}
 
-    PAIR_ID pairId;
-    ORDER_TIME timestamp;
-    std::vector<bookElement> buyBook, sellBook;
+static void onClusterMessage(natsConnection*, natsSubscription*, natsMsg* msg, void* closure) {
+    PartitionContext& partition = *static_cast<PartitionContext*>(closure);
+    std::string id(natsMsg_GetData(msg), static_cast<size_t>(natsMsg_GetDataLength(msg)));
+    bool leave = std::strcmp(natsMsg_GetSubject(msg), kLeaveSubject) == 0;
+    uint64_t now = static_cast<uint64_t>(nats_Now());
+    {
+        std::lock_guard<std::mutex> lock(partition.mutex);
+        if (leave ? partition.membership.leave(id, now) : partition.membership.heartbeat(id, now)) {
+            partition.membersChanged = true;
+        }
+    }
+    natsMsg_Destroy(msg);
+}
+
+// Stops processing a pair; called with the partition mutex held
+static void releasePair(PartitionContext& partition, PAIR_ID pairId) {
+    partition.ownership[pairId] = PairOwnership::INACTIVE;
+    partition.pendingFrames.erase(pairId);
+    auto it = partition.subscriptions.find(pairId);
+    if (it != partition.subscriptions.end()) {
+        natsSubscription_Unsubscribe(it->second);
+        natsSubscription_Destroy(it->second);
+        partition.subscriptions.erase(it);
+    }
+}
+
+// Pair id of a per-pair subject such as orderbook.checkpoint.<pair>, 0 if none
+static PAIR_ID pairOfSubject(const char* subject) {
+    const char* dot = std::strrchr(subject, '.');
+    return dot ? static_cast<PAIR_ID>(std::strtoll(dot + 1, nullptr, 10)) : 0;
+}
+
+// A replica taking over a pair asks for it on orderbook.checkpoint.<pair>. The
+// owner answers with its book and output sequences and stops processing the
+// pair in the same step, so no snapshot is applied by both.
+static void onCheckpointRequest(natsConnection* nc, natsSubscription*, natsMsg* msg, void* closure) {
+    ProcessorContext* ctx = static_cast<ProcessorContext*>(closure);
+    PartitionContext& partition = *ctx->partition;
+    const char* reply = natsMsg_GetReply(msg);
+    PAIR_ID pairId = pairOfSubject(natsMsg_GetSubject(msg));
+    std::string requester(natsMsg_GetData(msg), static_cast<size_t>(natsMsg_GetDataLength(msg)));
+    {
+        std::lock_guard<std::mutex> lock(partition.mutex);
+        auto it = partition.ownership.find(pairId);
+        if (reply && it != partition.ownership.end() && it->second == PairOwnership::ACTIVE &&
+            requester != partition.membership.self()) {
+            PairCheckpoint checkpoint;
+            captureCheckpoint(*ctx->parser, pairId, checkpoint);
+            const PairOutput& output = ctx->routing->pairs.at(pairId);
+            checkpoint.tbtSequence = output.tbtSequence;
+            checkpoint.filteredSequence = output.filteredSequence;
+            std::vector<char> wire = serializeCheckpoint(checkpoint);
+            releasePair(partition, pairId);
+            natsStatus s = natsConnection_Publish(nc, reply, wire.data(), static_cast<int>(wire.size()));
+            if (s != NATS_OK) {
+                AsyncLogger::instance().log(kPublishError, natsStatus_GetText(s));
+            }
+            AsyncLogger::instance().log(kPairHandedOff, pairId, requester.c_str(), checkpoint.tbtSequence);
+        }
+    }
+    natsMsg_Destroy(msg);
+}
+
+// Restarts a pair's output sequences above any an earlier owner published
+// (restartSequence), so consumers see a gap and resync rather than drop the
+// frames as duplicates
+static void restartSequences(PairOutput& output) {
+    uint64_t now = static_cast<uint64_t>(nats_Now());
+    output.tbtSequence = restartSequence(output.tbtSequence, now);
+    output.filteredSequence = restartSequence(output.filteredSequence, now);
+}
+
+// Drops a pair's book and restarts its sequences: the next snapshot goes out
+// as the full book, after a gap
+static void restartPair(ProcessorContext& ctx, PAIR_ID pairId) {
+    std::vector<bookElement> empty, emptyAsks;
+    ctx.parser->LoadBook(pairId, empty, emptyAsks, ctx.parser->getLastSnapshotTime(pairId), SeekerBounds());
+    restartSequences(ctx.routing->pairs.at(pairId));
+}
+
+// Starts processing a pair from its checkpoint, or restarts it when no
+// replica had it (first start, or its owner died). Partition mutex held.
+static void activatePair(natsConnection* nc, ProcessorContext& ctx, PAIR_ID pairId, PairCheckpoint* checkpoint) {
+    PartitionContext& partition = *ctx.partition;
+    PairOutput& output = ctx.routing->pairs.at(pairId);
+    if (checkpoint) {
+        restoreCheckpoint(*ctx.parser, *checkpoint);
+        output.tbtSequence = checkpoint->tbtSequence;
+        output.filteredSequence = checkpoint->filteredSequence;
+        AsyncLogger::instance().log(kPairTakenOver, pairId, output.tbtSequence);
+    } else {
+        restartPair(ctx, pairId);
+        AsyncLogger::instance().log(kPairNoCheckpoint, pairId, output.tbtSequence);
+    }
+    partition.ownership[pairId] = PairOwnership::ACTIVE;
+    auto pending = partition.pendingFrames.find(pairId);
+    if (pending != partition.pendingFrames.end()) {
+        std::vector<char> frame;
+        frame.swap(pending->second);
+        partition.pendingFrames.erase(pending);
+        handleSnapshotFrame(nc, &ctx, frame.data(), static_cast<int>(frame.size()));
+    }
+}
+
+// Requests the checkpoints of pairs on subject(pair) and passes each reply to
+// onCheckpoint, until timeoutMs is over or giveUp (polled, may be empty) says
+// so. Returns the pairs nobody answered for.
+static std::unordered_set<PAIR_ID> collectCheckpoints(natsConnection* nc, const std::vector<PAIR_ID>& pairs,
+                                                      std::string (*subject)(PAIR_ID), const std::string& requester,
+                                                      int64_t timeoutMs,
+                                                      const std::function<void(PairCheckpoint&)>& onCheckpoint,
+                                                      const std::function<bool()>& giveUp) {
+    natsInbox* inbox = NULL;
+    natsSubscription* replies = NULL;
+    natsStatus s = natsInbox_Create(&inbox);
+    if (s == NATS_OK) s = natsConnection_SubscribeSync(&replies, nc, inbox);
+    if (s == NATS_OK) s = natsConnection_FlushTimeout(nc, timeoutMs);
+    for (size_t i = 0; s == NATS_OK && i < pairs.size(); i++) {
+        s = natsConnection_PublishRequest(nc, subject(pairs[i]).c_str(), inbox, requester.data(),
+                                          static_cast<int>(requester.size()));
+    }
+    if (s != NATS_OK) {
+        AsyncLogger::instance().log(kPublishError, natsStatus_GetText(s));
+    }
 
-    if (!deserializeSnapshot(data, static_cast<size_t>(dataLen), pairId, timestamp, buyBook, sellBook)) {
-        fprintf(stderr, "Failed to deserialize snapshot (%d bytes)\n", dataLen);
+    std::unordered_set<PAIR_ID> waiting(pairs.begin(), pairs.end());
+    int64_t deadline = nats_Now() + timeoutMs;
+    while (s == NATS_OK && !waiting.empty() && !(giveUp && giveUp())) {
+        int64_t remaining = deadline - nats_Now();
+        if (remaining <= 0) break;
+        natsMsg* reply = NULL;
+        natsStatus next = natsSubscription_NextMsg(&reply, replies, std::min<int64_t>(remaining, 10));
+        if (next == NATS_TIMEOUT) continue;
+        if (next != NATS_OK) break;
+        PairCheckpoint checkpoint;
+        if (deserializeCheckpoint(natsMsg_GetData(reply), static_cast<size_t>(natsMsg_GetDataLength(reply)),
+                                  checkpoint) && waiting.erase(checkpoint.pairId) > 0) {
+            onCheckpoint(checkpoint);
+        }
+        natsMsg_Destroy(reply);
+    }
+    natsSubscription_Destroy(replies);
+    natsInbox_Destroy(inbox);
+    return waiting;
+}
+
+// Takes over pairs the ring moved to this replica: subscribes to their
+// snapshots first, so none published after the old owner's checkpoint is
+// missed, then collects the checkpoints of all of them within one timeout
+static void acquirePairs(natsConnection* nc, ProcessorContext& ctx, const std::vector<PAIR_ID>& pairs) {
+    PartitionContext& partition = *ctx.partition;
+    std::unordered_set<PAIR_ID> missing = collectCheckpoints(
+        nc, pairs, checkpointSubject, partition.membership.self(), partition.handoffTimeoutMs,
+        [&](PairCheckpoint& checkpoint) {
+            std::lock_guard<std::mutex> lock(partition.mutex);
+            if (partition.ownership[checkpoint.pairId] == PairOwnership::PENDING) {
+                activatePair(nc, ctx, checkpoint.pairId, &checkpoint);
+            }
+        }, nullptr);
+    std::lock_guard<std::mutex> lock(partition.mutex);
+    for (PAIR_ID pairId : missing) {
+        if (partition.ownership[pairId] == PairOwnership::PENDING) activatePair(nc, ctx, pairId, nullptr);
+    }
+}
+
+// Main thread, every loop: expires silent replicas and, if the member set
+// changed, takes over the pairs that moved here. Pairs that moved away keep
+// being processed until their new owner asks for them.
+static void rebalancePartition(natsConnection* nc, ProcessorContext& ctx, const std::vector<PAIR_ID>& pairIds) {
+    PartitionContext& partition = *ctx.partition;
+    int64_t now = nats_Now();
+    if (now < partition.joinAt) return;
+    std::vector<PAIR_ID> gained;
+    {
+        std::lock_guard<std::mutex> lock(partition.mutex);
+        if (partition.membership.expire(static_cast<uint64_t>(now))) partition.membersChanged = true;
+        if (!partition.membersChanged) return;
+        partition.membersChanged = false;
+        std::vector<std::string> members = partition.membership.members();
+        partition.ring.setMembers(members);
+        size_t owned = 0;
+        for (PAIR_ID pairId : pairIds) {
+            if (partition.ring.owner(pairId) != partition.membership.self()) continue;
+            owned++;
+            if (partition.ownership[pairId] != PairOwnership::INACTIVE) continue;
+            natsSubscription* sub = NULL;
+            natsStatus s = natsConnection_Subscribe(&sub, nc, snapshotSubject(pairId).c_str(),
+                                                    onPartitionedSnapshot, &ctx);
+            if (s != NATS_OK) {
+                AsyncLogger::instance().log(kSubscribeError, natsStatus_GetText(s));
+                partition.membersChanged = true;   // retried on the next pass
+                continue;
+            }
+            partition.subscriptions[pairId] = sub;
+            partition.ownership[pairId] = PairOwnership::PENDING;
+            gained.push_back(pairId);
+        }
+        AsyncLogger::instance().log(kPartitionMembers, members.size(), owned, pairIds.size());
+    }
+    if (!gained.empty()) acquirePairs(nc, ctx, gained);
+}
+
+// Standby: snapshots go through the parser like on the primary, except for
+// pairs waiting for a checkpoint, which keep theirs for the replay
+static void onStandbySnapshot(natsConnection* nc, natsSubscription*, natsMsg* msg, void* closure) {
+    ProcessorContext* ctx = static_cast<ProcessorContext*>(closure);
+    StandbyContext& standby = *ctx->standby;
+    const char* data = natsMsg_GetData(msg);
+    int dataLen = natsMsg_GetDataLength(msg);
+    if (dataLen < static_cast<int>(WIRE_SNAPSHOT_HEADER_SIZE)) {
+        AsyncLogger::instance().log(kDeserializeFailed, dataLen);
         natsMsg_Destroy(msg);
         return;
     }
+    PAIR_ID pairId = static_cast<PAIR_ID>(wire_detail::read_i64_le(data));
+    {
+        std::lock_guard<std::mutex> lock(standby.mutex);
+        auto it = standby.syncing.find(pairId);
+        if (it != standby.syncing.end()) {
+            it->second.emplace_back(data, data + dataLen);
+        } else {
+            handleSnapshotFrame(nc, ctx, data, dataLen);
+        }
+    }
+    natsMsg_Destroy(msg);
+}
 
-    parser->EmitOrdersAndUpdateOldBuyBook(pairId, buyBook, timestamp);
-    parser->EmitOrdersAndUpdateOldSellBook(pairId, sellBook, timestamp);
+// Standby: the primary's TBT and filtered frames, whose sequences release the gate
+static void onPrimaryOutput(natsConnection*, natsSubscription*, natsMsg* msg, void* closure) {
+    StandbyContext& standby = *static_cast<StandbyContext*>(closure);
+    OrderFrameView frame;
+    if (frame.parse(natsMsg_GetData(msg), static_cast<size_t>(natsMsg_GetDataLength(msg)))) {
+        std::lock_guard<std::mutex> lock(standby.mutex);
+        if (!standby.primary.load()) standby.gate.observe(outputStream(natsMsg_GetSubject(msg)), frame.sequence());
+    }
+    natsMsg_Destroy(msg);
+}
 
-    const auto& orders = parser->getEmittedOrders();
-    if (!orders.empty()) {
-        std::vector<char> outBuf = serializeOrders(orders);
-        natsStatus s = natsConnection_Publish(nc, "orderbook.tbt",
-            outBuf.data(), static_cast<int>(outBuf.size()));
-        if (s != NATS_OK) {
-            fprintf(stderr, "Publish error: %s\n", natsStatus_GetText(s));
+// Marks a pair for a resync from the primary; standby mutex held
+static void startResync(StandbyContext& standby, PAIR_ID pairId) {
+    standby.syncing[pairId];
+}
+
+// Primary: publishes the pair's checksum every HOT_STANDBY_CHECKSUM_MS.
+// Standby: compares its own with the primary's of the same snapshot.
+static void checksumSnapshot(natsConnection* nc, ProcessorContext& ctx, PAIR_ID pairId) {
+    StandbyContext& standby = *ctx.standby;
+    BookChecksum checksum;
+    checksum.pairId = pairId;
+    checksum.time = ctx.parser->getLastSnapshotTime(pairId);
+    checksum.buyHash = ctx.parser->getBookHash(pairId, ORDER_SIDE::BUY);
+    checksum.sellHash = ctx.parser->getBookHash(pairId, ORDER_SIDE::SELL);
+    checksum.sequence = ctx.routing->pairs.at(pairId).tbtSequence;
+    if (standby.primary.load()) {
+        int64_t now = nats_Now();
+        int64_t& last = standby.lastChecksumAt[pairId];
+        if (now - last < standby.checksumMs) return;
+        last = now;
+        char wire[WIRE_CHECKSUM_SIZE];
+        serializeChecksum(checksum, wire);
+        publishFrame(nc, kStandbyChecksumSubject, wire, WIRE_CHECKSUM_SIZE);
+    } else if (standby.verifier.recordLocal(checksum) == CHECKSUM_RESULT::MISMATCH) {
+        AsyncLogger::instance().log(kChecksumMismatch, pairId, checksum.time);
+        startResync(standby, pairId);
+    }
+}
+
+static void onPrimaryChecksum(natsConnection*, natsSubscription*, natsMsg* msg, void* closure) {
+    ProcessorContext* ctx = static_cast<ProcessorContext*>(closure);
+    StandbyContext& standby = *ctx->standby;
+    BookChecksum checksum;
+    if (deserializeChecksum(natsMsg_GetData(msg), static_cast<size_t>(natsMsg_GetDataLength(msg)), checksum) &&
+        ctx->routing->pairs.count(checksum.pairId) > 0) {
+        std::lock_guard<std::mutex> lock(standby.mutex);
+        if (!standby.primary.load() && standby.syncing.count(checksum.pairId) == 0 &&
+            standby.verifier.checkRemote(checksum) == CHECKSUM_RESULT::MISMATCH) {
+            AsyncLogger::instance().log(kChecksumMismatch, checksum.pairId, checksum.time);
+            startResync(standby, checksum.pairId);
+        }
+    }
+    natsMsg_Destroy(msg);
+}
+
+// Primary: answers a standby's resync request with the pair's book and sequences
+static void onStandbyCheckpointRequest(natsConnection* nc, natsSubscription*, natsMsg* msg, void* closure) {
+    ProcessorContext* ctx = static_cast<ProcessorContext*>(closure);
+    StandbyContext& standby = *ctx->standby;
+    const char* reply = natsMsg_GetReply(msg);
+    PAIR_ID pairId = pairOfSubject(natsMsg_GetSubject(msg));
+    {
+        std::lock_guard<std::mutex> lock(standby.mutex);
+        if (reply && standby.primary.load() && ctx->routing->pairs.count(pairId) > 0 &&
+            standby.syncing.count(pairId) == 0) {
+            PairCheckpoint checkpoint;
+            captureCheckpoint(*ctx->parser, pairId, checkpoint);
+            const PairOutput& output = ctx->routing->pairs.at(pairId);
+            checkpoint.tbtSequence = output.tbtSequence;
+            checkpoint.filteredSequence = output.filteredSequence;
+            std::vector<char> wire = serializeCheckpoint(checkpoint);
+            publishFrame(nc, reply, wire.data(), wire.size());
         }
     }
+    natsMsg_Destroy(msg);
+}
 
-    parser->clearEmittedOrders();
+// Heartbeats are "<epoch> <id>", sent by the primary every HOT_STANDBY_HEARTBEAT_MS
+static void onStandbyHeartbeat(natsConnection*, natsSubscription*, natsMsg* msg, void* closure) {
+    StandbyContext& standby = *static_cast<StandbyContext*>(closure);
+    std::string payload(natsMsg_GetData(msg), static_cast<size_t>(natsMsg_GetDataLength(msg)));
     natsMsg_Destroy(msg);
+    char* end = nullptr;
+    uint64_t epoch = std::strtoull(payload.c_str(), &end, 10);
+    if (*end != ' ') return;
+    std::string id(end + 1);
+    if (id == standby.self) return;
+
+    std::lock_guard<std::mutex> lock(standby.heartbeatMutex);
+    if (standby.primary.load()) {
+        if (!yieldsTo(standby.epoch, standby.self, epoch, id)) return;
+        standby.yield = true;
+    } else if (epoch < standby.epoch) {
+        return;   // a former primary that has not noticed its successor yet
+    }
+    standby.epoch = epoch;
+    standby.primaryId = id;
+    standby.lastHeartbeat = nats_Now();
+    standby.heartbeatSeen = true;
+}
+
+static void publishHeartbeat(StandbyContext& standby) {
+    std::string payload;
+    {
+        std::lock_guard<std::mutex> lock(standby.heartbeatMutex);
+        payload = std::to_string(standby.epoch) + " " + standby.self;
+    }
+    natsConnection_PublishString(standby.control, kStandbyHeartbeatSubject, payload.c_str());
+}
+
+static bool primaryExpired(StandbyContext& standby) {
+    std::lock_guard<std::mutex> lock(standby.heartbeatMutex);
+    return nats_Now() - standby.lastHeartbeat >= standby.timeoutMs;
+}
+
+// Ends a pair's resync, from the primary's checkpoint if there is one, and
+// replays the snapshots that arrived meanwhile. Standby mutex held.
+static void resumePair(natsConnection* nc, ProcessorContext& ctx, PAIR_ID pairId, PairCheckpoint* checkpoint) {
+    StandbyContext& standby = *ctx.standby;
+    auto it = standby.syncing.find(pairId);
+    if (it == standby.syncing.end()) return;
+    std::vector<std::vector<char>> frames;
+    frames.swap(it->second);
+    standby.syncing.erase(it);
+    if (checkpoint) {
+        PairOutput& output = ctx.routing->pairs.at(pairId);
+        restoreCheckpoint(*ctx.parser, *checkpoint);
+        output.tbtSequence = checkpoint->tbtSequence;
+        output.filteredSequence = checkpoint->filteredSequence;
+        standby.gate.reset(output.tbtStream, output.tbtSequence);
+        standby.gate.reset(output.filteredSubject, output.filteredSequence);
+        AsyncLogger::instance().log(kPairResynced, pairId, output.tbtSequence);
+    } else {
+        AsyncLogger::instance().log(kPairNotResynced, pairId);
+    }
+    standby.verifier.reset(pairId);
+    for (const std::vector<char>& frame : frames) {
+        handleSnapshotFrame(nc, &ctx, frame.data(), static_cast<int>(frame.size()));
+    }
+}
+
+// Standby: fetches the primary's checkpoints of the pairs being resynced,
+// giving up early if the primary dies meanwhile
+static void resyncPairs(natsConnection* nc, ProcessorContext& ctx) {
+    StandbyContext& standby = *ctx.standby;
+    std::vector<PAIR_ID> pairs;
+    {
+        std::lock_guard<std::mutex> lock(standby.mutex);
+        for (const auto& pair : standby.syncing) pairs.push_back(pair.first);
+    }
+    if (pairs.empty()) return;
+    std::unordered_set<PAIR_ID> missing = collectCheckpoints(
+        nc, pairs, standbyCheckpointSubject, standby.self, standby.resyncTimeoutMs,
+        [&](PairCheckpoint& checkpoint) {
+            std::lock_guard<std::mutex> lock(standby.mutex);
+            resumePair(nc, ctx, checkpoint.pairId, &checkpoint);
+        },
+        [&]() { return primaryExpired(standby); });
+    std::lock_guard<std::mutex> lock(standby.mutex);
+    for (PAIR_ID pairId : missing) resumePair(nc, ctx, pairId, nullptr);
+}
+
+// Standby to primary: publishes the held frames the old primary never sent,
+// then everything from here on, so each stream continues where it stopped.
+// Pairs still waiting for a checkpoint have a book known to be wrong: their
+// held frames are dropped and they restart, so their consumers see a gap.
+static void takeOver(natsConnection* nc, ProcessorContext& ctx) {
+    StandbyContext& standby = *ctx.standby;
+    std::lock_guard<std::mutex> lock(standby.mutex);
+    uint64_t epoch;
+    {
+        std::lock_guard<std::mutex> heartbeatLock(standby.heartbeatMutex);
+        epoch = ++standby.epoch;
+        standby.primaryId = standby.self;
+    }
+    std::unordered_map<PAIR_ID, std::vector<std::vector<char>>> syncing;
+    syncing.swap(standby.syncing);
+    for (const auto& pair : syncing) {
+        const PairOutput& output = ctx.routing->pairs.at(pair.first);
+        restartPair(ctx, pair.first);
+        standby.gate.reset(output.tbtStream, output.tbtSequence);
+        standby.gate.reset(output.filteredSubject, output.filteredSequence);
+        standby.verifier.reset(pair.first);
+        AsyncLogger::instance().log(kPairRestarted, pair.first, output.tbtSequence);
+    }
+    uint64_t held = standby.gate.held();
+    standby.gate.release([nc](const std::string& subject, const std::vector<char>& frame) {
+        publishFrame(nc, subject.c_str(), frame.data(), frame.size());
+    });
+    standby.primary.store(true);
+    publishHeartbeat(standby);
+    for (const auto& pair : syncing) {
+        for (const std::vector<char>& frame : pair.second) {
+            handleSnapshotFrame(nc, &ctx, frame.data(), static_cast<int>(frame.size()));
+        }
+    }
+    AsyncLogger::instance().log(kStandbyPromoted, standby.timeoutMs, epoch, held);
+}
+
+// Primary to standby, when another primary takes precedence: every pair is
+// resynced from it before this processor follows again
+static void standBy(ProcessorContext& ctx, const std::vector<PAIR_ID>& pairIds) {
+    StandbyContext& standby = *ctx.standby;
+    std::lock_guard<std::mutex> lock(standby.mutex);
+    standby.primary.store(false);
+    standby.gate = StandbyGate();
+    standby.verifier = ChecksumVerifier();
+    for (PAIR_ID pairId : pairIds) standby.syncing[pairId].clear();
+    std::lock_guard<std::mutex> heartbeatLock(standby.heartbeatMutex);
+    AsyncLogger::instance().log(kStandbyYielded, standby.primaryId.c_str(), standby.epoch);
+}
+
+// Main thread, every millisecond: takes over when the primary's heartbeats
+// stop, stands by when a primary with precedence shows up, and resyncs pairs
+static void superviseStandby(natsConnection* nc, ProcessorContext& ctx, const std::vector<PAIR_ID>& pairIds) {
+    StandbyContext& standby = *ctx.standby;
+    bool yield, seen;
+    {
+        std::lock_guard<std::mutex> lock(standby.heartbeatMutex);
+        yield = standby.yield;
+        seen = standby.heartbeatSeen;
+        standby.yield = false;
+    }
+    if (standby.primary.load()) {
+        if (yield) standBy(ctx, pairIds);
+    } else if (primaryExpired(standby)) {
+        takeOver(nc, ctx);
+    } else if (seen) {
+        resyncPairs(nc, ctx);
+    }
+}
+
+#ifdef BUNI_MULTICAST
+struct MulticastLatency {
+    uint64_t samples = 0;
+    double sumUs = 0;
+    double maxUs = 0;
+};
+
+// Multicast ingest thread: same handling as onMessage, one frame per arbitrated datagram
+static void runMulticastIngest(natsConnection* nc, ProcessorContext* ctx, MulticastSnapshotFeed* feed,
+                               MulticastLatency* latency) {
+    while (g_running.load()) {
+        feed->poll(100, [&](const char* data, size_t length, uint64_t rxTimeNs) {
+            handleSnapshotFrame(nc, ctx, data, static_cast<int>(length));
+            uint64_t nowNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+            double us = nowNs > rxTimeNs ? (nowNs - rxTimeNs) / 1000.0 : 0.0;
+            latency->samples++;
+            latency->sumUs += us;
+            if (us > latency->maxUs) latency->maxUs = us;
+        });
+    }
+}
+#endif
+
+// REPLICA_ID, else $HOSTNAME, else processor-<pid>
+static std::string replicaIdFromEnv() {
+    const char* replicaId = getenv("REPLICA_ID");
+    if (!replicaId || !*replicaId) replicaId = getenv("HOSTNAME");
+    return replicaId && *replicaId ? replicaId : "processor-" + std::to_string(getpid());
+}
+
+// CONFLATE_PAIRS: "all" or a comma separated list of pair ids
+static std::vector<PAIR_ID> parseConflatedPairs(const char* spec, const std::vector<PAIR_ID>& pairIds) {
+    std::vector<PAIR_ID> result;
+    if (!spec || !*spec) return result;
+    if (std::strcmp(spec, "all") == 0) return pairIds;
+
+    const char* p = spec;
+    while (*p) {
+        char* end = nullptr;
+        long long id = std::strtoll(p, &end, 10);
+        if (end == p) break;
+        if (std::find(pairIds.begin(), pairIds.end(), static_cast<PAIR_ID>(id)) != pairIds.end()) {
+            result.push_back(static_cast<PAIR_ID>(id));
+        }
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return result;
 }
 
 int main() {
     signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
 
     natsOptions* opts = NULL;
     natsConnection* conn = NULL;
@@ -56,38 +868,439 @@ int main() {
     const char* nats_url = getenv("NATS_URL");
     if (!nats_url) nats_url = "nats://localhost:4222";
 
+    // PARTITIONED=1: replicas split the pairs by consistent hashing and hand
+    // them over with their books when replicas join or leave (src/pair_partition.h).
+    // Each pair is read from orderbook.snapshots.<pair>; REPLICA_ID names this
+    // replica (default $HOSTNAME), HEARTBEAT_MS (default 250) paces its heartbeats,
+    // MEMBER_TIMEOUT_MS (default 1000) drops silent replicas and
+    // HANDOFF_TIMEOUT_MS (default 500) bounds the wait for a checkpoint.
+    const char* partitioned = getenv("PARTITIONED");
+    bool partitionMode = partitioned && std::strcmp(partitioned, "1") == 0;
+    // HOT_STANDBY=1: run two processors on the same snapshots; the first one up
+    // publishes, the other stays book-identical and takes over publishing when
+    // the primary's heartbeats stop (src/hot_standby.h). REPLICA_ID names it as
+    // above; HOT_STANDBY_HEARTBEAT_MS (default 5) paces the primary's heartbeats,
+    // HOT_STANDBY_TIMEOUT_MS (default 50) is the silence before a takeover,
+    // HOT_STANDBY_CHECKSUM_MS (default 1000) paces the per-pair book checksums
+    // and HANDOFF_TIMEOUT_MS bounds a resync.
+    const char* hotStandby = getenv("HOT_STANDBY");
+    bool standbyMode = hotStandby && std::strcmp(hotStandby, "1") == 0;
+
     natsStatus s = natsOptions_Create(&opts);
     if (s == NATS_OK) s = natsOptions_SetURL(opts, nats_url);
+    if (s == NATS_OK && (partitionMode || standbyMode)) {
+        // One delivery thread for every subscription: the callbacks share the parser
+        s = nats_SetMessageDeliveryPoolSize(1);
+        if (s == NATS_OK) s = natsOptions_UseGlobalMessageDelivery(opts, true);
+    }
+    // The standby watches the primary's output, not its own
+    if (s == NATS_OK && standbyMode) s = natsOptions_SetNoEcho(opts, true);
     if (s != NATS_OK) {
-        fprintf(stderr, "Options error: %s\n", natsStatus_GetText(s));
+        AsyncLogger::instance().log(kOptionsError, natsStatus_GetText(s));
         return 1;
     }
 
     s = natsConnection_Connect(&conn, opts);
     if (s != NATS_OK) {
-        fprintf(stderr, "Connect error: %s\n", natsStatus_GetText(s));
+        AsyncLogger::instance().log(kConnectError, natsStatus_GetText(s));
         natsOptions_Destroy(opts);
         return 1;
     }
-    printf("Connected to NATS\n");
+    AsyncLogger::instance().log(kConnected);
 
-    SeekerNetBoonSnapshotParserToTBT parser({1});
+    // CONSOLIDATE=100=1,2;101=3,4: consolidate the books of pairs quoting one
+    // instrument on several venues; events go to orderbook.consolidated.<group>
+    // and NBBO updates to orderbook.nbbo.<group>. Member pairs are added to the pair set.
+    // PAIRS=1,2,10-19: pairs to accept snapshots for (default 1)
+    std::vector<PAIR_ID> pairIds;
+    const char* pairsSpec = getenv("PAIRS");
+    if (!parsePairList(pairsSpec ? pairsSpec : "1", pairIds) || pairIds.empty()) {
+        AsyncLogger::instance().log(kPairsError, pairsSpec);
+        natsConnection_Destroy(conn);
+        natsOptions_Destroy(opts);
+        return 1;
+    }
+    std::vector<ConsolidationSpec> groups;
+    const char* consolidate = getenv("CONSOLIDATE");
+    if (consolidate && !parseConsolidationGroups(consolidate, groups)) {
+        AsyncLogger::instance().log(kConsolidationError, consolidate);
+        natsConnection_Destroy(conn);
+        natsOptions_Destroy(opts);
+        return 1;
+    }
+    for (const ConsolidationSpec& group : groups) {
+        for (PAIR_ID member : group.members) {
+            if (std::find(pairIds.begin(), pairIds.end(), member) == pairIds.end()) pairIds.push_back(member);
+        }
+    }
 
-    s = natsConnection_Subscribe(&sub, conn, "orderbook.snapshots", onMessage, &parser);
-    if (s != NATS_OK) {
-        fprintf(stderr, "Subscribe error: %s\n", natsStatus_GetText(s));
+    SeekerNetBoonSnapshotParserToTBT parser(pairIds);
+    SnapshotConflator conflator(pairIds);
+    OutputRouting routing;
+    ProcessorContext ctx{&parser, nullptr, 0, false, nullptr, &routing, nullptr, nullptr};
+    for (const ConsolidationSpec& group : groups) {
+        if (!parser.SetConsolidationGroup(group.groupId, group.members)) {
+            AsyncLogger::instance().log(kConsolidationError, consolidate);
+            natsConnection_Destroy(conn);
+            natsOptions_Destroy(opts);
+            return 1;
+        }
+        GroupOutput& output = routing.groups[group.groupId];
+        output.consolidatedSubject = consolidatedSubject(group.groupId);
+        output.nbboSubject = nbboSubject(group.groupId);
+        output.consolidatedSequence = restartSequence(0, static_cast<uint64_t>(nats_Now()));
+    }
+
+    // TBT_FLAT_SUBJECT=0: stop publishing every event to the single orderbook.tbt subject
+    // TBT_FILTER=top=N,seeker,market: derived per-pair stream on orderbook.filtered.<pair>
+    // Sequences start above those of an earlier run, which consumers may still hold
+    for (PAIR_ID pairId : pairIds) {
+        PairOutput& output = routing.pairs[pairId];
+        restartSequences(output);
+        output.buySubject = tbtSubject(pairId, ORDER_SIDE::BUY);
+        output.sellSubject = tbtSubject(pairId, ORDER_SIDE::SELL);
+        output.filteredSubject = filteredSubject(pairId);
+        output.bboSubject = bboSubject(pairId);
+        output.analyticsSubject = analyticsSubject(pairId);
+        output.tbtStream = outputStream(output.buySubject);
+    }
+    const char* flatSubject = getenv("TBT_FLAT_SUBJECT");
+    routing.flatSubject = !flatSubject || std::strcmp(flatSubject, "0") != 0;
+    const char* filterSpec = getenv("TBT_FILTER");
+    if (filterSpec && *filterSpec) {
+        if (!parseEventFilter(filterSpec, routing.filter)) {
+            AsyncLogger::instance().log(kFilterError, filterSpec);
+            natsConnection_Destroy(conn);
+            natsOptions_Destroy(opts);
+            return 1;
+        }
+        AsyncLogger::instance().log(kFilterEnabled, filterSpec);
+    }
+
+    // NET_EVENTS=1: one ADD/REMOVE/MODIFY per price per snapshot side
+    // MAX_DEPTH=N: only the best N levels per side are decoded, diffed and kept
+    // SKIP_UNCHANGED=1: skip the diff for sides whose fingerprint did not change
+    // FINGERPRINT_VERIFY_EVERY=N: fully diff every Nth fingerprint match anyway
+    // TICK_SIZE=x: keep books in a direct-indexed price ladder on an x tick grid
+    // BBO_STREAM=1: publish 32-byte BBO updates to orderbook.bbo.<pair> when the top of book changes
+    // ANALYTICS=N: publish imbalance, microprice, the top-N depth-weighted mid and the depth within
+    // ANALYTICS_BAND_BPS (default 10) of the mid to orderbook.analytics.<pair> after every snapshot
+    const char* netEvents = getenv("NET_EVENTS");
+    const char* maxDepth = getenv("MAX_DEPTH");
+    const char* skipUnchanged = getenv("SKIP_UNCHANGED");
+    const char* verifyEvery = getenv("FINGERPRINT_VERIFY_EVERY");
+    const char* tickSize = getenv("TICK_SIZE");
+    const char* bboStream = getenv("BBO_STREAM");
+    const char* analytics = getenv("ANALYTICS");
+    const char* analyticsBand = getenv("ANALYTICS_BAND_BPS");
+    if (maxDepth) {
+        ctx.maxDepth = static_cast<size_t>(std::strtoul(maxDepth, nullptr, 10));
+    }
+    ctx.skipUnchanged = skipUnchanged && std::strcmp(skipUnchanged, "1") == 0;
+    for (PAIR_ID pairId : pairIds) {
+        PairConfig config = parser.getPairConfig(pairId);
+        config.netEvents = netEvents && std::strcmp(netEvents, "1") == 0;
+        config.maxDepth = ctx.maxDepth;
+        config.skipUnchangedSides = ctx.skipUnchanged;
+        if (verifyEvery) {
+            config.verifyEvery = static_cast<uint32_t>(std::strtoul(verifyEvery, nullptr, 10));
+        }
+        if (tickSize) {
+            config.layout = BOOK_LAYOUT::PRICE_LADDER;
+            config.tickSize = std::strtod(tickSize, nullptr);
+        }
+        config.trackBbo = bboStream && std::strcmp(bboStream, "1") == 0;
+        if (analytics) {
+            config.analyticsLevels = static_cast<size_t>(std::strtoul(analytics, nullptr, 10));
+        }
+        if (analyticsBand) {
+            config.analyticsBandBps = std::strtod(analyticsBand, nullptr);
+        }
+        parser.SetPairConfig(pairId, config);
+    }
+
+    // SHM_RING=name: also publish TBT frames to /dev/shm/<name> for local readers
+    // (SHM_RING_SLOTS, SHM_RING_SLOT_BYTES size the ring)
+    ShmRingWriter shmRing;
+    const char* shmName = getenv("SHM_RING");
+    if (shmName && *shmName) {
+        const char* slots = getenv("SHM_RING_SLOTS");
+        const char* slotBytes = getenv("SHM_RING_SLOT_BYTES");
+        uint32_t slotCount = slots ? static_cast<uint32_t>(std::strtoul(slots, nullptr, 10))
+                                   : ShmRingWriter::DEFAULT_SLOTS;
+        uint32_t slotSize = slotBytes ? static_cast<uint32_t>(std::strtoul(slotBytes, nullptr, 10))
+                                      : ShmRingWriter::DEFAULT_SLOT_BYTES;
+        if (shmRing.open(shmName, slotCount, slotSize)) {
+            ctx.shm = &shmRing;
+            AsyncLogger::instance().log(kShmEnabled, shmName);
+        } else {
+            AsyncLogger::instance().log(kShmOpenError, shmName);
+        }
+    }
+
+    std::vector<PAIR_ID> conflatedPairs = parseConflatedPairs(getenv("CONFLATE_PAIRS"), pairIds);
+    for (PAIR_ID pairId : conflatedPairs) {
+        conflator.SetConflation(pairId, true);
+        AsyncLogger::instance().log(kConflationEnabled, pairId);
+    }
+    if (!conflatedPairs.empty()) {
+        ctx.conflator = &conflator;
+    }
+
+    // MCAST_A=group:port[@iface] (and optionally MCAST_B for the redundant
+    // line): ingest snapshots from UDP multicast instead of orderbook.snapshots
+    const char* mcastA = getenv("MCAST_A");
+#ifdef BUNI_MULTICAST
+    MulticastSnapshotFeed multicastFeed;
+    MulticastLatency multicastLatency;
+    std::thread multicastThread;
+#endif
+    std::unique_ptr<PartitionContext> partition;
+    std::thread heartbeatThread;
+    natsSubscription* clusterSubs[3] = {NULL, NULL, NULL};
+    StandbyContext standby;
+    natsOptions* controlOpts = NULL;
+    natsSubscription* standbySubs[6] = {NULL, NULL, NULL, NULL, NULL, NULL};
+    if (standbyMode && (partitionMode || (mcastA && *mcastA) || !groups.empty() || ctx.conflator)) {
+        // The standby must see every snapshot the primary applies, in the same order
+        AsyncLogger::instance().log(kStandbyError, partitionMode ? "PARTITIONED" :
+            (mcastA && *mcastA) ? "MCAST_A" : !groups.empty() ? "CONSOLIDATE" : "CONFLATE_PAIRS");
+        natsConnection_Destroy(conn);
+        natsOptions_Destroy(opts);
+        return 1;
+    }
+    if (partitionMode && ((mcastA && *mcastA) || !groups.empty())) {
+        AsyncLogger::instance().log(kPartitionError, groups.empty() ? "MCAST_A" : "CONSOLIDATE");
         natsConnection_Destroy(conn);
         natsOptions_Destroy(opts);
         return 1;
     }
-    printf("Subscribed to orderbook.snapshots, publishing to orderbook.tbt\n");
+    if (partitionMode) {
+        std::string self = replicaIdFromEnv();
+        const char* heartbeatMs = getenv("HEARTBEAT_MS");
+        const char* memberTimeoutMs = getenv("MEMBER_TIMEOUT_MS");
+        const char* handoffTimeoutMs = getenv("HANDOFF_TIMEOUT_MS");
+        int64_t heartbeatInterval = heartbeatMs ? std::strtoll(heartbeatMs, nullptr, 10) : 250;
+        if (heartbeatInterval <= 0) heartbeatInterval = 250;
+        partition.reset(new PartitionContext(
+            self, memberTimeoutMs ? std::strtoull(memberTimeoutMs, nullptr, 10) : 1000));
+        if (handoffTimeoutMs) partition->handoffTimeoutMs = std::strtoll(handoffTimeoutMs, nullptr, 10);
+        partition->joinAt = nats_Now() + 2 * heartbeatInterval;
+        for (PAIR_ID pairId : pairIds) partition->ownership[pairId] = PairOwnership::INACTIVE;
+        ctx.partition = partition.get();
 
-    while (g_running.load()) {
-        nats_Sleep(100);
+        s = natsConnection_Subscribe(&clusterSubs[0], conn, kHeartbeatSubject, onClusterMessage, partition.get());
+        if (s == NATS_OK) {
+            s = natsConnection_Subscribe(&clusterSubs[1], conn, kLeaveSubject, onClusterMessage, partition.get());
+        }
+        if (s == NATS_OK) {
+            s = natsConnection_Subscribe(&clusterSubs[2], conn, "orderbook.checkpoint.*", onCheckpointRequest, &ctx);
+        }
+        if (s != NATS_OK) {
+            AsyncLogger::instance().log(kSubscribeError, natsStatus_GetText(s));
+            natsConnection_Destroy(conn);
+            natsOptions_Destroy(opts);
+            return 1;
+        }
+        heartbeatThread = std::thread([conn, self, heartbeatInterval]() {
+            while (g_running.load()) {
+                natsConnection_PublishString(conn, kHeartbeatSubject, self.c_str());
+                nats_Sleep(heartbeatInterval);
+            }
+        });
+        AsyncLogger::instance().log(kPartitionEnabled, self.c_str());
+    } else if (standbyMode) {
+        const char* heartbeatMs = getenv("HOT_STANDBY_HEARTBEAT_MS");
+        const char* timeoutMs = getenv("HOT_STANDBY_TIMEOUT_MS");
+        const char* checksumMs = getenv("HOT_STANDBY_CHECKSUM_MS");
+        const char* resyncTimeoutMs = getenv("HANDOFF_TIMEOUT_MS");
+        standby.self = replicaIdFromEnv();
+        if (heartbeatMs && std::strtoll(heartbeatMs, nullptr, 10) > 0) {
+            standby.heartbeatMs = std::strtoll(heartbeatMs, nullptr, 10);
+        }
+        if (timeoutMs) standby.timeoutMs = std::strtoll(timeoutMs, nullptr, 10);
+        if (checksumMs) standby.checksumMs = std::strtoll(checksumMs, nullptr, 10);
+        if (resyncTimeoutMs) standby.resyncTimeoutMs = std::strtoll(resyncTimeoutMs, nullptr, 10);
+        // Every pair starts out waiting for the primary's checkpoint; with no
+        // primary heartbeat within the timeout, this processor becomes the primary
+        for (PAIR_ID pairId : pairIds) standby.syncing[pairId];
+        standby.lastHeartbeat = nats_Now();
+        ctx.standby = &standby;
+
+        s = natsOptions_Create(&controlOpts);
+        if (s == NATS_OK) s = natsOptions_SetURL(controlOpts, nats_url);
+        if (s == NATS_OK) s = natsConnection_Connect(&standby.control, controlOpts);
+        if (s == NATS_OK) {
+            s = natsConnection_Subscribe(&standbySubs[0], standby.control, kStandbyHeartbeatSubject,
+                                         onStandbyHeartbeat, &standby);
+        }
+        if (s == NATS_OK) {
+            s = natsConnection_Subscribe(&standbySubs[1], conn, "orderbook.tbt.*.*", onPrimaryOutput, &standby);
+        }
+        if (s == NATS_OK) {
+            s = natsConnection_Subscribe(&standbySubs[2], conn, "orderbook.filtered.*", onPrimaryOutput, &standby);
+        }
+        if (s == NATS_OK) {
+            s = natsConnection_Subscribe(&standbySubs[3], conn, kStandbyChecksumSubject, onPrimaryChecksum, &ctx);
+        }
+        if (s == NATS_OK) {
+            s = natsConnection_Subscribe(&standbySubs[4], conn, "orderbook.standby.checkpoint.*",
+                                         onStandbyCheckpointRequest, &ctx);
+        }
+        if (s == NATS_OK) {
+            s = natsConnection_Subscribe(&standbySubs[5], conn, "orderbook.snapshots", onStandbySnapshot, &ctx);
+        }
+        if (s != NATS_OK) {
+            AsyncLogger::instance().log(kSubscribeError, natsStatus_GetText(s));
+            for (natsSubscription* standbySub : standbySubs) natsSubscription_Destroy(standbySub);
+            natsConnection_Destroy(standby.control);
+            natsOptions_Destroy(controlOpts);
+            natsConnection_Destroy(conn);
+            natsOptions_Destroy(opts);
+            return 1;
+        }
+        heartbeatThread = std::thread([&standby]() {
+            while (g_running.load()) {
+                if (standby.primary.load()) publishHeartbeat(standby);
+                nats_Sleep(standby.heartbeatMs);
+            }
+        });
+        AsyncLogger::instance().log(kStandbyEnabled, standby.self.c_str(), standby.timeoutMs);
+    } else if (mcastA && *mcastA) {
+#ifdef BUNI_MULTICAST
+        const char* mcastB = getenv("MCAST_B");
+        MulticastEndpoint lineA, lineB;
+        bool hasB = mcastB && *mcastB;
+        if (!parseMulticastEndpoint(mcastA, lineA) || (hasB && !parseMulticastEndpoint(mcastB, lineB)) ||
+            !multicastFeed.open(lineA, hasB ? &lineB : nullptr)) {
+            AsyncLogger::instance().log(kMulticastError, hasB ? mcastB : mcastA);
+            natsConnection_Destroy(conn);
+            natsOptions_Destroy(opts);
+            return 1;
+        }
+        AsyncLogger::instance().log(kMulticastSubscribed, mcastA, hasB ? mcastB : "none");
+        multicastThread = std::thread(runMulticastIngest, conn, &ctx, &multicastFeed, &multicastLatency);
+#else
+        AsyncLogger::instance().log(kMulticastUnsupported);
+        natsConnection_Destroy(conn);
+        natsOptions_Destroy(opts);
+        return 1;
+#endif
+    } else {
+        s = natsConnection_Subscribe(&sub, conn, "orderbook.snapshots", onMessage, &ctx);
+        if (s != NATS_OK) {
+            AsyncLogger::instance().log(kSubscribeError, natsStatus_GetText(s));
+            natsConnection_Destroy(conn);
+            natsOptions_Destroy(opts);
+            return 1;
+        }
+        AsyncLogger::instance().log(kSubscribed);
     }
 
-    printf("\nShutting down...\n");
+    if (ctx.conflator) {
+        // Parser runs on this thread; the NATS callback only fills the conflator
+        PendingSnapshot pending;
+        while (g_running.load()) {
+            if (ctx.partition) rebalancePartition(conn, ctx, pairIds);
+            if (!conflator.WaitForPending(ctx.partition ? 20 : 100)) continue;
+            while (conflator.Poll(pending)) {
+                if (!ctx.partition) {
+                    processSnapshot(conn, ctx, pending.pairId, pending.time,
+                                    pending.buyBook, pending.sellBook);
+                    continue;
+                }
+                // A pair handed off meanwhile is dropped; its new owner has the snapshot too
+                std::lock_guard<std::mutex> lock(ctx.partition->mutex);
+                if (ctx.partition->ownership[pending.pairId] == PairOwnership::ACTIVE) {
+                    processSnapshot(conn, ctx, pending.pairId, pending.time,
+                                    pending.buyBook, pending.sellBook);
+                }
+            }
+        }
+    } else {
+        while (g_running.load()) {
+            if (ctx.partition) rebalancePartition(conn, ctx, pairIds);
+            if (ctx.standby) superviseStandby(conn, ctx, pairIds);
+            nats_Sleep(ctx.standby ? 1 : ctx.partition ? 20 : 100);
+        }
+    }
+
+    AsyncLogger::instance().log(kShuttingDown);
+    if (ctx.partition) {
+        // Announce the leave and keep answering checkpoint requests until the
+        // other replicas have taken every pair, or there is nobody to take them
+        heartbeatThread.join();
+        const std::string& self = ctx.partition->membership.self();
+        natsConnection_PublishString(conn, kLeaveSubject, self.c_str());
+        natsConnection_Flush(conn);
+        int64_t deadline = nats_Now() + 2 * ctx.partition->handoffTimeoutMs + 100;
+        unsigned long long remaining = 0;
+        do {
+            nats_Sleep(20);
+            std::lock_guard<std::mutex> lock(ctx.partition->mutex);
+            remaining = 0;
+            for (const auto& pair : ctx.partition->ownership) {
+                if (pair.second != PairOwnership::INACTIVE) remaining++;
+            }
+        } while (remaining > 0 && nats_Now() < deadline);
+        AsyncLogger::instance().log(kPartitionLeft, remaining);
+        for (natsSubscription* clusterSub : clusterSubs) natsSubscription_Destroy(clusterSub);
+        std::lock_guard<std::mutex> lock(ctx.partition->mutex);
+        for (PAIR_ID pairId : pairIds) releasePair(*ctx.partition, pairId);
+    }
+    if (ctx.standby) {
+        // Stop processing and get the last frames out before the heartbeats
+        // stop, so a standby taking over finds them published
+        natsSubscription_Unsubscribe(standbySubs[5]);
+        {
+            std::lock_guard<std::mutex> lock(standby.mutex);
+            standby.primary.store(false);
+        }
+        natsConnection_Flush(conn);
+        heartbeatThread.join();
+        for (natsSubscription* standbySub : standbySubs) natsSubscription_Destroy(standbySub);
+        natsConnection_Destroy(standby.control);
+        natsOptions_Destroy(controlOpts);
+        const ChecksumStats& stats = standby.verifier.getStats();
+        AsyncLogger::instance().log(kStandbyStats, stats.matched, stats.mismatched, stats.unmatched,
+                                    standby.gate.overflowed());
+    }
+#ifdef BUNI_MULTICAST
+    if (multicastThread.joinable()) {
+        multicastThread.join();
+        const ArbitrationStats& stats = multicastFeed.getStats();
+        AsyncLogger::instance().log(kMulticastStats, stats.delivered, stats.duplicates, stats.gaps, stats.malformed);
+        if (multicastLatency.samples > 0) {
+            AsyncLogger::instance().log(kMulticastLatency, multicastLatency.sumUs / multicastLatency.samples,
+                                        multicastLatency.maxUs);
+        }
+        multicastFeed.close();
+    }
+#endif
     natsSubscription_Destroy(sub);
+    for (PAIR_ID pairId : pairIds) {
+        ConflationStats stats = conflator.getStats(pairId);
+        if (conflator.isConflating(pairId)) {
+            AsyncLogger::instance().log(kConflationStats, pairId, stats.offered, stats.conflated, stats.delivered);
+        }
+        if (stats.dropped > 0) AsyncLogger::instance().log(kConflationDropped, pairId, stats.dropped);
+    }
+    for (PAIR_ID pairId : pairIds) {
+        const SnapshotStats& stats = parser.getSnapshotStats(pairId);
+        AsyncLogger::instance().log(kSnapshotStats, pairId, stats.applied,
+                                    stats.crossed + stats.locked, stats.stale);
+    }
+    if (ctx.skipUnchanged) {
+        for (PAIR_ID pairId : pairIds) {
+            const FingerprintStats& stats = parser.getFingerprintStats(pairId);
+            AsyncLogger::instance().log(kFingerprintStats, pairId, stats.sidesSkipped,
+                                        stats.verifications, stats.collisions);
+        }
+    }
+    if (ctx.shm) {
+        shmRing.close();
+        ShmRingWriter::unlink(shmName);
+    }
     natsConnection_Destroy(conn);
     natsOptions_Destroy(opts);
     return 0;
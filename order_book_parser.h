@@ -4,7 +4,17 @@
 // Include this single header to get all functionality
 
 #include "src/types.h"
+#include "src/price_ladder.h"
+#include "src/cumulative_depth.h"
+#include "src/book_view.h"
+#include "src/book_analytics.h"
 #include "src/data_structures.h"
+#include "src/book_hash.h"
+#include "src/diff_stats.h"
 #include "src/utils.h"
+#include "src/async_logger.h"
 #include "src/order_factory.h"
+#include "src/consolidated_book.h"
 #include "src/snapshot_parser.h"
+#include "src/snapshot_conflator.h"
+#include "src/tbt_book_builder.h"
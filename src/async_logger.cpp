@@ -0,0 +1,246 @@
+#include "async_logger.h"
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+namespace {
+
+constexpr uint64_t RATE_WINDOW_NS = 1000000000ULL;
+
+uint64_t wallClockNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+size_t roundUpPowerOfTwo(size_t v) {
+    size_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+const char* levelName(LOG_LEVEL level) {
+    switch (level) {
+        case LOG_LEVEL::INFO:    return "INFO";
+        case LOG_LEVEL::WARNING: return "WARN";
+        case LOG_LEVEL::ERROR:   return "ERROR";
+        default:                 return "N/A";
+    }
+}
+
+bool isConversion(char c) {
+    return std::strchr("diouxXeEfFgGaAcsp", c) != nullptr;
+}
+
+// printf-style expansion of a format against raw argument slots. Each
+// conversion is formatted on its own so the argument type can be chosen
+// from the conversion character.
+size_t formatRecord(char* out, size_t cap, const char* format, const LogArg* args, uint8_t argCount) {
+    size_t len = 0;
+    uint8_t argIdx = 0;
+    const char* p = format;
+    while (*p && len + 1 < cap) {
+        if (*p != '%') {
+            out[len++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[len++] = '%';
+            p += 2;
+            continue;
+        }
+
+        const char* specStart = p++;
+        while (*p && !isConversion(*p)) p++;
+        if (!*p) break;
+        char conv = *p++;
+
+        char spec[32];
+        size_t specLen = static_cast<size_t>(p - specStart);
+        if (specLen >= sizeof(spec)) specLen = sizeof(spec) - 1;
+        std::memcpy(spec, specStart, specLen);
+        spec[specLen] = '\0';
+
+        int written = 0;
+        if (argIdx >= argCount) {
+            written = std::snprintf(out + len, cap - len, "<missing>");
+        } else {
+            const LogArg& arg = args[argIdx++];
+            switch (conv) {
+                case 'e': case 'E': case 'f': case 'F':
+                case 'g': case 'G': case 'a': case 'A':
+                    written = std::snprintf(out + len, cap - len, spec, arg.d);
+                    break;
+                case 's':
+                    written = std::snprintf(out + len, cap - len, spec, arg.s ? arg.s : "(null)");
+                    break;
+                case 'p':
+                    written = std::snprintf(out + len, cap - len, spec, static_cast<const void*>(arg.s));
+                    break;
+                case 'c':
+                    written = std::snprintf(out + len, cap - len, spec, static_cast<int>(arg.i));
+                    break;
+                case 'u': case 'o': case 'x': case 'X':
+                    written = std::snprintf(out + len, cap - len, spec, static_cast<unsigned long long>(arg.i));
+                    break;
+                default:
+                    written = std::snprintf(out + len, cap - len, spec, static_cast<long long>(arg.i));
+                    break;
+            }
+        }
+        if (written < 0) break;
+        len += static_cast<size_t>(written);
+        if (len >= cap) len = cap - 1;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+} // namespace
+
+AsyncLogger::AsyncLogger(size_t capacity, FILE* infoSink, FILE* errorSink)
+    : _ring(roundUpPowerOfTwo(capacity < 2 ? 2 : capacity)),
+      _mask(_ring.size() - 1),
+      _infoSink(infoSink),
+      _errorSink(errorSink),
+      _enqueuePos(0),
+      _dequeuePos(0),
+      _logged(0),
+      _suppressed(0),
+      _dropped(0),
+      _running(true) {
+    for (size_t i = 0; i < _ring.size(); i++) {
+        _ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    _drainThread = std::thread(&AsyncLogger::_drainLoop, this);
+}
+
+AsyncLogger::~AsyncLogger() {
+    _running.store(false, std::memory_order_release);
+    if (_drainThread.joinable()) {
+        _drainThread.join();
+    }
+}
+
+AsyncLogger& AsyncLogger::instance() {
+    static AsyncLogger logger;
+    return logger;
+}
+
+bool AsyncLogger::_enqueue(LogMessageType& type, const LogArg* args, uint8_t argCount) {
+    uint64_t now = wallClockNs();
+    uint64_t suppressedBefore = 0;
+
+    if (type.maxPerSecond > 0) {
+        uint64_t windowStart = type.windowStartNs.load(std::memory_order_relaxed);
+        if (now - windowStart >= RATE_WINDOW_NS &&
+            type.windowStartNs.compare_exchange_strong(windowStart, now, std::memory_order_relaxed)) {
+            type.windowCount.store(0, std::memory_order_relaxed);
+            suppressedBefore = type.suppressed.exchange(0, std::memory_order_relaxed);
+        }
+        if (type.windowCount.fetch_add(1, std::memory_order_relaxed) >= type.maxPerSecond) {
+            type.suppressed.fetch_add(1, std::memory_order_relaxed);
+            _suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    uint64_t pos = _enqueuePos.load(std::memory_order_relaxed);
+    Record* record;
+    for (;;) {
+        record = &_ring[pos & _mask];
+        uint64_t seq = record->sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+        if (diff == 0) {
+            if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            if (suppressedBefore) type.suppressed.fetch_add(suppressedBefore, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = _enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    record->timestampNs = now;
+    record->suppressedBefore = suppressedBefore;
+    record->type = &type;
+    record->argCount = argCount;
+    for (uint8_t i = 0; i < argCount; i++) {
+        record->args[i] = args[i];
+    }
+    record->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool AsyncLogger::_drainOnce() {
+    bool wroteAny = false;
+    for (;;) {
+        uint64_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        Record& record = _ring[pos & _mask];
+        if (record.sequence.load(std::memory_order_acquire) != pos + 1) break;
+
+        _write(record);
+        record.sequence.store(pos + _mask + 1, std::memory_order_release);
+        _dequeuePos.store(pos + 1, std::memory_order_release);
+        _logged.fetch_add(1, std::memory_order_relaxed);
+        wroteAny = true;
+    }
+    if (wroteAny) {
+        std::fflush(_infoSink);
+        if (_errorSink != _infoSink) std::fflush(_errorSink);
+    }
+    return wroteAny;
+}
+
+void AsyncLogger::_drainLoop() {
+    while (_running.load(std::memory_order_acquire)) {
+        if (!_drainOnce()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    _drainOnce();
+}
+
+void AsyncLogger::_write(const Record& record) {
+    char line[512];
+    time_t seconds = static_cast<time_t>(record.timestampNs / 1000000000ULL);
+    unsigned micros = static_cast<unsigned>((record.timestampNs % 1000000000ULL) / 1000);
+    struct tm tmUtc;
+    gmtime_r(&seconds, &tmUtc);
+
+    size_t len = std::strftime(line, sizeof(line), "%Y-%m-%d %H:%M:%S", &tmUtc);
+    len += static_cast<size_t>(std::snprintf(line + len, sizeof(line) - len, ".%06u %-5s ",
+        micros, levelName(record.type->level)));
+    len += formatRecord(line + len, sizeof(line) - len, record.type->format, record.args, record.argCount);
+    if (record.suppressedBefore > 0 && len < sizeof(line)) {
+        len += static_cast<size_t>(std::snprintf(line + len, sizeof(line) - len,
+            " (%llu similar suppressed)", static_cast<unsigned long long>(record.suppressedBefore)));
+    }
+
+    FILE* sink = record.type->level == LOG_LEVEL::INFO ? _infoSink : _errorSink;
+    std::fputs(line, sink);
+    std::fputc('\n', sink);
+}
+
+void AsyncLogger::flush() {
+    uint64_t target = _enqueuePos.load(std::memory_order_acquire);
+    while (_dequeuePos.load(std::memory_order_acquire) < target) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+AsyncLoggerStats AsyncLogger::getStats() const {
+    AsyncLoggerStats stats;
+    stats.logged = _logged.load(std::memory_order_relaxed);
+    stats.suppressed = _suppressed.load(std::memory_order_relaxed);
+    stats.dropped = _dropped.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
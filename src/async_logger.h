@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+enum LOG_LEVEL {
+    INFO = 1,
+    WARNING = 2,
+    ERROR = 3
+};
+
+// Static description of one diagnostic message. Declare one per call site
+// (namespace or function scope static); the logger keeps a pointer to it, so
+// it must outlive the logger. The format uses printf conversions, with
+// integer arguments passed as %lld / %llu.
+struct LogMessageType {
+    LogMessageType(LOG_LEVEL level, uint32_t maxPerSecond, const char* format)
+        : level(level), maxPerSecond(maxPerSecond), format(format),
+          windowStartNs(0), windowCount(0), suppressed(0) {}
+
+    LOG_LEVEL level;
+    uint32_t maxPerSecond;   // 0 = unlimited
+    const char* format;
+
+    // Rate limiting state, touched only by producers
+    std::atomic<uint64_t> windowStartNs;
+    std::atomic<uint32_t> windowCount;
+    std::atomic<uint64_t> suppressed;
+};
+
+// Raw argument slot. Strings are stored by pointer and must have static
+// lifetime (string literals, natsStatus_GetText(), toString()).
+union LogArg {
+    int64_t i;
+    double d;
+    const char* s;
+};
+
+struct AsyncLoggerStats {
+    uint64_t logged = 0;      // records written by the drain thread
+    uint64_t suppressed = 0;  // rejected by per-type rate limiting
+    uint64_t dropped = 0;     // rejected because the ring was full
+};
+
+// Lock-free binary log ring drained by a background thread. Producers copy
+// the message type pointer and raw arguments into a preallocated slot
+// (bounded MPSC queue, one CAS per record); formatting and the write to
+// stdout/stderr happen on the drain thread. Producers never block: when the
+// ring is full the record is dropped and counted.
+class AsyncLogger {
+public:
+    static constexpr size_t MAX_ARGS = 4;
+
+    explicit AsyncLogger(size_t capacity = 4096, FILE* infoSink = stdout, FILE* errorSink = stderr);
+    ~AsyncLogger();
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    // Process-wide logger used by the parser and the processor
+    static AsyncLogger& instance();
+
+    template <typename... Args>
+    bool log(LogMessageType& type, Args... args) {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "too many log arguments");
+        LogArg packed[MAX_ARGS];
+        _pack(packed, args...);
+        return _enqueue(type, packed, static_cast<uint8_t>(sizeof...(Args)));
+    }
+
+    // Blocks until every record enqueued before the call has been written
+    void flush();
+
+    AsyncLoggerStats getStats() const;
+
+private:
+    struct Record {
+        std::atomic<uint64_t> sequence;
+        uint64_t timestampNs;
+        uint64_t suppressedBefore;
+        LogMessageType* type;
+        uint8_t argCount;
+        LogArg args[MAX_ARGS];
+    };
+
+    std::vector<Record> _ring;
+    size_t _mask;
+    FILE* _infoSink;
+    FILE* _errorSink;
+
+    alignas(64) std::atomic<uint64_t> _enqueuePos;
+    alignas(64) std::atomic<uint64_t> _dequeuePos;
+    std::atomic<uint64_t> _logged;
+    std::atomic<uint64_t> _suppressed;
+    std::atomic<uint64_t> _dropped;
+    std::atomic<bool> _running;
+    std::thread _drainThread;
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, LogArg>::type
+    _toArg(T v) { LogArg a; a.i = static_cast<int64_t>(v); return a; }
+    template <typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value, LogArg>::type
+    _toArg(T v) { LogArg a; a.d = static_cast<double>(v); return a; }
+    static LogArg _toArg(const char* v) { LogArg a; a.s = v; return a; }
+
+    static void _pack(LogArg*) {}
+    template <typename T, typename... Rest>
+    static void _pack(LogArg* out, T first, Rest... rest) {
+        *out = _toArg(first);
+        _pack(out + 1, rest...);
+    }
+
+    bool _enqueue(LogMessageType& type, const LogArg* args, uint8_t argCount);
+    bool _drainOnce();
+    void _drainLoop();
+    void _write(const Record& record);
+};
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
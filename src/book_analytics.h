@@ -0,0 +1,201 @@
+#pragma once
+
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+// Book metrics of one pair after an update (PairConfig::analyticsLevels).
+// Every field is 0 when the side(s) it needs are empty.
+struct BookAnalytics {
+    PAIR_ID pairId = 0;
+    ORDER_TIME time = 0;
+    double imbalance = 0;     // (bidQty - askQty) / (bidQty + askQty) at the best levels
+    double microprice = 0;    // best prices weighted by the opposite side's best qty
+    double weightedMid = 0;   // mean of the bid and ask VWAPs over the best analyticsLevels levels
+    int64_t bidDepth = 0;     // qty within analyticsBandBps of the mid (of the own best
+    int64_t askDepth = 0;     //   price while the other side is empty)
+};
+
+// Incremental top-N and price band sums of one book side. Levels in the
+// band always form a prefix of the side, so both are kept as running sums
+// updated from the level hooks in O(1); settle() then moves the band edge
+// after the reference price moved, touching only the levels that crossed it.
+class SideAnalytics {
+public:
+    void configure(size_t levels, double bandBps, bool isBuySide) {
+        _levels = levels;
+        _bandBps = bandBps;
+        _isBuySide = isBuySide;
+        clear();
+    }
+    bool active() const { return _levels > 0; }
+    void clear() {
+        _topQty = 0;
+        _topNotional = 0;
+        _bandLevels = 0;
+        _bandQty = 0;
+    }
+
+    // Level hooks: call after the book is modified for inserts and before it
+    // is for erases and qty changes
+    template <typename Levels>
+    void inserted(const Levels& book, size_t index, ORDER_PRICE price, int64_t qty) {
+        if (index < _levels) {
+            _add(price, qty);
+            if (book.size() > _levels) _add(book[_levels].price, -book[_levels].qty);
+        }
+        if (index < _bandLevels) {
+            _bandLevels++;
+            _bandQty += qty;
+        }
+    }
+    template <typename Levels>
+    void erased(const Levels& book, size_t index, ORDER_PRICE price, int64_t qty) {
+        if (index < _levels) {
+            _add(price, -qty);
+            if (book.size() > _levels) _add(book[_levels].price, book[_levels].qty);
+        }
+        if (index < _bandLevels) {
+            _bandLevels--;
+            _bandQty -= qty;
+        }
+    }
+    void qtyChanged(size_t index, ORDER_PRICE price, int64_t delta) {
+        if (index < _levels) _add(price, delta);
+        if (index < _bandLevels) _bandQty += delta;
+    }
+
+    // Moves the band edge to reference * (1 -/+ bandBps) after an update
+    template <typename Levels>
+    void settle(const Levels& book, double reference) {
+        double edge = bandEdge(reference);
+        while (_bandLevels > 0 && !inBand(book[_bandLevels - 1].price, edge)) {
+            _bandLevels--;
+            _bandQty -= book[_bandLevels].qty;
+        }
+        while (_bandLevels < book.size() && inBand(book[_bandLevels].price, edge)) {
+            _bandQty += book[_bandLevels].qty;
+            _bandLevels++;
+        }
+    }
+
+    // Recomputes the top-N sums after a change that bypassed the hooks; the
+    // band is emptied and refilled by the next settle()
+    template <typename Levels>
+    void rebuild(const Levels& book) {
+        clear();
+        size_t top = book.size() < _levels ? book.size() : _levels;
+        for (size_t i = 0; i < top; i++) _add(book[i].price, book[i].qty);
+    }
+
+    double bandEdge(double reference) const {
+        double offset = reference * _bandBps / 10000.0;
+        return _isBuySide ? reference - offset : reference + offset;
+    }
+    bool inBand(ORDER_PRICE price, double edge) const {
+        return _isBuySide ? price >= edge : price <= edge;
+    }
+
+    int64_t topQty() const { return _topQty; }
+    double topNotional() const { return _topNotional; }
+    double vwap() const { return _topQty > 0 ? _topNotional / static_cast<double>(_topQty) : 0; }
+    int64_t bandQty() const { return _bandQty; }
+    size_t bandLevels() const { return _bandLevels; }
+
+private:
+    size_t _levels = 0;      // 0 = off
+    double _bandBps = 0;
+    bool _isBuySide = true;
+    int64_t _topQty = 0;
+    double _topNotional = 0;
+    size_t _bandLevels = 0;  // band = book[0, _bandLevels)
+    int64_t _bandQty = 0;
+
+    void _add(ORDER_PRICE price, int64_t qty) {
+        _topQty += qty;
+        _topNotional += price * static_cast<double>(qty);
+    }
+};
+
+// Band reference price: the mid, or the best price of the only non-empty side
+template <typename Levels>
+double analyticsReference(const Levels& bids, const Levels& asks) {
+    if (bids.empty()) return asks.empty() ? 0 : asks.front().price;
+    if (asks.empty()) return bids.front().price;
+    return (bids.front().price + asks.front().price) / 2;
+}
+
+// Fills the metrics from the settled side state; O(1)
+template <typename Levels>
+void fillBookAnalytics(const Levels& bids, const Levels& asks, const SideAnalytics& buy,
+                       const SideAnalytics& sell, BookAnalytics& out) {
+    out.imbalance = 0;
+    out.microprice = 0;
+    out.weightedMid = 0;
+    if (!bids.empty() && !asks.empty()) {
+        double bidQty = bids.front().qty;
+        double askQty = asks.front().qty;
+        double total = bidQty + askQty;
+        if (total > 0) {
+            out.imbalance = (bidQty - askQty) / total;
+            out.microprice = (bids.front().price * askQty + asks.front().price * bidQty) / total;
+        }
+        out.weightedMid = (buy.vwap() + sell.vwap()) / 2;
+    }
+    out.bidDepth = buy.bandQty();
+    out.askDepth = sell.bandQty();
+}
+
+// Reference implementation: every metric recomputed from the full book
+template <typename Levels>
+void computeBookAnalytics(const Levels& bids, const Levels& asks, size_t levels, double bandBps,
+                          BookAnalytics& out) {
+    SideAnalytics buy;
+    SideAnalytics sell;
+    buy.configure(levels, bandBps, true);
+    sell.configure(levels, bandBps, false);
+    double reference = analyticsReference(bids, asks);
+    double buyEdge = buy.bandEdge(reference);
+    double sellEdge = sell.bandEdge(reference);
+
+    BookAnalytics naive;
+    double bidNotional = 0, askNotional = 0;
+    int64_t bidQty = 0, askQty = 0;
+    for (size_t i = 0; i < bids.size(); i++) {
+        if (i < levels) {
+            bidQty += bids[i].qty;
+            bidNotional += bids[i].price * bids[i].qty;
+        }
+        if (buy.inBand(bids[i].price, buyEdge)) naive.bidDepth += bids[i].qty;
+    }
+    for (size_t i = 0; i < asks.size(); i++) {
+        if (i < levels) {
+            askQty += asks[i].qty;
+            askNotional += asks[i].price * asks[i].qty;
+        }
+        if (sell.inBand(asks[i].price, sellEdge)) naive.askDepth += asks[i].qty;
+    }
+    if (!bids.empty() && !asks.empty()) {
+        double bestBidQty = bids.front().qty;
+        double bestAskQty = asks.front().qty;
+        double total = bestBidQty + bestAskQty;
+        if (total > 0) {
+            naive.imbalance = (bestBidQty - bestAskQty) / total;
+            naive.microprice = (bids.front().price * bestAskQty + asks.front().price * bestBidQty) / total;
+        }
+        if (bidQty > 0 && askQty > 0) {
+            naive.weightedMid = (bidNotional / bidQty + askNotional / askQty) / 2;
+        }
+    }
+    naive.pairId = out.pairId;
+    naive.time = out.time;
+    out = naive;
+}
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
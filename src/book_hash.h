@@ -0,0 +1,46 @@
+#pragma once
+
+#include "data_structures.h"
+#include <cstdint>
+#include <cstring>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+// Book side fingerprints. A side hashes to the wrapping sum of one mixed
+// 64-bit value per (price, qty) level, so the parser can keep it current with
+// one add/subtract per level change and a decoder can compute it in the same
+// pass that reads the levels.
+inline uint64_t bookLevelHash(ORDER_PRICE price, ORDER_QTY qty) {
+    double normalized = price + 0.0;   // -0.0 and +0.0 hash the same
+    uint64_t bits = 0;
+    std::memcpy(&bits, &normalized, sizeof(bits));
+
+    // splitmix64 finalizer over price bits folded with qty
+    uint64_t h = bits ^ (static_cast<uint64_t>(static_cast<uint32_t>(qty)) * 0x9E3779B97F4A7C15ULL);
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+template <typename Levels>
+inline uint64_t bookSideHash(const Levels& levels) {
+    uint64_t h = 0;
+    for (const auto& level : levels) {
+        h += bookLevelHash(level.price, level.qty);
+    }
+    return h;
+}
+
+struct BookHashes {
+    uint64_t buy = 0;
+    uint64_t sell = 0;
+};
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
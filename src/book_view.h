@@ -0,0 +1,119 @@
+#pragma once
+
+#include "types.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+struct BookViewLevel {
+    ORDER_PRICE price;
+    ORDER_QTY qty;
+};
+
+// Copy of the top of one pair's book as published by the parser thread
+struct BookView {
+    static constexpr size_t MAX_LEVELS = 16;
+
+    uint64_t sequence = 0;   // number of publishes so far, 0 = nothing published yet
+    ORDER_TIME time = 0;
+    uint32_t bidLevels = 0;
+    uint32_t askLevels = 0;
+    BookViewLevel bids[MAX_LEVELS];   // best first, bidLevels valid
+    BookViewLevel asks[MAX_LEVELS];
+
+    bool hasBbo() const { return bidLevels > 0 && askLevels > 0; }
+    const BookViewLevel& bestBid() const { return bids[0]; }   // require bidLevels > 0
+    const BookViewLevel& bestAsk() const { return asks[0]; }   // require askLevels > 0
+};
+
+// Single-writer, multi-reader publication of a BookView. The writer fills the
+// slot readers are not pointed at, then flips to it, so a publish never waits
+// for readers and a reader only retries if the writer published twice while
+// it was copying. Each slot carries a seqlock counter (odd while written) to
+// detect that case.
+class PublishedBookView {
+public:
+    // Levels per side to publish, capped at BookView::MAX_LEVELS. Writer thread only.
+    void setDepth(size_t levels) {
+        const size_t maxLevels = BookView::MAX_LEVELS;
+        _depth = levels < maxLevels ? levels : maxLevels;
+    }
+    size_t depth() const { return _depth; }
+
+    // Writer thread only
+    template <typename Levels>
+    void publish(const Levels& bids, const Levels& asks, ORDER_TIME time) {
+        uint64_t next = _published.load(std::memory_order_relaxed) + 1;
+        Slot& slot = _slots[next & 1];
+        uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        BookView& view = slot.view;
+        view.sequence = next;
+        view.time = time;
+        view.bidLevels = static_cast<uint32_t>(_copyTop(bids, view.bids));
+        view.askLevels = static_cast<uint32_t>(_copyTop(asks, view.asks));
+
+        slot.seq.store(seq + 2, std::memory_order_release);
+        _published.store(next, std::memory_order_release);
+    }
+
+    // Any thread. Copies the latest view into out; false if the writer
+    // overwrote it mid-copy (out is then unspecified).
+    bool tryRead(BookView& out) const {
+        const Slot& slot = _slots[_published.load(std::memory_order_acquire) & 1];
+        uint64_t before = slot.seq.load(std::memory_order_acquire);
+        if (before & 1) return false;
+
+        // A torn read can see any count; clamp it so the copy stays in bounds
+        const uint32_t maxLevels = BookView::MAX_LEVELS;
+        const BookView& view = slot.view;
+        out.sequence = view.sequence;
+        out.time = view.time;
+        out.bidLevels = view.bidLevels < maxLevels ? view.bidLevels : maxLevels;
+        out.askLevels = view.askLevels < maxLevels ? view.askLevels : maxLevels;
+        std::memcpy(out.bids, view.bids, out.bidLevels * sizeof(BookViewLevel));
+        std::memcpy(out.asks, view.asks, out.askLevels * sizeof(BookViewLevel));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.seq.load(std::memory_order_relaxed) == before;
+    }
+
+    void read(BookView& out) const {
+        while (!tryRead(out)) {
+        }
+    }
+
+    // Publishes so far; readers can poll this to skip unchanged views
+    uint64_t sequence() const { return _published.load(std::memory_order_acquire); }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> seq{0};
+        BookView view;
+    };
+
+    Slot _slots[2];
+    std::atomic<uint64_t> _published{0};
+    size_t _depth = 0;
+
+    template <typename Levels>
+    size_t _copyTop(const Levels& levels, BookViewLevel* out) const {
+        size_t count = levels.size() < _depth ? levels.size() : _depth;
+        for (size_t i = 0; i < count; i++) {
+            out[i].price = levels[i].price;
+            out[i].qty = levels[i].qty;
+        }
+        return count;
+    }
+};
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
@@ -0,0 +1,162 @@
+#include "buni_c.h"
+#include "snapshot_parser.h"
+#include "wire_format.h"
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+using namespace cl::data_feed::data_feed_parser;
+
+static_assert(sizeof(buni_order) == sizeof(Order), "buni_order must mirror Order");
+static_assert(offsetof(buni_order, price) == offsetof(Order, price) &&
+              offsetof(buni_order, time) == offsetof(Order, time) &&
+              offsetof(buni_order, qty) == offsetof(Order, qty) &&
+              offsetof(buni_order, side) == offsetof(Order, side) &&
+              offsetof(buni_order, type) == offsetof(Order, type) &&
+              offsetof(buni_order, action) == offsetof(Order, action),
+              "buni_order must mirror Order");
+
+struct buni_parser {
+    SeekerNetBoonSnapshotParserToTBT parser{std::vector<PAIR_ID>{}};
+    std::vector<bookElement> bids;   // decode scratch
+    std::vector<bookElement> asks;
+    buni_event_callback callback = nullptr;
+    void* user = nullptr;
+};
+
+namespace {
+// Decodes and applies one frame; *used receives its size
+int applyFrame(buni_parser* handle, const char* data, size_t len, size_t* used) {
+    PAIR_ID pairId;
+    ORDER_TIME timestamp;
+    BookHashes hashes;
+    bool skip = false;
+    size_t maxDepth = 0;
+    if (len >= WIRE_SNAPSHOT_HEADER_SIZE) {
+        PAIR_ID framePair = static_cast<PAIR_ID>(wire_detail::read_i64_le(data));
+        try {
+            const PairConfig& config = handle->parser.getPairConfig(framePair);
+            skip = config.skipUnchangedSides;
+            maxDepth = config.maxDepth;
+        } catch (const std::out_of_range&) {
+            return BUNI_E_UNKNOWN_PAIR;
+        }
+    }
+    if (!deserializeSnapshot(data, len, pairId, timestamp, handle->bids, handle->asks, maxDepth,
+                             skip ? &hashes : nullptr)) {
+        return BUNI_E_MALFORMED;
+    }
+    *used = WIRE_SNAPSHOT_HEADER_SIZE +
+            static_cast<size_t>(wire_detail::read_u16_le(data + 16) + wire_detail::read_u16_le(data + 18)) *
+                WIRE_BOOK_LEVEL_SIZE;
+
+    size_t begin = handle->parser.getEmittedOrders().size();
+    SNAPSHOT_RESULT result = handle->parser.ApplySnapshot(pairId, handle->bids, handle->asks, timestamp,
+                                                          skip ? &hashes : nullptr);
+    if (handle->callback) {
+        const std::vector<Order>& orders = handle->parser.getEmittedOrders();
+        if (orders.size() > begin) {
+            handle->callback(handle->user, pairId, reinterpret_cast<const buni_order*>(orders.data() + begin),
+                             orders.size() - begin);
+        }
+    }
+    return static_cast<int>(result);
+}
+
+// Runs an exported body; no exception may cross the C ABI (cgo cannot unwind
+// through it), so anything thrown becomes a status code
+template <typename Body>
+auto guarded(Body body) -> decltype(body()) {
+    try {
+        return body();
+    } catch (const std::bad_alloc&) {
+        return BUNI_E_NO_MEMORY;
+    } catch (...) {
+        return BUNI_E_INTERNAL;
+    }
+}
+} // namespace
+
+extern "C" {
+
+buni_parser* buni_parser_create(void) {
+    try {
+        return new buni_parser();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void buni_parser_destroy(buni_parser* parser) {
+    delete parser;
+}
+
+int buni_register_pair(buni_parser* parser, int64_t pair_id) {
+    if (!parser) return BUNI_E_ARGUMENT;
+    return guarded([&] { return parser->parser.AddPair(static_cast<PAIR_ID>(pair_id)) ? BUNI_OK : BUNI_E_EXISTS; });
+}
+
+int buni_configure_pair(buni_parser* parser, int64_t pair_id, const buni_pair_config* config) {
+    if (!parser || !config || config->tick_size < 0) return BUNI_E_ARGUMENT;
+    return guarded([&]() -> int {
+        PairConfig pairConfig;
+        try {
+            pairConfig = parser->parser.getPairConfig(static_cast<PAIR_ID>(pair_id));
+        } catch (const std::out_of_range&) {
+            return BUNI_E_UNKNOWN_PAIR;
+        }
+        pairConfig.netEvents = config->net_events != 0;
+        pairConfig.maxDepth = config->max_depth;
+        pairConfig.skipUnchangedSides = config->skip_unchanged != 0;
+        pairConfig.layout = config->tick_size > 0 ? BOOK_LAYOUT::PRICE_LADDER : BOOK_LAYOUT::SORTED_LEVELS;
+        pairConfig.tickSize = config->tick_size;
+        parser->parser.SetPairConfig(static_cast<PAIR_ID>(pair_id), pairConfig);
+        return BUNI_OK;
+    });
+}
+
+int buni_apply_snapshot(buni_parser* parser, const void* data, size_t len) {
+    if (!parser || !data) return BUNI_E_ARGUMENT;
+    size_t used = 0;
+    return guarded([&] { return applyFrame(parser, static_cast<const char*>(data), len, &used); });
+}
+
+int64_t buni_apply_snapshots(buni_parser* parser, const void* data, size_t len, size_t* applied) {
+    if (applied) *applied = 0;
+    if (!parser || (!data && len > 0)) return BUNI_E_ARGUMENT;
+    const char* p = static_cast<const char*>(data);
+    int64_t frames = 0;
+    while (len > 0) {
+        size_t used = 0;
+        int result = guarded([&] { return applyFrame(parser, p, len, &used); });
+        if (result < 0) return result;
+        p += used;
+        len -= used;
+        frames++;
+        if (applied) *applied = static_cast<size_t>(frames);
+    }
+    return frames;
+}
+
+const buni_order* buni_events(const buni_parser* parser, size_t* count) {
+    if (!parser) {
+        if (count) *count = 0;
+        return nullptr;
+    }
+    const std::vector<Order>& orders = parser->parser.getEmittedOrders();
+    if (count) *count = orders.size();
+    return reinterpret_cast<const buni_order*>(orders.data());
+}
+
+void buni_clear_events(buni_parser* parser) {
+    if (parser) parser->parser.clearEmittedOrders();
+}
+
+void buni_set_event_callback(buni_parser* parser, buni_event_callback callback, void* user) {
+    if (!parser) return;
+    parser->callback = callback;
+    parser->user = user;
+}
+
+} // extern "C"
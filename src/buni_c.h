@@ -0,0 +1,92 @@
+#ifndef BUNI_C_H
+#define BUNI_C_H
+
+/* C ABI of the snapshot parser (libbuni_c), for embedding it in other
+ * languages. Snapshots go in as wire frames (serializeSnapshot); the events
+ * they produce collect in a per-handle buffer that the caller reads in place
+ * and clears. From cgo, prefer buni_apply_snapshots() with several frames per
+ * call and read the buffer once: every crossing costs far more than a
+ * snapshot diff.
+ *
+ * A handle is not thread safe; use one per thread. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define BUNI_API __declspec(dllexport)
+#else
+#define BUNI_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Status codes; successful calls return >= 0 */
+#define BUNI_OK 0
+#define BUNI_E_MALFORMED (-1)     /* truncated or inconsistent frame */
+#define BUNI_E_UNKNOWN_PAIR (-2)  /* pair not registered */
+#define BUNI_E_EXISTS (-3)        /* pair already registered */
+#define BUNI_E_ARGUMENT (-4)      /* null handle or bad argument */
+#define BUNI_E_NO_MEMORY (-5)     /* allocation failed */
+#define BUNI_E_INTERNAL (-6)      /* unexpected parser error; the pair's book may be partly updated */
+
+/* buni_apply_snapshot() results */
+#define BUNI_APPLIED 0
+#define BUNI_REBUILT_CROSSED 1
+#define BUNI_REBUILT_LOCKED 2
+#define BUNI_DROPPED_STALE 3
+
+/* One TBT event; same 40-byte layout as an order in an orders wire frame */
+typedef struct buni_order {
+    int64_t pair_id;
+    double price;
+    uint64_t time;
+    int32_t qty;
+    int32_t side;     /* 1 buy, 2 sell */
+    int32_t type;     /* 1 limit, 2 market, 3 iceberg */
+    int32_t action;   /* 0 seeker add, 1 add, 2 remove, 3 modify */
+} buni_order;
+
+typedef struct buni_pair_config {
+    int32_t net_events;      /* one event per price per snapshot side */
+    uint32_t max_depth;      /* best N levels per side, 0 = all */
+    int32_t skip_unchanged;  /* skip sides whose fingerprint did not change */
+    double tick_size;        /* > 0 keeps the pair in a price ladder on this grid */
+} buni_pair_config;
+
+typedef struct buni_parser buni_parser;
+
+/* Called after every applied snapshot with the events it produced. The
+ * events are only valid during the call. No exception escapes the API: one
+ * thrown below it, the callback's included, becomes a BUNI_E_ status. */
+typedef void (*buni_event_callback)(void* user, int64_t pair_id, const buni_order* events, size_t count);
+
+BUNI_API buni_parser* buni_parser_create(void);
+BUNI_API void buni_parser_destroy(buni_parser* parser);
+
+BUNI_API int buni_register_pair(buni_parser* parser, int64_t pair_id);
+BUNI_API int buni_configure_pair(buni_parser* parser, int64_t pair_id, const buni_pair_config* config);
+
+/* One snapshot frame. Returns a BUNI_APPLIED.. result or an error. */
+BUNI_API int buni_apply_snapshot(buni_parser* parser, const void* data, size_t len);
+
+/* Back-to-back snapshot frames in one buffer. Returns the number of frames
+ * applied; on a bad frame, the negative error (earlier frames stay applied,
+ * *applied, when given, receives their count). */
+BUNI_API int64_t buni_apply_snapshots(buni_parser* parser, const void* data, size_t len, size_t* applied);
+
+/* Buffer sink: events of every snapshot applied since the last clear, valid
+ * until the next apply or clear call */
+BUNI_API const buni_order* buni_events(const buni_parser* parser, size_t* count);
+BUNI_API void buni_clear_events(buni_parser* parser);
+
+/* Callback sink (NULL to turn off). Events still collect in the buffer. */
+BUNI_API void buni_set_event_callback(buni_parser* parser, buni_event_callback callback, void* user);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,80 @@
+#include "consolidated_book.h"
+#include "utils.h"
+#include <algorithm>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+void VenueTournament::configure(size_t venues, bool isBuySide) {
+    _isBuySide = isBuySide;
+    _leaves = 1;
+    while (_leaves < venues) _leaves <<= 1;
+    _nodes.assign(2 * _leaves, VenueTop());
+}
+
+void VenueTournament::update(size_t venue, ORDER_PRICE price, int64_t qty) {
+    size_t node = _leaves + venue;
+    _nodes[node].price = qty > 0 ? price : 0;
+    _nodes[node].qty = qty > 0 ? qty : 0;
+    for (node >>= 1; node >= 1; node >>= 1) {
+        _nodes[node] = _combine(_nodes[2 * node], _nodes[2 * node + 1]);
+    }
+}
+
+VenueTop VenueTournament::_combine(const VenueTop& a, const VenueTop& b) const {
+    if (a.qty == 0) return b;
+    if (b.qty == 0) return a;
+    if (SafeDoubleCompare(a.price, b.price)) {
+        VenueTop both = a;
+        both.qty += b.qty;
+        return both;
+    }
+    bool aBetter = _isBuySide ? a.price > b.price : a.price < b.price;
+    return aBetter ? a : b;
+}
+
+void mergeVenueBooks(const std::vector<const BookSide*>& venues, bool isBuySide, size_t maxLevels,
+                     std::vector<bookElement>& out) {
+    out.clear();
+    struct Cursor {
+        ORDER_PRICE price;
+        size_t venue;
+        size_t level;
+    };
+    // Heap top is the best price across the venue cursors
+    auto worse = [isBuySide](const Cursor& a, const Cursor& b) {
+        return isBuySide ? a.price < b.price : a.price > b.price;
+    };
+    std::vector<Cursor> heap;
+    heap.reserve(venues.size());
+    for (size_t v = 0; v < venues.size(); v++) {
+        if (!venues[v]->empty()) heap.push_back({venues[v]->front().price, v, 0});
+    }
+    std::make_heap(heap.begin(), heap.end(), worse);
+
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), worse);
+        Cursor cursor = heap.back();
+        heap.pop_back();
+        const bookElement& level = (*venues[cursor.venue])[cursor.level];
+
+        if (!out.empty() && SafeDoubleCompare(out.back().price, level.price)) {
+            out.back().qty += level.qty;
+            if (level.time > out.back().time) out.back().time = level.time;
+        } else {
+            if (maxLevels > 0 && out.size() == maxLevels) break;
+            out.push_back(level);
+        }
+
+        if (++cursor.level < venues[cursor.venue]->size()) {
+            cursor.price = (*venues[cursor.venue])[cursor.level].price;
+            heap.push_back(cursor);
+            std::push_heap(heap.begin(), heap.end(), worse);
+        }
+    }
+}
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
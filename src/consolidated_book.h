@@ -0,0 +1,53 @@
+#pragma once
+
+#include "data_structures.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+// Best level of one venue; qty 0 = the side is empty
+struct VenueTop {
+    ORDER_PRICE price = 0;
+    int64_t qty = 0;
+};
+
+// Tournament tree over the best level of every venue of one side. The root
+// is the best price across venues with the qty of all venues quoting it;
+// a venue update replays only its path to the root, O(log venues).
+class VenueTournament {
+public:
+    void configure(size_t venues, bool isBuySide);
+    void update(size_t venue, ORDER_PRICE price, int64_t qty);
+    const VenueTop& best() const { return _nodes[1]; }
+
+private:
+    std::vector<VenueTop> _nodes;   // 1-based heap layout, leaves from _leaves
+    size_t _leaves = 1;
+    bool _isBuySide = true;
+
+    VenueTop _combine(const VenueTop& a, const VenueTop& b) const;
+};
+
+// Pair IDs quoting the same instrument on different venues. Member level
+// changes are re-emitted as consolidated events under groupId (see
+// SeekerNetBoonSnapshotParserToTBT::SetConsolidationGroup).
+struct ConsolidationGroup {
+    PAIR_ID groupId = 0;
+    std::vector<PAIR_ID> members;   // venue index = position
+    VenueTournament bids;
+    VenueTournament asks;
+    Bbo nbbo;                       // qty = total at the best price across venues
+};
+
+// K-way merge of the venue books of one side into at most maxLevels
+// consolidated levels (0 = all); equal prices are summed. O(levels * log venues).
+void mergeVenueBooks(const std::vector<const BookSide*>& venues, bool isBuySide, size_t maxLevels,
+                     std::vector<bookElement>& out);
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
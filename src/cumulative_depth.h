@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+// Running qty totals of one book side: total(i) is the qty of levels 0..i.
+// Stored sums are relative to an offset, so changes at the front of the book
+// (market order fills, best level churn) cost O(1). Changes deeper in the
+// book mark the suffix stale; it is extended lazily, only as far as a query
+// needs.
+class CumulativeDepth {
+public:
+    void clear() {
+        _sums.clear();
+        _offset = 0;
+    }
+
+    // Level index changed; call before the book is modified for erases and
+    // qty changes and after it for inserts
+    void frontInserted(int64_t qty) {
+        if (_sums.empty()) return;
+        _sums.push_front(-_offset);
+        _offset += qty;
+    }
+    void frontErased(int64_t qty) {
+        if (_sums.empty()) return;
+        _sums.pop_front();
+        _offset -= qty;
+    }
+    void frontQtyChanged(int64_t delta) {
+        if (_sums.empty()) return;
+        _offset += delta;
+    }
+    void invalidateFrom(size_t index) {
+        if (index < _sums.size()) _sums.resize(index);
+        if (_sums.empty()) _offset = 0;
+    }
+
+    // Qty of the best `levels` levels
+    template <typename Levels>
+    int64_t total(const Levels& book, size_t levels) {
+        if (levels == 0) return 0;
+        if (levels > book.size()) levels = book.size();
+        while (_sums.size() < levels) _extend(book);
+        return _sums[levels - 1] + _offset;
+    }
+
+    // Index of the first level at which the running total reaches qty, or
+    // book.size() if the whole side holds less
+    template <typename Levels>
+    size_t levelsToFill(const Levels& book, int64_t qty) {
+        while (_sums.size() < book.size() && (_sums.empty() || _sums.back() + _offset < qty)) {
+            _extend(book);
+        }
+        auto it = std::lower_bound(_sums.begin(), _sums.end(), qty - _offset);
+        return static_cast<size_t>(it - _sums.begin());
+    }
+
+private:
+    std::deque<int64_t> _sums;   // total(i) - _offset for the valid prefix
+    int64_t _offset = 0;
+
+    template <typename Levels>
+    void _extend(const Levels& book) {
+        int64_t previous = _sums.empty() ? -_offset : _sums.back();
+        _sums.push_back(previous + book[_sums.size()].qty);
+    }
+};
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
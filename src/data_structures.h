@@ -1,13 +1,22 @@
 #pragma once
 
 #include "types.h"
+#include "diff_stats.h"
+#include "price_ladder.h"
+#include "cumulative_depth.h"
+#include "book_view.h"
+#include "book_analytics.h"
+#include <cstddef>
 #include <vector>
 #include <deque>
+#include <memory>
 
 namespace cl {
 namespace data_feed {
 namespace data_feed_parser {
 
+struct ConsolidationGroup;
+
 struct Order {
     PAIR_ID pairId;
     ORDER_PRICE price;
@@ -26,11 +35,71 @@ struct bookElement {
 
 typedef std::deque<bookElement> BookSide;
 
-struct PairOrderBookCache {
-    BookSide oldBuySide;
-    BookSide newBuySide;
-    BookSide oldSellSide;
-    BookSide newSellSide;
+// Per-pair parser options, set with SetPairConfig()
+struct PairConfig {
+    // Collapse the events of one snapshot side to at most one per price:
+    // ADD/SEEKER_ADD (new level, full qty), REMOVE (level gone, old qty) or
+    // MODIFY (level kept, qty is the new resting quantity)
+    bool netEvents = false;
+
+    // Keep only the best maxDepth levels per side (0 = unlimited). Incoming
+    // books are truncated at ingest; levels pushed below the last visible
+    // level go out of view silently instead of producing REMOVE events.
+    size_t maxDepth = 0;
+
+    // Skip the diff for a side whose incoming fingerprint equals the current
+    // book's. Every verifyEvery-th skip (0 = never) runs the full diff anyway
+    // and counts a collision if it emits anything.
+    bool skipUnchangedSides = false;
+    uint32_t verifyEvery = 0;
+
+    // PRICE_LADDER keeps each side in a direct-indexed PriceLadder on a
+    // tickSize grid and diffs snapshots against it; each changed tick is then
+    // applied to the sorted BookSide. Without a tickSize the pair stays sorted.
+    BOOK_LAYOUT layout = BOOK_LAYOUT::SORTED_LEVELS;
+    double tickSize = 0;
+
+    // Publish the best publishLevels levels per side (capped at
+    // BookView::MAX_LEVELS) to a PublishedBookView after every book update,
+    // for getBookView() readers on other threads. 0 = off.
+    size_t publishLevels = 0;
+
+    // Record a Bbo in getBboUpdates() whenever an update changes the best
+    // bid or ask price or qty
+    bool trackBbo = false;
+
+    // Record a BookAnalytics in getAnalytics() after every update: VWAPs over
+    // the best analyticsLevels levels per side (0 = off) and the qty resting
+    // within analyticsBandBps of the mid
+    size_t analyticsLevels = 0;
+    double analyticsBandBps = 10;
+};
+
+// Best bid and offer; an empty side has price and qty 0 (so a new pair
+// starts with the BBO of an empty book)
+struct Bbo {
+    PAIR_ID pairId = 0;
+    ORDER_TIME time = 0;   // of the update that produced it
+    ORDER_PRICE bidPrice = 0;
+    ORDER_PRICE askPrice = 0;
+    ORDER_QTY bidQty = 0;
+    ORDER_QTY askQty = 0;
+};
+
+// State kept in step with every level change of one book side
+struct BookSideState {
+    uint64_t hash = 0;   // bookSideHash() of the side
+    PriceLadder ladder;  // PRICE_LADDER layout only
+    CumulativeDepth depth;
+    SideAnalytics analytics;   // PairConfig::analyticsLevels
+    ConsolidationGroup* group = nullptr;   // set for consolidation group members
+    bool isBuySide = true;
+};
+
+struct FingerprintStats {
+    uint64_t sidesSkipped = 0;    // diffs avoided on a fingerprint match
+    uint64_t verifications = 0;   // matches diffed anyway (verifyEvery)
+    uint64_t collisions = 0;      // verifications that found a real change
 };
 
 struct SeekerBounds {
@@ -38,6 +107,35 @@ struct SeekerBounds {
     double minAskSeen = MAX_DOUBLE;
 };
 
+struct SnapshotStats {
+    uint64_t applied = 0;   // ApplySnapshot() diffs
+    uint64_t crossed = 0;   // best bid above best ask, book rebuilt
+    uint64_t locked = 0;    // best bid equal to best ask, book rebuilt
+    uint64_t stale = 0;     // older than the last applied snapshot, dropped
+};
+
+// Everything the parser keeps for one pair, reached with a single lookup
+struct PairOrderBookCache {
+    BookSide oldBuySide;
+    BookSide newBuySide;
+    BookSide oldSellSide;
+    BookSide newSellSide;
+    BookSideState buyState;
+    BookSideState sellState;
+    SeekerBounds seekerBounds;
+    PairConfig config;
+    FingerprintStats fingerprint;
+    ORDER_TIME lastSnapshotTime = 0;
+    SnapshotStats snapshotStats;
+    Bbo bbo;   // PairConfig::trackBbo
+    ConsolidationGroup* group = nullptr;
+    size_t venue = 0;   // index in group->members
+    std::unique_ptr<PublishedBookView> view;   // created on first publishLevels > 0, never freed
+#ifdef BUNI_DIFF_STATS
+    DiffStats diffStats;
+#endif
+};
+
 } // namespace data_feed_parser
 } // namespace data_feed
 } // namespace cl
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+// Per-pair counters for the snapshot diff engine (_emitOrdersAndUpdateBook).
+// Only populated when the library is built with BUNI_DIFF_STATS defined;
+// otherwise every counter site compiles away and getDiffStats() returns zeros.
+struct DiffStats {
+    uint64_t sidesDiffed = 0;           // _emitOrdersAndUpdateBook calls
+    uint64_t dequeInserts = 0;          // insert()/push_back() into the old book
+    uint64_t dequeErases = 0;           // erase()/pop_back() from the old book
+    uint64_t frontPops = 0;             // pop_front() on a worse old top level
+    uint64_t qtyChanges = 0;            // same price, quantity-only update
+    uint64_t seekerAdds = 0;            // SEEKER_ADD events
+    uint64_t levelsVisited = 0;         // outer loop iterations
+    uint64_t loopIterations = 0;        // inner do/while iterations
+    uint64_t maxIterationsPerLevel = 0; // worst inner iteration count for one level
+    uint64_t guardTrips = 0;            // iteration guard hits
+};
+
+#ifdef BUNI_DIFF_STATS
+#define BUNI_DIFF_STAT(stats, field) (++(stats).field)
+#define BUNI_DIFF_STAT_MAX(stats, field, value) \
+    do { if ((value) > (stats).field) (stats).field = (value); } while (0)
+#else
+#define BUNI_DIFF_STAT(stats, field) ((void)0)
+#define BUNI_DIFF_STAT_MAX(stats, field, value) ((void)0)
+#endif
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
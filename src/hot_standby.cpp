@@ -0,0 +1,138 @@
+#include "hot_standby.h"
+#include "wire_format.h"
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+std::string outputStream(const std::string& subject) {
+    static const std::string tbtPrefix = "orderbook.tbt.";
+    if (subject.compare(0, tbtPrefix.size(), tbtPrefix) != 0) return subject;
+    size_t sideDot = subject.rfind('.');
+    return sideDot > tbtPrefix.size() ? subject.substr(0, sideDot) : subject;
+}
+
+constexpr size_t StandbyGate::DEFAULT_MAX_HELD;
+
+StandbyGate::StandbyGate(size_t maxHeldPerStream) : _maxHeld(maxHeldPerStream > 0 ? maxHeldPerStream : 1) {}
+
+bool StandbyGate::hold(const std::string& stream, const std::string& subject, uint64_t sequence,
+                       const char* data, size_t len) {
+    Stream& s = _streams[stream];
+    if (sequence <= s.published) return true;   // the primary is ahead
+    bool complete = true;
+    if (s.held.size() >= _maxHeld) {
+        s.held.pop_front();
+        _overflowed++;
+        complete = false;
+    }
+    Frame frame;
+    frame.sequence = sequence;
+    frame.subject = subject;
+    frame.data.assign(data, data + len);
+    s.held.push_back(std::move(frame));
+    return complete;
+}
+
+void StandbyGate::observe(const std::string& stream, uint64_t sequence) {
+    Stream& s = _streams[stream];
+    if (sequence > s.published) s.published = sequence;
+    while (!s.held.empty() && s.held.front().sequence <= s.published) s.held.pop_front();
+}
+
+void StandbyGate::reset(const std::string& stream, uint64_t sequence) {
+    Stream& s = _streams[stream];
+    s.held.clear();
+    if (sequence > s.published) s.published = sequence;
+}
+
+void StandbyGate::release(
+    const std::function<void(const std::string& subject, const std::vector<char>& frame)>& publish) {
+    for (auto& stream : _streams) {
+        for (const Frame& frame : stream.second.held) publish(frame.subject, frame.data);
+        stream.second.held.clear();
+    }
+}
+
+uint64_t StandbyGate::published(const std::string& stream) const {
+    auto it = _streams.find(stream);
+    return it != _streams.end() ? it->second.published : 0;
+}
+
+size_t StandbyGate::held() const {
+    size_t total = 0;
+    for (const auto& stream : _streams) total += stream.second.held.size();
+    return total;
+}
+
+void serializeChecksum(const BookChecksum& checksum, char* out) {
+    wire_detail::write_i64_le(out, static_cast<int64_t>(checksum.pairId));
+    wire_detail::write_u64_le(out + 8, static_cast<uint64_t>(checksum.time));
+    wire_detail::write_u64_le(out + 16, checksum.buyHash);
+    wire_detail::write_u64_le(out + 24, checksum.sellHash);
+    wire_detail::write_u64_le(out + 32, checksum.sequence);
+}
+
+bool deserializeChecksum(const char* data, size_t len, BookChecksum& out) {
+    if (!data || len < WIRE_CHECKSUM_SIZE) return false;
+    out.pairId = static_cast<PAIR_ID>(wire_detail::read_i64_le(data));
+    out.time = static_cast<ORDER_TIME>(wire_detail::read_u64_le(data + 8));
+    out.buyHash = wire_detail::read_u64_le(data + 16);
+    out.sellHash = wire_detail::read_u64_le(data + 24);
+    out.sequence = wire_detail::read_u64_le(data + 32);
+    return true;
+}
+
+constexpr size_t ChecksumVerifier::DEFAULT_HISTORY;
+
+ChecksumVerifier::ChecksumVerifier(size_t history) : _history(history > 0 ? history : 1) {}
+
+CHECKSUM_RESULT ChecksumVerifier::_compare(const BookChecksum& local, const BookChecksum& remote) {
+    if (local.buyHash == remote.buyHash && local.sellHash == remote.sellHash &&
+        local.sequence == remote.sequence) {
+        _stats.matched++;
+        return CHECKSUM_RESULT::MATCH;
+    }
+    _stats.mismatched++;
+    return CHECKSUM_RESULT::MISMATCH;
+}
+
+CHECKSUM_RESULT ChecksumVerifier::recordLocal(const BookChecksum& local) {
+    PairHistory& pair = _pairs[local.pairId];
+    if (pair.recent.size() >= _history) pair.recent.pop_front();
+    pair.recent.push_back(local);
+    if (!pair.hasWaiting || local.time < pair.waiting.time) return CHECKSUM_RESULT::PENDING;
+    pair.hasWaiting = false;
+    if (local.time == pair.waiting.time) return _compare(local, pair.waiting);
+    _stats.unmatched++;   // the standby never applied that snapshot
+    return CHECKSUM_RESULT::UNMATCHED;
+}
+
+CHECKSUM_RESULT ChecksumVerifier::checkRemote(const BookChecksum& remote) {
+    PairHistory& pair = _pairs[remote.pairId];
+    if (pair.recent.empty() || remote.time > pair.recent.back().time) {
+        if (pair.hasWaiting) _stats.unmatched++;
+        pair.waiting = remote;
+        pair.hasWaiting = true;
+        return CHECKSUM_RESULT::PENDING;
+    }
+    // Newest first: a stale snapshot repeats the time of the one before it
+    for (auto it = pair.recent.rbegin(); it != pair.recent.rend(); ++it) {
+        if (it->time == remote.time) return _compare(*it, remote);
+        if (it->time < remote.time) break;
+    }
+    _stats.unmatched++;
+    return CHECKSUM_RESULT::UNMATCHED;
+}
+
+void ChecksumVerifier::reset(PAIR_ID pairId) {
+    _pairs.erase(pairId);
+}
+
+bool yieldsTo(uint64_t epoch, const std::string& id, uint64_t otherEpoch, const std::string& otherId) {
+    return otherEpoch > epoch || (otherEpoch == epoch && otherId < id);
+}
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "data_structures.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+// Active/standby processing. Both processors apply the same snapshots in the
+// same order, so they produce the same output frames with the same
+// sequences. The standby holds its frames in a StandbyGate and drops each
+// one once it sees the primary publish that sequence. When the primary's
+// heartbeats stop, the standby releases what is still held and publishes
+// from then on. Each sequenced stream continues with no gap and no
+// duplicate. A ChecksumVerifier compares the standby's books with the
+// primary's periodic BookChecksums; a pair that differs is resynced from the
+// primary's checkpoint, and so is one whose held frames overflowed the gate.
+// A pair still resyncing at takeover restarts instead, from an empty book and
+// a higher sequence (restartSequence), so its consumers see a gap.
+// Only the sequenced streams are covered: the flat orderbook.tbt subject,
+// the shared memory ring, BBO and analytics are not held, so what the old
+// primary computed but never published there is lost at failover.
+
+// Sequenced stream an output subject belongs to: the buy and sell subjects
+// of a pair share one sequence, orderbook.tbt.<pair>
+std::string outputStream(const std::string& subject);
+
+// Held output frames of a standby, per stream in sequence order
+class StandbyGate {
+public:
+    static constexpr size_t DEFAULT_MAX_HELD = 4096;   // per stream; the oldest frame goes first
+
+    explicit StandbyGate(size_t maxHeldPerStream = DEFAULT_MAX_HELD);
+
+    // A frame the standby would have published. False if the stream was full
+    // and its oldest frame was dropped: a takeover would now leave a gap, so
+    // the stream's pair needs a resync.
+    bool hold(const std::string& stream, const std::string& subject, uint64_t sequence,
+              const char* data, size_t len);
+    // The primary published sequence on stream: frames up to it are dropped
+    void observe(const std::string& stream, uint64_t sequence);
+    // Resync: drops the stream's held frames, computed from a wrong book, and
+    // takes everything up to sequence as published
+    void reset(const std::string& stream, uint64_t sequence);
+
+    // Takeover: passes every held frame to publish, stream by stream in
+    // sequence order. What the primary published is kept: a standby that was
+    // behind it must still drop those frames when it computes them.
+    void release(const std::function<void(const std::string& subject, const std::vector<char>& frame)>& publish);
+
+    uint64_t published(const std::string& stream) const;   // highest sequence seen from the primary
+    size_t held() const;
+    uint64_t overflowed() const { return _overflowed; }   // frames dropped at maxHeldPerStream
+
+private:
+    struct Frame {
+        uint64_t sequence;
+        std::string subject;
+        std::vector<char> data;
+    };
+    struct Stream {
+        uint64_t published = 0;   // highest sequence seen from the primary
+        std::deque<Frame> held;
+    };
+    size_t _maxHeld;
+    uint64_t _overflowed = 0;
+    std::unordered_map<std::string, Stream> _streams;
+};
+
+// Book fingerprints of a pair after a snapshot, with the pair's TBT sequence
+struct BookChecksum {
+    PAIR_ID pairId = 0;
+    ORDER_TIME time = 0;   // last applied snapshot
+    uint64_t buyHash = 0;
+    uint64_t sellHash = 0;
+    uint64_t sequence = 0;
+};
+
+constexpr size_t WIRE_CHECKSUM_SIZE = 40;   // pairId(8) + time(8) + buyHash(8) + sellHash(8) + sequence(8)
+void serializeChecksum(const BookChecksum& checksum, char* out);
+bool deserializeChecksum(const char* data, size_t len, BookChecksum& out);
+
+enum class CHECKSUM_RESULT { MATCH, MISMATCH, PENDING, UNMATCHED };
+
+struct ChecksumStats {
+    uint64_t matched = 0;
+    uint64_t mismatched = 0;
+    uint64_t unmatched = 0;   // no local checksum of the same snapshot (dropped, or too old)
+};
+
+// Compares the primary's checksums with the standby's own. Either side may
+// be ahead: recent local checksums are kept per pair, and a primary checksum
+// from the future waits for the standby to apply that snapshot.
+class ChecksumVerifier {
+public:
+    static constexpr size_t DEFAULT_HISTORY = 64;
+
+    explicit ChecksumVerifier(size_t history = DEFAULT_HISTORY);
+
+    // After each snapshot the standby applies; the result of a waiting primary
+    // checksum for it, or PENDING if none was waiting
+    CHECKSUM_RESULT recordLocal(const BookChecksum& local);
+    CHECKSUM_RESULT checkRemote(const BookChecksum& remote);
+    void reset(PAIR_ID pairId);   // forget a pair's history, e.g. after a resync
+
+    const ChecksumStats& getStats() const { return _stats; }
+
+private:
+    struct PairHistory {
+        std::deque<BookChecksum> recent;
+        bool hasWaiting = false;
+        BookChecksum waiting;
+    };
+    CHECKSUM_RESULT _compare(const BookChecksum& local, const BookChecksum& remote);
+
+    size_t _history;
+    ChecksumStats _stats;
+    std::unordered_map<PAIR_ID, PairHistory> _pairs;
+};
+
+// Two processors both acting as primary: the one with the older epoch, or
+// with the same epoch and the larger id, yields and becomes the standby
+bool yieldsTo(uint64_t epoch, const std::string& id, uint64_t otherEpoch, const std::string& otherId);
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
@@ -0,0 +1,245 @@
+#include "multicast_feed.h"
+#include "wire_format.h"
+#include <arpa/inet.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <poll.h>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+namespace {
+constexpr size_t kControlBytes = CMSG_SPACE(sizeof(scm_timestamping));
+
+uint64_t realtimeNs() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+} // namespace
+
+constexpr size_t MulticastReceiver::BATCH;
+
+bool parseMulticastEndpoint(const char* spec, MulticastEndpoint& out) {
+    if (!spec) return false;
+    const char* colon = std::strchr(spec, ':');
+    if (!colon || colon == spec) return false;
+
+    char* end = nullptr;
+    unsigned long port = std::strtoul(colon + 1, &end, 10);
+    if (end == colon + 1 || port > 65535 || (*end != '\0' && *end != '@')) return false;
+
+    out.group.assign(spec, colon);
+    out.port = static_cast<uint16_t>(port);
+    out.iface = *end == '@' ? std::string(end + 1) : std::string("0.0.0.0");
+    return true;
+}
+
+MulticastReceiver::~MulticastReceiver() {
+    close();
+}
+
+bool MulticastReceiver::open(const MulticastEndpoint& endpoint) {
+    close();
+    ip_mreq membership;
+    if (inet_pton(AF_INET, endpoint.group.c_str(), &membership.imr_multiaddr) != 1 ||
+        inet_pton(AF_INET, endpoint.iface.c_str(), &membership.imr_interface) != 1) {
+        return false;
+    }
+
+    _fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (_fd < 0) return false;
+
+    int one = 1;
+    setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    int rcvbuf = 8 << 20;
+    setsockopt(_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    // Bound to the group address so other groups on the same port are not delivered here
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(endpoint.port);
+    addr.sin_addr = membership.imr_multiaddr;
+    socklen_t addrLen = sizeof(addr);
+    if (bind(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        setsockopt(_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0 ||
+        getsockname(_fd, reinterpret_cast<sockaddr*>(&addr), &addrLen) != 0) {
+        close();
+        return false;
+    }
+    _port = ntohs(addr.sin_port);
+
+    // Kernel software receive timestamps; without them rxTimeNs falls back to the read time
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    setsockopt(_fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags));
+
+    _buffers.assign(BATCH * MULTICAST_MAX_DATAGRAM, 0);
+    _control.assign(BATCH * kControlBytes, 0);
+    _msgs.assign(BATCH, mmsghdr());
+    _iov.assign(BATCH, iovec());
+    _datagrams.assign(BATCH, MulticastDatagram());
+    for (size_t i = 0; i < BATCH; i++) {
+        _iov[i].iov_base = _buffers.data() + i * MULTICAST_MAX_DATAGRAM;
+        _iov[i].iov_len = MULTICAST_MAX_DATAGRAM;
+    }
+    return true;
+}
+
+void MulticastReceiver::close() {
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+    _port = 0;
+}
+
+size_t MulticastReceiver::receive() {
+    if (_fd < 0) return 0;
+    for (size_t i = 0; i < BATCH; i++) {
+        msghdr& hdr = _msgs[i].msg_hdr;
+        std::memset(&hdr, 0, sizeof(hdr));
+        hdr.msg_iov = &_iov[i];
+        hdr.msg_iovlen = 1;
+        hdr.msg_control = _control.data() + i * kControlBytes;
+        hdr.msg_controllen = kControlBytes;
+    }
+
+    int received = recvmmsg(_fd, _msgs.data(), static_cast<unsigned int>(BATCH), MSG_DONTWAIT, nullptr);
+    if (received <= 0) return 0;
+
+    uint64_t fallbackNs = 0;
+    for (int i = 0; i < received; i++) {
+        MulticastDatagram& datagram = _datagrams[i];
+        datagram.data = static_cast<const char*>(_iov[i].iov_base);
+        datagram.length = _msgs[i].msg_len;
+        datagram.rxTimeNs = 0;
+
+        msghdr& hdr = _msgs[i].msg_hdr;
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMPING) {
+                scm_timestamping ts;
+                std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                datagram.rxTimeNs = static_cast<uint64_t>(ts.ts[0].tv_sec) * 1000000000ULL +
+                                    static_cast<uint64_t>(ts.ts[0].tv_nsec);
+            }
+        }
+        if (datagram.rxTimeNs == 0) {
+            if (fallbackNs == 0) fallbackNs = realtimeNs();
+            datagram.rxTimeNs = fallbackNs;
+        }
+    }
+    return static_cast<size_t>(received);
+}
+
+bool LineArbiter::accept(uint64_t sequence, bool lineB) {
+    if (sequence <= _last) {
+        _stats.duplicates++;
+        return false;
+    }
+    if (_last != 0 && sequence > _last + 1) {
+        _stats.gaps += sequence - _last - 1;
+    }
+    _last = sequence;
+    _stats.delivered++;
+    if (lineB) _stats.fromB++;
+    else _stats.fromA++;
+    return true;
+}
+
+bool MulticastSnapshotFeed::open(const MulticastEndpoint& lineA, const MulticastEndpoint* lineB) {
+    close();
+    if (!_a.open(lineA)) return false;
+    if (lineB && !_b.open(*lineB)) {
+        _a.close();
+        return false;
+    }
+    return true;
+}
+
+void MulticastSnapshotFeed::close() {
+    _a.close();
+    _b.close();
+    _arbiter.reset();
+}
+
+bool MulticastSnapshotFeed::_wait(int timeoutMs, bool readable[2]) {
+    pollfd fds[2];
+    int count = 0;
+    int lineOf[2];
+    if (_a.isOpen()) {
+        fds[count].fd = _a.fd();
+        fds[count].events = POLLIN;
+        lineOf[count++] = 0;
+    }
+    if (_b.isOpen()) {
+        fds[count].fd = _b.fd();
+        fds[count].events = POLLIN;
+        lineOf[count++] = 1;
+    }
+    if (count == 0 || ::poll(fds, static_cast<nfds_t>(count), timeoutMs) <= 0) return false;
+
+    for (int i = 0; i < count; i++) {
+        readable[lineOf[i]] = (fds[i].revents & POLLIN) != 0;
+    }
+    return true;
+}
+
+uint64_t MulticastSnapshotFeed::_sequence(const MulticastDatagram& datagram) {
+    return wire_detail::read_u64_le(datagram.data);
+}
+
+MulticastSender::~MulticastSender() {
+    close();
+}
+
+bool MulticastSender::open(const MulticastEndpoint& endpoint, int ttl, bool loopback) {
+    close();
+    in_addr iface;
+    std::memset(&_address, 0, sizeof(_address));
+    _address.sin_family = AF_INET;
+    _address.sin_port = htons(endpoint.port);
+    if (inet_pton(AF_INET, endpoint.group.c_str(), &_address.sin_addr) != 1 ||
+        inet_pton(AF_INET, endpoint.iface.c_str(), &iface) != 1) {
+        return false;
+    }
+
+    _fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (_fd < 0) return false;
+    unsigned char hops = static_cast<unsigned char>(ttl);
+    unsigned char loop = loopback ? 1 : 0;
+    if (setsockopt(_fd, IPPROTO_IP, IP_MULTICAST_TTL, &hops, sizeof(hops)) != 0 ||
+        setsockopt(_fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) != 0 ||
+        (iface.s_addr != htonl(INADDR_ANY) &&
+         setsockopt(_fd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) != 0)) {
+        close();
+        return false;
+    }
+    _buffer.reserve(MULTICAST_MAX_DATAGRAM);
+    return true;
+}
+
+void MulticastSender::close() {
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
+
+bool MulticastSender::send(uint64_t sequence, const char* frame, size_t length) {
+    if (_fd < 0 || MULTICAST_HEADER_SIZE + length > MULTICAST_MAX_DATAGRAM) return false;
+    _buffer.resize(MULTICAST_HEADER_SIZE + length);
+    wire_detail::write_u64_le(_buffer.data(), sequence);
+    std::memcpy(_buffer.data() + MULTICAST_HEADER_SIZE, frame, length);
+    ssize_t sent = sendto(_fd, _buffer.data(), _buffer.size(), 0,
+                          reinterpret_cast<const sockaddr*>(&_address), sizeof(_address));
+    return sent == static_cast<ssize_t>(_buffer.size());
+}
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
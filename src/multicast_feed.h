@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+// Snapshot ingest from UDP multicast. Each datagram is one snapshot wire
+// frame (serializeSnapshot) behind an 8-byte little-endian sequence number
+// shared by the A and B lines; the first copy of a sequence to arrive on
+// either line is delivered, later copies and older sequences are dropped.
+constexpr size_t MULTICAST_HEADER_SIZE = 8;
+constexpr size_t MULTICAST_MAX_DATAGRAM = 65536;
+
+struct MulticastEndpoint {
+    std::string group;                 // e.g. 239.1.1.1
+    uint16_t port = 0;                 // 0 binds an ephemeral port (see MulticastReceiver::port())
+    std::string iface = "0.0.0.0";     // local address of the interface to join on
+};
+
+// "group:port" or "group:port@iface"
+bool parseMulticastEndpoint(const char* spec, MulticastEndpoint& out);
+
+struct MulticastDatagram {
+    const char* data;      // sequence header included
+    size_t length;
+    uint64_t rxTimeNs;     // kernel receive time (SO_TIMESTAMPING), realtime clock
+};
+
+// One joined group. receive() drains up to BATCH datagrams with one
+// recvmmsg call and never blocks.
+class MulticastReceiver {
+public:
+    static constexpr size_t BATCH = 16;
+
+    MulticastReceiver() = default;
+    ~MulticastReceiver();
+    MulticastReceiver(const MulticastReceiver&) = delete;
+    MulticastReceiver& operator=(const MulticastReceiver&) = delete;
+
+    bool open(const MulticastEndpoint& endpoint);
+    void close();
+    bool isOpen() const { return _fd >= 0; }
+    int fd() const { return _fd; }
+    uint16_t port() const { return _port; }
+
+    // Returns the number of datagrams now available through datagram(i)
+    size_t receive();
+    const MulticastDatagram& datagram(size_t i) const { return _datagrams[i]; }
+
+private:
+    int _fd = -1;
+    uint16_t _port = 0;
+    std::vector<char> _buffers;
+    std::vector<char> _control;
+    std::vector<mmsghdr> _msgs;
+    std::vector<iovec> _iov;
+    std::vector<MulticastDatagram> _datagrams;
+};
+
+struct ArbitrationStats {
+    uint64_t delivered = 0;
+    uint64_t duplicates = 0;   // sequence already delivered (the other line won)
+    uint64_t gaps = 0;         // sequences missing on both lines
+    uint64_t malformed = 0;    // datagrams shorter than the sequence header
+    uint64_t fromA = 0;        // delivered copies per line
+    uint64_t fromB = 0;
+};
+
+// A/B arbitration on the shared sequence number. Snapshots carry full book
+// state, so a sequence older than the newest delivered one is never useful
+// and counts as a duplicate.
+class LineArbiter {
+public:
+    bool accept(uint64_t sequence, bool lineB);
+    void rejectMalformed() { _stats.malformed++; }
+    void reset() { _last = 0; _stats = ArbitrationStats(); }
+    uint64_t lastSequence() const { return _last; }
+    const ArbitrationStats& getStats() const { return _stats; }
+
+private:
+    uint64_t _last = 0;   // newest delivered sequence, 0 = none yet
+    ArbitrationStats _stats;
+};
+
+// A and (optionally) B line receivers feeding one arbiter
+class MulticastSnapshotFeed {
+public:
+    bool open(const MulticastEndpoint& lineA, const MulticastEndpoint* lineB = nullptr);
+    void close();
+
+    // Waits up to timeoutMs for traffic on either line, then calls
+    // onFrame(data, length, rxTimeNs) for every arbitrated snapshot frame
+    // (sequence header stripped). Returns the number of frames delivered.
+    template <typename OnFrame>
+    size_t poll(int timeoutMs, OnFrame onFrame);
+
+    const ArbitrationStats& getStats() const { return _arbiter.getStats(); }
+    const MulticastReceiver& line(bool lineB) const { return lineB ? _b : _a; }
+
+private:
+    MulticastReceiver _a;
+    MulticastReceiver _b;
+    LineArbiter _arbiter;
+
+    // poll(2) on the open lines; readable[0] for A, readable[1] for B
+    bool _wait(int timeoutMs, bool readable[2]);
+    static uint64_t _sequence(const MulticastDatagram& datagram);
+};
+
+// Sends sequenced snapshot frames to a group (feed simulators, tests)
+class MulticastSender {
+public:
+    MulticastSender() = default;
+    ~MulticastSender();
+    MulticastSender(const MulticastSender&) = delete;
+    MulticastSender& operator=(const MulticastSender&) = delete;
+
+    // iface selects the outgoing interface; loopback keeps the datagrams on this host
+    bool open(const MulticastEndpoint& endpoint, int ttl = 1, bool loopback = true);
+    void close();
+    bool send(uint64_t sequence, const char* frame, size_t length);
+
+private:
+    int _fd = -1;
+    std::vector<char> _buffer;
+    sockaddr_in _address{};
+};
+
+template <typename OnFrame>
+size_t MulticastSnapshotFeed::poll(int timeoutMs, OnFrame onFrame) {
+    bool readable[2] = {false, false};
+    if (!_wait(timeoutMs, readable)) return 0;
+
+    size_t delivered = 0;
+    for (int line = 0; line < 2; line++) {
+        if (!readable[line]) continue;
+        MulticastReceiver& receiver = line == 0 ? _a : _b;
+        size_t count = receiver.receive();
+        for (size_t i = 0; i < count; i++) {
+            const MulticastDatagram& datagram = receiver.datagram(i);
+            if (datagram.length < MULTICAST_HEADER_SIZE) {
+                _arbiter.rejectMalformed();
+                continue;
+            }
+            if (!_arbiter.accept(_sequence(datagram), line == 1)) continue;
+            onFrame(datagram.data + MULTICAST_HEADER_SIZE, datagram.length - MULTICAST_HEADER_SIZE,
+                    datagram.rxTimeNs);
+            delivered++;
+        }
+    }
+    return delivered;
+}
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
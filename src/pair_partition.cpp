@@ -0,0 +1,188 @@
+#include "pair_partition.h"
+#include "wire_format.h"
+#include <algorithm>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+namespace {
+constexpr size_t CHECKPOINT_HEADER_SIZE = 56;
+constexpr size_t CHECKPOINT_LEVEL_SIZE = 20;
+
+uint64_t mix64(uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+// FNV-1a: the same on every host and build, unlike std::hash
+uint64_t pointHash(const std::string& member, uint32_t vnode) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (char c : member) {
+        h = (h ^ static_cast<unsigned char>(c)) * 0x100000001B3ULL;
+    }
+    return mix64(h ^ (static_cast<uint64_t>(vnode) * 0x9E3779B97F4A7C15ULL));
+}
+
+size_t writeLevels(char* dst, const std::vector<bookElement>& levels) {
+    for (const bookElement& level : levels) {
+        wire_detail::write_f64_le(dst, level.price);
+        wire_detail::write_i32_le(dst + 8, static_cast<int32_t>(level.qty));
+        wire_detail::write_u64_le(dst + 12, static_cast<uint64_t>(level.time));
+        dst += CHECKPOINT_LEVEL_SIZE;
+    }
+    return levels.size() * CHECKPOINT_LEVEL_SIZE;
+}
+
+void readLevels(const char* src, uint32_t count, std::vector<bookElement>& out) {
+    out.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        out[i].price = wire_detail::read_f64_le(src);
+        out[i].qty = static_cast<ORDER_QTY>(wire_detail::read_i32_le(src + 8));
+        out[i].time = static_cast<ORDER_TIME>(wire_detail::read_u64_le(src + 12));
+        src += CHECKPOINT_LEVEL_SIZE;
+    }
+}
+} // namespace
+
+constexpr size_t HashRing::DEFAULT_VIRTUAL_NODES;
+
+HashRing::HashRing(size_t virtualNodes) : _virtualNodes(virtualNodes > 0 ? virtualNodes : 1) {}
+
+void HashRing::setMembers(const std::vector<std::string>& members) {
+    _members = members;
+    std::sort(_members.begin(), _members.end());
+    _members.erase(std::unique(_members.begin(), _members.end()), _members.end());
+
+    _points.clear();
+    _points.reserve(_members.size() * _virtualNodes);
+    for (uint32_t m = 0; m < _members.size(); m++) {
+        for (uint32_t v = 0; v < _virtualNodes; v++) {
+            Point point;
+            point.hash = pointHash(_members[m], v);
+            point.member = m;
+            _points.push_back(point);
+        }
+    }
+    std::sort(_points.begin(), _points.end(), [](const Point& a, const Point& b) {
+        return a.hash < b.hash || (a.hash == b.hash && a.member < b.member);
+    });
+}
+
+const std::string& HashRing::owner(PAIR_ID pairId) const {
+    static const std::string none;
+    if (_points.empty()) return none;
+    uint64_t h = mix64(static_cast<uint64_t>(pairId) * 0x9E3779B97F4A7C15ULL);
+    auto it = std::lower_bound(_points.begin(), _points.end(), h,
+                               [](const Point& point, uint64_t value) { return point.hash < value; });
+    if (it == _points.end()) it = _points.begin();
+    return _members[it->member];
+}
+
+ClusterMembership::ClusterMembership(const std::string& self, uint64_t timeoutMs)
+    : _self(self), _timeoutMs(timeoutMs) {}
+
+bool ClusterMembership::heartbeat(const std::string& id, uint64_t nowMs) {
+    if (id == _self) return false;
+    auto left = _left.find(id);
+    if (left != _left.end()) {
+        if (nowMs - left->second < _timeoutMs) return false;
+        _left.erase(left);
+    }
+    auto it = _lastSeen.find(id);
+    if (it != _lastSeen.end()) {
+        it->second = nowMs;
+        return false;
+    }
+    _lastSeen[id] = nowMs;
+    return true;
+}
+
+bool ClusterMembership::leave(const std::string& id, uint64_t nowMs) {
+    if (id == _self) return false;
+    _left[id] = nowMs;
+    return _lastSeen.erase(id) > 0;
+}
+
+bool ClusterMembership::expire(uint64_t nowMs) {
+    bool changed = false;
+    for (auto it = _lastSeen.begin(); it != _lastSeen.end();) {
+        if (nowMs - it->second >= _timeoutMs) {
+            it = _lastSeen.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+    return changed;
+}
+
+std::vector<std::string> ClusterMembership::members() const {
+    std::vector<std::string> result;
+    result.reserve(_lastSeen.size() + 1);
+    for (const auto& member : _lastSeen) result.push_back(member.first);
+    result.insert(std::lower_bound(result.begin(), result.end(), _self), _self);
+    return result;
+}
+
+uint64_t restartSequence(uint64_t current, uint64_t nowMs) {
+    return std::max(current, nowMs << RESTART_SEQUENCE_SHIFT);
+}
+
+void captureCheckpoint(const SeekerNetBoonSnapshotParserToTBT& parser, PAIR_ID pairId, PairCheckpoint& out) {
+    const BookSide& bids = parser.getBuySide(pairId);
+    const BookSide& asks = parser.getSellSide(pairId);
+    out.pairId = pairId;
+    out.time = parser.getLastSnapshotTime(pairId);
+    out.bounds = parser.getSeekerBounds(pairId);
+    out.bids.assign(bids.begin(), bids.end());
+    out.asks.assign(asks.begin(), asks.end());
+}
+
+void restoreCheckpoint(SeekerNetBoonSnapshotParserToTBT& parser, PairCheckpoint& checkpoint) {
+    parser.LoadBook(checkpoint.pairId, checkpoint.bids, checkpoint.asks, checkpoint.time, checkpoint.bounds);
+}
+
+std::vector<char> serializeCheckpoint(const PairCheckpoint& checkpoint) {
+    std::vector<char> buf(CHECKPOINT_HEADER_SIZE +
+                          (checkpoint.bids.size() + checkpoint.asks.size()) * CHECKPOINT_LEVEL_SIZE);
+    char* p = buf.data();
+    wire_detail::write_i64_le(p, static_cast<int64_t>(checkpoint.pairId));
+    wire_detail::write_u64_le(p + 8, static_cast<uint64_t>(checkpoint.time));
+    wire_detail::write_u64_le(p + 16, checkpoint.tbtSequence);
+    wire_detail::write_u64_le(p + 24, checkpoint.filteredSequence);
+    wire_detail::write_f64_le(p + 32, checkpoint.bounds.maxBidSeen);
+    wire_detail::write_f64_le(p + 40, checkpoint.bounds.minAskSeen);
+    wire_detail::write_u32_le(p + 48, static_cast<uint32_t>(checkpoint.bids.size()));
+    wire_detail::write_u32_le(p + 52, static_cast<uint32_t>(checkpoint.asks.size()));
+    p += CHECKPOINT_HEADER_SIZE;
+    p += writeLevels(p, checkpoint.bids);
+    writeLevels(p, checkpoint.asks);
+    return buf;
+}
+
+bool deserializeCheckpoint(const char* data, size_t len, PairCheckpoint& out) {
+    if (!data || len < CHECKPOINT_HEADER_SIZE) return false;
+    uint32_t numBids = wire_detail::read_u32_le(data + 48);
+    uint32_t numAsks = wire_detail::read_u32_le(data + 52);
+    if ((len - CHECKPOINT_HEADER_SIZE) / CHECKPOINT_LEVEL_SIZE < static_cast<uint64_t>(numBids) + numAsks) {
+        return false;
+    }
+    out.pairId = static_cast<PAIR_ID>(wire_detail::read_i64_le(data));
+    out.time = static_cast<ORDER_TIME>(wire_detail::read_u64_le(data + 8));
+    out.tbtSequence = wire_detail::read_u64_le(data + 16);
+    out.filteredSequence = wire_detail::read_u64_le(data + 24);
+    out.bounds.maxBidSeen = wire_detail::read_f64_le(data + 32);
+    out.bounds.minAskSeen = wire_detail::read_f64_le(data + 40);
+    readLevels(data + CHECKPOINT_HEADER_SIZE, numBids, out.bids);
+    readLevels(data + CHECKPOINT_HEADER_SIZE + numBids * CHECKPOINT_LEVEL_SIZE, numAsks, out.asks);
+    return true;
+}
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "data_structures.h"
+#include "snapshot_parser.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+// Partitioned processing: replicas split the pairs between them with a
+// consistent hash ring over the live members, each subscribing to the
+// per-pair snapshot subjects of the pairs it owns. When the member set
+// changes, a pair's new owner asks the current one for a PairCheckpoint and
+// continues the pair's book and output sequences from it.
+
+// Consistent hash ring. Each member sits at virtualNodes points on a 64-bit
+// ring and a pair belongs to the first point at or after the pair's hash, so
+// a member joining or leaving only moves the pairs on its own points.
+// Replicas that agree on the member set agree on every owner.
+class HashRing {
+public:
+    static constexpr size_t DEFAULT_VIRTUAL_NODES = 128;
+
+    explicit HashRing(size_t virtualNodes = DEFAULT_VIRTUAL_NODES);
+
+    void setMembers(const std::vector<std::string>& members);
+    const std::vector<std::string>& members() const { return _members; }
+
+    // Owning member of a pair; empty when the ring has no members
+    const std::string& owner(PAIR_ID pairId) const;
+
+private:
+    struct Point {
+        uint64_t hash;
+        uint32_t member;   // index in _members
+    };
+    size_t _virtualNodes;
+    std::vector<std::string> _members;   // sorted
+    std::vector<Point> _points;          // sorted by hash
+};
+
+// Live members from heartbeats. A member is dropped when it announces that it
+// leaves or when it has not been heard from for timeoutMs; heartbeats still in
+// flight from a member that left are ignored for another timeoutMs. Self is
+// always a member. Each call returns true if the member set changed.
+class ClusterMembership {
+public:
+    ClusterMembership(const std::string& self, uint64_t timeoutMs);
+
+    bool heartbeat(const std::string& id, uint64_t nowMs);
+    bool leave(const std::string& id, uint64_t nowMs);
+    bool expire(uint64_t nowMs);
+
+    std::vector<std::string> members() const;   // sorted
+    const std::string& self() const { return _self; }
+
+private:
+    std::string _self;
+    uint64_t _timeoutMs;
+    std::map<std::string, uint64_t> _lastSeen;   // other members
+    std::map<std::string, uint64_t> _left;       // id -> time it left
+};
+
+// A pair's state as handed from one processor to the next: its book, the
+// seeker bounds that classify its next ADDs, and the sequences of its output
+// streams so consumers see them continue across the handoff
+struct PairCheckpoint {
+    PAIR_ID pairId = 0;
+    ORDER_TIME time = 0;            // last applied snapshot
+    uint64_t tbtSequence = 0;
+    uint64_t filteredSequence = 0;
+    SeekerBounds bounds;
+    std::vector<bookElement> bids;
+    std::vector<bookElement> asks;
+};
+
+// Sequence a pair's output streams restart from when their new owner cannot
+// continue the previous owner's (no checkpoint, or a book known to be wrong):
+// the wall clock in milliseconds above the low RESTART_SEQUENCE_SHIFT bits,
+// or current if that is higher. It is above anything an earlier owner
+// published unless that owner averaged over 2^20 frames a millisecond since
+// its own restart or the clocks differ by more than that restart's age, so
+// consumers see a gap (FRAME_GAP) and resync instead of dropping the new
+// owner's frames as duplicates.
+constexpr unsigned RESTART_SEQUENCE_SHIFT = 20;
+uint64_t restartSequence(uint64_t current, uint64_t nowMs);
+
+// Copies the parser's state of a pair; the sequences are left to the caller
+void captureCheckpoint(const SeekerNetBoonSnapshotParserToTBT& parser, PAIR_ID pairId, PairCheckpoint& out);
+
+// Loads a checkpoint's book into the parser without emitting events
+// (SeekerNetBoonSnapshotParserToTBT::LoadBook)
+void restoreCheckpoint(SeekerNetBoonSnapshotParserToTBT& parser, PairCheckpoint& checkpoint);
+
+// Wire form: pairId(8) + time(8) + tbtSeq(8) + filteredSeq(8) + maxBidSeen(8) +
+// minAskSeen(8) + numBids(4) + numAsks(4), then price(8) + qty(4) + time(8) per level
+std::vector<char> serializeCheckpoint(const PairCheckpoint& checkpoint);
+bool deserializeCheckpoint(const char* data, size_t len, PairCheckpoint& out);
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
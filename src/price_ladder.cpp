@@ -0,0 +1,169 @@
+#include "price_ladder.h"
+#include <cmath>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+void PriceLadder::configure(double tickSize, bool isBuySide) {
+    _tickSize = tickSize;
+    _isBuySide = isBuySide;
+    _active = false;
+    _anchor = 0;
+    _count = 0;
+    _loWord = 0;
+    _hiWord = 0;
+    _bestSlot = -1;
+    size_t capacity = _qty.empty() ? DEFAULT_TICKS : _qty.size();
+    _qty.assign(capacity, 0);
+    _price.assign(capacity, 0.0);
+    _occupied.assign(capacity / 64, 0);
+    _incoming.assign(capacity / 64, 0);
+    _ticks.clear();
+}
+
+void PriceLadder::reset() {
+    _tickSize = 0;
+    _active = false;
+    _count = 0;
+    _bestSlot = -1;
+    std::vector<ORDER_QTY>().swap(_qty);
+    std::vector<ORDER_PRICE>().swap(_price);
+    std::vector<uint64_t>().swap(_occupied);
+    std::vector<uint64_t>().swap(_incoming);
+    std::vector<int64_t>().swap(_ticks);
+}
+
+bool PriceLadder::toTick(ORDER_PRICE price, int64_t& tick) const {
+    if (_tickSize <= 0) return false;
+    double ticks = std::round(price / _tickSize);
+    if (std::fabs(price - ticks * _tickSize) > DoubleComparisonEpsilon) return false;
+    tick = static_cast<int64_t>(ticks);
+    return true;
+}
+
+ORDER_QTY PriceLadder::qtyAt(int64_t tick) const {
+    if (!_fits(tick, tick)) return 0;
+    size_t slot = static_cast<size_t>(tick - _anchor);
+    return (_occupied[slot >> 6] & (1ULL << (slot & 63))) ? _qty[slot] : 0;
+}
+
+bool PriceLadder::set(ORDER_PRICE price, ORDER_QTY qty) {
+    if (qty <= 0) {
+        erase(price);
+        return true;
+    }
+    int64_t tick = 0;
+    if (!toTick(price, tick) || (!_fits(tick, tick) && !_reanchor(tick, tick))) {
+        _active = false;
+        return false;
+    }
+    size_t slot = static_cast<size_t>(tick - _anchor);
+    if (_occupied[slot >> 6] & (1ULL << (slot & 63))) {
+        _qty[slot] = qty;
+        _price[slot] = price;
+    } else {
+        _occupy(slot, price, qty);
+    }
+    return true;
+}
+
+void PriceLadder::erase(ORDER_PRICE price) {
+    int64_t tick = 0;
+    if (!toTick(price, tick) || !_fits(tick, tick)) return;
+    size_t slot = static_cast<size_t>(tick - _anchor);
+    if (_occupied[slot >> 6] & (1ULL << (slot & 63))) {
+        _vacate(slot);
+    }
+}
+
+void PriceLadder::_occupy(size_t slot, ORDER_PRICE price, ORDER_QTY qty) {
+    size_t word = slot >> 6;
+    _occupied[word] |= 1ULL << (slot & 63);
+    _qty[slot] = qty;
+    _price[slot] = price;
+    if (_count == 0) {
+        _loWord = word;
+        _hiWord = word;
+        _bestSlot = static_cast<int64_t>(slot);
+    } else {
+        if (word < _loWord) _loWord = word;
+        if (word > _hiWord) _hiWord = word;
+        int64_t s = static_cast<int64_t>(slot);
+        if (_isBuySide ? s > _bestSlot : s < _bestSlot) _bestSlot = s;
+    }
+    _count++;
+}
+
+void PriceLadder::_vacate(size_t slot) {
+    _occupied[slot >> 6] &= ~(1ULL << (slot & 63));
+    _qty[slot] = 0;
+    _count--;
+    if (static_cast<int64_t>(slot) == _bestSlot) {
+        _findBest();
+    }
+}
+
+void PriceLadder::_findBest() {
+    _bestSlot = -1;
+    if (_count == 0) return;
+    // Tighten the word bounds from the best end while looking
+    if (_isBuySide) {
+        while (_hiWord > _loWord && _occupied[_hiWord] == 0) _hiWord--;
+        _bestSlot = static_cast<int64_t>((_hiWord << 6) + static_cast<size_t>(_highestBit(_occupied[_hiWord])));
+    } else {
+        while (_loWord < _hiWord && _occupied[_loWord] == 0) _loWord++;
+        _bestSlot = static_cast<int64_t>((_loWord << 6) + static_cast<size_t>(_lowestBit(_occupied[_loWord])));
+    }
+}
+
+bool PriceLadder::_reanchor(int64_t lo, int64_t hi) {
+    if (_count > 0) {
+        int64_t occLo = _anchor + static_cast<int64_t>(_loWord << 6);
+        int64_t occHi = _anchor + static_cast<int64_t>((_hiWord << 6) + 63);
+        if (occLo < lo) lo = occLo;
+        if (occHi > hi) hi = occHi;
+    }
+    uint64_t span = static_cast<uint64_t>(hi - lo) + 1;
+    size_t capacity = _capacity() == 0 ? DEFAULT_TICKS : _capacity();
+    while (capacity < 2 * span && capacity < MAX_TICKS) capacity <<= 1;
+    if (span > capacity) return false;
+
+    // Re-insert the current levels around the new anchor, centred on the range
+    std::vector<ORDER_QTY> qty(capacity, 0);
+    std::vector<ORDER_PRICE> price(capacity, 0.0);
+    std::vector<uint64_t> occupied(capacity / 64, 0);
+    int64_t anchor = lo - static_cast<int64_t>((capacity - span) / 2);
+
+    size_t count = _count;
+    size_t loWord = capacity / 64, hiWord = 0;
+    for (size_t w = _loWord; count > 0 && w <= _hiWord; w++) {
+        uint64_t bits = _occupied[w];
+        while (bits) {
+            size_t oldSlot = (w << 6) + static_cast<size_t>(_lowestBit(bits));
+            size_t slot = static_cast<size_t>(_anchor + static_cast<int64_t>(oldSlot) - anchor);
+            qty[slot] = _qty[oldSlot];
+            price[slot] = _price[oldSlot];
+            occupied[slot >> 6] |= 1ULL << (slot & 63);
+            if ((slot >> 6) < loWord) loWord = slot >> 6;
+            if ((slot >> 6) > hiWord) hiWord = slot >> 6;
+            bits &= bits - 1;
+        }
+    }
+
+    _qty.swap(qty);
+    _price.swap(price);
+    _occupied.swap(occupied);
+    _incoming.assign(capacity / 64, 0);
+    _anchor = anchor;
+    if (_count > 0) {
+        _loWord = loWord;
+        _hiWord = hiWord;
+        _findBest();
+    }
+    return true;
+}
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+// One book side on a fixed tick grid: a sliding window of slots indexed by
+// tick - anchor, with a bitmap of occupied slots and the best slot cached.
+// Level reads and writes are O(1) and a snapshot diff is a bitmap XOR over
+// the occupied words instead of a merge of two sorted sequences. The window
+// re-anchors (growing if needed) when prices drift out of it.
+class PriceLadder {
+public:
+    static constexpr size_t DEFAULT_TICKS = 4096;
+    static constexpr size_t MAX_TICKS = 1 << 20;
+
+    // Empties the ladder and sets its grid; it becomes active once loaded
+    void configure(double tickSize, bool isBuySide);
+    // Empties the ladder and releases its memory
+    void reset();
+
+    // True while the ladder holds the same levels as its book side
+    bool active() const { return _active; }
+    void invalidate() { _active = false; }
+
+    // Loads a book side. Returns false (and stays inactive) if a level is off the grid.
+    template <typename Levels>
+    bool rebuild(const Levels& levels);
+
+    bool toTick(ORDER_PRICE price, int64_t& tick) const;
+    double tickSize() const { return _tickSize; }
+
+    size_t size() const { return _count; }
+    bool empty() const { return _count == 0; }
+    int64_t bestTick() const { return _anchor + _bestSlot; }   // requires !empty()
+    ORDER_QTY qtyAt(int64_t tick) const;                          // 0 if the level is empty
+
+    // Single level updates; qty <= 0 erases. set() invalidates the ladder and
+    // returns false for an off-grid price or a window that cannot grow.
+    bool set(ORDER_PRICE price, ORDER_QTY qty);
+    void erase(ORDER_PRICE price);
+
+    // Replaces the ladder contents with a full book side (levels with qty <= 0
+    // are ignored). onChange(price, oldQty, newQty) is called for every level
+    // that changed, 0 standing for "absent": new and modified levels first in
+    // input order, then removed levels. Returns false and leaves the ladder
+    // untouched if an incoming level is off the grid or the range is too wide.
+    template <typename Levels, typename OnChange>
+    bool applySnapshot(const Levels& levels, OnChange onChange);
+
+    // Appends the occupied levels, best first
+    template <typename Out>
+    void copyLevels(Out& out, ORDER_TIME time) const;
+
+private:
+    double _tickSize = 0;
+    bool _isBuySide = true;
+    bool _active = false;
+
+    int64_t _anchor = 0;           // tick of slot 0
+    size_t _count = 0;
+    size_t _loWord = 0;            // words that may hold occupied bits (valid when _count > 0)
+    size_t _hiWord = 0;
+    int64_t _bestSlot = -1;
+
+    std::vector<ORDER_QTY> _qty;
+    std::vector<ORDER_PRICE> _price;   // last price seen for the slot, kept bit-exact
+    std::vector<uint64_t> _occupied;
+    std::vector<uint64_t> _incoming;   // applySnapshot scratch, all zero between calls
+    std::vector<int64_t> _ticks;       // applySnapshot scratch
+
+    size_t _capacity() const { return _qty.size(); }
+    bool _fits(int64_t lo, int64_t hi) const {
+        return lo >= _anchor && hi < _anchor + static_cast<int64_t>(_capacity());
+    }
+    // Moves the window so it covers [lo, hi] and every occupied level
+    bool _reanchor(int64_t lo, int64_t hi);
+    void _occupy(size_t slot, ORDER_PRICE price, ORDER_QTY qty);
+    void _vacate(size_t slot);
+    void _findBest();
+
+    // Index of the lowest/highest set bit of a nonzero word
+    static int _lowestBit(uint64_t w) {
+#if defined(__GNUC__)
+        return __builtin_ctzll(w);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        unsigned long index;
+        _BitScanForward64(&index, w);
+        return static_cast<int>(index);
+#else
+        int bit = 0;
+        while (!(w & 1)) {
+            w >>= 1;
+            bit++;
+        }
+        return bit;
+#endif
+    }
+    static int _highestBit(uint64_t w) {
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(w);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        unsigned long index;
+        _BitScanReverse64(&index, w);
+        return static_cast<int>(index);
+#else
+        int bit = 63;
+        while (!(w >> bit)) bit--;
+        return bit;
+#endif
+    }
+};
+
+template <typename Levels>
+bool PriceLadder::rebuild(const Levels& levels) {
+    configure(_tickSize, _isBuySide);
+    for (const auto& level : levels) {
+        if (level.qty > 0 && !set(level.price, level.qty)) {
+            return false;
+        }
+    }
+    _active = _tickSize > 0;
+    return _active;
+}
+
+template <typename Levels, typename OnChange>
+bool PriceLadder::applySnapshot(const Levels& levels, OnChange onChange) {
+    _ticks.clear();
+    bool anyLevel = false;
+    int64_t lo = 0, hi = 0;
+    for (const auto& level : levels) {
+        int64_t tick = 0;
+        if (level.qty > 0) {
+            if (!toTick(level.price, tick)) return false;
+            if (!anyLevel || tick < lo) lo = tick;
+            if (!anyLevel || tick > hi) hi = tick;
+            anyLevel = true;
+        }
+        _ticks.push_back(tick);
+    }
+    if (anyLevel && !_fits(lo, hi) && !_reanchor(lo, hi)) {
+        return false;
+    }
+
+    // Pass 1: mark incoming levels, report new levels and qty changes
+    bool hadLevels = _count > 0;
+    size_t inLo = std::numeric_limits<size_t>::max();
+    size_t inHi = 0;
+    size_t i = 0;
+    for (const auto& level : levels) {
+        int64_t tick = _ticks[i++];
+        if (level.qty <= 0) continue;
+        size_t slot = static_cast<size_t>(tick - _anchor);
+        size_t word = slot >> 6;
+        uint64_t bit = 1ULL << (slot & 63);
+        if (_incoming[word] & bit) continue;   // duplicate price, first one wins
+        _incoming[word] |= bit;
+        if (word < inLo) inLo = word;
+        if (word > inHi) inHi = word;
+
+        if (_occupied[word] & bit) {
+            if (_qty[slot] != level.qty) {
+                onChange(level.price, _qty[slot], level.qty);
+                _qty[slot] = level.qty;
+            }
+        } else {
+            onChange(level.price, 0, level.qty);
+            _qty[slot] = level.qty;
+            _count++;
+        }
+        _price[slot] = level.price;
+    }
+
+    // Pass 2: occupied & ~incoming are the removed levels
+    size_t from = inLo;
+    size_t to = inHi;
+    if (hadLevels) {
+        if (_loWord < from) from = _loWord;
+        if (_hiWord > to) to = _hiWord;
+    }
+    for (size_t w = from; w <= to; w++) {
+        uint64_t removed = _occupied[w] & ~_incoming[w];
+        while (removed) {
+            size_t slot = (w << 6) + static_cast<size_t>(_lowestBit(removed));
+            onChange(_price[slot], _qty[slot], 0);
+            _qty[slot] = 0;
+            _count--;
+            removed &= removed - 1;
+        }
+        _occupied[w] = _incoming[w];
+        _incoming[w] = 0;
+    }
+
+    if (inLo <= inHi) {
+        _loWord = inLo;
+        _hiWord = inHi;
+    }
+    _findBest();
+    return true;
+}
+
+template <typename Out>
+void PriceLadder::copyLevels(Out& out, ORDER_TIME time) const {
+    if (_count == 0) return;
+    typename Out::value_type level;
+    level.time = time;
+    if (_isBuySide) {
+        for (size_t w = _hiWord + 1; w-- > _loWord;) {
+            uint64_t bits = _occupied[w];
+            while (bits) {
+                int b = _highestBit(bits);
+                size_t slot = (w << 6) + static_cast<size_t>(b);
+                level.price = _price[slot];
+                level.qty = _qty[slot];
+                out.push_back(level);
+                bits &= ~(1ULL << b);
+            }
+        }
+    } else {
+        for (size_t w = _loWord; w <= _hiWord; w++) {
+            uint64_t bits = _occupied[w];
+            while (bits) {
+                size_t slot = (w << 6) + static_cast<size_t>(_lowestBit(bits));
+                level.price = _price[slot];
+                level.qty = _qty[slot];
+                out.push_back(level);
+                bits &= bits - 1;
+            }
+        }
+    }
+}
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
@@ -0,0 +1,223 @@
+#include "shm_ring.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+using shm_detail::RingHeader;
+using shm_detail::SlotHeader;
+
+namespace {
+std::string shmPath(const std::string& name) {
+    return name.empty() || name[0] == '/' ? name : "/" + name;
+}
+
+uint32_t roundUpPow2(uint32_t v) {
+    uint32_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+// Flags the segment at path as retired for the readers still mapped to it,
+// then removes it
+void retireSegment(const std::string& path) {
+    int fd = shm_open(path.c_str(), O_RDWR, 0);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(RingHeader)) {
+            void* mem = mmap(nullptr, sizeof(RingHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (mem != MAP_FAILED) {
+                RingHeader* header = static_cast<RingHeader*>(mem);
+                if (header->magic == shm_detail::kMagic && header->version == shm_detail::kVersion) {
+                    header->retired.store(1, std::memory_order_release);
+                }
+                munmap(mem, sizeof(RingHeader));
+            }
+        }
+        ::close(fd);
+    }
+    shm_unlink(path.c_str());
+}
+
+inline const SlotHeader* slotAt(const char* slots, uint32_t stride, uint32_t mask, uint64_t seq) {
+    return reinterpret_cast<const SlotHeader*>(slots + static_cast<size_t>((seq - 1) & mask) * stride);
+}
+} // namespace
+
+constexpr uint32_t ShmRingWriter::DEFAULT_SLOTS;
+constexpr uint32_t ShmRingWriter::DEFAULT_SLOT_BYTES;
+
+ShmRingWriter::~ShmRingWriter() {
+    close();
+}
+
+bool ShmRingWriter::open(const std::string& name, uint32_t slotCount, uint32_t slotBytes) {
+    close();
+    if (slotCount == 0 || slotBytes == 0) return false;
+
+    slotCount = roundUpPow2(slotCount);
+    uint32_t stride = static_cast<uint32_t>((sizeof(SlotHeader) + slotBytes + 63) & ~size_t(63));
+    size_t bytes = sizeof(RingHeader) + static_cast<size_t>(slotCount) * stride;
+
+    std::string path = shmPath(name);
+    retireSegment(path);
+    int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) return false;
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        ::close(fd);
+        shm_unlink(path.c_str());
+        return false;
+    }
+    void* mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) {
+        shm_unlink(path.c_str());
+        return false;
+    }
+
+    // The segment is zero-filled: every slot tag is 0 (holds no frame)
+    _header = static_cast<RingHeader*>(mem);
+    _slots = static_cast<char*>(mem) + sizeof(RingHeader);
+    _mappedBytes = bytes;
+    _published = 0;
+    _header->version = shm_detail::kVersion;
+    _header->slotCount = slotCount;
+    _header->slotBytes = slotBytes;
+    _header->slotStride = stride;
+    _header->retired.store(0, std::memory_order_relaxed);
+    _header->published.store(0, std::memory_order_relaxed);
+    // Readers check the magic last
+    std::atomic_thread_fence(std::memory_order_release);
+    _header->magic = shm_detail::kMagic;
+    return true;
+}
+
+void ShmRingWriter::close() {
+    if (_header) {
+        munmap(_header, _mappedBytes);
+        _header = nullptr;
+        _slots = nullptr;
+        _mappedBytes = 0;
+    }
+}
+
+void ShmRingWriter::unlink(const std::string& name) {
+    retireSegment(shmPath(name));
+}
+
+bool ShmRingWriter::publish(const char* data, size_t length) {
+    if (!_header || length > _header->slotBytes) return false;
+
+    uint64_t seq = _published + 1;
+    SlotHeader* slot = const_cast<SlotHeader*>(
+        slotAt(_slots, _header->slotStride, _header->slotCount - 1, seq));
+    slot->tag.store((seq << 1) | 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->length = static_cast<uint32_t>(length);
+    std::memcpy(reinterpret_cast<char*>(slot + 1), data, length);
+
+    slot->tag.store(seq << 1, std::memory_order_release);
+    _header->published.store(seq, std::memory_order_release);
+    _published = seq;
+    return true;
+}
+
+ShmRingReader::~ShmRingReader() {
+    close();
+}
+
+bool ShmRingReader::open(const std::string& name, bool fromOldest) {
+    close();
+    int fd = shm_open(shmPath(name).c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(RingHeader)) {
+        ::close(fd);
+        return false;
+    }
+    size_t bytes = static_cast<size_t>(st.st_size);
+    void* mem = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) return false;
+
+    const RingHeader* header = static_cast<const RingHeader*>(mem);
+    bool valid = header->magic == shm_detail::kMagic && header->version == shm_detail::kVersion;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!valid || header->retired.load(std::memory_order_relaxed) != 0 || header->slotCount == 0 ||
+        sizeof(RingHeader) + static_cast<size_t>(header->slotCount) * header->slotStride > bytes) {
+        munmap(mem, bytes);
+        return false;
+    }
+
+    _header = header;
+    _slots = static_cast<const char*>(mem) + sizeof(RingHeader);
+    _mappedBytes = bytes;
+    _lost = 0;
+
+    uint64_t published = _header->published.load(std::memory_order_acquire);
+    if (!fromOldest) {
+        _next = published + 1;
+    } else {
+        // Keep one slot of margin: the writer may already be refilling the oldest
+        uint64_t span = _header->slotCount - 1;
+        _next = published > span ? published - span + 1 : 1;
+    }
+    return true;
+}
+
+void ShmRingReader::close() {
+    if (_header) {
+        munmap(const_cast<RingHeader*>(_header), _mappedBytes);
+        _header = nullptr;
+        _slots = nullptr;
+        _mappedBytes = 0;
+    }
+}
+
+bool ShmRingReader::poll(std::vector<char>& out) {
+    if (!_header) return false;
+
+    const SlotHeader* slot = slotAt(_slots, _header->slotStride, _header->slotCount - 1, _next);
+    uint64_t tag = slot->tag.load(std::memory_order_acquire);
+    if (tag != (_next << 1)) {
+        // Older frame (or empty): not written yet. Same frame, odd tag: being written.
+        if ((tag >> 1) <= _next) return false;
+        _skipAhead();
+        return false;
+    }
+
+    uint32_t length = slot->length;
+    if (length > _header->slotBytes) {
+        _skipAhead();   // torn read of the length, the slot is being reused
+        return false;
+    }
+    const char* data = reinterpret_cast<const char*>(slot + 1);
+    out.assign(data, data + length);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->tag.load(std::memory_order_relaxed) != tag) {
+        _skipAhead();
+        return false;
+    }
+    _next++;
+    return true;
+}
+
+void ShmRingReader::_skipAhead() {
+    uint64_t published = _header->published.load(std::memory_order_acquire);
+    if (published > _next) {
+        _lost += published - _next;
+        _next = published;
+    }
+}
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
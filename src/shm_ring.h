@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+// Broadcast ring of frames in a named POSIX shared memory segment
+// (/dev/shm/<name>), for consumers on the same host. One writer, any number
+// of readers; readers only load from the mapping, so polling costs no
+// syscalls. The writer never waits: a reader that falls a full ring behind
+// is lapped, notices it from the slot sequence numbers and skips ahead,
+// counting the frames it lost.
+//
+// Frames live in fixed-size slots. Frame n (numbered from 1) goes to slot
+// (n - 1) % slotCount, whose tag is 2n while it holds frame n and 2n + 1
+// while the writer is filling it.
+//
+// A writer that replaces a segment (or unlink()) first sets its retired
+// flag, so readers still mapped to the old segment learn that no more
+// frames will arrive there instead of polling it forever.
+namespace shm_detail {
+constexpr uint64_t kMagic = 0x314e4952494e5542ULL;   // "BUNIRIN1"
+constexpr uint32_t kVersion = 2;
+
+struct RingHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t slotCount;       // power of two
+    uint32_t slotBytes;       // max frame size
+    uint32_t slotStride;      // bytes between slot starts
+    std::atomic<uint32_t> retired;     // set once the segment is replaced or unlinked
+    char pad[36];
+    std::atomic<uint64_t> published;   // last complete frame
+};
+
+struct SlotHeader {
+    std::atomic<uint64_t> tag;
+    uint32_t length;
+    uint32_t pad;
+};
+} // namespace shm_detail
+
+class ShmRingWriter {
+public:
+    static constexpr uint32_t DEFAULT_SLOTS = 1024;
+    static constexpr uint32_t DEFAULT_SLOT_BYTES = 16 * 1024;
+
+    ShmRingWriter() = default;
+    ~ShmRingWriter();
+    ShmRingWriter(const ShmRingWriter&) = delete;
+    ShmRingWriter& operator=(const ShmRingWriter&) = delete;
+
+    // Creates /dev/shm/<name>, replacing any previous segment (readers still
+    // attached to that one see retired() and must reopen). slotCount is
+    // rounded up to a power of two. Returns false if the segment cannot be
+    // created or mapped.
+    bool open(const std::string& name, uint32_t slotCount = DEFAULT_SLOTS,
+              uint32_t slotBytes = DEFAULT_SLOT_BYTES);
+    // Unmaps the segment; it stays in /dev/shm until unlink()
+    void close();
+    // Retires and removes the segment
+    static void unlink(const std::string& name);
+
+    bool isOpen() const { return _header != nullptr; }
+
+    // Appends one frame. False if the ring is closed or the frame exceeds slotBytes.
+    bool publish(const char* data, size_t length);
+    uint64_t published() const { return _published; }
+
+private:
+    shm_detail::RingHeader* _header = nullptr;
+    char* _slots = nullptr;
+    size_t _mappedBytes = 0;
+    uint64_t _published = 0;
+};
+
+class ShmRingReader {
+public:
+    ShmRingReader() = default;
+    ~ShmRingReader();
+    ShmRingReader(const ShmRingReader&) = delete;
+    ShmRingReader& operator=(const ShmRingReader&) = delete;
+
+    // Attaches to an existing ring. A late reader starts at the next frame
+    // published, or with fromOldest at the oldest frame still in the ring.
+    bool open(const std::string& name, bool fromOldest = false);
+    void close();
+    bool isOpen() const { return _header != nullptr; }
+
+    // Copies the next frame into out. Returns false if no new frame is ready.
+    bool poll(std::vector<char>& out);
+    // The writer replaced or removed this ring: once poll() returns false no
+    // more frames will arrive, reopen to attach to the new one
+    bool retired() const {
+        return _header && _header->retired.load(std::memory_order_acquire) != 0;
+    }
+
+    uint64_t nextSequence() const { return _next; }
+    uint64_t lost() const { return _lost; }   // frames skipped after being lapped
+
+private:
+    const shm_detail::RingHeader* _header = nullptr;
+    const char* _slots = nullptr;
+    size_t _mappedBytes = 0;
+    uint64_t _next = 1;
+    uint64_t _lost = 0;
+
+    // Lapped: move to the newest complete frame
+    void _skipAhead();
+};
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
@@ -0,0 +1,156 @@
+#include "snapshot_conflator.h"
+#include <chrono>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+constexpr size_t SnapshotConflator::DEFAULT_MAX_QUEUED;
+
+SnapshotConflator::SnapshotConflator(std::vector<PAIR_ID> availablePairIds, size_t maxQueuedPerPair)
+    : _maxQueued(maxQueuedPerPair > 0 ? maxQueuedPerPair : 1) {
+    for (auto& pairId : availablePairIds) {
+        _slots.insert({pairId, PairSlot{}});
+    }
+}
+
+void SnapshotConflator::SetConflation(PAIR_ID pairId, bool enabled) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    PairSlot& slot = _slots.at(pairId);
+    if (slot.conflate == enabled) return;
+
+    if (enabled && !slot.queue.empty()) {
+        // Keep only the newest queued snapshot
+        slot.stats.conflated += slot.queue.size() - 1;
+        _pending -= slot.queue.size() - 1;
+        std::swap(slot.slot, slot.queue.back());
+        slot.slotFull = true;
+        while (!slot.queue.empty()) {
+            _spare.push_back(std::move(slot.queue.front()));
+            slot.queue.pop_front();
+        }
+    } else if (!enabled && slot.slotFull) {
+        slot.queue.push_back(PendingSnapshot{});
+        std::swap(slot.queue.back(), slot.slot);
+        slot.slotFull = false;
+    }
+    slot.conflate = enabled;
+}
+
+bool SnapshotConflator::isConflating(PAIR_ID pairId) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _slots.at(pairId).conflate;
+}
+
+void SnapshotConflator::_swapInto(PendingSnapshot& dst, PAIR_ID pairId, ORDER_TIME time,
+                                  std::vector<bookElement>& buyBook, std::vector<bookElement>& sellBook) {
+    dst.pairId = pairId;
+    dst.time = time;
+    dst.buyBook.swap(buyBook);
+    dst.sellBook.swap(sellBook);
+}
+
+bool SnapshotConflator::Offer(PAIR_ID pairId, ORDER_TIME time,
+                              std::vector<bookElement>& buyBook, std::vector<bookElement>& sellBook) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _slots.find(pairId);
+        if (it == _slots.end()) return false;
+        PairSlot& slot = it->second;
+        slot.stats.offered++;
+
+        if (slot.conflate) {
+            if (slot.slotFull) {
+                slot.stats.conflated++;
+            } else {
+                slot.slotFull = true;
+                _pending++;
+            }
+            _swapInto(slot.slot, pairId, time, buyBook, sellBook);
+        } else {
+            if (slot.queue.size() >= _maxQueued) {
+                _spare.push_back(std::move(slot.queue.front()));
+                slot.queue.pop_front();
+                slot.stats.dropped++;
+                _pending--;
+            }
+            if (_spare.empty()) {
+                slot.queue.push_back(PendingSnapshot{});
+            } else {
+                slot.queue.push_back(std::move(_spare.back()));
+                _spare.pop_back();
+            }
+            _swapInto(slot.queue.back(), pairId, time, buyBook, sellBook);
+            _pending++;
+        }
+
+        if (!slot.scheduled) {
+            slot.scheduled = true;
+            _readyPairs.push_back(pairId);
+        }
+    }
+    _pendingCv.notify_one();
+    return true;
+}
+
+bool SnapshotConflator::Poll(PendingSnapshot& out) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    while (!_readyPairs.empty()) {
+        PAIR_ID pairId = _readyPairs.front();
+        _readyPairs.pop_front();
+        PairSlot& slot = _slots.at(pairId);
+        slot.scheduled = false;
+
+        if (slot.slotFull) {
+            std::swap(out, slot.slot);
+            slot.slotFull = false;
+        } else if (!slot.queue.empty()) {
+            std::swap(out, slot.queue.front());
+            _spare.push_back(std::move(slot.queue.front()));
+            slot.queue.pop_front();
+            if (!slot.queue.empty()) {
+                slot.scheduled = true;
+                _readyPairs.push_back(pairId);
+            }
+        } else {
+            continue;
+        }
+
+        slot.stats.delivered++;
+        _pending--;
+        return true;
+    }
+    return false;
+}
+
+bool SnapshotConflator::WaitForPending(int timeoutMs) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _pendingCv.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+        [this] { return _pending > 0; });
+}
+
+ConflationStats SnapshotConflator::getStats(PAIR_ID pairId) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _slots.at(pairId).stats;
+}
+
+ConflationStats SnapshotConflator::getTotalStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    ConflationStats total;
+    for (const auto& entry : _slots) {
+        total.offered += entry.second.stats.offered;
+        total.conflated += entry.second.stats.conflated;
+        total.delivered += entry.second.stats.delivered;
+        total.dropped += entry.second.stats.dropped;
+    }
+    return total;
+}
+
+size_t SnapshotConflator::pendingCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _pending;
+}
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
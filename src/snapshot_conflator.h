@@ -0,0 +1,86 @@
+#pragma once
+
+#include "data_structures.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+struct PendingSnapshot {
+    PAIR_ID pairId = 0;
+    ORDER_TIME time = 0;
+    std::vector<bookElement> buyBook;
+    std::vector<bookElement> sellBook;
+};
+
+struct ConflationStats {
+    uint64_t offered = 0;     // snapshots handed to Offer()
+    uint64_t conflated = 0;   // pending snapshots replaced before the parser reached them
+    uint64_t delivered = 0;   // snapshots returned by Poll()
+    uint64_t dropped = 0;     // oldest queued snapshots dropped at the queue bound
+};
+
+// Hand-off stage between an ingest thread and the parser thread. Pairs with
+// conflation enabled keep a single slot holding only the newest pending
+// snapshot, so a burst costs one diff against the current book instead of one
+// per snapshot (coarser TBT granularity, bounded latency). Other pairs keep
+// every snapshot in arrival order, up to maxQueuedPerPair: past it the oldest
+// is dropped (the next diff still brings the book up to date) and counted.
+// Book vectors are swapped in and out rather than copied, so steady state
+// runs without allocations.
+class SnapshotConflator {
+public:
+    static constexpr size_t DEFAULT_MAX_QUEUED = 1024;
+
+    explicit SnapshotConflator(std::vector<PAIR_ID> availablePairIds,
+                               size_t maxQueuedPerPair = DEFAULT_MAX_QUEUED);
+
+    void SetConflation(PAIR_ID pairId, bool enabled);
+    bool isConflating(PAIR_ID pairId) const;
+
+    // Producer side. Takes the contents of buyBook/sellBook (the caller gets
+    // recycled buffers back). Returns false for unknown pairs.
+    bool Offer(PAIR_ID pairId, ORDER_TIME time,
+               std::vector<bookElement>& buyBook, std::vector<bookElement>& sellBook);
+
+    // Consumer side. Moves the next pending snapshot into out (round-robin
+    // across pairs) and returns false when nothing is pending.
+    bool Poll(PendingSnapshot& out);
+
+    // Waits up to timeoutMs for a pending snapshot
+    bool WaitForPending(int timeoutMs);
+
+    ConflationStats getStats(PAIR_ID pairId) const;
+    ConflationStats getTotalStats() const;
+    size_t pendingCount() const;
+
+private:
+    struct PairSlot {
+        bool conflate = false;
+        bool scheduled = false;       // pair id is in _readyPairs
+        bool slotFull = false;        // conflating mode: slot holds a snapshot
+        PendingSnapshot slot;
+        std::deque<PendingSnapshot> queue;
+        ConflationStats stats;
+    };
+
+    mutable std::mutex _mutex;
+    std::condition_variable _pendingCv;
+    std::unordered_map<PAIR_ID, PairSlot> _slots;
+    std::deque<PAIR_ID> _readyPairs;
+    std::vector<PendingSnapshot> _spare;
+    size_t _pending = 0;
+    size_t _maxQueued;
+
+    static void _swapInto(PendingSnapshot& dst, PAIR_ID pairId, ORDER_TIME time,
+                          std::vector<bookElement>& buyBook, std::vector<bookElement>& sellBook);
+};
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
@@ -1,24 +1,65 @@
 #include "snapshot_parser.h"
 #include "order_factory.h"
 #include "utils.h"
+#include "async_logger.h"
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 
 namespace cl {
 namespace data_feed {
 namespace data_feed_parser {
 
+namespace {
+LogMessageType kNoMatchingLiquidity(LOG_LEVEL::ERROR, 10,
+    "Market order for PAIRID=%lld has no matching liquidity on the %s book at price=%g");
+LogMessageType kIterationGuard(LOG_LEVEL::WARNING, 10,
+    "Seeker diff exceeded iteration guard for pairId=%lld (old=%llu, new=%llu)");
+LogMessageType kOffGridSnapshot(LOG_LEVEL::WARNING, 10,
+    "Snapshot for pairId=%lld is off the tick grid, diffing sorted levels");
+LogMessageType kStaleSnapshot(LOG_LEVEL::WARNING, 10,
+    "Dropped stale snapshot for pairId=%lld (time=%llu, last applied=%llu)");
+LogMessageType kCrossedSnapshot(LOG_LEVEL::WARNING, 10,
+    "Snapshot for pairId=%lld is %s (bid=%g, ask=%g), rebuilding book");
+LogMessageType kFingerprintCollision(LOG_LEVEL::WARNING, 10,
+    "Fingerprint collision on pairId=%lld %s side: book differed from snapshot");
+
+// Bucket key for epsilon-equal prices: two prices that SafeDoubleCompare
+// treats as equal land in the same or an adjacent bucket.
+inline double netBucketKey(double price) {
+    return std::floor(price / DoubleComparisonEpsilon) + 0.0;
+}
+
+inline size_t netBucketHash(double key) {
+    uint64_t bits;
+    std::memcpy(&bits, &key, sizeof(bits));
+    bits ^= bits >> 33;
+    bits *= 0xff51afd7ed558ccdULL;
+    bits ^= bits >> 33;
+    return static_cast<size_t>(bits);
+}
+} // namespace
+
 SeekerNetBoonSnapshotParserToTBT::SeekerNetBoonSnapshotParserToTBT(std::vector<PAIR_ID> availablePairIds) {
     _emittedOrders.reserve(256);
+    _bboUpdates.reserve(16);
+    _analytics.reserve(16);
+    _consolidatedOrders.reserve(256);
+    _nbboUpdates.reserve(16);
+    _netIndex.resize(512, NetSlot{0.0, 0, 0});
     for (auto& pairId : availablePairIds) {
-        _orderBooksCache.insert({pairId, PairOrderBookCache{}});
-        SeekerBounds bounds;
-        bounds.maxBidSeen = -MAX_DOUBLE;
-        bounds.minAskSeen = MAX_DOUBLE;
-        _seekerBoundCache.insert({pairId, bounds});
+        AddPair(pairId);
     }
 }
 
+bool SeekerNetBoonSnapshotParserToTBT::AddPair(PAIR_ID pairId) {
+    if (_orderBooksCache.count(pairId) || _groups.count(pairId)) return false;
+    PairOrderBookCache& cache = _orderBooksCache[pairId];
+    cache.sellState.isBuySide = false;
+    return true;
+}
+
 const BookSide& SeekerNetBoonSnapshotParserToTBT::getBuySide(PAIR_ID pairId) const {
     return _orderBooksCache.at(pairId).oldBuySide;
 }
@@ -28,7 +69,7 @@ const BookSide& SeekerNetBoonSnapshotParserToTBT::getSellSide(PAIR_ID pairId) co
 }
 
 const SeekerBounds& SeekerNetBoonSnapshotParserToTBT::getSeekerBounds(PAIR_ID pairId) const {
-    return _seekerBoundCache.at(pairId);
+    return _orderBooksCache.at(pairId).seekerBounds;
 }
 
 const std::vector<Order>& SeekerNetBoonSnapshotParserToTBT::getEmittedOrders() const {
@@ -37,75 +78,186 @@ const std::vector<Order>& SeekerNetBoonSnapshotParserToTBT::getEmittedOrders() c
 
 void SeekerNetBoonSnapshotParserToTBT::clearEmittedOrders() {
     _emittedOrders.clear();
+    _bboUpdates.clear();
+    _analytics.clear();
+    _consolidatedOrders.clear();
+    _consolidatedStamped = 0;
+    _nbboUpdates.clear();
+}
+
+const DiffStats& SeekerNetBoonSnapshotParserToTBT::getDiffStats(PAIR_ID pairId) const {
+#ifdef BUNI_DIFF_STATS
+    return _orderBooksCache.at(pairId).diffStats;
+#else
+    _orderBooksCache.at(pairId);
+    static const DiffStats disabled;
+    return disabled;
+#endif
+}
+
+void SeekerNetBoonSnapshotParserToTBT::resetDiffStats(PAIR_ID pairId) {
+#ifdef BUNI_DIFF_STATS
+    _orderBooksCache.at(pairId).diffStats = DiffStats{};
+#else
+    _orderBooksCache.at(pairId);
+#endif
+}
+
+void SeekerNetBoonSnapshotParserToTBT::_levelInserted(
+    const BookSide& book, BookSideState& state, size_t index, const bookElement& level
+) {
+    state.hash += bookLevelHash(level.price, level.qty);
+    if (state.ladder.active() && !_ladderUpdate) state.ladder.set(level.price, level.qty);
+    if (state.analytics.active()) state.analytics.inserted(book, index, level.price, level.qty);
+    if (state.group && !_tradeUpdate) _consolidatedLevelChanged(state, level.price, level.qty);
+    if (index == 0) state.depth.frontInserted(level.qty);
+    else state.depth.invalidateFrom(index);
+}
+
+void SeekerNetBoonSnapshotParserToTBT::_levelErased(
+    const BookSide& book, BookSideState& state, size_t index, const bookElement& level
+) {
+    state.hash -= bookLevelHash(level.price, level.qty);
+    if (state.ladder.active() && !_ladderUpdate) state.ladder.erase(level.price);
+    if (state.analytics.active()) state.analytics.erased(book, index, level.price, level.qty);
+    if (state.group && !_tradeUpdate) _consolidatedLevelChanged(state, level.price, -static_cast<int64_t>(level.qty));
+    if (index == 0) state.depth.frontErased(level.qty);
+    else state.depth.invalidateFrom(index);
+}
+
+void SeekerNetBoonSnapshotParserToTBT::_levelQtyChanged(
+    const BookSide&, BookSideState& state, size_t index, ORDER_PRICE price, ORDER_QTY oldQty, ORDER_QTY newQty
+) {
+    state.hash += bookLevelHash(price, newQty) - bookLevelHash(price, oldQty);
+    if (state.ladder.active() && !_ladderUpdate) state.ladder.set(price, newQty);
+    if (state.analytics.active()) state.analytics.qtyChanged(index, price, static_cast<int64_t>(newQty) - oldQty);
+    if (state.group && !_tradeUpdate) _consolidatedLevelChanged(state, price, static_cast<int64_t>(newQty) - oldQty);
+    if (index == 0) state.depth.frontQtyChanged(static_cast<int64_t>(newQty) - oldQty);
+    else state.depth.invalidateFrom(index);
 }
 
 void SeekerNetBoonSnapshotParserToTBT::_emitMarketOrderAndUpdateBook(
     PAIR_ID pairId, ORDER_QTY orderQty, ORDER_PRICE orderPrice, ORDER_TIME time,
-    BookSide& oldBook, ORDER_SIDE bookSide
+    BookSide& oldBook, BookSideState& state, ORDER_SIDE bookSide
 ) {
     ORDER_SIDE oppositeSide = (bookSide == ORDER_SIDE::BUY) ? ORDER_SIDE::SELL : ORDER_SIDE::BUY;
+    bool isBuySide = bookSide == ORDER_SIDE::BUY;
 
     if (oldBook.size() == 0) {
         _emittedOrders.push_back({pairId, orderPrice, time, orderQty, bookSide, ORDER_TYPE::ICEBERG, ORDER_ACTION::ADD});
         _emittedOrders.push_back({pairId, orderPrice, time, orderQty, oppositeSide, ORDER_TYPE::MARKET, ORDER_ACTION::ADD});
+        return;
     }
-    else if (SafeDoubleCompare(oldBook.begin()->price, orderPrice)) {
-        auto qtyDifference = oldBook.begin()->qty - orderQty;
-        if (qtyDifference > 0) {
-            oldBook.begin()->qty = qtyDifference;
-            oldBook.begin()->time = time;
-            _emittedOrders.push_back({pairId, orderPrice, time, orderQty, oppositeSide, ORDER_TYPE::MARKET, ORDER_ACTION::ADD});
-        }
-        else if (qtyDifference == 0) {
-            _emittedOrders.push_back({pairId, orderPrice, time, orderQty, oppositeSide, ORDER_TYPE::MARKET, ORDER_ACTION::ADD});
-            oldBook.erase(oldBook.begin());
-        }
-        else {
-            _emittedOrders.push_back({pairId, orderPrice, time, -qtyDifference, bookSide, ORDER_TYPE::ICEBERG, ORDER_ACTION::ADD});
-            _emittedOrders.push_back({pairId, orderPrice, time, orderQty, oppositeSide, ORDER_TYPE::MARKET, ORDER_ACTION::ADD});
-            oldBook.erase(oldBook.begin());
-        }
+
+    // The order price is the worst price the order traded at: it can sweep
+    // every level at or better than it
+    auto reachable = [&](const bookElement& level) {
+        return SafeDoubleCompare(level.price, orderPrice) ||
+               (isBuySide ? level.price > orderPrice : level.price < orderPrice);
+    };
+    size_t reachableLevels = static_cast<size_t>(
+        std::partition_point(oldBook.begin(), oldBook.end(), reachable) - oldBook.begin());
+    if (reachableLevels == 0) {
+        AsyncLogger::instance().log(kNoMatchingLiquidity, pairId, isBuySide ? "buy" : "sell", orderPrice);
+        return;
+    }
+
+    // Binary search on the running qty for the level that completes the order
+    size_t lastLevel = state.depth.levelsToFill(oldBook, orderQty);
+    size_t sweptLevels = lastLevel < reachableLevels ? lastLevel : reachableLevels;
+    ORDER_QTY remaining = static_cast<ORDER_QTY>(orderQty - state.depth.total(oldBook, sweptLevels));
+
+    // Levels consumed in full, except a last reachable level at the order
+    // price that hides more than it shows (handled below)
+    bool icebergAtLastLevel = lastLevel >= reachableLevels &&
+        SafeDoubleCompare(oldBook[reachableLevels - 1].price, orderPrice);
+    size_t fullFills = icebergAtLastLevel ? sweptLevels - 1 : sweptLevels;
+    for (size_t i = 0; i < fullFills; i++) {
+        const bookElement& level = oldBook.front();
+        ORDER_PRICE fillPrice = SafeDoubleCompare(level.price, orderPrice) ? orderPrice : level.price;
+        _emittedOrders.push_back({pairId, fillPrice, time, level.qty, oppositeSide, ORDER_TYPE::MARKET, ORDER_ACTION::ADD});
+        _levelErased(oldBook, state, 0, level);
+        oldBook.pop_front();
     }
-    else if (bookSide == ORDER_SIDE::BUY) {
-        std::cout << "Error on buyside book at PAIRID=" << pairId
-                  << " no matching liquidty at price=" << orderPrice << std::endl;
+
+    if (lastLevel < reachableLevels) {
+        // Visible liquidity completes the order at the current best level
+        bookElement& level = oldBook.front();
+        ORDER_PRICE fillPrice = SafeDoubleCompare(level.price, orderPrice) ? orderPrice : level.price;
+        ORDER_QTY left = level.qty - remaining;
+        if (left > 0) {
+            _levelQtyChanged(oldBook, state, 0, level.price, level.qty, left);
+            level.qty = left;
+            level.time = time;
+            _emittedOrders.push_back({pairId, fillPrice, time, remaining, oppositeSide, ORDER_TYPE::MARKET, ORDER_ACTION::ADD});
+        } else {
+            _emittedOrders.push_back({pairId, fillPrice, time, remaining, oppositeSide, ORDER_TYPE::MARKET, ORDER_ACTION::ADD});
+            _levelErased(oldBook, state, 0, level);
+            oldBook.pop_front();
+        }
+    } else if (icebergAtLastLevel) {
+        // More traded at the order price than was shown there
+        const bookElement& level = oldBook.front();
+        _emittedOrders.push_back({pairId, orderPrice, time, remaining, bookSide, ORDER_TYPE::ICEBERG, ORDER_ACTION::ADD});
+        _emittedOrders.push_back({pairId, orderPrice, time, level.qty + remaining, oppositeSide, ORDER_TYPE::MARKET, ORDER_ACTION::ADD});
+        _levelErased(oldBook, state, 0, level);
+        oldBook.pop_front();
+    } else {
+        // Traded at a price with no visible level: hidden liquidity there
+        _emittedOrders.push_back({pairId, orderPrice, time, remaining, bookSide, ORDER_TYPE::ICEBERG, ORDER_ACTION::ADD});
+        _emittedOrders.push_back({pairId, orderPrice, time, remaining, oppositeSide, ORDER_TYPE::MARKET, ORDER_ACTION::ADD});
     }
 }
 
 void SeekerNetBoonSnapshotParserToTBT::EmitMarketOrderAndUpdateBuyBook(
     PAIR_ID pairId, ORDER_QTY orderQty, ORDER_PRICE orderPrice, ORDER_TIME time
 ) {
+    PairOrderBookCache& cache = _orderBooksCache.at(pairId);
+    size_t begin = _emittedOrders.size();
+    _tradeUpdate = true;
     _emitMarketOrderAndUpdateBook(pairId, orderQty, orderPrice, time,
-        _orderBooksCache.at(pairId).oldBuySide, ORDER_SIDE::BUY);
+        cache.oldBuySide, cache.buyState, ORDER_SIDE::BUY);
+    _tradeUpdate = false;
+    if (cache.group) _forwardTrades(*cache.group, begin);
+    _bookUpdated(pairId, cache, time);
 }
 
 void SeekerNetBoonSnapshotParserToTBT::EmitMarketOrderAndUpdateSellBook(
     PAIR_ID pairId, ORDER_QTY orderQty, ORDER_PRICE orderPrice, ORDER_TIME time
 ) {
+    PairOrderBookCache& cache = _orderBooksCache.at(pairId);
+    size_t begin = _emittedOrders.size();
+    _tradeUpdate = true;
     _emitMarketOrderAndUpdateBook(pairId, orderQty, orderPrice, time,
-        _orderBooksCache.at(pairId).oldSellSide, ORDER_SIDE::SELL);
+        cache.oldSellSide, cache.sellState, ORDER_SIDE::SELL);
+    _tradeUpdate = false;
+    if (cache.group) _forwardTrades(*cache.group, begin);
+    _bookUpdated(pairId, cache, time);
+}
+
+ORDER_ACTION SeekerNetBoonSnapshotParserToTBT::_seekerAction(
+    PairOrderBookCache& cache, ORDER_PRICE price, bool isBuySide
+) {
+    SeekerBounds& bounds = cache.seekerBounds;
+    if (isBuySide ? price > bounds.maxBidSeen : price < bounds.minAskSeen) {
+        (isBuySide ? bounds.maxBidSeen : bounds.minAskSeen) = price;
+        BUNI_DIFF_STAT(cache.diffStats, seekerAdds);
+        return ORDER_ACTION::SEEKER_ADD;
+    }
+    return ORDER_ACTION::ADD;
 }
 
 void SeekerNetBoonSnapshotParserToTBT::_emitOrdersAndUpdateBook(
-    PAIR_ID pairId, BookSide& oldBook, std::vector<bookElement>& newBook,
+    PAIR_ID pairId, PairOrderBookCache& cache, BookSide& oldBook, BookSideState& state, std::vector<bookElement>& newBook,
     ORDER_TIME time, ORDER_SIDE side, bool isBuySide
 ) {
-    SeekerBounds& bounds = _seekerBoundCache.at(pairId);
+#ifdef BUNI_DIFF_STATS
+    DiffStats& stats = cache.diffStats;
+#endif
     double defaultPrice = isBuySide ? 0 : MAX_DOUBLE;
 
     auto checkAndUpdateSeeker = [&](double price) -> ORDER_ACTION {
-        if (isBuySide) {
-            if (price > bounds.maxBidSeen) {
-                bounds.maxBidSeen = price;
-                return ORDER_ACTION::SEEKER_ADD;
-            }
-        } else {
-            if (price < bounds.minAskSeen) {
-                bounds.minAskSeen = price;
-                return ORDER_ACTION::SEEKER_ADD;
-            }
-        }
-        return ORDER_ACTION::ADD;
+        return _seekerAction(cache, price, isBuySide);
     };
 
     auto priceIsBetter = [&](double a, double b) -> bool {
@@ -117,6 +269,8 @@ void SeekerNetBoonSnapshotParserToTBT::_emitOrdersAndUpdateBook(
         _emittedOrders.push_back({pid, price, time, qty, side, ORDER_TYPE::LIMIT, action});
     };
 
+    BUNI_DIFF_STAT(stats, sidesDiffed);
+
     if (newBook.size() == 0 && oldBook.size() == 0) {
         return;
     }
@@ -124,7 +278,9 @@ void SeekerNetBoonSnapshotParserToTBT::_emitOrdersAndUpdateBook(
         do {
             auto& back = *(oldBook.end() - 1);
             emitLimit(pairId, ORDER_ACTION::REMOVE, back.price, back.qty);
+            _levelErased(oldBook, state, oldBook.size() - 1, back);
             oldBook.pop_back();
+            BUNI_DIFF_STAT(stats, dequeErases);
         } while (oldBook.size() > 0);
     }
     else if (oldBook.size() == 0) {
@@ -133,6 +289,8 @@ void SeekerNetBoonSnapshotParserToTBT::_emitOrdersAndUpdateBook(
             tmp.price = iter->price;
             tmp.qty = iter->qty;
             oldBook.push_back(tmp);
+            _levelInserted(oldBook, state, oldBook.size() - 1, tmp);
+            BUNI_DIFF_STAT(stats, dequeInserts);
 
             ORDER_ACTION action = checkAndUpdateSeeker(iter->price);
             emitLimit(pairId, action, iter->price, iter->qty);
@@ -142,11 +300,18 @@ void SeekerNetBoonSnapshotParserToTBT::_emitOrdersAndUpdateBook(
         if (isBuySide && oldBook.size() > 0 && newBook.size() > 0 &&
             SafeDoubleCompare(oldBook[0].price, newBook[0].price)) {
             auto qtyDifference = newBook[0].qty - oldBook[0].qty;
+            if (qtyDifference != 0) {
+                BUNI_DIFF_STAT(stats, qtyChanges);
+            }
             if (qtyDifference > 0) {
+                _levelQtyChanged(oldBook, state, 0, oldBook[0].price,
+                    oldBook[0].qty, oldBook[0].qty + qtyDifference);
                 oldBook[0].qty += qtyDifference;
                 emitLimit(pairId, ORDER_ACTION::ADD, oldBook[0].price, qtyDifference);
             }
             else if (qtyDifference < 0) {
+                _levelQtyChanged(oldBook, state, 0, oldBook[0].price,
+                    oldBook[0].qty, oldBook[0].qty + qtyDifference);
                 oldBook[0].qty += qtyDifference;
                 emitLimit(pairId, ORDER_ACTION::REMOVE, oldBook[0].price, -qtyDifference);
             }
@@ -156,6 +321,10 @@ void SeekerNetBoonSnapshotParserToTBT::_emitOrdersAndUpdateBook(
                                  : static_cast<long>(std::max(newBook.size(), oldBook.size()));
 
         for (int i = 1; i < loopEnd; i++) {
+            BUNI_DIFF_STAT(stats, levelsVisited);
+#ifdef BUNI_DIFF_STATS
+            uint64_t levelIterations = 0;
+#endif
             double oldBookPriceLevel;
             double newBookPriceLevel;
             double nextOldBookPriceLevel;
@@ -163,9 +332,13 @@ void SeekerNetBoonSnapshotParserToTBT::_emitOrdersAndUpdateBook(
             long maxIterations = static_cast<long>(oldBook.size() + newBook.size()) * 4 + 16;
 
             do {
+                BUNI_DIFF_STAT(stats, loopIterations);
+#ifdef BUNI_DIFF_STATS
+                ++levelIterations;
+#endif
                 if (--maxIterations <= 0) {
-                    std::cerr << "Seeker diff exceeded iteration guard for pairId=" << pairId
-                              << " (old=" << oldBook.size() << ", new=" << newBook.size() << ")\n";
+                    BUNI_DIFF_STAT(stats, guardTrips);
+                    AsyncLogger::instance().log(kIterationGuard, pairId, oldBook.size(), newBook.size());
                     break;
                 }
                 if (oldBook.empty() || newBook.empty()) break;
@@ -184,7 +357,9 @@ void SeekerNetBoonSnapshotParserToTBT::_emitOrdersAndUpdateBook(
 
                 if (priceIsBetter(oldBookPriceLevel, newBookPriceLevel)) {
                     emitLimit(pairId, ORDER_ACTION::REMOVE, oldBook.front().price, oldBook.front().qty);
+                    _levelErased(oldBook, state, 0, oldBook.front());
                     oldBook.pop_front();
+                    BUNI_DIFF_STAT(stats, frontPops);
                     continue;
                 }
                 if (priceIsBetter(newBookPriceLevel, oldBookPriceLevel)) {
@@ -192,6 +367,8 @@ void SeekerNetBoonSnapshotParserToTBT::_emitOrdersAndUpdateBook(
                     tmp.price = newBookPriceLevel;
                     tmp.qty = newBook[i - 1].qty;
                     oldBook.insert(oldBook.begin() + (i - 1), tmp);
+                    _levelInserted(oldBook, state, i - 1, tmp);
+                    BUNI_DIFF_STAT(stats, dequeInserts);
                     emitLimit(pairId, ORDER_ACTION::ADD, oldBook[i - 1].price, oldBook[i - 1].qty);
                     continue;
                 }
@@ -199,11 +376,18 @@ void SeekerNetBoonSnapshotParserToTBT::_emitOrdersAndUpdateBook(
                 if (SafeDoubleCompare(oldBookPriceLevel, newBookPriceLevel)) {
                     if (newBook.size() - 1 >= i - 1 && oldBook.size() - 1 >= i - 1) {
                         auto qtyDifference = newBook[i - 1].qty - oldBook[i - 1].qty;
+                        if (qtyDifference != 0) {
+                            BUNI_DIFF_STAT(stats, qtyChanges);
+                        }
                         if (qtyDifference > 0) {
+                            _levelQtyChanged(oldBook, state, i - 1, oldBook[i - 1].price,
+                                oldBook[i - 1].qty, oldBook[i - 1].qty + qtyDifference);
                             oldBook[i - 1].qty += qtyDifference;
                             emitLimit(pairId, ORDER_ACTION::ADD, oldBook[i - 1].price, qtyDifference);
                         }
                         if (qtyDifference < 0) {
+                            _levelQtyChanged(oldBook, state, i - 1, oldBook[i - 1].price,
+                                oldBook[i - 1].qty, oldBook[i - 1].qty + qtyDifference);
                             oldBook[i - 1].qty += qtyDifference;
                             emitLimit(pairId, ORDER_ACTION::REMOVE, oldBook[i - 1].price, -qtyDifference);
                         }
@@ -211,7 +395,9 @@ void SeekerNetBoonSnapshotParserToTBT::_emitOrdersAndUpdateBook(
 
                     if (priceIsBetter(nextOldBookPriceLevel, nextNewBookPriceLevel)) {
                         emitLimit(pairId, ORDER_ACTION::REMOVE, oldBook[i].price, oldBook[i].qty);
+                        _levelErased(oldBook, state, i, oldBook[i]);
                         oldBook.erase(oldBook.begin() + (i));
+                        BUNI_DIFF_STAT(stats, dequeErases);
                     }
                     if (priceIsBetter(nextNewBookPriceLevel, nextOldBookPriceLevel)) {
                         ORDER_ACTION action = checkAndUpdateSeeker(nextNewBookPriceLevel);
@@ -219,6 +405,8 @@ void SeekerNetBoonSnapshotParserToTBT::_emitOrdersAndUpdateBook(
                         tmp.price = nextNewBookPriceLevel;
                         tmp.qty = newBook[i].qty;
                         oldBook.insert(oldBook.begin() + (i), tmp);
+                        _levelInserted(oldBook, state, i, tmp);
+                        BUNI_DIFF_STAT(stats, dequeInserts);
                         emitLimit(pairId, action, oldBook[i].price, oldBook[i].qty);
                     }
                 }
@@ -226,11 +414,18 @@ void SeekerNetBoonSnapshotParserToTBT::_emitOrdersAndUpdateBook(
                 if (SafeDoubleCompare(nextOldBookPriceLevel, nextNewBookPriceLevel)) {
                     if (newBook.size() - 1 >= i && oldBook.size() - 1 >= i) {
                         auto qtyDifference = newBook[i].qty - oldBook[i].qty;
+                        if (qtyDifference != 0) {
+                            BUNI_DIFF_STAT(stats, qtyChanges);
+                        }
                         if (qtyDifference > 0) {
+                            _levelQtyChanged(oldBook, state, i, oldBook[i].price,
+                                oldBook[i].qty, oldBook[i].qty + qtyDifference);
                             oldBook[i].qty += qtyDifference;
                             emitLimit(pairId, ORDER_ACTION::ADD, oldBook[i].price, qtyDifference);
                         }
                         if (qtyDifference < 0) {
+                            _levelQtyChanged(oldBook, state, i, oldBook[i].price,
+                                oldBook[i].qty, oldBook[i].qty + qtyDifference);
                             oldBook[i].qty += qtyDifference;
                             emitLimit(pairId, ORDER_ACTION::REMOVE, oldBook[i].price, -qtyDifference);
                         }
@@ -238,6 +433,7 @@ void SeekerNetBoonSnapshotParserToTBT::_emitOrdersAndUpdateBook(
                 }
             } while (!SafeDoubleCompare(oldBookPriceLevel, newBookPriceLevel) ||
                      !SafeDoubleCompare(nextOldBookPriceLevel, nextNewBookPriceLevel));
+            BUNI_DIFF_STAT_MAX(stats, maxIterationsPerLevel, levelIterations);
         }
     }
 }
@@ -245,13 +441,584 @@ void SeekerNetBoonSnapshotParserToTBT::_emitOrdersAndUpdateBook(
 void SeekerNetBoonSnapshotParserToTBT::EmitOrdersAndUpdateOldBuyBook(
     PAIR_ID pairId, std::vector<bookElement>& newBook, ORDER_TIME time
 ) {
-    _emitOrdersAndUpdateBook(pairId, _orderBooksCache.at(pairId).oldBuySide, newBook, time, ORDER_SIDE::BUY, true);
+    PairOrderBookCache& cache = _orderBooksCache.at(pairId);
+    _updateSide(pairId, cache, true, newBook, time, nullptr);
+    _bookUpdated(pairId, cache, time);
 }
 
 void SeekerNetBoonSnapshotParserToTBT::EmitOrdersAndUpdateOldSellBook(
     PAIR_ID pairId, std::vector<bookElement>& newBook, ORDER_TIME time
 ) {
-    _emitOrdersAndUpdateBook(pairId, _orderBooksCache.at(pairId).oldSellSide, newBook, time, ORDER_SIDE::SELL, false);
+    PairOrderBookCache& cache = _orderBooksCache.at(pairId);
+    _updateSide(pairId, cache, false, newBook, time, nullptr);
+    _bookUpdated(pairId, cache, time);
+}
+
+void SeekerNetBoonSnapshotParserToTBT::EmitOrdersAndUpdateOldBuyBook(
+    PAIR_ID pairId, std::vector<bookElement>& newBook, ORDER_TIME time, uint64_t newBookHash
+) {
+    PairOrderBookCache& cache = _orderBooksCache.at(pairId);
+    _updateSide(pairId, cache, true, newBook, time, &newBookHash);
+    _bookUpdated(pairId, cache, time);
+}
+
+void SeekerNetBoonSnapshotParserToTBT::EmitOrdersAndUpdateOldSellBook(
+    PAIR_ID pairId, std::vector<bookElement>& newBook, ORDER_TIME time, uint64_t newBookHash
+) {
+    PairOrderBookCache& cache = _orderBooksCache.at(pairId);
+    _updateSide(pairId, cache, false, newBook, time, &newBookHash);
+    _bookUpdated(pairId, cache, time);
+}
+
+void SeekerNetBoonSnapshotParserToTBT::_updateSide(
+    PAIR_ID pairId, PairOrderBookCache& cache, bool isBuySide,
+    std::vector<bookElement>& newBook, ORDER_TIME time, const uint64_t* newBookHash
+) {
+    BookSide& oldBook = isBuySide ? cache.oldBuySide : cache.oldSellSide;
+    BookSideState& state = isBuySide ? cache.buyState : cache.sellState;
+    const PairConfig& config = cache.config;
+
+    if (config.maxDepth > 0) {
+        size_t received = newBook.size();
+        _applyDepthLimit(config.maxDepth, oldBook, state, newBook, isBuySide);
+        if (newBook.size() != received) {
+            newBookHash = nullptr;   // the caller's hash covers the dropped levels
+        }
+    }
+
+    bool verifying = false;
+    if (config.skipUnchangedSides) {
+        uint64_t incoming = newBookHash ? *newBookHash : bookSideHash(newBook);
+        if (incoming == state.hash) {
+            FingerprintStats& fp = cache.fingerprint;
+            uint64_t matches = fp.sidesSkipped + fp.verifications + 1;
+            if (config.verifyEvery == 0 || matches % config.verifyEvery != 0) {
+                fp.sidesSkipped++;
+                return;
+            }
+            fp.verifications++;
+            verifying = true;
+        }
+    }
+
+    size_t begin = _emittedOrders.size();
+    if (config.layout != BOOK_LAYOUT::PRICE_LADDER ||
+        !_emitLadderDiffAndUpdateBook(pairId, cache, oldBook, state, newBook, time, isBuySide)) {
+        _emitOrdersAndUpdateBook(pairId, cache, oldBook, state, newBook, time,
+                                 isBuySide ? ORDER_SIDE::BUY : ORDER_SIDE::SELL, isBuySide);
+    }
+    if (verifying && _emittedOrders.size() != begin) {
+        cache.fingerprint.collisions++;
+        AsyncLogger::instance().log(kFingerprintCollision, pairId, isBuySide ? "buy" : "sell");
+    }
+    if (config.netEvents) {
+        _netEvents(begin, oldBook, isBuySide);
+    }
+}
+
+SNAPSHOT_RESULT SeekerNetBoonSnapshotParserToTBT::ApplySnapshot(
+    PAIR_ID pairId, std::vector<bookElement>& bids, std::vector<bookElement>& asks,
+    ORDER_TIME time, const BookHashes* hashes
+) {
+    PairOrderBookCache& cache = _orderBooksCache.at(pairId);
+
+    SnapshotStats& stats = cache.snapshotStats;
+    if (time < cache.lastSnapshotTime) {
+        stats.stale++;
+        AsyncLogger::instance().log(kStaleSnapshot, pairId, time, cache.lastSnapshotTime);
+        return SNAPSHOT_RESULT::DROPPED_STALE;
+    }
+    cache.lastSnapshotTime = time;
+
+    if (!bids.empty() && !asks.empty()) {
+        double bestBid = bids.front().price;
+        double bestAsk = asks.front().price;
+        bool locked = SafeDoubleCompare(bestBid, bestAsk);
+        if (locked || bestBid > bestAsk) {
+            if (locked) stats.locked++;
+            else stats.crossed++;
+            AsyncLogger::instance().log(kCrossedSnapshot, pairId, locked ? "locked" : "crossed", bestBid, bestAsk);
+            _rebuildSide(pairId, cache, true, bids, time);
+            _rebuildSide(pairId, cache, false, asks, time);
+            _bookUpdated(pairId, cache, time);
+            return locked ? SNAPSHOT_RESULT::REBUILT_LOCKED : SNAPSHOT_RESULT::REBUILT_CROSSED;
+        }
+    }
+
+    _updateSide(pairId, cache, true, bids, time, hashes ? &hashes->buy : nullptr);
+    _updateSide(pairId, cache, false, asks, time, hashes ? &hashes->sell : nullptr);
+    _bookUpdated(pairId, cache, time);
+    stats.applied++;
+    return SNAPSHOT_RESULT::APPLIED;
+}
+
+const SnapshotStats& SeekerNetBoonSnapshotParserToTBT::getSnapshotStats(PAIR_ID pairId) const {
+    return _orderBooksCache.at(pairId).snapshotStats;
+}
+
+ORDER_TIME SeekerNetBoonSnapshotParserToTBT::getLastSnapshotTime(PAIR_ID pairId) const {
+    return _orderBooksCache.at(pairId).lastSnapshotTime;
+}
+
+void SeekerNetBoonSnapshotParserToTBT::LoadBook(
+    PAIR_ID pairId, std::vector<bookElement>& bids, std::vector<bookElement>& asks,
+    ORDER_TIME time, const SeekerBounds& bounds
+) {
+    // A rebuild keeps hashes, ladders, analytics and consolidation current;
+    // its events are then discarded
+    PairOrderBookCache& cache = _orderBooksCache.at(pairId);
+    _rebuildSide(pairId, cache, true, bids, time);
+    _rebuildSide(pairId, cache, false, asks, time);
+    _bookUpdated(pairId, cache, time);
+    cache.seekerBounds = bounds;
+    cache.lastSnapshotTime = time;
+    clearEmittedOrders();
+}
+
+void SeekerNetBoonSnapshotParserToTBT::_rebuildSide(
+    PAIR_ID pairId, PairOrderBookCache& cache, bool isBuySide,
+    std::vector<bookElement>& newBook, ORDER_TIME time
+) {
+    BookSide& oldBook = isBuySide ? cache.oldBuySide : cache.oldSellSide;
+    BookSideState& state = isBuySide ? cache.buyState : cache.sellState;
+    ORDER_SIDE side = isBuySide ? ORDER_SIDE::BUY : ORDER_SIDE::SELL;
+    size_t begin = _emittedOrders.size();
+
+    if (cache.config.maxDepth > 0 && newBook.size() > cache.config.maxDepth) {
+        newBook.resize(cache.config.maxDepth);
+    }
+    for (const auto& level : oldBook) {
+        _emittedOrders.push_back({pairId, level.price, time, level.qty, side, ORDER_TYPE::LIMIT, ORDER_ACTION::REMOVE});
+        if (state.group) _consolidatedLevelChanged(state, level.price, -static_cast<int64_t>(level.qty));
+    }
+    oldBook.assign(newBook.begin(), newBook.end());
+    for (const auto& level : oldBook) {
+        ORDER_ACTION action = _seekerAction(cache, level.price, isBuySide);
+        _emittedOrders.push_back({pairId, level.price, time, level.qty, side, ORDER_TYPE::LIMIT, action});
+        if (state.group) _consolidatedLevelChanged(state, level.price, level.qty);
+    }
+
+    state.hash = bookSideHash(oldBook);
+    state.depth.clear();
+    if (state.analytics.active()) state.analytics.rebuild(oldBook);
+    if (cache.config.layout == BOOK_LAYOUT::PRICE_LADDER && cache.config.tickSize > 0) {
+        state.ladder.rebuild(oldBook);
+    }
+    if (cache.config.netEvents) {
+        _netEvents(begin, oldBook, isBuySide);
+    }
+}
+
+void SeekerNetBoonSnapshotParserToTBT::_publishView(PairOrderBookCache& cache, ORDER_TIME time) {
+    if (cache.config.publishLevels > 0) {
+        cache.view->publish(cache.oldBuySide, cache.oldSellSide, time);
+    }
+}
+
+void SeekerNetBoonSnapshotParserToTBT::_bookUpdated(PAIR_ID pairId, PairOrderBookCache& cache, ORDER_TIME time) {
+    _publishView(cache, time);
+    if (cache.config.analyticsLevels > 0) _emitAnalytics(pairId, cache, time);
+    if (cache.group) _updateConsolidation(cache, time);
+    if (!cache.config.trackBbo) return;
+
+    // Only the best levels can have changed the BBO; no pass over the book
+    const BookSide& bids = cache.oldBuySide;
+    const BookSide& asks = cache.oldSellSide;
+    ORDER_PRICE bidPrice = bids.empty() ? 0 : bids.front().price;
+    ORDER_QTY bidQty = bids.empty() ? 0 : bids.front().qty;
+    ORDER_PRICE askPrice = asks.empty() ? 0 : asks.front().price;
+    ORDER_QTY askQty = asks.empty() ? 0 : asks.front().qty;
+
+    Bbo& bbo = cache.bbo;
+    if (bbo.bidPrice == bidPrice && bbo.bidQty == bidQty &&
+        bbo.askPrice == askPrice && bbo.askQty == askQty) {
+        return;
+    }
+    bbo.pairId = pairId;
+    bbo.time = time;
+    bbo.bidPrice = bidPrice;
+    bbo.bidQty = bidQty;
+    bbo.askPrice = askPrice;
+    bbo.askQty = askQty;
+    _bboUpdates.push_back(bbo);
+}
+
+void SeekerNetBoonSnapshotParserToTBT::_emitAnalytics(PAIR_ID pairId, PairOrderBookCache& cache, ORDER_TIME time) {
+    const BookSide& bids = cache.oldBuySide;
+    const BookSide& asks = cache.oldSellSide;
+    double reference = analyticsReference(bids, asks);
+    cache.buyState.analytics.settle(bids, reference);
+    cache.sellState.analytics.settle(asks, reference);
+
+    BookAnalytics analytics;
+    analytics.pairId = pairId;
+    analytics.time = time;
+    fillBookAnalytics(bids, asks, cache.buyState.analytics, cache.sellState.analytics, analytics);
+    _analytics.push_back(analytics);
+}
+
+bool SeekerNetBoonSnapshotParserToTBT::SetConsolidationGroup(PAIR_ID groupId, const std::vector<PAIR_ID>& members) {
+    if (members.empty() || _orderBooksCache.count(groupId) || _groups.count(groupId)) return false;
+    for (size_t i = 0; i < members.size(); i++) {
+        auto it = _orderBooksCache.find(members[i]);
+        if (it == _orderBooksCache.end() || it->second.group) return false;
+        if (std::find(members.begin(), members.begin() + i, members[i]) != members.begin() + i) return false;
+    }
+
+    ConsolidationGroup& group = _groups[groupId];
+    group.groupId = groupId;
+    group.members = members;
+    group.bids.configure(members.size(), true);
+    group.asks.configure(members.size(), false);
+    group.nbbo.pairId = groupId;
+    for (size_t venue = 0; venue < members.size(); venue++) {
+        PairOrderBookCache& cache = _orderBooksCache.at(members[venue]);
+        cache.group = &group;
+        cache.venue = venue;
+        cache.buyState.group = &group;
+        cache.sellState.group = &group;
+        // Levels already resting are added to the consolidated stream
+        for (const auto& level : cache.oldBuySide) _consolidatedLevelChanged(cache.buyState, level.price, level.qty);
+        for (const auto& level : cache.oldSellSide) _consolidatedLevelChanged(cache.sellState, level.price, level.qty);
+        _updateConsolidation(cache, cache.lastSnapshotTime);
+    }
+    return true;
+}
+
+void SeekerNetBoonSnapshotParserToTBT::_consolidatedLevelChanged(
+    const BookSideState& state, ORDER_PRICE price, int64_t delta
+) {
+    if (delta == 0) return;
+    ORDER_SIDE side = state.isBuySide ? ORDER_SIDE::BUY : ORDER_SIDE::SELL;
+    ORDER_ACTION action = delta > 0 ? ORDER_ACTION::ADD : ORDER_ACTION::REMOVE;
+    _consolidatedOrders.push_back({state.group->groupId, price, 0,
+                                   static_cast<ORDER_QTY>(delta > 0 ? delta : -delta),
+                                   side, ORDER_TYPE::LIMIT, action});
+}
+
+void SeekerNetBoonSnapshotParserToTBT::_forwardTrades(const ConsolidationGroup& group, size_t begin) {
+    for (size_t i = begin; i < _emittedOrders.size(); i++) {
+        Order order = _emittedOrders[i];
+        order.pairId = group.groupId;
+        _consolidatedOrders.push_back(order);
+    }
+}
+
+void SeekerNetBoonSnapshotParserToTBT::_updateConsolidation(PairOrderBookCache& cache, ORDER_TIME time) {
+    for (size_t i = _consolidatedStamped; i < _consolidatedOrders.size(); i++) {
+        _consolidatedOrders[i].time = time;
+    }
+    _consolidatedStamped = _consolidatedOrders.size();
+
+    // Only this venue's best levels can have moved the NBBO
+    ConsolidationGroup& group = *cache.group;
+    const BookSide& bids = cache.oldBuySide;
+    const BookSide& asks = cache.oldSellSide;
+    group.bids.update(cache.venue, bids.empty() ? 0 : bids.front().price, bids.empty() ? 0 : bids.front().qty);
+    group.asks.update(cache.venue, asks.empty() ? 0 : asks.front().price, asks.empty() ? 0 : asks.front().qty);
+
+    const VenueTop& bestBid = group.bids.best();
+    const VenueTop& bestAsk = group.asks.best();
+    Bbo& nbbo = group.nbbo;
+    if (nbbo.bidPrice == bestBid.price && nbbo.bidQty == bestBid.qty &&
+        nbbo.askPrice == bestAsk.price && nbbo.askQty == bestAsk.qty) {
+        return;
+    }
+    nbbo.time = time;
+    nbbo.bidPrice = bestBid.price;
+    nbbo.bidQty = static_cast<ORDER_QTY>(bestBid.qty);
+    nbbo.askPrice = bestAsk.price;
+    nbbo.askQty = static_cast<ORDER_QTY>(bestAsk.qty);
+    _nbboUpdates.push_back(nbbo);
+}
+
+const std::vector<Order>& SeekerNetBoonSnapshotParserToTBT::getConsolidatedOrders() const {
+    return _consolidatedOrders;
+}
+
+const std::vector<Bbo>& SeekerNetBoonSnapshotParserToTBT::getNbboUpdates() const {
+    return _nbboUpdates;
+}
+
+const Bbo& SeekerNetBoonSnapshotParserToTBT::getNbbo(PAIR_ID groupId) const {
+    return _groups.at(groupId).nbbo;
+}
+
+void SeekerNetBoonSnapshotParserToTBT::getConsolidatedBook(
+    PAIR_ID groupId, ORDER_SIDE side, size_t maxLevels, std::vector<bookElement>& out
+) const {
+    const ConsolidationGroup& group = _groups.at(groupId);
+    std::vector<const BookSide*> venues;
+    venues.reserve(group.members.size());
+    for (PAIR_ID member : group.members) {
+        const PairOrderBookCache& cache = _orderBooksCache.at(member);
+        venues.push_back(side == ORDER_SIDE::BUY ? &cache.oldBuySide : &cache.oldSellSide);
+    }
+    mergeVenueBooks(venues, side == ORDER_SIDE::BUY, maxLevels, out);
+}
+
+const std::vector<BookAnalytics>& SeekerNetBoonSnapshotParserToTBT::getAnalytics() const {
+    return _analytics;
+}
+
+const std::vector<Bbo>& SeekerNetBoonSnapshotParserToTBT::getBboUpdates() const {
+    return _bboUpdates;
+}
+
+const Bbo& SeekerNetBoonSnapshotParserToTBT::getBbo(PAIR_ID pairId) const {
+    return _orderBooksCache.at(pairId).bbo;
+}
+
+const PublishedBookView* SeekerNetBoonSnapshotParserToTBT::getBookView(PAIR_ID pairId) const {
+    return _orderBooksCache.at(pairId).view.get();
+}
+
+uint64_t SeekerNetBoonSnapshotParserToTBT::getBookHash(PAIR_ID pairId, ORDER_SIDE side) const {
+    const PairOrderBookCache& cache = _orderBooksCache.at(pairId);
+    return side == ORDER_SIDE::BUY ? cache.buyState.hash : cache.sellState.hash;
+}
+
+const FingerprintStats& SeekerNetBoonSnapshotParserToTBT::getFingerprintStats(PAIR_ID pairId) const {
+    return _orderBooksCache.at(pairId).fingerprint;
+}
+
+int64_t SeekerNetBoonSnapshotParserToTBT::getCumulativeDepth(PAIR_ID pairId, ORDER_SIDE side, size_t levels) {
+    PairOrderBookCache& cache = _orderBooksCache.at(pairId);
+    if (side == ORDER_SIDE::BUY) {
+        return cache.buyState.depth.total(cache.oldBuySide, levels);
+    }
+    return cache.sellState.depth.total(cache.oldSellSide, levels);
+}
+
+void SeekerNetBoonSnapshotParserToTBT::SetPairConfig(PAIR_ID pairId, const PairConfig& config) {
+    PairOrderBookCache& cache = _orderBooksCache.at(pairId);
+    bool useLadder = config.layout == BOOK_LAYOUT::PRICE_LADDER && config.tickSize > 0;
+    if (!useLadder) {
+        cache.buyState.ladder.reset();
+        cache.sellState.ladder.reset();
+    } else if (!cache.buyState.ladder.active() || !cache.sellState.ladder.active() ||
+               cache.buyState.ladder.tickSize() != config.tickSize) {
+        // Load from the current book; an off-grid book is retried on the next snapshot
+        cache.buyState.ladder.configure(config.tickSize, true);
+        cache.sellState.ladder.configure(config.tickSize, false);
+        cache.buyState.ladder.rebuild(cache.oldBuySide);
+        cache.sellState.ladder.rebuild(cache.oldSellSide);
+    }
+    if (config.analyticsLevels != cache.config.analyticsLevels ||
+        config.analyticsBandBps != cache.config.analyticsBandBps) {
+        cache.buyState.analytics.configure(config.analyticsLevels, config.analyticsBandBps, true);
+        cache.sellState.analytics.configure(config.analyticsLevels, config.analyticsBandBps, false);
+        cache.buyState.analytics.rebuild(cache.oldBuySide);
+        cache.sellState.analytics.rebuild(cache.oldSellSide);
+    }
+    cache.config = config;
+
+    if (config.publishLevels > 0) {
+        if (!cache.view) cache.view.reset(new PublishedBookView());
+        cache.view->setDepth(config.publishLevels);
+        _publishView(cache, cache.lastSnapshotTime);
+    }
+}
+
+const PriceLadder& SeekerNetBoonSnapshotParserToTBT::getLadder(PAIR_ID pairId, ORDER_SIDE side) const {
+    const PairOrderBookCache& cache = _orderBooksCache.at(pairId);
+    return side == ORDER_SIDE::BUY ? cache.buyState.ladder : cache.sellState.ladder;
+}
+
+bool SeekerNetBoonSnapshotParserToTBT::_emitLadderDiffAndUpdateBook(
+    PAIR_ID pairId, PairOrderBookCache& cache, BookSide& oldBook, BookSideState& state, std::vector<bookElement>& newBook,
+    ORDER_TIME time, bool isBuySide
+) {
+    PriceLadder& ladder = state.ladder;
+#ifdef BUNI_DIFF_STATS
+    DiffStats& stats = cache.diffStats;
+#endif
+    ORDER_SIDE side = isBuySide ? ORDER_SIDE::BUY : ORDER_SIDE::SELL;
+
+    if (!ladder.active()) {
+        // Re-enter the ladder once a snapshot is back on the grid. Off-grid
+        // levels left in the book cannot be in the ladder, so they are removed.
+        int64_t tick = 0;
+        for (const auto& level : newBook) {
+            if (level.qty > 0 && !ladder.toTick(level.price, tick)) return false;
+        }
+        std::vector<bookElement> onGrid;
+        for (const auto& level : oldBook) {
+            if (ladder.toTick(level.price, tick)) onGrid.push_back(level);
+        }
+        if (!ladder.rebuild(onGrid)) return false;
+        for (size_t i = oldBook.size(); i-- > 0;) {
+            if (ladder.toTick(oldBook[i].price, tick)) continue;
+            _emittedOrders.push_back({pairId, oldBook[i].price, time, oldBook[i].qty, side,
+                                      ORDER_TYPE::LIMIT, ORDER_ACTION::REMOVE});
+            _levelErased(oldBook, state, i, oldBook[i]);
+            oldBook.erase(oldBook.begin() + i);
+            BUNI_DIFF_STAT(stats, dequeErases);
+        }
+    }
+
+    // Each changed tick is applied to the sorted side through the level
+    // hooks, so the fingerprint, depth and analytics stay O(changes)
+    auto better = [isBuySide](const bookElement& level, double price) {
+        return !SafeDoubleCompare(level.price, price) &&
+               (isBuySide ? level.price > price : level.price < price);
+    };
+    _ladderUpdate = true;
+    bool applied = ladder.applySnapshot(newBook, [&](ORDER_PRICE price, ORDER_QTY oldQty, ORDER_QTY newQty) {
+        ORDER_ACTION action = ORDER_ACTION::ADD;
+        ORDER_QTY qty = newQty - oldQty;
+        if (oldQty == 0) {
+            action = _seekerAction(cache, price, isBuySide);
+        } else if (qty < 0) {
+            action = ORDER_ACTION::REMOVE;
+            qty = -qty;
+        }
+        _emittedOrders.push_back({pairId, price, time, qty, side, ORDER_TYPE::LIMIT, action});
+
+        size_t index = static_cast<size_t>(
+            std::lower_bound(oldBook.begin(), oldBook.end(), price, better) - oldBook.begin());
+        if (oldQty == 0) {
+            bookElement level;
+            level.price = price;
+            level.qty = newQty;
+            level.time = time;
+            oldBook.insert(oldBook.begin() + index, level);
+            _levelInserted(oldBook, state, index, level);
+            BUNI_DIFF_STAT(stats, dequeInserts);
+        } else if (newQty == 0) {
+            _levelErased(oldBook, state, index, oldBook[index]);
+            oldBook.erase(oldBook.begin() + index);
+            BUNI_DIFF_STAT(stats, dequeErases);
+        } else {
+            BUNI_DIFF_STAT(stats, qtyChanges);
+            _levelQtyChanged(oldBook, state, index, price, oldQty, newQty);
+            oldBook[index].qty = newQty;
+        }
+    });
+    _ladderUpdate = false;
+    if (!applied) {
+        ladder.invalidate();
+        AsyncLogger::instance().log(kOffGridSnapshot, pairId);
+        return false;
+    }
+    BUNI_DIFF_STAT(stats, sidesDiffed);
+    return true;
+}
+
+const PairConfig& SeekerNetBoonSnapshotParserToTBT::getPairConfig(PAIR_ID pairId) const {
+    return _orderBooksCache.at(pairId).config;
+}
+
+void SeekerNetBoonSnapshotParserToTBT::_applyDepthLimit(
+    size_t maxDepth, BookSide& oldBook, BookSideState& state,
+    std::vector<bookElement>& newBook, bool isBuySide
+) {
+    if (newBook.size() > maxDepth) {
+        newBook.resize(maxDepth);
+    }
+
+    // A full view hides everything below its last level, so old levels past
+    // that price were pushed out of view rather than cancelled
+    if (newBook.size() == maxDepth) {
+        double lastVisible = newBook.back().price;
+        while (!oldBook.empty() && !SafeDoubleCompare(oldBook.back().price, lastVisible) &&
+               (isBuySide ? oldBook.back().price < lastVisible : oldBook.back().price > lastVisible)) {
+            _levelErased(oldBook, state, oldBook.size() - 1, oldBook.back());
+            oldBook.pop_back();
+        }
+    }
+    while (oldBook.size() > maxDepth) {
+        _levelErased(oldBook, state, oldBook.size() - 1, oldBook.back());
+        oldBook.pop_back();
+    }
+}
+
+void SeekerNetBoonSnapshotParserToTBT::_netEvents(size_t begin, const BookSide& book, bool isBuySide) {
+    size_t end = _emittedOrders.size();
+    size_t count = end - begin;
+    if (count == 0) return;
+
+    if (_netIndex.size() < count * 2) {
+        size_t size = _netIndex.size();
+        while (size < count * 2) size <<= 1;
+        _netIndex.assign(size, NetSlot{0.0, 0, 0});
+        _netGeneration = 0;
+    }
+    if (++_netGeneration == 0) {
+        std::fill(_netIndex.begin(), _netIndex.end(), NetSlot{0.0, 0, 0});
+        _netGeneration = 1;
+    }
+    const size_t mask = _netIndex.size() - 1;
+
+    // Pass 1: fold events into the first event seen at each price. qty holds
+    // the signed net change, action records whether any SEEKER_ADD was folded.
+    size_t write = begin;
+    for (size_t read = begin; read < end; read++) {
+        const Order& event = _emittedOrders[read];
+        ORDER_QTY delta = (event.action == ORDER_ACTION::REMOVE) ? -event.qty : event.qty;
+        bool seeker = (event.action == ORDER_ACTION::SEEKER_ADD);
+        double key = netBucketKey(event.price);
+
+        size_t found = end;
+        for (int offset = -1; offset <= 1 && found == end; offset++) {
+            double probeKey = key + offset;
+            for (size_t h = netBucketHash(probeKey) & mask;
+                 _netIndex[h].generation == _netGeneration; h = (h + 1) & mask) {
+                const NetSlot& slot = _netIndex[h];
+                if (slot.key == probeKey &&
+                    SafeDoubleCompare(_emittedOrders[slot.index].price, event.price)) {
+                    found = slot.index;
+                    break;
+                }
+            }
+        }
+
+        if (found != end) {
+            _emittedOrders[found].qty += delta;
+            if (seeker) _emittedOrders[found].action = ORDER_ACTION::SEEKER_ADD;
+            continue;
+        }
+
+        Order folded = event;
+        folded.qty = delta;
+        folded.action = seeker ? ORDER_ACTION::SEEKER_ADD : ORDER_ACTION::ADD;
+        _emittedOrders[write] = folded;
+
+        size_t h = netBucketHash(key) & mask;
+        while (_netIndex[h].generation == _netGeneration) h = (h + 1) & mask;
+        _netIndex[h] = NetSlot{key, _netGeneration, static_cast<uint32_t>(write)};
+        write++;
+    }
+
+    // Pass 2: turn net changes into final events using the updated book
+    auto worseThan = [isBuySide](const bookElement& level, double price) {
+        return !SafeDoubleCompare(level.price, price) &&
+               (isBuySide ? level.price > price : level.price < price);
+    };
+
+    size_t out = begin;
+    for (size_t i = begin; i < write; i++) {
+        Order event = _emittedOrders[i];
+        ORDER_QTY net = event.qty;
+        if (net == 0) continue;
+
+        auto level = std::lower_bound(book.begin(), book.end(), event.price, worseThan);
+        bool exists = level != book.end() && SafeDoubleCompare(level->price, event.price);
+
+        if (!exists) {
+            if (net > 0) continue;
+            event.action = ORDER_ACTION::REMOVE;
+            event.qty = -net;
+        } else if (level->qty == net) {
+            event.qty = level->qty;
+            if (event.action != ORDER_ACTION::SEEKER_ADD) event.action = ORDER_ACTION::ADD;
+        } else {
+            event.action = ORDER_ACTION::MODIFY;
+            event.qty = level->qty;
+        }
+        _emittedOrders[out++] = event;
+    }
+    _emittedOrders.resize(out);
 }
 
 void SeekerNetBoonSnapshotParserToTBT::PrintFullBook(PAIR_ID pairId) {
@@ -279,11 +1046,11 @@ void SeekerNetBoonSnapshotParserToTBT::_printSellBook(PAIR_ID pairId) {
 }
 
 void SeekerNetBoonSnapshotParserToTBT::_setMinAskSeen(PAIR_ID pairId, double newValue) {
-    _seekerBoundCache.at(pairId).minAskSeen = newValue;
+    _orderBooksCache.at(pairId).seekerBounds.minAskSeen = newValue;
 }
 
 void SeekerNetBoonSnapshotParserToTBT::_setMaxBidSeen(PAIR_ID pairId, double newValue) {
-    _seekerBoundCache.at(pairId).maxBidSeen = newValue;
+    _orderBooksCache.at(pairId).seekerBounds.maxBidSeen = newValue;
 }
 
 void SeekerNetBoonSnapshotParserToTBT::_emitOrder(PAIR_ID pairId, const Order& order) {
@@ -1,6 +1,10 @@
 #pragma once
 
+#include "book_hash.h"
+#include "consolidated_book.h"
 #include "data_structures.h"
+#include "diff_stats.h"
+#include <cstddef>
 #include <unordered_map>
 #include <vector>
 
@@ -12,14 +16,80 @@ class SeekerNetBoonSnapshotParserToTBT {
 public:
     explicit SeekerNetBoonSnapshotParserToTBT(std::vector<PAIR_ID> availablePairIds);
 
-    // Market order updates
+    // Market order updates. orderPrice is the worst traded price: every level
+    // at or better than it can be swept; qty beyond what was shown there is
+    // reported as ICEBERG liquidity at orderPrice.
     void EmitMarketOrderAndUpdateBuyBook(PAIR_ID pairId, ORDER_QTY orderQty, ORDER_PRICE orderPrice, ORDER_TIME time);
     void EmitMarketOrderAndUpdateSellBook(PAIR_ID pairId, ORDER_QTY orderQty, ORDER_PRICE orderPrice, ORDER_TIME time);
 
-    // Limit order updates
+    // Limit order updates. With PairConfig::maxDepth set, newBook is truncated in place.
     void EmitOrdersAndUpdateOldBuyBook(PAIR_ID pairId, std::vector<bookElement>& newBook, ORDER_TIME time);
     void EmitOrdersAndUpdateOldSellBook(PAIR_ID pairId, std::vector<bookElement>& newBook, ORDER_TIME time);
 
+    // Same, with the incoming side's bookSideHash() already computed (e.g. by
+    // deserializeSnapshot) for PairConfig::skipUnchangedSides
+    void EmitOrdersAndUpdateOldBuyBook(PAIR_ID pairId, std::vector<bookElement>& newBook, ORDER_TIME time,
+                                       uint64_t newBookHash);
+    void EmitOrdersAndUpdateOldSellBook(PAIR_ID pairId, std::vector<bookElement>& newBook, ORDER_TIME time,
+                                        uint64_t newBookHash);
+
+    // Both sides of one snapshot in a single call. Snapshots older than the
+    // last one applied are dropped; crossed or locked books replace the
+    // current book wholesale (REMOVE all, then ADD all with SEEKER_ADD for
+    // prices past the seeker bounds) instead of being diffed.
+    SNAPSHOT_RESULT ApplySnapshot(PAIR_ID pairId, std::vector<bookElement>& bids, std::vector<bookElement>& asks,
+                                  ORDER_TIME time, const BookHashes* hashes = nullptr);
+    const SnapshotStats& getSnapshotStats(PAIR_ID pairId) const;
+    ORDER_TIME getLastSnapshotTime(PAIR_ID pairId) const;
+
+    // Replaces a pair's book as of time without emitting anything, e.g. with
+    // a book handed over by another processor (src/pair_partition.h). Clears
+    // all outputs like clearEmittedOrders(), so call it between snapshots.
+    void LoadBook(PAIR_ID pairId, std::vector<bookElement>& bids, std::vector<bookElement>& asks,
+                  ORDER_TIME time, const SeekerBounds& bounds);
+
+    // Registers a pair after construction; false if it already exists
+    bool AddPair(PAIR_ID pairId);
+
+    // Per-pair options
+    void SetPairConfig(PAIR_ID pairId, const PairConfig& config);
+    const PairConfig& getPairConfig(PAIR_ID pairId) const;
+    const PriceLadder& getLadder(PAIR_ID pairId, ORDER_SIDE side) const;
+
+    // BBO changes since the last clearEmittedOrders() (PairConfig::trackBbo),
+    // one entry per update that moved a best price or qty
+    const std::vector<Bbo>& getBboUpdates() const;
+    const Bbo& getBbo(PAIR_ID pairId) const;
+
+    // Book metrics since the last clearEmittedOrders() (PairConfig::analyticsLevels),
+    // one entry per update, maintained from the level changes rather than the full book
+    const std::vector<BookAnalytics>& getAnalytics() const;
+
+    // Consolidation group: the pairs in members quote one instrument on
+    // different venues. Their level changes are re-emitted under groupId in
+    // getConsolidatedOrders() (ADD/REMOVE per changed price, trades forwarded
+    // as they are) and NBBO changes are recorded in getNbboUpdates(). False if
+    // groupId is a pair or an existing group, or a member is unknown or
+    // already grouped.
+    bool SetConsolidationGroup(PAIR_ID groupId, const std::vector<PAIR_ID>& members);
+    const std::vector<Order>& getConsolidatedOrders() const;
+    const std::vector<Bbo>& getNbboUpdates() const;
+    const Bbo& getNbbo(PAIR_ID groupId) const;
+    // Best maxLevels consolidated levels of a side (0 = all), merged from the member books
+    void getConsolidatedBook(PAIR_ID groupId, ORDER_SIDE side, size_t maxLevels,
+                             std::vector<bookElement>& out) const;
+
+    // Top of book published for other threads (PairConfig::publishLevels), or
+    // null if never enabled. The pointer stays valid for the parser's lifetime.
+    const PublishedBookView* getBookView(PAIR_ID pairId) const;
+
+    // Book fingerprints, maintained incrementally
+    uint64_t getBookHash(PAIR_ID pairId, ORDER_SIDE side) const;
+    const FingerprintStats& getFingerprintStats(PAIR_ID pairId) const;
+
+    // Qty resting in the best `levels` levels of a side
+    int64_t getCumulativeDepth(PAIR_ID pairId, ORDER_SIDE side, size_t levels);
+
     // Debug output
     void PrintFullBook(PAIR_ID pairId);
 
@@ -28,23 +98,84 @@ public:
     const BookSide& getSellSide(PAIR_ID pairId) const;
     const SeekerBounds& getSeekerBounds(PAIR_ID pairId) const;
     const std::vector<Order>& getEmittedOrders() const;
-    void clearEmittedOrders();
+    void clearEmittedOrders();   // also clears the BBO, analytics, consolidated and NBBO outputs
+
+    // Diff engine counters (all zero unless built with BUNI_DIFF_STATS)
+    const DiffStats& getDiffStats(PAIR_ID pairId) const;
+    void resetDiffStats(PAIR_ID pairId);
 
 private:
     std::unordered_map<PAIR_ID, PairOrderBookCache> _orderBooksCache;
-    std::unordered_map<PAIR_ID, SeekerBounds> _seekerBoundCache;
     std::vector<Order> _emittedOrders;
+    std::vector<Bbo> _bboUpdates;
+    std::vector<BookAnalytics> _analytics;
+    std::unordered_map<PAIR_ID, ConsolidationGroup> _groups;
+    std::vector<Order> _consolidatedOrders;
+    size_t _consolidatedStamped = 0;   // _consolidatedOrders before this have their time set
+    std::vector<Bbo> _nbboUpdates;
+    bool _tradeUpdate = false;         // market order in progress: its events are forwarded instead
+    bool _ladderUpdate = false;        // ladder diff in progress: the ladder already holds the change
+
+    // Scratch index for event netting, reused across snapshots
+    struct NetSlot {
+        double key;
+        uint32_t generation;
+        uint32_t index;
+    };
+    std::vector<NetSlot> _netIndex;
+    uint32_t _netGeneration = 0;
 
     // Unified book update helpers
     void _emitMarketOrderAndUpdateBook(
         PAIR_ID pairId, ORDER_QTY orderQty, ORDER_PRICE orderPrice, ORDER_TIME time,
-        BookSide& book, ORDER_SIDE bookSide);
+        BookSide& book, BookSideState& state, ORDER_SIDE bookSide);
 
     void _emitOrdersAndUpdateBook(
-        PAIR_ID pairId, BookSide& oldBook, std::vector<bookElement>& newBook,
+        PAIR_ID pairId, PairOrderBookCache& cache, BookSide& oldBook, BookSideState& state, std::vector<bookElement>& newBook,
         ORDER_TIME time, ORDER_SIDE side, bool isBuySide);
 
-    // Seeker bound management
+    // PRICE_LADDER diff; false if the snapshot cannot go through the ladder
+    bool _emitLadderDiffAndUpdateBook(
+        PAIR_ID pairId, PairOrderBookCache& cache, BookSide& oldBook, BookSideState& state, std::vector<bookElement>& newBook,
+        ORDER_TIME time, bool isBuySide);
+
+    // Applies the per-pair options around one side's diff. newBookHash may be null.
+    void _updateSide(PAIR_ID pairId, PairOrderBookCache& cache, bool isBuySide,
+                     std::vector<bookElement>& newBook, ORDER_TIME time, const uint64_t* newBookHash);
+
+    // Replaces a side with newBook: REMOVE for every old level, ADD (or
+    // SEEKER_ADD past the seeker bounds) for every new one
+    void _rebuildSide(PAIR_ID pairId, PairOrderBookCache& cache, bool isBuySide,
+                      std::vector<bookElement>& newBook, ORDER_TIME time);
+
+    // Publishes the current book if PairConfig::publishLevels is set
+    void _publishView(PairOrderBookCache& cache, ORDER_TIME time);
+    // After every public book update: view publishing, BBO tracking and analytics
+    void _bookUpdated(PAIR_ID pairId, PairOrderBookCache& cache, ORDER_TIME time);
+    void _emitAnalytics(PAIR_ID pairId, PairOrderBookCache& cache, ORDER_TIME time);
+    void _updateConsolidation(PairOrderBookCache& cache, ORDER_TIME time);
+    // A member level's qty moved by delta (from the hooks and the hook-less paths)
+    void _consolidatedLevelChanged(const BookSideState& state, ORDER_PRICE price, int64_t delta);
+    // Re-emits a member's market order events, _emittedOrders[begin, end), under the group
+    void _forwardTrades(const ConsolidationGroup& group, size_t begin);
+
+    // Drops out-of-view levels for PairConfig::maxDepth
+    void _applyDepthLimit(size_t maxDepth, BookSide& oldBook, BookSideState& state,
+                          std::vector<bookElement>& newBook, bool isBuySide);
+
+    // Called on every change to a resting level, before the book is modified
+    // for erases and qty changes and after it for inserts
+    void _levelInserted(const BookSide& book, BookSideState& state, size_t index, const bookElement& level);
+    void _levelErased(const BookSide& book, BookSideState& state, size_t index, const bookElement& level);
+    void _levelQtyChanged(const BookSide& book, BookSideState& state, size_t index, ORDER_PRICE price,
+                          ORDER_QTY oldQty, ORDER_QTY newQty);
+
+    // Collapses _emittedOrders[begin, end) to one event per price (PairConfig::netEvents)
+    void _netEvents(size_t begin, const BookSide& book, bool isBuySide);
+
+    // Seeker bound management. A new level beyond the best price seen so far
+    // is a SEEKER_ADD and moves the bound; anything else is an ADD.
+    ORDER_ACTION _seekerAction(PairOrderBookCache& cache, ORDER_PRICE price, bool isBuySide);
     void _setMinAskSeen(PAIR_ID pairId, double newValue);
     void _setMaxBidSeen(PAIR_ID pairId, double newValue);
 
@@ -0,0 +1,175 @@
+#include "tbt_book_builder.h"
+#include "utils.h"
+#include "wire_format.h"
+#include <algorithm>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+TbtBookBuilder::TbtBookBuilder(bool checkSequences) : _checkSequences(checkSequences) {}
+
+TbtBookBuilder::LocalBook& TbtBookBuilder::_book(PAIR_ID pairId) {
+    if (_lastBook && _lastPairId == pairId) return *_lastBook;
+    _lastPairId = pairId;
+    _lastBook = &_books[pairId];   // node based: the pointer stays valid
+    return *_lastBook;
+}
+
+FRAME_RESULT TbtBookBuilder::applyFrame(const char* data, size_t len) {
+    OrderFrameView frame;
+    if (!frame.parse(data, len)) return FRAME_MALFORMED;
+    if (frame.size() == 0) return FRAME_APPLIED;
+
+    PAIR_ID pairId = frame.pairId();
+    LocalBook& book = _book(pairId);
+    FRAME_RESULT result = FRAME_APPLIED;
+    if (_checkSequences) {
+        uint64_t sequence = frame.sequence();
+        if (book.lastSequence != 0) {
+            if (sequence <= book.lastSequence) {
+                book.stats.duplicates++;
+                return FRAME_DUPLICATE;
+            }
+            if (sequence > book.lastSequence + 1) {
+                book.stats.gaps += sequence - book.lastSequence - 1;
+                book.inSync = false;
+                result = FRAME_GAP;
+            }
+        }
+        book.lastSequence = sequence;
+    }
+    book.stats.frames++;
+
+    for (size_t i = 0; i < frame.size(); i++) {
+        applyOrder(frame[i]);
+    }
+
+    if (_checksumHook) {
+        const LocalBook& updated = _book(pairId);
+        BookHashes hashes;
+        hashes.buy = updated.buyHash;
+        hashes.sell = updated.sellHash;
+        _checksumHook(pairId, hashes);
+    }
+    return result;
+}
+
+void TbtBookBuilder::applyOrder(const Order& order) {
+    LocalBook& book = _book(order.pairId);
+    if (order.type == ORDER_TYPE::MARKET) {
+        // A market event carries the aggressor side and consumes the other book
+        _changeLevel(book, order.side == ORDER_SIDE::SELL, order.price, order.time, -order.qty, false);
+        return;
+    }
+    bool isBuySide = order.side == ORDER_SIDE::BUY;
+    switch (order.action) {
+        case ORDER_ACTION::SEEKER_ADD:
+        case ORDER_ACTION::ADD:
+            _changeLevel(book, isBuySide, order.price, order.time, order.qty, false);
+            break;
+        case ORDER_ACTION::REMOVE:
+            _changeLevel(book, isBuySide, order.price, order.time, -order.qty, false);
+            break;
+        case ORDER_ACTION::MODIFY:
+            _changeLevel(book, isBuySide, order.price, order.time, order.qty, true);
+            break;
+    }
+}
+
+void TbtBookBuilder::_changeLevel(LocalBook& book, bool isBuySide, ORDER_PRICE price, ORDER_TIME time,
+                                  int64_t qty, bool absolute) {
+    LocalBookSide& side = isBuySide ? book.bids : book.asks;
+    uint64_t& hash = isBuySide ? book.buyHash : book.sellHash;
+
+    // First level not strictly better than price (outside the comparison epsilon)
+    auto it = std::partition_point(side.begin(), side.end(), [&](const bookElement& level) {
+        return !SafeDoubleCompare(level.price, price) && (isBuySide ? level.price > price : level.price < price);
+    });
+    bool found = it != side.end() && SafeDoubleCompare(it->price, price);
+
+    if (!found) {
+        if (qty <= 0) {
+            book.stats.unmatched++;
+            return;
+        }
+        if (_maxDepth > 0 && static_cast<size_t>(it - side.begin()) >= _maxDepth) return;
+        bookElement level;
+        level.price = price;
+        level.qty = static_cast<ORDER_QTY>(qty);
+        level.time = time;
+        side.insert(it, level);
+        hash += bookLevelHash(price, level.qty);
+        if (_maxDepth > 0 && side.size() > _maxDepth) {
+            hash -= bookLevelHash(side.back().price, side.back().qty);
+            side.pop_back();
+        }
+        return;
+    }
+
+    int64_t newQty = absolute ? qty : it->qty + qty;
+    hash -= bookLevelHash(it->price, it->qty);
+    if (newQty <= 0) {
+        side.erase(it);
+        return;
+    }
+    it->qty = static_cast<ORDER_QTY>(newQty);
+    it->time = time;
+    hash += bookLevelHash(it->price, it->qty);
+}
+
+void TbtBookBuilder::resync(PAIR_ID pairId, const std::vector<bookElement>& bids,
+                            const std::vector<bookElement>& asks) {
+    LocalBook& book = _book(pairId);
+    book.bids.assign(bids.begin(), bids.end());
+    book.asks.assign(asks.begin(), asks.end());
+    if (_maxDepth > 0) {
+        if (book.bids.size() > _maxDepth) book.bids.resize(_maxDepth);
+        if (book.asks.size() > _maxDepth) book.asks.resize(_maxDepth);
+    }
+    book.buyHash = bookSideHash(book.bids);
+    book.sellHash = bookSideHash(book.asks);
+    book.lastSequence = 0;
+    book.inSync = true;
+}
+
+bool TbtBookBuilder::verifyChecksum(PAIR_ID pairId, const BookHashes& expected) const {
+    const LocalBook& book = _books.at(pairId);
+    return book.buyHash == expected.buy && book.sellHash == expected.sell;
+}
+
+const LocalBookSide& TbtBookBuilder::getBuySide(PAIR_ID pairId) const {
+    return _books.at(pairId).bids;
+}
+
+const LocalBookSide& TbtBookBuilder::getSellSide(PAIR_ID pairId) const {
+    return _books.at(pairId).asks;
+}
+
+uint64_t TbtBookBuilder::getBookHash(PAIR_ID pairId, ORDER_SIDE side) const {
+    const LocalBook& book = _books.at(pairId);
+    return side == ORDER_SIDE::BUY ? book.buyHash : book.sellHash;
+}
+
+int64_t TbtBookBuilder::getCumulativeDepth(PAIR_ID pairId, ORDER_SIDE side, size_t levels) const {
+    const LocalBookSide& book = side == ORDER_SIDE::BUY ? getBuySide(pairId) : getSellSide(pairId);
+    int64_t total = 0;
+    for (size_t i = 0; i < levels && i < book.size(); i++) total += book[i].qty;
+    return total;
+}
+
+bool TbtBookBuilder::isInSync(PAIR_ID pairId) const {
+    return _books.at(pairId).inSync;
+}
+
+uint64_t TbtBookBuilder::getLastSequence(PAIR_ID pairId) const {
+    return _books.at(pairId).lastSequence;
+}
+
+const SequenceStats& TbtBookBuilder::getSequenceStats(PAIR_ID pairId) const {
+    return _books.at(pairId).stats;
+}
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "book_hash.h"
+#include "data_structures.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+// Consumer-side book reconstruction from TBT order frames (serializeOrders).
+// Each side is a contiguous vector, best level first, so reads index it the
+// same way as the parser's BookSide.
+typedef std::vector<bookElement> LocalBookSide;
+
+enum FRAME_RESULT {
+    FRAME_APPLIED = 0,
+    FRAME_GAP = 1,         // applied, but frames were missed: the pair is out of sync
+    FRAME_DUPLICATE = 2,   // sequence already seen, dropped
+    FRAME_MALFORMED = 3    // not a complete orders frame, dropped
+};
+
+struct SequenceStats {
+    uint64_t frames = 0;       // applied
+    uint64_t gaps = 0;         // frames missing before an applied one
+    uint64_t duplicates = 0;
+    uint64_t unmatched = 0;    // REMOVE/MODIFY/MARKET at a price with no level
+};
+
+class TbtBookBuilder {
+public:
+    // Called after every applied frame with the pair's local book hashes
+    typedef std::function<void(PAIR_ID, const BookHashes&)> ChecksumHook;
+
+    // checkSequences: header sequences are per pair (both sides of
+    // orderbook.tbt.<pair>.*, or a filtered or consolidated subject); turn it
+    // off for frames numbered across pairs, e.g. orderbook.tbt, and for a
+    // single side's subject
+    explicit TbtBookBuilder(bool checkSequences = true);
+
+    // Applies every event of one frame; pairs are created on first use
+    FRAME_RESULT applyFrame(const char* data, size_t len);
+    // One event, outside any sequence
+    void applyOrder(const Order& order);
+
+    // Replaces a pair's book (e.g. from a snapshot after a gap); the next
+    // frame of the pair is accepted whatever its sequence
+    void resync(PAIR_ID pairId, const std::vector<bookElement>& bids, const std::vector<bookElement>& asks);
+
+    // Keep only the best maxDepth levels per side (0 = unlimited), for
+    // producers running with MAX_DEPTH
+    void setMaxDepth(size_t maxDepth) { _maxDepth = maxDepth; }
+    void setChecksumHook(ChecksumHook hook) { _checksumHook = hook; }
+    // True if the local book hashes to the source snapshot's hashes (deserializeSnapshot)
+    bool verifyChecksum(PAIR_ID pairId, const BookHashes& expected) const;
+
+    // Read API, as on SeekerNetBoonSnapshotParserToTBT
+    const LocalBookSide& getBuySide(PAIR_ID pairId) const;
+    const LocalBookSide& getSellSide(PAIR_ID pairId) const;
+    uint64_t getBookHash(PAIR_ID pairId, ORDER_SIDE side) const;
+    int64_t getCumulativeDepth(PAIR_ID pairId, ORDER_SIDE side, size_t levels) const;
+
+    bool hasPair(PAIR_ID pairId) const { return _books.count(pairId) != 0; }
+    bool isInSync(PAIR_ID pairId) const;   // false after a gap until resync()
+    uint64_t getLastSequence(PAIR_ID pairId) const;
+    const SequenceStats& getSequenceStats(PAIR_ID pairId) const;
+
+private:
+    struct LocalBook {
+        LocalBookSide bids;
+        LocalBookSide asks;
+        uint64_t buyHash = 0;
+        uint64_t sellHash = 0;
+        uint64_t lastSequence = 0;   // 0 = accept any
+        bool inSync = true;
+        SequenceStats stats;
+    };
+
+    std::unordered_map<PAIR_ID, LocalBook> _books;
+    PAIR_ID _lastPairId = 0;
+    LocalBook* _lastBook = nullptr;   // lookup cache for runs of one pair
+    bool _checkSequences;
+    size_t _maxDepth = 0;
+    ChecksumHook _checksumHook;
+
+    LocalBook& _book(PAIR_ID pairId);
+    // Adds delta to the level at price (or sets it with absolute), erasing it at zero
+    void _changeLevel(LocalBook& book, bool isBuySide, ORDER_PRICE price, ORDER_TIME time,
+                      int64_t qty, bool absolute);
+};
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
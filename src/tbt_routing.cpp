@@ -0,0 +1,152 @@
+#include "tbt_routing.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+std::string tbtSubject(PAIR_ID pairId, ORDER_SIDE side) {
+    return "orderbook.tbt." + std::to_string(pairId) + (side == ORDER_SIDE::BUY ? ".buy" : ".sell");
+}
+
+std::string filteredSubject(PAIR_ID pairId) {
+    return "orderbook.filtered." + std::to_string(pairId);
+}
+
+std::string bboSubject(PAIR_ID pairId) {
+    return "orderbook.bbo." + std::to_string(pairId);
+}
+
+std::string analyticsSubject(PAIR_ID pairId) {
+    return "orderbook.analytics." + std::to_string(pairId);
+}
+
+std::string consolidatedSubject(PAIR_ID groupId) {
+    return "orderbook.consolidated." + std::to_string(groupId);
+}
+
+std::string nbboSubject(PAIR_ID groupId) {
+    return "orderbook.nbbo." + std::to_string(groupId);
+}
+
+std::string snapshotSubject(PAIR_ID pairId) {
+    return "orderbook.snapshots." + std::to_string(pairId);
+}
+
+std::string checkpointSubject(PAIR_ID pairId) {
+    return "orderbook.checkpoint." + std::to_string(pairId);
+}
+
+std::string standbyCheckpointSubject(PAIR_ID pairId) {
+    return "orderbook.standby.checkpoint." + std::to_string(pairId);
+}
+
+bool parseEventFilter(const char* spec, EventFilterConfig& out) {
+    EventFilterConfig config;
+    const char* p = spec;
+    while (p && *p) {
+        const char* end = std::strchr(p, ',');
+        size_t len = end ? static_cast<size_t>(end - p) : std::strlen(p);
+        if (len == 6 && std::strncmp(p, "seeker", len) == 0) {
+            config.seekerAdds = true;
+        } else if (len == 6 && std::strncmp(p, "market", len) == 0) {
+            config.marketOrders = true;
+        } else if (len > 4 && std::strncmp(p, "top=", 4) == 0) {
+            char* numEnd = nullptr;
+            unsigned long levels = std::strtoul(p + 4, &numEnd, 10);
+            if (numEnd != p + len || levels == 0) return false;
+            config.topLevels = static_cast<size_t>(levels);
+        } else if (len > 0) {
+            return false;
+        }
+        p = end ? end + 1 : nullptr;
+    }
+    out = config;
+    return true;
+}
+
+void filterEvents(const EventFilterConfig& config, const std::vector<Order>& orders,
+                  const BookSide& buyBook, const BookSide& sellBook, std::vector<Order>& out) {
+    bool anyKind = !config.seekerAdds && !config.marketOrders;
+
+    // Worst price still inside the top N of each side; a shorter side has no cutoff
+    bool buyCutoff = config.topLevels > 0 && buyBook.size() >= config.topLevels;
+    bool sellCutoff = config.topLevels > 0 && sellBook.size() >= config.topLevels;
+    ORDER_PRICE buyLimit = buyCutoff ? buyBook[config.topLevels - 1].price : 0;
+    ORDER_PRICE sellLimit = sellCutoff ? sellBook[config.topLevels - 1].price : 0;
+
+    for (const Order& order : orders) {
+        bool isMarket = order.type == ORDER_TYPE::MARKET;
+        if (!anyKind && !(config.seekerAdds && order.action == ORDER_ACTION::SEEKER_ADD) &&
+            !(config.marketOrders && isMarket)) {
+            continue;
+        }
+        if (!isMarket) {
+            if (order.side == ORDER_SIDE::BUY && buyCutoff && order.price < buyLimit) continue;
+            if (order.side == ORDER_SIDE::SELL && sellCutoff && order.price > sellLimit) continue;
+        }
+        out.push_back(order);
+    }
+}
+
+bool parseConsolidationGroups(const char* spec, std::vector<ConsolidationSpec>& out) {
+    std::vector<ConsolidationSpec> groups;
+    const char* p = spec;
+    while (p && *p) {
+        ConsolidationSpec group;
+        char* end = nullptr;
+        group.groupId = static_cast<PAIR_ID>(std::strtoll(p, &end, 10));
+        if (end == p || *end != '=') return false;
+        p = end + 1;
+        while (true) {
+            long long member = std::strtoll(p, &end, 10);
+            if (end == p) return false;
+            group.members.push_back(static_cast<PAIR_ID>(member));
+            p = end;
+            if (*p != ',') break;
+            p++;
+        }
+        if (*p != ';' && *p != '\0') return false;
+        groups.push_back(group);
+        if (*p == ';') p++;
+    }
+    out = groups;
+    return true;
+}
+
+bool parsePairList(const char* spec, std::vector<PAIR_ID>& out) {
+    std::vector<PAIR_ID> pairs;
+    const char* p = spec;
+    while (p && *p) {
+        char* end = nullptr;
+        long long first = std::strtoll(p, &end, 10);
+        if (end == p) return false;
+        long long last = first;
+        p = end;
+        if (*p == '-') {
+            last = std::strtoll(p + 1, &end, 10);
+            if (end == p + 1 || last < first) return false;
+            p = end;
+        }
+        if (*p != ',' && *p != '\0') return false;
+        for (long long id = first; id <= last; id++) pairs.push_back(static_cast<PAIR_ID>(id));
+        if (*p == ',' && *++p == '\0') return false;
+    }
+    for (PAIR_ID pairId : pairs) {
+        if (std::find(out.begin(), out.end(), pairId) == out.end()) out.push_back(pairId);
+    }
+    return true;
+}
+
+void splitBySide(const std::vector<Order>& orders, std::vector<Order>& buys, std::vector<Order>& sells) {
+    for (const Order& order : orders) {
+        if (order.side == ORDER_SIDE::BUY) buys.push_back(order);
+        else sells.push_back(order);
+    }
+}
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "data_structures.h"
+#include <string>
+#include <vector>
+
+namespace cl {
+namespace data_feed {
+namespace data_feed_parser {
+
+// Output subjects. Full TBT goes to orderbook.tbt.<pair>.<buy|sell>, so a
+// consumer can take one pair (orderbook.tbt.<pair>.*) or everything
+// (orderbook.tbt.>). The per-pair filtered stream lives outside that tree so
+// wildcard subscribers do not receive its events twice.
+//
+// The buy and sell subjects of a pair share one frame sequence, so sequence
+// checking needs both: subscribe to orderbook.tbt.<pair>.* or wider. A
+// consumer of a single side sees the other side's frames as gaps and must
+// not check sequences (TbtBookBuilder(false)).
+std::string tbtSubject(PAIR_ID pairId, ORDER_SIDE side);
+std::string filteredSubject(PAIR_ID pairId);
+std::string bboSubject(PAIR_ID pairId);   // 32-byte BBO updates (serializeBbo)
+std::string analyticsSubject(PAIR_ID pairId);   // 48-byte book metrics (serializeAnalytics)
+std::string consolidatedSubject(PAIR_ID groupId);   // consolidated TBT of a consolidation group
+std::string nbboSubject(PAIR_ID groupId);           // 32-byte NBBO updates (serializeBbo)
+
+// Partitioned mode inputs: per-pair snapshots, and checkpoint requests for a
+// pair answered by its current owner (src/pair_partition.h)
+std::string snapshotSubject(PAIR_ID pairId);
+std::string checkpointSubject(PAIR_ID pairId);
+// Hot standby resync: the primary's checkpoint of a pair (src/hot_standby.h)
+std::string standbyCheckpointSubject(PAIR_ID pairId);
+
+// Derived stream selection. An event passes when it is one of the selected
+// kinds (any event if no kind is selected) and, with topLevels set, a limit
+// or iceberg event priced at or better than the topLevels-th level of its
+// side after the update. Market events pass the depth check: they trade at
+// the top by definition.
+struct EventFilterConfig {
+    size_t topLevels = 0;        // 0 = any depth
+    bool seekerAdds = false;     // SEEKER_ADD events
+    bool marketOrders = false;   // MARKET events
+
+    bool enabled() const { return topLevels > 0 || seekerAdds || marketOrders; }
+};
+
+// Parses "top=N,seeker,market" (any subset, comma separated). False on an unknown term.
+bool parseEventFilter(const char* spec, EventFilterConfig& out);
+
+// Appends the events of orders that pass the filter to out
+void filterEvents(const EventFilterConfig& config, const std::vector<Order>& orders,
+                  const BookSide& buyBook, const BookSide& sellBook, std::vector<Order>& out);
+
+// One consolidation group: "100=1,2,3" consolidates pairs 1, 2 and 3 as 100
+struct ConsolidationSpec {
+    PAIR_ID groupId = 0;
+    std::vector<PAIR_ID> members;
+};
+
+// Parses "group=pair,pair;group=pair,..." False on a malformed group.
+bool parseConsolidationGroups(const char* spec, std::vector<ConsolidationSpec>& out);
+
+// Parses a pair set such as "1,2,10-19" (ranges inclusive) and appends the
+// ids not already in out. False on a malformed term.
+bool parsePairList(const char* spec, std::vector<PAIR_ID>& out);
+
+// Splits orders into buy and sell events, keeping their relative order
+void splitBySide(const std::vector<Order>& orders, std::vector<Order>& buys, std::vector<Order>& sells);
+
+} // namespace data_feed_parser
+} // namespace data_feed
+} // namespace cl
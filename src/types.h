@@ -37,6 +37,18 @@ enum ORDER_ACTION {
     MODIFY = 3
 };
 
+enum SNAPSHOT_RESULT {
+    APPLIED = 0,
+    REBUILT_CROSSED = 1,
+    REBUILT_LOCKED = 2,
+    DROPPED_STALE = 3
+};
+
+enum BOOK_LAYOUT {
+    SORTED_LEVELS = 0,
+    PRICE_LADDER = 1
+};
+
 } // namespace data_feed_parser
 } // namespace data_feed
 } // namespace cl
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "book_hash.h"
 #include "data_structures.h"
 #include <vector>
 #include <cstring>
@@ -86,6 +87,8 @@ constexpr size_t WIRE_SNAPSHOT_HEADER_SIZE = 20; // pairId(8) + timestamp(8) + n
 constexpr size_t WIRE_BOOK_LEVEL_SIZE = 12;      // price(8) + qty(4)
 constexpr size_t WIRE_ORDERS_HEADER_SIZE = 20;   // type(1) + pairId(4) + seq(8) + count(4) + pad(3)
 constexpr size_t WIRE_ORDER_SIZE = 40;           // pairId(8) + price(8) + time(8) + qty(4) + side(4) + type(4) + action(4)
+constexpr size_t WIRE_BBO_SIZE = 32;             // time(8) + bidPrice(8) + askPrice(8) + bidQty(4) + askQty(4)
+constexpr size_t WIRE_ANALYTICS_SIZE = 48;       // time(8) + imbalance(8) + microprice(8) + weightedMid(8) + bidDepth(8) + askDepth(8)
 
 inline std::vector<char> serializeSnapshot(
     PAIR_ID pairId,
@@ -117,13 +120,18 @@ inline std::vector<char> serializeSnapshot(
     return buf;
 }
 
+// maxLevels > 0 decodes only the best maxLevels levels of each side (the
+// frame is still validated against its full declared size). hashes, when
+// given, receives bookSideHash() of the decoded sides.
 inline bool deserializeSnapshot(
     const char* data,
     size_t len,
     PAIR_ID& pairId,
     ORDER_TIME& timestamp,
     std::vector<bookElement>& buyBook,
-    std::vector<bookElement>& sellBook)
+    std::vector<bookElement>& sellBook,
+    size_t maxLevels = 0,
+    BookHashes* hashes = nullptr)
 {
     if (len < WIRE_SNAPSHOT_HEADER_SIZE) return false;
 
@@ -136,27 +144,89 @@ inline bool deserializeSnapshot(
         static_cast<size_t>(numBids + numAsks) * WIRE_BOOK_LEVEL_SIZE;
     if (len < expectedSize) return false;
 
-    buyBook.resize(numBids);
+    uint16_t keepBids = numBids;
+    uint16_t keepAsks = numAsks;
+    if (maxLevels > 0) {
+        if (keepBids > maxLevels) keepBids = static_cast<uint16_t>(maxLevels);
+        if (keepAsks > maxLevels) keepAsks = static_cast<uint16_t>(maxLevels);
+    }
+
+    uint64_t buyHash = 0;
+    uint64_t sellHash = 0;
+    buyBook.resize(keepBids);
     size_t offset = WIRE_SNAPSHOT_HEADER_SIZE;
-    for (uint16_t i = 0; i < numBids; i++) {
+    for (uint16_t i = 0; i < keepBids; i++) {
         buyBook[i].price = wire_detail::read_f64_le(data + offset);
         buyBook[i].qty = wire_detail::read_i32_le(data + offset + 8);
         buyBook[i].time = timestamp;
+        if (hashes) buyHash += bookLevelHash(buyBook[i].price, buyBook[i].qty);
         offset += WIRE_BOOK_LEVEL_SIZE;
     }
 
-    sellBook.resize(numAsks);
-    for (uint16_t i = 0; i < numAsks; i++) {
+    offset = WIRE_SNAPSHOT_HEADER_SIZE + static_cast<size_t>(numBids) * WIRE_BOOK_LEVEL_SIZE;
+    sellBook.resize(keepAsks);
+    for (uint16_t i = 0; i < keepAsks; i++) {
         sellBook[i].price = wire_detail::read_f64_le(data + offset);
         sellBook[i].qty = wire_detail::read_i32_le(data + offset + 8);
         sellBook[i].time = timestamp;
+        if (hashes) sellHash += bookLevelHash(sellBook[i].price, sellBook[i].qty);
         offset += WIRE_BOOK_LEVEL_SIZE;
     }
 
+    if (hashes) {
+        hashes->buy = buyHash;
+        hashes->sell = sellHash;
+    }
     return true;
 }
 
-inline std::vector<char> serializeOrders(const std::vector<Order>& orders) {
+// Fixed-size BBO update; the pair is identified by the subject it is published on
+inline void serializeBbo(const Bbo& bbo, char* out) {
+    wire_detail::write_u64_le(out + 0, static_cast<uint64_t>(bbo.time));
+    wire_detail::write_f64_le(out + 8, bbo.bidPrice);
+    wire_detail::write_f64_le(out + 16, bbo.askPrice);
+    wire_detail::write_i32_le(out + 24, static_cast<int32_t>(bbo.bidQty));
+    wire_detail::write_i32_le(out + 28, static_cast<int32_t>(bbo.askQty));
+}
+
+inline bool deserializeBbo(const char* data, size_t len, Bbo& bbo) {
+    if (len < WIRE_BBO_SIZE) return false;
+    bbo.time = static_cast<ORDER_TIME>(wire_detail::read_u64_le(data + 0));
+    bbo.bidPrice = wire_detail::read_f64_le(data + 8);
+    bbo.askPrice = wire_detail::read_f64_le(data + 16);
+    bbo.bidQty = wire_detail::read_i32_le(data + 24);
+    bbo.askQty = wire_detail::read_i32_le(data + 28);
+    return true;
+}
+
+// Fixed-size BookAnalytics record, published per pair like the BBO
+inline void serializeAnalytics(const BookAnalytics& analytics, char* out) {
+    wire_detail::write_u64_le(out + 0, static_cast<uint64_t>(analytics.time));
+    wire_detail::write_f64_le(out + 8, analytics.imbalance);
+    wire_detail::write_f64_le(out + 16, analytics.microprice);
+    wire_detail::write_f64_le(out + 24, analytics.weightedMid);
+    wire_detail::write_u64_le(out + 32, static_cast<uint64_t>(analytics.bidDepth));
+    wire_detail::write_u64_le(out + 40, static_cast<uint64_t>(analytics.askDepth));
+}
+
+inline bool deserializeAnalytics(const char* data, size_t len, BookAnalytics& analytics) {
+    if (len < WIRE_ANALYTICS_SIZE) return false;
+    analytics.time = static_cast<ORDER_TIME>(wire_detail::read_u64_le(data + 0));
+    analytics.imbalance = wire_detail::read_f64_le(data + 8);
+    analytics.microprice = wire_detail::read_f64_le(data + 16);
+    analytics.weightedMid = wire_detail::read_f64_le(data + 24);
+    analytics.bidDepth = static_cast<int64_t>(wire_detail::read_u64_le(data + 32));
+    analytics.askDepth = static_cast<int64_t>(wire_detail::read_u64_le(data + 40));
+    return true;
+}
+
+// Orders frame with an explicit header sequence. Publishers of per-pair
+// subjects number each stream's frames consecutively so consumers can detect
+// loss (see TbtBookBuilder). The first sequence is arbitrary: the processor
+// starts streams from the wall clock and restarts them higher on a takeover
+// without checkpoint (restartSequence in pair_partition.h), so a consumer
+// must accept whatever sequence it sees first.
+inline std::vector<char> serializeOrders(const std::vector<Order>& orders, uint64_t seq) {
     uint32_t count = static_cast<uint32_t>(orders.size());
     size_t totalSize = WIRE_ORDERS_HEADER_SIZE + static_cast<size_t>(count) * WIRE_ORDER_SIZE;
     std::vector<char> buf(totalSize, 0);
@@ -166,9 +236,6 @@ inline std::vector<char> serializeOrders(const std::vector<Order>& orders) {
         wirePairId = static_cast<uint32_t>(orders[0].pairId);
     }
 
-    static std::atomic<uint64_t> sequence{1};
-    uint64_t seq = sequence.fetch_add(1, std::memory_order_relaxed);
-
     buf[0] = static_cast<char>(WIRE_MSG_ORDERS);
     wire_detail::write_u32_le(buf.data() + 1, wirePairId);
     wire_detail::write_u64_le(buf.data() + 5, seq);
@@ -189,6 +256,48 @@ inline std::vector<char> serializeOrders(const std::vector<Order>& orders) {
     return buf;
 }
 
+// Orders frame numbered from a process-wide counter
+inline std::vector<char> serializeOrders(const std::vector<Order>& orders) {
+    static std::atomic<uint64_t> sequence{1};
+    return serializeOrders(orders, sequence.fetch_add(1, std::memory_order_relaxed));
+}
+
+// Zero-copy view of an orders frame: events are decoded from the buffer on
+// access, which must outlive the view
+class OrderFrameView {
+public:
+    // False if data is not a complete orders frame
+    bool parse(const char* data, size_t len) {
+        if (len < WIRE_ORDERS_HEADER_SIZE || static_cast<uint8_t>(data[0]) != WIRE_MSG_ORDERS) return false;
+        uint32_t count = wire_detail::read_u32_le(data + 13);
+        if ((len - WIRE_ORDERS_HEADER_SIZE) / WIRE_ORDER_SIZE < count) return false;
+        _data = data;
+        _count = count;
+        return true;
+    }
+
+    PAIR_ID pairId() const { return static_cast<PAIR_ID>(wire_detail::read_u32_le(_data + 1)); }
+    uint64_t sequence() const { return wire_detail::read_u64_le(_data + 5); }
+    size_t size() const { return _count; }
+
+    Order operator[](size_t i) const {
+        const char* p = _data + WIRE_ORDERS_HEADER_SIZE + i * WIRE_ORDER_SIZE;
+        Order order;
+        order.pairId = static_cast<PAIR_ID>(wire_detail::read_i64_le(p + 0));
+        order.price = wire_detail::read_f64_le(p + 8);
+        order.time = static_cast<ORDER_TIME>(wire_detail::read_u64_le(p + 16));
+        order.qty = wire_detail::read_i32_le(p + 24);
+        order.side = static_cast<ORDER_SIDE>(wire_detail::read_i32_le(p + 28));
+        order.type = static_cast<ORDER_TYPE>(wire_detail::read_i32_le(p + 32));
+        order.action = static_cast<ORDER_ACTION>(wire_detail::read_i32_le(p + 36));
+        return order;
+    }
+
+private:
+    const char* _data = nullptr;
+    size_t _count = 0;
+};
+
 } // namespace data_feed_parser
 } // namespace data_feed
 } // namespace cl
@@ -0,0 +1,128 @@
+#include "test_common.h"
+
+class ApplySnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        parser = std::make_unique<SeekerNetBoonSnapshotParserToTBT>(std::vector<PAIR_ID>{1});
+        bids = {makeBookElement(100.0, 10), makeBookElement(99.0, 20)};
+        asks = {makeBookElement(101.0, 10), makeBookElement(102.0, 20)};
+    }
+
+    std::unique_ptr<SeekerNetBoonSnapshotParserToTBT> parser;
+    std::vector<bookElement> bids, asks;
+};
+
+TEST_F(ApplySnapshotTest, MatchesPerSideCalls) {
+    SeekerNetBoonSnapshotParserToTBT reference({1});
+    std::vector<bookElement> refBids = bids, refAsks = asks;
+    reference.EmitOrdersAndUpdateOldBuyBook(1, refBids, 1000);
+    reference.EmitOrdersAndUpdateOldSellBook(1, refAsks, 1000);
+
+    EXPECT_EQ(parser->ApplySnapshot(1, bids, asks, 1000), SNAPSHOT_RESULT::APPLIED);
+
+    ASSERT_EQ(parser->getEmittedOrders().size(), reference.getEmittedOrders().size());
+    for (size_t i = 0; i < reference.getEmittedOrders().size(); i++) {
+        EXPECT_DOUBLE_EQ(parser->getEmittedOrders()[i].price, reference.getEmittedOrders()[i].price);
+        EXPECT_EQ(parser->getEmittedOrders()[i].action, reference.getEmittedOrders()[i].action);
+        EXPECT_EQ(parser->getEmittedOrders()[i].side, reference.getEmittedOrders()[i].side);
+    }
+    EXPECT_EQ(parser->getBuySide(1).size(), 2u);
+    EXPECT_EQ(parser->getSellSide(1).size(), 2u);
+    EXPECT_EQ(parser->getSnapshotStats(1).applied, 1u);
+}
+
+TEST_F(ApplySnapshotTest, StaleSnapshotIsDropped) {
+    parser->ApplySnapshot(1, bids, asks, 2000);
+    parser->clearEmittedOrders();
+
+    std::vector<bookElement> oldBids = {makeBookElement(100.0, 50)};
+    std::vector<bookElement> oldAsks = {makeBookElement(101.0, 50)};
+    EXPECT_EQ(parser->ApplySnapshot(1, oldBids, oldAsks, 1999), SNAPSHOT_RESULT::DROPPED_STALE);
+
+    EXPECT_TRUE(parser->getEmittedOrders().empty());
+    EXPECT_EQ(parser->getBuySide(1).front().qty, 10);
+    EXPECT_EQ(parser->getSnapshotStats(1).stale, 1u);
+}
+
+TEST_F(ApplySnapshotTest, SameTimestampIsApplied) {
+    parser->ApplySnapshot(1, bids, asks, 2000);
+    std::vector<bookElement> bids2 = {makeBookElement(100.0, 15), makeBookElement(99.0, 20)};
+    std::vector<bookElement> asks2 = {makeBookElement(101.0, 10), makeBookElement(102.0, 20)};
+    EXPECT_EQ(parser->ApplySnapshot(1, bids2, asks2, 2000), SNAPSHOT_RESULT::APPLIED);
+    EXPECT_EQ(parser->getBuySide(1).front().qty, 15);
+}
+
+TEST_F(ApplySnapshotTest, CrossedBookIsRebuilt) {
+    parser->ApplySnapshot(1, bids, asks, 1000);
+    parser->clearEmittedOrders();
+
+    std::vector<bookElement> crossedBids = {makeBookElement(103.0, 5), makeBookElement(100.0, 10)};
+    std::vector<bookElement> crossedAsks = {makeBookElement(101.0, 10)};
+    EXPECT_EQ(parser->ApplySnapshot(1, crossedBids, crossedAsks, 2000), SNAPSHOT_RESULT::REBUILT_CROSSED);
+
+    const auto& buy = parser->getBuySide(1);
+    ASSERT_EQ(buy.size(), 2u);
+    EXPECT_DOUBLE_EQ(buy[0].price, 103.0);
+    ASSERT_EQ(parser->getSellSide(1).size(), 1u);
+
+    // Bid side: 2 removes + 2 adds (103 is a new best bid), ask side: 2 removes + 1 add
+    int removes = 0, adds = 0, seekerAdds = 0;
+    for (const auto& order : parser->getEmittedOrders()) {
+        if (order.action == ORDER_ACTION::REMOVE) removes++;
+        if (order.action == ORDER_ACTION::ADD) adds++;
+        if (order.action == ORDER_ACTION::SEEKER_ADD) seekerAdds++;
+    }
+    EXPECT_EQ(removes, 4);
+    EXPECT_EQ(adds, 2);
+    EXPECT_EQ(seekerAdds, 1);
+    EXPECT_EQ(parser->getSnapshotStats(1).crossed, 1u);
+    EXPECT_EQ(parser->getBookHash(1, ORDER_SIDE::BUY), bookSideHash(buy));
+}
+
+TEST_F(ApplySnapshotTest, CrossedRebuildUpdatesSeekerBounds) {
+    parser->ApplySnapshot(1, bids, asks, 1000);
+    parser->clearEmittedOrders();
+
+    std::vector<bookElement> crossedBids = {makeBookElement(103.0, 5), makeBookElement(100.0, 10)};
+    std::vector<bookElement> crossedAsks = {makeBookElement(98.0, 4), makeBookElement(101.0, 10)};
+    EXPECT_EQ(parser->ApplySnapshot(1, crossedBids, crossedAsks, 2000), SNAPSHOT_RESULT::REBUILT_CROSSED);
+
+    const auto& events = parser->getEmittedOrders();
+    auto actionAt = [&](double price, ORDER_SIDE side) {
+        for (const auto& order : events) {
+            if (order.side == side && order.price == price && order.action != ORDER_ACTION::REMOVE) return order.action;
+        }
+        return ORDER_ACTION::REMOVE;
+    };
+    EXPECT_EQ(actionAt(103.0, ORDER_SIDE::BUY), ORDER_ACTION::SEEKER_ADD);
+    EXPECT_EQ(actionAt(100.0, ORDER_SIDE::BUY), ORDER_ACTION::ADD);
+    EXPECT_EQ(actionAt(98.0, ORDER_SIDE::SELL), ORDER_ACTION::SEEKER_ADD);
+    EXPECT_EQ(actionAt(101.0, ORDER_SIDE::SELL), ORDER_ACTION::ADD);
+    EXPECT_DOUBLE_EQ(parser->getSeekerBounds(1).maxBidSeen, 103.0);
+    EXPECT_DOUBLE_EQ(parser->getSeekerBounds(1).minAskSeen, 98.0);
+
+    // Later diffs are classified against the moved bounds
+    parser->clearEmittedOrders();
+    std::vector<bookElement> bids2 = {makeBookElement(102.0, 5), makeBookElement(100.0, 10)};
+    std::vector<bookElement> asks2 = {makeBookElement(104.0, 10)};
+    EXPECT_EQ(parser->ApplySnapshot(1, bids2, asks2, 3000), SNAPSHOT_RESULT::APPLIED);
+    EXPECT_EQ(actionAt(102.0, ORDER_SIDE::BUY), ORDER_ACTION::ADD);
+}
+
+TEST_F(ApplySnapshotTest, LockedBookIsRebuilt) {
+    std::vector<bookElement> lockedBids = {makeBookElement(101.0, 5)};
+    std::vector<bookElement> lockedAsks = {makeBookElement(101.0, 7)};
+    EXPECT_EQ(parser->ApplySnapshot(1, lockedBids, lockedAsks, 1000), SNAPSHOT_RESULT::REBUILT_LOCKED);
+    EXPECT_EQ(parser->getSnapshotStats(1).locked, 1u);
+    EXPECT_EQ(parser->getBuySide(1).size(), 1u);
+    EXPECT_EQ(parser->getSellSide(1).size(), 1u);
+}
+
+TEST_F(ApplySnapshotTest, OneSidedSnapshotIsNotCrossed) {
+    std::vector<bookElement> noAsks;
+    EXPECT_EQ(parser->ApplySnapshot(1, bids, noAsks, 1000), SNAPSHOT_RESULT::APPLIED);
+}
+
+TEST_F(ApplySnapshotTest, UnknownPairThrows) {
+    EXPECT_THROW(parser->ApplySnapshot(999, bids, asks, 1000), std::out_of_range);
+}
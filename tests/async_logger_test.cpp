@@ -0,0 +1,116 @@
+#include "test_common.h"
+#include <cstdio>
+#include <string>
+#include <thread>
+
+class AsyncLoggerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        sink = std::tmpfile();
+        ASSERT_NE(sink, nullptr);
+    }
+    void TearDown() override {
+        if (sink) std::fclose(sink);
+    }
+
+    std::string readSink() {
+        std::fflush(sink);
+        std::rewind(sink);
+        std::string out;
+        char buf[256];
+        size_t n;
+        while ((n = std::fread(buf, 1, sizeof(buf), sink)) > 0) {
+            out.append(buf, n);
+        }
+        return out;
+    }
+
+    static size_t countLines(const std::string& text) {
+        size_t lines = 0;
+        for (char c : text) {
+            if (c == '\n') lines++;
+        }
+        return lines;
+    }
+
+    FILE* sink = nullptr;
+};
+
+TEST_F(AsyncLoggerTest, FormatsArgumentsOnDrainThread) {
+    static LogMessageType type(LOG_LEVEL::ERROR, 0, "pair=%lld price=%g side=%s");
+    {
+        AsyncLogger logger(16, sink, sink);
+        EXPECT_TRUE(logger.log(type, static_cast<PAIR_ID>(7), 101.5, toString(ORDER_SIDE::BUY)));
+        logger.flush();
+        EXPECT_EQ(logger.getStats().logged, 1u);
+    }
+
+    std::string out = readSink();
+    EXPECT_NE(out.find("ERROR"), std::string::npos);
+    EXPECT_NE(out.find("pair=7 price=101.5 side=BUY"), std::string::npos);
+}
+
+TEST_F(AsyncLoggerTest, InfoAndErrorUseSeparateSinks) {
+    FILE* errSink = std::tmpfile();
+    ASSERT_NE(errSink, nullptr);
+    static LogMessageType info(LOG_LEVEL::INFO, 0, "hello");
+    static LogMessageType err(LOG_LEVEL::ERROR, 0, "boom");
+    {
+        AsyncLogger logger(16, sink, errSink);
+        logger.log(info);
+        logger.log(err);
+        logger.flush();
+    }
+
+    std::string out = readSink();
+    EXPECT_NE(out.find("hello"), std::string::npos);
+    EXPECT_EQ(out.find("boom"), std::string::npos);
+    std::fclose(errSink);
+}
+
+TEST_F(AsyncLoggerTest, RateLimitSuppressesBurst) {
+    static LogMessageType type(LOG_LEVEL::WARNING, 3, "burst %lld");
+    {
+        AsyncLogger logger(64, sink, sink);
+        int accepted = 0;
+        for (int i = 0; i < 10; i++) {
+            if (logger.log(type, i)) accepted++;
+        }
+        logger.flush();
+        EXPECT_EQ(accepted, 3);
+        EXPECT_EQ(logger.getStats().suppressed, 7u);
+        EXPECT_EQ(logger.getStats().logged, 3u);
+    }
+    EXPECT_EQ(countLines(readSink()), 3u);
+}
+
+TEST_F(AsyncLoggerTest, FullRingDropsInsteadOfBlocking) {
+    static LogMessageType type(LOG_LEVEL::INFO, 0, "msg %lld");
+    AsyncLogger logger(4, sink, sink);
+    uint64_t attempted = 0;
+    for (int i = 0; i < 100000; i++) {
+        logger.log(type, i);
+        attempted++;
+    }
+    logger.flush();
+    AsyncLoggerStats stats = logger.getStats();
+    EXPECT_EQ(stats.logged + stats.dropped, attempted);
+}
+
+TEST_F(AsyncLoggerTest, ConcurrentProducers) {
+    static LogMessageType type(LOG_LEVEL::INFO, 0, "thread %lld seq %lld");
+    AsyncLogger logger(1 << 14, sink, sink);
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; t++) {
+        producers.emplace_back([&logger, t]() {
+            for (int i = 0; i < 1000; i++) {
+                logger.log(type, t, i);
+            }
+        });
+    }
+    for (auto& th : producers) th.join();
+    logger.flush();
+
+    AsyncLoggerStats stats = logger.getStats();
+    EXPECT_EQ(stats.logged + stats.dropped, 4000u);
+}
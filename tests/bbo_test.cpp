@@ -0,0 +1,90 @@
+#include "test_common.h"
+#include "src/wire_format.h"
+
+class BboTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        parser = std::make_unique<SeekerNetBoonSnapshotParserToTBT>(std::vector<PAIR_ID>{1});
+        PairConfig config;
+        config.trackBbo = true;
+        parser->SetPairConfig(1, config);
+        bids = {makeBookElement(100.0, 10), makeBookElement(99.0, 20)};
+        asks = {makeBookElement(101.0, 15), makeBookElement(102.0, 25)};
+    }
+
+    std::unique_ptr<SeekerNetBoonSnapshotParserToTBT> parser;
+    std::vector<bookElement> bids, asks;
+};
+
+TEST_F(BboTest, FirstSnapshotEmitsBbo) {
+    parser->ApplySnapshot(1, bids, asks, 1000);
+
+    ASSERT_EQ(parser->getBboUpdates().size(), 1u);
+    const Bbo& bbo = parser->getBboUpdates()[0];
+    EXPECT_EQ(bbo.pairId, 1);
+    EXPECT_EQ(bbo.time, 1000u);
+    EXPECT_DOUBLE_EQ(bbo.bidPrice, 100.0);
+    EXPECT_EQ(bbo.bidQty, 10);
+    EXPECT_DOUBLE_EQ(bbo.askPrice, 101.0);
+    EXPECT_EQ(bbo.askQty, 15);
+}
+
+TEST_F(BboTest, DeepChangeDoesNotEmit) {
+    parser->ApplySnapshot(1, bids, asks, 1000);
+    parser->clearEmittedOrders();
+    EXPECT_TRUE(parser->getBboUpdates().empty());
+
+    std::vector<bookElement> bids2 = {makeBookElement(100.0, 10), makeBookElement(99.0, 50)};
+    std::vector<bookElement> asks2 = asks;
+    parser->ApplySnapshot(1, bids2, asks2, 2000);
+    EXPECT_FALSE(parser->getEmittedOrders().empty());
+    EXPECT_TRUE(parser->getBboUpdates().empty());
+}
+
+TEST_F(BboTest, TopQtyChangeEmits) {
+    parser->ApplySnapshot(1, bids, asks, 1000);
+    parser->clearEmittedOrders();
+
+    std::vector<bookElement> bids2 = {makeBookElement(100.0, 12), makeBookElement(99.0, 20)};
+    std::vector<bookElement> asks2 = asks;
+    parser->ApplySnapshot(1, bids2, asks2, 2000);
+    ASSERT_EQ(parser->getBboUpdates().size(), 1u);
+    EXPECT_EQ(parser->getBboUpdates()[0].bidQty, 12);
+    EXPECT_EQ(parser->getBbo(1).bidQty, 12);
+}
+
+TEST_F(BboTest, MarketOrderMovesBbo) {
+    parser->ApplySnapshot(1, bids, asks, 1000);
+    parser->clearEmittedOrders();
+
+    parser->EmitMarketOrderAndUpdateBuyBook(1, 10, 100.0, 1001);
+    ASSERT_EQ(parser->getBboUpdates().size(), 1u);
+    EXPECT_DOUBLE_EQ(parser->getBboUpdates()[0].bidPrice, 99.0);
+    EXPECT_EQ(parser->getBboUpdates()[0].time, 1001u);
+}
+
+TEST_F(BboTest, DisabledByDefault) {
+    SeekerNetBoonSnapshotParserToTBT plain({1});
+    plain.ApplySnapshot(1, bids, asks, 1000);
+    EXPECT_TRUE(plain.getBboUpdates().empty());
+}
+
+TEST_F(BboTest, WireRoundTripIs32Bytes) {
+    Bbo bbo;
+    bbo.time = 123456789;
+    bbo.bidPrice = 99.5;
+    bbo.askPrice = 100.25;
+    bbo.bidQty = 7;
+    bbo.askQty = -1;
+
+    char buf[WIRE_BBO_SIZE];
+    serializeBbo(bbo, buf);
+    Bbo decoded;
+    ASSERT_TRUE(deserializeBbo(buf, sizeof(buf), decoded));
+    EXPECT_EQ(decoded.time, bbo.time);
+    EXPECT_DOUBLE_EQ(decoded.bidPrice, 99.5);
+    EXPECT_DOUBLE_EQ(decoded.askPrice, 100.25);
+    EXPECT_EQ(decoded.bidQty, 7);
+    EXPECT_EQ(decoded.askQty, -1);
+    EXPECT_FALSE(deserializeBbo(buf, WIRE_BBO_SIZE - 1, decoded));
+}
@@ -0,0 +1,137 @@
+#include "test_common.h"
+#include "src/wire_format.h"
+#include <random>
+
+class BookAnalyticsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        parser = std::make_unique<SeekerNetBoonSnapshotParserToTBT>(std::vector<PAIR_ID>{1});
+        config.analyticsLevels = 2;
+        config.analyticsBandBps = 150;
+        parser->SetPairConfig(1, config);
+        bids = {makeBookElement(100.0, 10), makeBookElement(99.0, 30), makeBookElement(97.0, 5)};
+        asks = {makeBookElement(101.0, 30), makeBookElement(102.0, 10), makeBookElement(104.0, 5)};
+    }
+
+    // Incremental metrics against a full recompute of the parser's book
+    void expectMatchesRecompute(const BookAnalytics& got) {
+        BookAnalytics want;
+        computeBookAnalytics(parser->getBuySide(1), parser->getSellSide(1),
+                             config.analyticsLevels, config.analyticsBandBps, want);
+        EXPECT_NEAR(got.imbalance, want.imbalance, 1e-9);
+        EXPECT_NEAR(got.microprice, want.microprice, 1e-9);
+        EXPECT_NEAR(got.weightedMid, want.weightedMid, 1e-9);
+        EXPECT_EQ(got.bidDepth, want.bidDepth);
+        EXPECT_EQ(got.askDepth, want.askDepth);
+    }
+
+    std::unique_ptr<SeekerNetBoonSnapshotParserToTBT> parser;
+    PairConfig config;
+    std::vector<bookElement> bids, asks;
+};
+
+TEST_F(BookAnalyticsTest, MetricsOfFirstSnapshot) {
+    parser->ApplySnapshot(1, bids, asks, 1000);
+
+    ASSERT_EQ(parser->getAnalytics().size(), 1u);
+    const BookAnalytics& a = parser->getAnalytics()[0];
+    EXPECT_EQ(a.pairId, 1);
+    EXPECT_EQ(a.time, 1000u);
+    EXPECT_DOUBLE_EQ(a.imbalance, (10.0 - 30.0) / 40.0);
+    EXPECT_DOUBLE_EQ(a.microprice, (100.0 * 30 + 101.0 * 10) / 40.0);
+    EXPECT_DOUBLE_EQ(a.weightedMid, ((100.0 * 10 + 99.0 * 30) / 40.0 + (101.0 * 30 + 102.0 * 10) / 40.0) / 2);
+    // Mid 100.5, 150 bps band: bids >= 98.9925, asks <= 102.0075
+    EXPECT_EQ(a.bidDepth, 40);
+    EXPECT_EQ(a.askDepth, 40);
+}
+
+TEST_F(BookAnalyticsTest, EmittedWithEveryUpdate) {
+    parser->ApplySnapshot(1, bids, asks, 1000);
+    parser->clearEmittedOrders();
+    EXPECT_TRUE(parser->getAnalytics().empty());
+
+    parser->EmitMarketOrderAndUpdateBuyBook(1, 15, 99.0, 1001);
+    ASSERT_EQ(parser->getAnalytics().size(), 1u);
+    expectMatchesRecompute(parser->getAnalytics()[0]);
+    EXPECT_EQ(parser->getAnalytics()[0].bidDepth, 25);
+}
+
+TEST_F(BookAnalyticsTest, OffByDefault) {
+    SeekerNetBoonSnapshotParserToTBT plain({1});
+    plain.ApplySnapshot(1, bids, asks, 1000);
+    EXPECT_TRUE(plain.getAnalytics().empty());
+}
+
+TEST_F(BookAnalyticsTest, EmptySideZeroesPairMetrics) {
+    std::vector<bookElement> none;
+    parser->ApplySnapshot(1, bids, none, 1000);
+    const BookAnalytics& a = parser->getAnalytics().back();
+    EXPECT_EQ(a.imbalance, 0);
+    EXPECT_EQ(a.microprice, 0);
+    EXPECT_EQ(a.weightedMid, 0);
+    // Band around the best bid: 100 * (1 - 0.015) = 98.5
+    EXPECT_EQ(a.bidDepth, 40);
+    EXPECT_EQ(a.askDepth, 0);
+}
+
+TEST_F(BookAnalyticsTest, MatchesRecomputeThroughRandomUpdates) {
+    std::mt19937 rng(17);
+    for (int round = 0; round < 400; round++) {
+        unsigned kind = rng() % 4;
+        if (kind == 3 && !parser->getBuySide(1).empty()) {
+            const auto& side = parser->getBuySide(1);
+            parser->EmitMarketOrderAndUpdateBuyBook(1, 1 + static_cast<int>(rng() % 40),
+                                                    side[rng() % side.size()].price, round);
+        } else {
+            // Mid drifts so levels cross the band edge and the top-N boundary
+            double mid = 100.0 + static_cast<int>(rng() % 5) - 2;
+            std::vector<bookElement> b, s;
+            double price = mid - 0.5;
+            for (int i = static_cast<int>(rng() % 8); i > 0; i--) {
+                b.push_back(makeBookElement(price, 1 + static_cast<int>(rng() % 20)));
+                price -= 0.5 + (rng() % 3) * 0.5;
+            }
+            price = mid + 0.5;
+            for (int i = static_cast<int>(rng() % 8); i > 0; i--) {
+                s.push_back(makeBookElement(price, 1 + static_cast<int>(rng() % 20)));
+                price += 0.5 + (rng() % 3) * 0.5;
+            }
+            parser->ApplySnapshot(1, b, s, round);
+        }
+
+        ASSERT_FALSE(parser->getAnalytics().empty()) << "round " << round;
+        SCOPED_TRACE(round);
+        expectMatchesRecompute(parser->getAnalytics().back());
+        parser->clearEmittedOrders();
+    }
+}
+
+TEST_F(BookAnalyticsTest, LadderLayoutMatchesRecompute) {
+    config.layout = BOOK_LAYOUT::PRICE_LADDER;
+    config.tickSize = 0.5;
+    parser->SetPairConfig(1, config);
+    parser->ApplySnapshot(1, bids, asks, 1000);
+    expectMatchesRecompute(parser->getAnalytics().back());
+
+    std::vector<bookElement> bids2 = {makeBookElement(100.5, 4), makeBookElement(100.0, 10)};
+    std::vector<bookElement> asks2 = {makeBookElement(102.0, 10)};
+    parser->ApplySnapshot(1, bids2, asks2, 2000);
+    expectMatchesRecompute(parser->getAnalytics().back());
+}
+
+TEST_F(BookAnalyticsTest, WireRoundTrip) {
+    parser->ApplySnapshot(1, bids, asks, 1000);
+    const BookAnalytics& a = parser->getAnalytics()[0];
+    char buf[WIRE_ANALYTICS_SIZE];
+    serializeAnalytics(a, buf);
+
+    BookAnalytics decoded;
+    ASSERT_TRUE(deserializeAnalytics(buf, sizeof(buf), decoded));
+    EXPECT_EQ(decoded.time, a.time);
+    EXPECT_EQ(decoded.imbalance, a.imbalance);
+    EXPECT_EQ(decoded.microprice, a.microprice);
+    EXPECT_EQ(decoded.weightedMid, a.weightedMid);
+    EXPECT_EQ(decoded.bidDepth, a.bidDepth);
+    EXPECT_EQ(decoded.askDepth, a.askDepth);
+    EXPECT_FALSE(deserializeAnalytics(buf, sizeof(buf) - 1, decoded));
+}
@@ -0,0 +1,120 @@
+#include "test_common.h"
+#include <atomic>
+#include <thread>
+
+class BookViewTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        parser = std::make_unique<SeekerNetBoonSnapshotParserToTBT>(std::vector<PAIR_ID>{1});
+        bids = {makeBookElement(100.0, 10), makeBookElement(99.0, 20), makeBookElement(98.0, 30)};
+        asks = {makeBookElement(101.0, 15), makeBookElement(102.0, 25), makeBookElement(103.0, 35)};
+    }
+
+    void enableView(size_t levels) {
+        PairConfig config;
+        config.publishLevels = levels;
+        parser->SetPairConfig(1, config);
+    }
+
+    std::unique_ptr<SeekerNetBoonSnapshotParserToTBT> parser;
+    std::vector<bookElement> bids, asks;
+};
+
+TEST_F(BookViewTest, DisabledByDefault) {
+    EXPECT_EQ(parser->getBookView(1), nullptr);
+}
+
+TEST_F(BookViewTest, PublishesTopLevelsAfterSnapshot) {
+    enableView(2);
+    parser->ApplySnapshot(1, bids, asks, 1000);
+
+    BookView view;
+    parser->getBookView(1)->read(view);
+    EXPECT_EQ(view.time, 1000u);
+    ASSERT_EQ(view.bidLevels, 2u);
+    ASSERT_EQ(view.askLevels, 2u);
+    ASSERT_TRUE(view.hasBbo());
+    EXPECT_DOUBLE_EQ(view.bestBid().price, 100.0);
+    EXPECT_EQ(view.bestBid().qty, 10);
+    EXPECT_DOUBLE_EQ(view.bestAsk().price, 101.0);
+    EXPECT_DOUBLE_EQ(view.bids[1].price, 99.0);
+    EXPECT_EQ(view.asks[1].qty, 25);
+}
+
+TEST_F(BookViewTest, DepthIsCapped) {
+    const size_t maxLevels = BookView::MAX_LEVELS;
+    enableView(maxLevels + 10);
+    EXPECT_EQ(parser->getBookView(1)->depth(), maxLevels);
+}
+
+TEST_F(BookViewTest, MarketOrderRepublishes) {
+    enableView(5);
+    parser->ApplySnapshot(1, bids, asks, 1000);
+    uint64_t before = parser->getBookView(1)->sequence();
+
+    parser->EmitMarketOrderAndUpdateBuyBook(1, 10, 100.0, 1001);
+
+    BookView view;
+    parser->getBookView(1)->read(view);
+    EXPECT_GT(view.sequence, before);
+    ASSERT_EQ(view.bidLevels, 2u);
+    EXPECT_DOUBLE_EQ(view.bestBid().price, 99.0);
+}
+
+TEST_F(BookViewTest, StaleSnapshotDoesNotPublish) {
+    enableView(5);
+    parser->ApplySnapshot(1, bids, asks, 1000);
+    uint64_t before = parser->getBookView(1)->sequence();
+
+    std::vector<bookElement> oldBids = {makeBookElement(100.0, 99)};
+    std::vector<bookElement> oldAsks = {makeBookElement(101.0, 99)};
+    parser->ApplySnapshot(1, oldBids, oldAsks, 999);
+    EXPECT_EQ(parser->getBookView(1)->sequence(), before);
+}
+
+TEST_F(BookViewTest, ViewSurvivesDisable) {
+    enableView(5);
+    const PublishedBookView* view = parser->getBookView(1);
+    parser->SetPairConfig(1, PairConfig());
+    parser->ApplySnapshot(1, bids, asks, 1000);
+
+    EXPECT_EQ(parser->getBookView(1), view);
+    EXPECT_EQ(view->sequence(), 1u);   // only the publish from SetPairConfig
+}
+
+TEST(PublishedBookViewTest, ReadersNeverSeeTornViews) {
+    PublishedBookView published;
+    published.setDepth(BookView::MAX_LEVELS);
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+
+    // Every level of a publish carries the same qty, so a mix of two publishes shows up
+    auto reader = [&]() {
+        BookView view;
+        while (!done.load()) {
+            published.read(view);
+            for (uint32_t i = 0; i < view.bidLevels; i++) {
+                if (view.bids[i].qty != view.bids[0].qty || view.asks[i].qty != view.bids[0].qty) torn++;
+            }
+        }
+    };
+    std::thread r1(reader), r2(reader);
+
+    std::vector<bookElement> bids(BookView::MAX_LEVELS), asks(BookView::MAX_LEVELS);
+    for (int n = 1; n <= 20000; n++) {
+        for (size_t i = 0; i < bids.size(); i++) {
+            bids[i] = makeBookElement(100.0 - i, n);
+            asks[i] = makeBookElement(101.0 + i, n);
+        }
+        published.publish(bids, asks, n);
+    }
+    done = true;
+    r1.join();
+    r2.join();
+
+    EXPECT_EQ(torn.load(), 0);
+    BookView last;
+    published.read(last);
+    EXPECT_EQ(last.sequence, 20000u);
+    EXPECT_EQ(last.bestBid().qty, 20000);
+}
@@ -0,0 +1,134 @@
+#include "test_common.h"
+#include "src/buni_c.h"
+#include "src/wire_format.h"
+#include <new>
+#include <stdexcept>
+
+class BuniCTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        handle = buni_parser_create();
+        ASSERT_NE(handle, nullptr);
+        ASSERT_EQ(buni_register_pair(handle, 1), BUNI_OK);
+    }
+    void TearDown() override { buni_parser_destroy(handle); }
+
+    buni_parser* handle = nullptr;
+};
+
+TEST_F(BuniCTest, AppliesSnapshotBytes) {
+    std::vector<char> frame = serializeSnapshot(1, 1000, {makeBookElement(100.0, 10), makeBookElement(99.5, 5)},
+                                                {makeBookElement(100.5, 7)});
+    EXPECT_EQ(buni_apply_snapshot(handle, frame.data(), frame.size()), BUNI_APPLIED);
+
+    size_t count = 0;
+    const buni_order* events = buni_events(handle, &count);
+    ASSERT_EQ(count, 3u);
+    EXPECT_EQ(events[0].pair_id, 1);
+    EXPECT_DOUBLE_EQ(events[0].price, 100.0);
+    EXPECT_EQ(events[0].qty, 10);
+    EXPECT_EQ(events[0].side, static_cast<int32_t>(ORDER_SIDE::BUY));
+    EXPECT_EQ(events[0].action, static_cast<int32_t>(ORDER_ACTION::SEEKER_ADD));
+    EXPECT_EQ(events[2].side, static_cast<int32_t>(ORDER_SIDE::SELL));
+    EXPECT_EQ(events[2].time, 1000u);
+
+    buni_clear_events(handle);
+    buni_events(handle, &count);
+    EXPECT_EQ(count, 0u);
+}
+
+TEST_F(BuniCTest, BatchMatchesSingleCalls) {
+    buni_parser* single = buni_parser_create();
+    ASSERT_EQ(buni_register_pair(single, 1), BUNI_OK);
+    ASSERT_EQ(buni_register_pair(handle, 2), BUNI_OK);
+    ASSERT_EQ(buni_register_pair(single, 2), BUNI_OK);
+
+    std::vector<char> batch;
+    for (int i = 0; i < 20; i++) {
+        PAIR_ID pair = 1 + i % 2;
+        std::vector<char> frame = serializeSnapshot(
+            pair, 1000 + i, {makeBookElement(100.0 - i % 3, 10 + i), makeBookElement(98.0, 5)},
+            {makeBookElement(101.0 + i % 4, 7)});
+        ASSERT_GE(buni_apply_snapshot(single, frame.data(), frame.size()), 0);
+        batch.insert(batch.end(), frame.begin(), frame.end());
+    }
+    size_t applied = 0;
+    EXPECT_EQ(buni_apply_snapshots(handle, batch.data(), batch.size(), &applied), 20);
+    EXPECT_EQ(applied, 20u);
+
+    size_t batchCount = 0, singleCount = 0;
+    const buni_order* batchEvents = buni_events(handle, &batchCount);
+    const buni_order* singleEvents = buni_events(single, &singleCount);
+    ASSERT_EQ(batchCount, singleCount);
+    for (size_t i = 0; i < batchCount; i++) {
+        EXPECT_EQ(batchEvents[i].pair_id, singleEvents[i].pair_id);
+        EXPECT_DOUBLE_EQ(batchEvents[i].price, singleEvents[i].price);
+        EXPECT_EQ(batchEvents[i].qty, singleEvents[i].qty);
+        EXPECT_EQ(batchEvents[i].action, singleEvents[i].action);
+    }
+    buni_parser_destroy(single);
+}
+
+TEST_F(BuniCTest, CallbackReceivesEachSnapshot) {
+    struct Sink {
+        std::vector<int64_t> pairs;
+        size_t events = 0;
+    } sink;
+    buni_set_event_callback(handle, [](void* user, int64_t pairId, const buni_order* events, size_t count) {
+        Sink* s = static_cast<Sink*>(user);
+        s->pairs.push_back(pairId);
+        s->events += count;
+        EXPECT_EQ(events[0].pair_id, pairId);
+    }, &sink);
+
+    std::vector<char> first = serializeSnapshot(1, 1000, {makeBookElement(100.0, 10)}, {makeBookElement(101.0, 5)});
+    std::vector<char> second = serializeSnapshot(1, 1001, {makeBookElement(100.0, 12)}, {makeBookElement(101.0, 5)});
+    std::vector<char> batch(first);
+    batch.insert(batch.end(), second.begin(), second.end());
+    batch.insert(batch.end(), second.begin(), second.end());   // unchanged: no events, no call
+
+    EXPECT_EQ(buni_apply_snapshots(handle, batch.data(), batch.size(), nullptr), 3);
+    EXPECT_EQ(sink.pairs.size(), 2u);
+    size_t count = 0;
+    buni_events(handle, &count);
+    EXPECT_EQ(sink.events, count);
+}
+
+TEST_F(BuniCTest, ReportsErrors) {
+    EXPECT_EQ(buni_register_pair(handle, 1), BUNI_E_EXISTS);
+    EXPECT_EQ(buni_apply_snapshot(nullptr, "", 0), BUNI_E_ARGUMENT);
+
+    std::vector<char> unknown = serializeSnapshot(9, 1000, {makeBookElement(100.0, 10)}, {});
+    EXPECT_EQ(buni_apply_snapshot(handle, unknown.data(), unknown.size()), BUNI_E_UNKNOWN_PAIR);
+
+    buni_pair_config config = {};
+    EXPECT_EQ(buni_configure_pair(handle, 9, &config), BUNI_E_UNKNOWN_PAIR);
+    config.net_events = 1;
+    config.tick_size = 0.5;
+    EXPECT_EQ(buni_configure_pair(handle, 1, &config), BUNI_OK);
+
+    // A truncated frame stops the batch after the good ones
+    std::vector<char> good = serializeSnapshot(1, 1000, {makeBookElement(100.0, 10)}, {makeBookElement(100.5, 3)});
+    std::vector<char> batch(good);
+    batch.insert(batch.end(), good.begin(), good.end() - 4);
+    size_t applied = 0;
+    EXPECT_EQ(buni_apply_snapshots(handle, batch.data(), batch.size(), &applied), BUNI_E_MALFORMED);
+    EXPECT_EQ(applied, 1u);
+}
+
+TEST_F(BuniCTest, ExceptionsBecomeStatusCodes) {
+    // A throwing callback stands in for any exception below the C ABI
+    int thrown = 0;
+    buni_set_event_callback(handle, [](void* user, int64_t, const buni_order*, size_t) {
+        if ((*static_cast<int*>(user))++ == 0) throw std::bad_alloc();
+        throw std::runtime_error("callback failed");
+    }, &thrown);
+
+    std::vector<char> first = serializeSnapshot(1, 1000, {makeBookElement(100.0, 10)}, {});
+    std::vector<char> second = serializeSnapshot(1, 1001, {makeBookElement(100.0, 12)}, {});
+    EXPECT_EQ(buni_apply_snapshot(handle, first.data(), first.size()), BUNI_E_NO_MEMORY);
+    size_t applied = 0;
+    EXPECT_EQ(buni_apply_snapshots(handle, second.data(), second.size(), &applied), BUNI_E_INTERNAL);
+    EXPECT_EQ(applied, 0u);
+    EXPECT_EQ(thrown, 2);
+}
@@ -0,0 +1,169 @@
+#include "test_common.h"
+#include <cmath>
+#include <map>
+#include <random>
+
+class ConsolidatedBookTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        parser = std::make_unique<SeekerNetBoonSnapshotParserToTBT>(std::vector<PAIR_ID>{1, 2, 3});
+        ASSERT_TRUE(parser->SetConsolidationGroup(100, {1, 2, 3}));
+    }
+
+    // Consolidated book rebuilt by a consumer of the consolidated events
+    void replay(const std::vector<Order>& orders) {
+        for (const Order& order : orders) {
+            ASSERT_EQ(order.pairId, 100);
+            bool buyBook = order.type == ORDER_TYPE::MARKET ? order.side == ORDER_SIDE::SELL
+                                                            : order.side == ORDER_SIDE::BUY;
+            int64_t qty = order.action == ORDER_ACTION::REMOVE || order.type == ORDER_TYPE::MARKET
+                              ? -static_cast<int64_t>(order.qty) : order.qty;
+            auto& levels = buyBook ? replayBids : replayAsks;
+            int64_t key = std::llround(order.price * 10000);
+            if ((levels[key] += qty) == 0) levels.erase(key);
+        }
+    }
+
+    void expectReplayMatchesMerge(ORDER_SIDE side) {
+        std::vector<bookElement> merged;
+        parser->getConsolidatedBook(100, side, 0, merged);
+        const auto& levels = side == ORDER_SIDE::BUY ? replayBids : replayAsks;
+        ASSERT_EQ(merged.size(), levels.size());
+        for (const auto& level : merged) {
+            auto it = levels.find(std::llround(level.price * 10000));
+            ASSERT_NE(it, levels.end()) << level.price;
+            EXPECT_EQ(it->second, level.qty) << level.price;
+        }
+    }
+
+    std::unique_ptr<SeekerNetBoonSnapshotParserToTBT> parser;
+    std::map<int64_t, int64_t> replayBids, replayAsks;
+};
+
+TEST(VenueTournamentTest, BestAcrossVenuesSumsTies) {
+    VenueTournament bids;
+    bids.configure(3, true);
+    EXPECT_EQ(bids.best().qty, 0);
+    bids.update(0, 100.0, 5);
+    bids.update(2, 101.0, 7);
+    EXPECT_DOUBLE_EQ(bids.best().price, 101.0);
+    EXPECT_EQ(bids.best().qty, 7);
+    bids.update(1, 101.0, 3);
+    EXPECT_EQ(bids.best().qty, 10);
+    bids.update(2, 0, 0);
+    bids.update(1, 0, 0);
+    EXPECT_DOUBLE_EQ(bids.best().price, 100.0);
+    EXPECT_EQ(bids.best().qty, 5);
+}
+
+TEST(MergeVenueBooksTest, SumsEqualPricesInOrder) {
+    BookSide a = {makeBookElement(101.0, 1), makeBookElement(99.0, 2)};
+    BookSide b = {makeBookElement(100.0, 4), makeBookElement(99.0, 8), makeBookElement(98.0, 16)};
+    BookSide empty;
+    std::vector<bookElement> out;
+    mergeVenueBooks({&a, &b, &empty}, true, 0, out);
+    ASSERT_EQ(out.size(), 4u);
+    EXPECT_DOUBLE_EQ(out[0].price, 101.0);
+    EXPECT_DOUBLE_EQ(out[1].price, 100.0);
+    EXPECT_DOUBLE_EQ(out[2].price, 99.0);
+    EXPECT_EQ(out[2].qty, 10);
+    EXPECT_DOUBLE_EQ(out[3].price, 98.0);
+
+    mergeVenueBooks({&a, &b}, true, 3, out);
+    ASSERT_EQ(out.size(), 3u);
+    EXPECT_EQ(out[2].qty, 10);
+}
+
+TEST_F(ConsolidatedBookTest, RejectsInvalidGroups) {
+    SeekerNetBoonSnapshotParserToTBT other({1, 2, 3});
+    EXPECT_FALSE(other.SetConsolidationGroup(1, {2, 3}));     // id of a pair
+    EXPECT_FALSE(other.SetConsolidationGroup(100, {}));
+    EXPECT_FALSE(other.SetConsolidationGroup(100, {2, 9}));   // unknown member
+    EXPECT_FALSE(other.SetConsolidationGroup(100, {2, 2}));
+    EXPECT_TRUE(other.SetConsolidationGroup(100, {1, 2}));
+    EXPECT_FALSE(other.SetConsolidationGroup(100, {3}));      // existing group
+    EXPECT_FALSE(other.SetConsolidationGroup(101, {2, 3}));   // 2 already grouped
+}
+
+TEST_F(ConsolidatedBookTest, NbboTracksBestVenue) {
+    std::vector<bookElement> bids = {makeBookElement(100.0, 10)};
+    std::vector<bookElement> asks = {makeBookElement(102.0, 5)};
+    parser->ApplySnapshot(1, bids, asks, 1000);
+    ASSERT_EQ(parser->getNbboUpdates().size(), 1u);
+
+    bids = {makeBookElement(100.0, 4)};
+    asks = {makeBookElement(101.0, 6)};
+    parser->ApplySnapshot(2, bids, asks, 1001);
+    const Bbo& nbbo = parser->getNbbo(100);
+    EXPECT_EQ(nbbo.pairId, 100);
+    EXPECT_EQ(nbbo.time, 1001u);
+    EXPECT_DOUBLE_EQ(nbbo.bidPrice, 100.0);
+    EXPECT_EQ(nbbo.bidQty, 14);
+    EXPECT_DOUBLE_EQ(nbbo.askPrice, 101.0);
+    EXPECT_EQ(nbbo.askQty, 6);
+    EXPECT_EQ(parser->getNbboUpdates().size(), 2u);
+
+    // A venue away from the top does not move the NBBO
+    parser->clearEmittedOrders();
+    bids = {makeBookElement(98.0, 1)};
+    asks = {makeBookElement(104.0, 1)};
+    parser->ApplySnapshot(3, bids, asks, 1002);
+    EXPECT_TRUE(parser->getNbboUpdates().empty());
+    EXPECT_EQ(parser->getConsolidatedOrders().size(), 2u);
+}
+
+TEST_F(ConsolidatedBookTest, MemberStreamsAreUnchanged) {
+    std::vector<bookElement> bids = {makeBookElement(100.0, 10)};
+    std::vector<bookElement> asks = {makeBookElement(101.0, 5)};
+    parser->ApplySnapshot(1, bids, asks, 1000);
+    for (const Order& order : parser->getEmittedOrders()) EXPECT_EQ(order.pairId, 1);
+    for (const Order& order : parser->getConsolidatedOrders()) {
+        EXPECT_EQ(order.pairId, 100);
+        EXPECT_EQ(order.time, 1000u);
+    }
+}
+
+TEST_F(ConsolidatedBookTest, ReplayMatchesMergedBook) {
+    PairConfig netted;
+    netted.netEvents = true;
+    parser->SetPairConfig(2, netted);
+    PairConfig ladder;
+    ladder.layout = BOOK_LAYOUT::PRICE_LADDER;
+    ladder.tickSize = 0.5;
+    parser->SetPairConfig(3, ladder);
+
+    std::mt19937 rng(23);
+    for (int round = 0; round < 300; round++) {
+        PAIR_ID venue = 1 + static_cast<PAIR_ID>(rng() % 3);
+        if (rng() % 4 == 0 && !parser->getBuySide(venue).empty()) {
+            const auto& side = parser->getBuySide(venue);
+            parser->EmitMarketOrderAndUpdateBuyBook(venue, 1 + static_cast<int>(rng() % 30),
+                                                    side[rng() % side.size()].price, round);
+        } else {
+            double mid = 100.0 + static_cast<int>(rng() % 4);
+            bool crossed = rng() % 10 == 0;
+            std::vector<bookElement> b, s;
+            double price = mid - 0.5;
+            for (int i = 1 + static_cast<int>(rng() % 6); i > 0; i--) {
+                b.push_back(makeBookElement(price, 1 + static_cast<int>(rng() % 20)));
+                price -= 0.5 * (1 + rng() % 2);
+            }
+            price = crossed ? mid - 1.0 : mid + 0.5;
+            for (int i = 1 + static_cast<int>(rng() % 6); i > 0; i--) {
+                s.push_back(makeBookElement(price, 1 + static_cast<int>(rng() % 20)));
+                price += 0.5 * (1 + rng() % 2);
+            }
+            parser->ApplySnapshot(venue, b, s, round);
+        }
+
+        SCOPED_TRACE(round);
+        replay(parser->getConsolidatedOrders());
+        expectReplayMatchesMerge(ORDER_SIDE::BUY);
+        expectReplayMatchesMerge(ORDER_SIDE::SELL);
+
+        std::vector<bookElement> top;
+        parser->getConsolidatedBook(100, ORDER_SIDE::BUY, 1, top);
+        EXPECT_EQ(parser->getNbbo(100).bidQty, top.empty() ? 0 : top[0].qty);
+        parser->clearEmittedOrders();
+    }
+}
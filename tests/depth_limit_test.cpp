@@ -0,0 +1,112 @@
+#include "test_common.h"
+#include "src/wire_format.h"
+
+class DepthLimitTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        parser = std::make_unique<SeekerNetBoonSnapshotParserToTBT>(std::vector<PAIR_ID>{1});
+        PairConfig config;
+        config.maxDepth = 3;
+        parser->SetPairConfig(1, config);
+    }
+
+    static std::vector<bookElement> bidLadder(double top, int levels, int qty = 10) {
+        std::vector<bookElement> book;
+        for (int i = 0; i < levels; i++) book.push_back(makeBookElement(top - i, qty));
+        return book;
+    }
+
+    std::unique_ptr<SeekerNetBoonSnapshotParserToTBT> parser;
+};
+
+TEST_F(DepthLimitTest, IncomingBookTruncatedToMaxDepth) {
+    std::vector<bookElement> book = bidLadder(100.0, 10);
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book, 1000);
+
+    auto& side = parser->getBuySide(1);
+    ASSERT_EQ(side.size(), 3u);
+    EXPECT_DOUBLE_EQ(side[0].price, 100.0);
+    EXPECT_DOUBLE_EQ(side[2].price, 98.0);
+    EXPECT_EQ(parser->getEmittedOrders().size(), 3u);
+}
+
+TEST_F(DepthLimitTest, LevelsPushedOutOfViewAreNotRemoved) {
+    std::vector<bookElement> book1 = bidLadder(100.0, 10);
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book1, 1000);
+    parser->clearEmittedOrders();
+
+    // Price moves up one tick: 98 falls off the visible top 3
+    std::vector<bookElement> book2 = bidLadder(101.0, 10);
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book2, 2000);
+
+    auto& side = parser->getBuySide(1);
+    ASSERT_EQ(side.size(), 3u);
+    EXPECT_DOUBLE_EQ(side[0].price, 101.0);
+    EXPECT_DOUBLE_EQ(side[2].price, 99.0);
+
+    for (const auto& order : parser->getEmittedOrders()) {
+        EXPECT_NE(order.action, ORDER_ACTION::REMOVE) << "out-of-view level at " << order.price;
+    }
+}
+
+TEST_F(DepthLimitTest, ThinBookStillEmitsRemoves) {
+    std::vector<bookElement> book1 = bidLadder(100.0, 3);
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book1, 1000);
+    parser->clearEmittedOrders();
+
+    std::vector<bookElement> emptyBook;
+    parser->EmitOrdersAndUpdateOldBuyBook(1, emptyBook, 2000);
+
+    EXPECT_TRUE(parser->getBuySide(1).empty());
+    EXPECT_EQ(parser->getEmittedOrders().size(), 3u);
+}
+
+TEST_F(DepthLimitTest, SellSideTruncatedToBestLevels) {
+    std::vector<bookElement> book;
+    for (int i = 0; i < 10; i++) book.push_back(makeBookElement(101.0 + i, 10));
+    parser->EmitOrdersAndUpdateOldSellBook(1, book, 1000);
+
+    auto& side = parser->getSellSide(1);
+    ASSERT_EQ(side.size(), 3u);
+    EXPECT_DOUBLE_EQ(side[0].price, 101.0);
+    EXPECT_DOUBLE_EQ(side[2].price, 103.0);
+}
+
+TEST_F(DepthLimitTest, LoweringMaxDepthTrimsExistingBookSilently) {
+    PairConfig unlimited;
+    parser->SetPairConfig(1, unlimited);
+    std::vector<bookElement> book1 = bidLadder(100.0, 10);
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book1, 1000);
+    ASSERT_EQ(parser->getBuySide(1).size(), 10u);
+
+    PairConfig limited;
+    limited.maxDepth = 2;
+    parser->SetPairConfig(1, limited);
+    parser->clearEmittedOrders();
+    std::vector<bookElement> book2 = bidLadder(100.0, 10);
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book2, 2000);
+
+    EXPECT_EQ(parser->getBuySide(1).size(), 2u);
+    EXPECT_TRUE(parser->getEmittedOrders().empty());
+}
+
+TEST(DepthLimitWireTest, DeserializeDecodesOnlyBestLevels) {
+    std::vector<bookElement> bids, asks;
+    for (int i = 0; i < 6; i++) {
+        bids.push_back(makeBookElement(100.0 - i, 10 + i));
+        asks.push_back(makeBookElement(101.0 + i, 20 + i));
+    }
+    std::vector<char> frame = serializeSnapshot(1, 1000, bids, asks);
+
+    PAIR_ID pairId;
+    ORDER_TIME time;
+    std::vector<bookElement> outBids, outAsks;
+    ASSERT_TRUE(deserializeSnapshot(frame.data(), frame.size(), pairId, time, outBids, outAsks, 2));
+    ASSERT_EQ(outBids.size(), 2u);
+    ASSERT_EQ(outAsks.size(), 2u);
+    EXPECT_DOUBLE_EQ(outBids[1].price, 99.0);
+    EXPECT_DOUBLE_EQ(outAsks[0].price, 101.0);
+    EXPECT_EQ(outAsks[1].qty, 21);
+
+    EXPECT_FALSE(deserializeSnapshot(frame.data(), frame.size() - 1, pairId, time, outBids, outAsks, 2));
+}
@@ -0,0 +1,101 @@
+#include "test_common.h"
+
+class DiffStatsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        parser = std::make_unique<SeekerNetBoonSnapshotParserToTBT>(std::vector<PAIR_ID>{1, 2});
+    }
+    std::unique_ptr<SeekerNetBoonSnapshotParserToTBT> parser;
+};
+
+TEST_F(DiffStatsTest, UnknownPairThrows) {
+    EXPECT_THROW(parser->getDiffStats(999), std::out_of_range);
+    EXPECT_THROW(parser->resetDiffStats(999), std::out_of_range);
+}
+
+TEST_F(DiffStatsTest, InitiallyZero) {
+    const DiffStats& stats = parser->getDiffStats(1);
+    EXPECT_EQ(stats.sidesDiffed, 0u);
+    EXPECT_EQ(stats.dequeInserts, 0u);
+    EXPECT_EQ(stats.loopIterations, 0u);
+}
+
+#ifdef BUNI_DIFF_STATS
+
+TEST_F(DiffStatsTest, InitialBuildCountsInsertsAndSeekerAdds) {
+    std::vector<bookElement> newBook = {
+        makeBookElement(100.0, 50),
+        makeBookElement(99.0, 30)
+    };
+    parser->EmitOrdersAndUpdateOldBuyBook(1, newBook, 1000);
+
+    const DiffStats& stats = parser->getDiffStats(1);
+    EXPECT_EQ(stats.sidesDiffed, 1u);
+    EXPECT_EQ(stats.dequeInserts, 2u);
+    EXPECT_EQ(stats.seekerAdds, 1u);
+    EXPECT_EQ(stats.loopIterations, 0u);
+}
+
+TEST_F(DiffStatsTest, QtyOnlyChangeCounted) {
+    std::vector<bookElement> book1 = {makeBookElement(100.0, 50), makeBookElement(99.0, 30)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book1, 1000);
+    parser->resetDiffStats(1);
+
+    std::vector<bookElement> book2 = {makeBookElement(100.0, 50), makeBookElement(99.0, 40)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book2, 2000);
+
+    const DiffStats& stats = parser->getDiffStats(1);
+    EXPECT_EQ(stats.qtyChanges, 1u);
+    EXPECT_EQ(stats.dequeInserts, 0u);
+    EXPECT_EQ(stats.dequeErases, 0u);
+    EXPECT_EQ(stats.levelsVisited, 1u);
+    EXPECT_GE(stats.loopIterations, 1u);
+    EXPECT_GE(stats.maxIterationsPerLevel, 1u);
+    EXPECT_EQ(stats.guardTrips, 0u);
+}
+
+TEST_F(DiffStatsTest, WorseTopLevelCountsFrontPop) {
+    std::vector<bookElement> book1 = {makeBookElement(100.0, 50), makeBookElement(99.0, 30)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book1, 1000);
+    parser->resetDiffStats(1);
+
+    std::vector<bookElement> book2 = {makeBookElement(99.0, 30), makeBookElement(98.0, 20)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book2, 2000);
+
+    const DiffStats& stats = parser->getDiffStats(1);
+    EXPECT_EQ(stats.frontPops, 1u);
+    EXPECT_EQ(stats.dequeInserts, 1u);
+}
+
+TEST_F(DiffStatsTest, ClearingBookCountsErases) {
+    std::vector<bookElement> book1 = {makeBookElement(100.0, 50), makeBookElement(99.0, 30)};
+    parser->EmitOrdersAndUpdateOldSellBook(1, book1, 1000);
+    parser->resetDiffStats(1);
+
+    std::vector<bookElement> emptyBook;
+    parser->EmitOrdersAndUpdateOldSellBook(1, emptyBook, 2000);
+
+    EXPECT_EQ(parser->getDiffStats(1).dequeErases, 2u);
+}
+
+TEST_F(DiffStatsTest, StatsArePerPair) {
+    std::vector<bookElement> book = {makeBookElement(100.0, 50)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book, 1000);
+
+    EXPECT_EQ(parser->getDiffStats(1).sidesDiffed, 1u);
+    EXPECT_EQ(parser->getDiffStats(2).sidesDiffed, 0u);
+}
+
+#else
+
+TEST_F(DiffStatsTest, DisabledStatsStayZero) {
+    std::vector<bookElement> book = {makeBookElement(100.0, 50), makeBookElement(99.0, 30)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book, 1000);
+
+    const DiffStats& stats = parser->getDiffStats(1);
+    EXPECT_EQ(stats.sidesDiffed, 0u);
+    EXPECT_EQ(stats.dequeInserts, 0u);
+    EXPECT_EQ(stats.seekerAdds, 0u);
+}
+
+#endif
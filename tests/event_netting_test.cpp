@@ -0,0 +1,135 @@
+#include "test_common.h"
+#include <map>
+#include <random>
+
+class EventNettingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        parser = std::make_unique<SeekerNetBoonSnapshotParserToTBT>(std::vector<PAIR_ID>{1, 2});
+        PairConfig config;
+        config.netEvents = true;
+        parser->SetPairConfig(1, config);
+    }
+
+    static std::map<double, ORDER_QTY> toMap(const BookSide& book) {
+        std::map<double, ORDER_QTY> levels;
+        for (const auto& level : book) levels[level.price] = level.qty;
+        return levels;
+    }
+
+    std::unique_ptr<SeekerNetBoonSnapshotParserToTBT> parser;
+};
+
+TEST_F(EventNettingTest, DisabledByDefault) {
+    EXPECT_FALSE(parser->getPairConfig(2).netEvents);
+    EXPECT_TRUE(parser->getPairConfig(1).netEvents);
+    EXPECT_THROW(parser->SetPairConfig(999, PairConfig{}), std::out_of_range);
+}
+
+TEST_F(EventNettingTest, QtyChangeBecomesModifyWithRestingQty) {
+    std::vector<bookElement> book1 = {makeBookElement(100.0, 50), makeBookElement(99.0, 30)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book1, 1000);
+    parser->clearEmittedOrders();
+
+    std::vector<bookElement> book2 = {makeBookElement(100.0, 50), makeBookElement(99.0, 45)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book2, 2000);
+
+    auto& emitted = parser->getEmittedOrders();
+    ASSERT_EQ(emitted.size(), 1u);
+    EXPECT_EQ(emitted[0].action, ORDER_ACTION::MODIFY);
+    EXPECT_DOUBLE_EQ(emitted[0].price, 99.0);
+    EXPECT_EQ(emitted[0].qty, 45);
+    EXPECT_EQ(emitted[0].type, ORDER_TYPE::LIMIT);
+    EXPECT_EQ(emitted[0].side, ORDER_SIDE::BUY);
+}
+
+TEST_F(EventNettingTest, UnnettedPairStillEmitsDeltas) {
+    std::vector<bookElement> book1 = {makeBookElement(100.0, 50), makeBookElement(99.0, 30)};
+    parser->EmitOrdersAndUpdateOldBuyBook(2, book1, 1000);
+    parser->clearEmittedOrders();
+
+    std::vector<bookElement> book2 = {makeBookElement(100.0, 50), makeBookElement(99.0, 45)};
+    parser->EmitOrdersAndUpdateOldBuyBook(2, book2, 2000);
+
+    auto& emitted = parser->getEmittedOrders();
+    ASSERT_EQ(emitted.size(), 1u);
+    EXPECT_EQ(emitted[0].action, ORDER_ACTION::ADD);
+    EXPECT_EQ(emitted[0].qty, 15);
+}
+
+TEST_F(EventNettingTest, NewLevelsKeepSeekerAndFullQty) {
+    std::vector<bookElement> book = {makeBookElement(100.0, 50), makeBookElement(99.0, 30)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book, 1000);
+
+    auto& emitted = parser->getEmittedOrders();
+    ASSERT_EQ(emitted.size(), 2u);
+    EXPECT_EQ(emitted[0].action, ORDER_ACTION::SEEKER_ADD);
+    EXPECT_EQ(emitted[0].qty, 50);
+    EXPECT_EQ(emitted[1].action, ORDER_ACTION::ADD);
+    EXPECT_EQ(emitted[1].qty, 30);
+}
+
+TEST_F(EventNettingTest, ClearedLevelsBecomeRemoveWithOldQty) {
+    std::vector<bookElement> book = {makeBookElement(100.0, 50), makeBookElement(99.0, 30)};
+    parser->EmitOrdersAndUpdateOldSellBook(1, book, 1000);
+    parser->clearEmittedOrders();
+
+    std::vector<bookElement> emptyBook;
+    parser->EmitOrdersAndUpdateOldSellBook(1, emptyBook, 2000);
+
+    auto& emitted = parser->getEmittedOrders();
+    ASSERT_EQ(emitted.size(), 2u);
+    for (const auto& order : emitted) {
+        EXPECT_EQ(order.action, ORDER_ACTION::REMOVE);
+    }
+    EXPECT_EQ(emitted[0].qty + emitted[1].qty, 80);
+}
+
+TEST_F(EventNettingTest, UnchangedSnapshotEmitsNothing) {
+    std::vector<bookElement> book = {makeBookElement(100.0, 50), makeBookElement(99.0, 30)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book, 1000);
+    parser->clearEmittedOrders();
+
+    std::vector<bookElement> same = book;
+    parser->EmitOrdersAndUpdateOldBuyBook(1, same, 2000);
+    EXPECT_TRUE(parser->getEmittedOrders().empty());
+}
+
+TEST_F(EventNettingTest, NettedEventsReplayToParserBook) {
+    std::mt19937 rng(7);
+    for (int round = 0; round < 500; round++) {
+        bool buySide = (round % 2) == 0;
+        std::vector<bookElement> book;
+        int levels = static_cast<int>(rng() % 8);
+        double price = 100.0 + static_cast<int>(rng() % 5);
+        for (int i = 0; i < levels; i++) {
+            price -= 1.0 + static_cast<int>(rng() % 2);
+            double p = buySide ? price : 200.0 - price;
+            book.push_back(makeBookElement(p, 1 + static_cast<int>(rng() % 5)));
+        }
+
+        const BookSide& side = buySide ? parser->getBuySide(1) : parser->getSellSide(1);
+        std::map<double, ORDER_QTY> replay = toMap(side);
+
+        parser->clearEmittedOrders();
+        if (buySide) parser->EmitOrdersAndUpdateOldBuyBook(1, book, round);
+        else parser->EmitOrdersAndUpdateOldSellBook(1, book, round);
+
+        std::map<double, int> eventsPerPrice;
+        for (const auto& order : parser->getEmittedOrders()) {
+            ASSERT_EQ(++eventsPerPrice[order.price], 1) << "duplicate event at " << order.price;
+            if (order.action == ORDER_ACTION::REMOVE) {
+                ASSERT_EQ(replay.count(order.price), 1u);
+                EXPECT_EQ(replay[order.price], order.qty);
+                replay.erase(order.price);
+            } else if (order.action == ORDER_ACTION::MODIFY) {
+                ASSERT_EQ(replay.count(order.price), 1u);
+                replay[order.price] = order.qty;
+            } else {
+                EXPECT_EQ(replay.count(order.price), 0u);
+                replay[order.price] = order.qty;
+            }
+        }
+        EXPECT_EQ(replay, toMap(side));
+    }
+}
@@ -0,0 +1,171 @@
+#include "test_common.h"
+#include "src/wire_format.h"
+#include <random>
+
+class FingerprintTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        parser = std::make_unique<SeekerNetBoonSnapshotParserToTBT>(std::vector<PAIR_ID>{1});
+    }
+
+    void enableSkip(uint32_t verifyEvery = 0) {
+        PairConfig config;
+        config.skipUnchangedSides = true;
+        config.verifyEvery = verifyEvery;
+        parser->SetPairConfig(1, config);
+    }
+
+    void expectHashesMatchBook() {
+        EXPECT_EQ(parser->getBookHash(1, ORDER_SIDE::BUY), bookSideHash(parser->getBuySide(1)));
+        EXPECT_EQ(parser->getBookHash(1, ORDER_SIDE::SELL), bookSideHash(parser->getSellSide(1)));
+    }
+
+    std::unique_ptr<SeekerNetBoonSnapshotParserToTBT> parser;
+};
+
+TEST_F(FingerprintTest, EmptyBookHashesToZero) {
+    EXPECT_EQ(parser->getBookHash(1, ORDER_SIDE::BUY), 0u);
+    EXPECT_EQ(parser->getBookHash(1, ORDER_SIDE::SELL), 0u);
+}
+
+TEST_F(FingerprintTest, LevelHashIgnoresSignOfZeroAndOrder) {
+    EXPECT_EQ(bookLevelHash(0.0, 5), bookLevelHash(-0.0, 5));
+    EXPECT_NE(bookLevelHash(100.0, 5), bookLevelHash(100.0, 6));
+    EXPECT_NE(bookLevelHash(100.0, 5), bookLevelHash(101.0, 5));
+
+    std::vector<bookElement> a = {makeBookElement(100.0, 5), makeBookElement(99.0, 7)};
+    std::vector<bookElement> b = {makeBookElement(99.0, 7), makeBookElement(100.0, 5)};
+    EXPECT_EQ(bookSideHash(a), bookSideHash(b));
+}
+
+TEST_F(FingerprintTest, HashTracksBookThroughDiffsAndMarketOrders) {
+    std::mt19937 rng(11);
+    for (int round = 0; round < 400; round++) {
+        std::vector<bookElement> bids, asks;
+        int levels = static_cast<int>(rng() % 8);
+        for (int i = 0; i < levels; i++) {
+            bids.push_back(makeBookElement(100.0 - i - static_cast<int>(rng() % 2), 1 + static_cast<int>(rng() % 5)));
+            asks.push_back(makeBookElement(101.0 + i + static_cast<int>(rng() % 2), 1 + static_cast<int>(rng() % 5)));
+        }
+        parser->EmitOrdersAndUpdateOldBuyBook(1, bids, round);
+        parser->EmitOrdersAndUpdateOldSellBook(1, asks, round);
+        expectHashesMatchBook();
+
+        const BookSide& buy = parser->getBuySide(1);
+        if (!buy.empty()) {
+            parser->EmitMarketOrderAndUpdateBuyBook(1, 1 + static_cast<int>(rng() % 6), buy.front().price, round);
+            expectHashesMatchBook();
+        }
+        parser->clearEmittedOrders();
+    }
+}
+
+TEST_F(FingerprintTest, HashTracksBookWithDepthLimit) {
+    PairConfig config;
+    config.maxDepth = 3;
+    parser->SetPairConfig(1, config);
+
+    std::vector<bookElement> book1 = {makeBookElement(100.0, 1), makeBookElement(99.0, 2),
+                                      makeBookElement(98.0, 3), makeBookElement(97.0, 4)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book1, 1000);
+    std::vector<bookElement> book2 = {makeBookElement(101.0, 1), makeBookElement(100.0, 1),
+                                      makeBookElement(99.0, 2), makeBookElement(98.0, 3)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book2, 2000);
+    expectHashesMatchBook();
+}
+
+TEST_F(FingerprintTest, UnchangedSideIsSkipped) {
+    enableSkip();
+    std::vector<bookElement> bids = {makeBookElement(100.0, 10), makeBookElement(99.0, 20)};
+    std::vector<bookElement> asks = {makeBookElement(101.0, 10)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, bids, 1000);
+    parser->EmitOrdersAndUpdateOldSellBook(1, asks, 1000);
+    parser->clearEmittedOrders();
+
+    std::vector<bookElement> newBids = {makeBookElement(100.0, 15), makeBookElement(99.0, 20)};
+    std::vector<bookElement> sameAsks = asks;
+    parser->EmitOrdersAndUpdateOldBuyBook(1, newBids, 2000);
+    parser->EmitOrdersAndUpdateOldSellBook(1, sameAsks, 2000);
+
+    EXPECT_EQ(parser->getFingerprintStats(1).sidesSkipped, 1u);
+    ASSERT_EQ(parser->getEmittedOrders().size(), 1u);
+    EXPECT_EQ(parser->getEmittedOrders()[0].side, ORDER_SIDE::BUY);
+    EXPECT_EQ(parser->getBuySide(1).front().qty, 15);
+}
+
+TEST_F(FingerprintTest, SkipDisabledByDefault) {
+    std::vector<bookElement> bids = {makeBookElement(100.0, 10)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, bids, 1000);
+    std::vector<bookElement> same = bids;
+    parser->EmitOrdersAndUpdateOldBuyBook(1, same, 2000);
+
+    EXPECT_EQ(parser->getFingerprintStats(1).sidesSkipped, 0u);
+}
+
+TEST_F(FingerprintTest, VerificationSamplesMatches) {
+    enableSkip(3);
+    std::vector<bookElement> bids = {makeBookElement(100.0, 10), makeBookElement(99.0, 20)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, bids, 1000);
+    for (int i = 0; i < 9; i++) {
+        std::vector<bookElement> same = bids;
+        parser->EmitOrdersAndUpdateOldBuyBook(1, same, 2000 + i);
+    }
+
+    const FingerprintStats& stats = parser->getFingerprintStats(1);
+    EXPECT_EQ(stats.verifications, 3u);
+    EXPECT_EQ(stats.sidesSkipped, 6u);
+    EXPECT_EQ(stats.collisions, 0u);
+}
+
+TEST_F(FingerprintTest, VerificationCatchesWrongFingerprint) {
+    enableSkip(1);
+    std::vector<bookElement> bids = {makeBookElement(100.0, 10)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, bids, 1000);
+    parser->clearEmittedOrders();
+
+    // Caller-supplied hash claims nothing changed
+    std::vector<bookElement> changed = {makeBookElement(100.0, 12)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, changed, 2000, parser->getBookHash(1, ORDER_SIDE::BUY));
+
+    EXPECT_EQ(parser->getFingerprintStats(1).collisions, 1u);
+    EXPECT_EQ(parser->getBuySide(1).front().qty, 12);
+    EXPECT_FALSE(parser->getEmittedOrders().empty());
+    expectHashesMatchBook();
+}
+
+TEST_F(FingerprintTest, DeserializeComputesSideHashes) {
+    std::vector<bookElement> bids = {makeBookElement(100.0, 10), makeBookElement(99.0, 20), makeBookElement(98.0, 30)};
+    std::vector<bookElement> asks = {makeBookElement(101.0, 5)};
+    std::vector<char> frame = serializeSnapshot(1, 1000, bids, asks);
+
+    PAIR_ID pairId;
+    ORDER_TIME ts;
+    std::vector<bookElement> outBids, outAsks;
+    BookHashes hashes;
+    ASSERT_TRUE(deserializeSnapshot(frame.data(), frame.size(), pairId, ts, outBids, outAsks, 0, &hashes));
+    EXPECT_EQ(hashes.buy, bookSideHash(bids));
+    EXPECT_EQ(hashes.sell, bookSideHash(asks));
+
+    ASSERT_TRUE(deserializeSnapshot(frame.data(), frame.size(), pairId, ts, outBids, outAsks, 2, &hashes));
+    EXPECT_EQ(hashes.buy, bookSideHash(outBids));
+}
+
+TEST_F(FingerprintTest, WireHashSkipsRepublishedSnapshot) {
+    enableSkip();
+    std::vector<bookElement> bids = {makeBookElement(100.0, 10), makeBookElement(99.0, 20)};
+    std::vector<bookElement> asks = {makeBookElement(101.0, 5)};
+    std::vector<char> frame = serializeSnapshot(1, 1000, bids, asks);
+
+    for (int i = 0; i < 2; i++) {
+        PAIR_ID pairId;
+        ORDER_TIME ts;
+        std::vector<bookElement> outBids, outAsks;
+        BookHashes hashes;
+        ASSERT_TRUE(deserializeSnapshot(frame.data(), frame.size(), pairId, ts, outBids, outAsks, 0, &hashes));
+        parser->EmitOrdersAndUpdateOldBuyBook(pairId, outBids, ts, hashes.buy);
+        parser->EmitOrdersAndUpdateOldSellBook(pairId, outAsks, ts, hashes.sell);
+    }
+
+    EXPECT_EQ(parser->getFingerprintStats(1).sidesSkipped, 2u);
+    expectHashesMatchBook();
+}
@@ -0,0 +1,190 @@
+#include "test_common.h"
+#include "src/hot_standby.h"
+#include "src/pair_partition.h"
+#include "src/tbt_book_builder.h"
+#include "src/tbt_routing.h"
+#include "src/wire_format.h"
+
+namespace {
+struct Published {
+    std::string subject;
+    std::vector<char> frame;
+};
+
+// What the processor does with one snapshot: buy and sell frames sharing the pair's sequence
+void applyAndFrame(SeekerNetBoonSnapshotParserToTBT& parser, int step, uint64_t& sequence,
+                   std::vector<Published>& out) {
+    std::vector<bookElement> bids = {makeBookElement(100.0 + step, 10 + step), makeBookElement(99.0, 20)};
+    std::vector<bookElement> asks = {makeBookElement(102.0 + step, 5 + step), makeBookElement(103.0, 20)};
+    parser.ApplySnapshot(1, bids, asks, 1000 * (step + 1));
+    std::vector<Order> buys, sells;
+    splitBySide(parser.getEmittedOrders(), buys, sells);
+    if (!buys.empty()) out.push_back({tbtSubject(1, ORDER_SIDE::BUY), serializeOrders(buys, ++sequence)});
+    if (!sells.empty()) out.push_back({tbtSubject(1, ORDER_SIDE::SELL), serializeOrders(sells, ++sequence)});
+    parser.clearEmittedOrders();
+}
+
+uint64_t sequenceOf(const std::vector<char>& frame) {
+    OrderFrameView view;
+    return view.parse(frame.data(), frame.size()) ? view.sequence() : 0;
+}
+
+BookChecksum makeChecksum(ORDER_TIME time, uint64_t hash, uint64_t sequence) {
+    BookChecksum checksum;
+    checksum.pairId = 1;
+    checksum.time = time;
+    checksum.buyHash = hash;
+    checksum.sellHash = hash + 1;
+    checksum.sequence = sequence;
+    return checksum;
+}
+} // namespace
+
+TEST(HotStandbyTest, OutputStreamJoinsTheSidesOfAPair) {
+    EXPECT_EQ(outputStream("orderbook.tbt.7.buy"), "orderbook.tbt.7");
+    EXPECT_EQ(outputStream("orderbook.tbt.7.sell"), "orderbook.tbt.7");
+    EXPECT_EQ(outputStream("orderbook.filtered.7"), "orderbook.filtered.7");
+}
+
+TEST(HotStandbyTest, TakeoverContinuesTheSequenceWithoutGapOrDuplicate) {
+    SeekerNetBoonSnapshotParserToTBT primary({1}), standby({1});
+    uint64_t primarySequence = 0, standbySequence = 0;
+    std::vector<Published> primaryFrames, standbyFrames;
+    for (int step = 0; step < 6; step++) {
+        applyAndFrame(primary, step, primarySequence, primaryFrames);
+        applyAndFrame(standby, step, standbySequence, standbyFrames);
+    }
+    ASSERT_EQ(primaryFrames.size(), standbyFrames.size());
+    ASSERT_GT(primaryFrames.size(), 6u);
+
+    // The primary dies after publishing the first five frames; the standby saw
+    // three of them before computing its own and two after
+    StandbyGate gate;
+    std::vector<Published> consumer(primaryFrames.begin(), primaryFrames.begin() + 5);
+    for (size_t i = 0; i < 3; i++) gate.observe("orderbook.tbt.1", sequenceOf(primaryFrames[i].frame));
+    for (const Published& frame : standbyFrames) {
+        gate.hold(outputStream(frame.subject), frame.subject, sequenceOf(frame.frame),
+                  frame.frame.data(), frame.frame.size());
+    }
+    EXPECT_EQ(gate.held(), standbyFrames.size() - 3);
+    for (size_t i = 3; i < 5; i++) gate.observe("orderbook.tbt.1", sequenceOf(primaryFrames[i].frame));
+    EXPECT_EQ(gate.held(), standbyFrames.size() - 5);
+
+    gate.release([&](const std::string& subject, const std::vector<char>& frame) {
+        consumer.push_back({subject, frame});
+    });
+    EXPECT_EQ(gate.held(), 0u);
+    EXPECT_EQ(gate.published("orderbook.tbt.1"), sequenceOf(primaryFrames[4].frame));
+    ASSERT_EQ(consumer.size(), primaryFrames.size());
+    for (size_t i = 0; i < consumer.size(); i++) {
+        EXPECT_EQ(sequenceOf(consumer[i].frame), i + 1);
+        EXPECT_EQ(consumer[i].subject, primaryFrames[i].subject);
+        EXPECT_EQ(consumer[i].frame, primaryFrames[i].frame);
+    }
+}
+
+TEST(HotStandbyTest, GateDropsFramesThePrimaryIsAheadOf) {
+    StandbyGate gate(2);
+    const char frame[] = "x";
+    gate.observe("s", 5);
+    EXPECT_TRUE(gate.hold("s", "s", 4, frame, 1));
+    EXPECT_TRUE(gate.hold("s", "s", 5, frame, 1));
+    EXPECT_EQ(gate.held(), 0u);
+
+    EXPECT_TRUE(gate.hold("s", "s", 6, frame, 1));
+    EXPECT_TRUE(gate.hold("s", "s", 7, frame, 1));
+    EXPECT_FALSE(gate.hold("s", "s", 8, frame, 1));   // 6 is lost: the pair must be resynced
+    EXPECT_EQ(gate.held(), 2u);
+    EXPECT_EQ(gate.overflowed(), 1u);
+
+    // A resync drops frames computed from the old book, never lowers what the primary published
+    gate.reset("s", 3);
+    EXPECT_EQ(gate.held(), 0u);
+    gate.hold("s", "s", 5, frame, 1);
+    EXPECT_EQ(gate.held(), 0u);
+}
+
+TEST(HotStandbyTest, PairResyncingAtTakeoverRestartsAfterAGap) {
+    SeekerNetBoonSnapshotParserToTBT primary({1}), standby({1});
+    uint64_t primarySequence = 0, standbySequence = 0;
+    std::vector<Published> primaryFrames, standbyFrames;
+    applyAndFrame(primary, 0, primarySequence, primaryFrames);
+    applyAndFrame(standby, 1, standbySequence, standbyFrames);   // missed a snapshot: wrong book
+    for (int step = 1; step < 4; step++) {
+        applyAndFrame(primary, step, primarySequence, primaryFrames);
+        applyAndFrame(standby, step + 1, standbySequence, standbyFrames);
+    }
+
+    TbtBookBuilder consumer;
+    StandbyGate gate;
+    for (const Published& frame : primaryFrames) {
+        ASSERT_EQ(consumer.applyFrame(frame.frame.data(), frame.frame.size()), FRAME_APPLIED);
+    }
+    gate.observe("orderbook.tbt.1", sequenceOf(primaryFrames[0].frame));
+    for (const Published& frame : standbyFrames) {
+        gate.hold(outputStream(frame.subject), frame.subject, sequenceOf(frame.frame),
+                  frame.frame.data(), frame.frame.size());
+    }
+    ASSERT_GT(gate.held(), 0u);
+
+    // The primary dies while the pair waits for its checkpoint: the frames
+    // computed from the wrong book are dropped and the pair restarts empty
+    std::vector<bookElement> empty;
+    standby.LoadBook(1, empty, empty, standby.getLastSnapshotTime(1), SeekerBounds());
+    standbySequence = restartSequence(standbySequence, 1700000000000ull);
+    gate.reset("orderbook.tbt.1", standbySequence);
+    size_t released = 0;
+    gate.release([&](const std::string&, const std::vector<char>&) { released++; });
+    EXPECT_EQ(released, 0u);
+
+    // Its next frames are a gap for the consumer, never duplicates; from an
+    // empty book they rebuild the whole of it
+    std::vector<Published> restarted;
+    applyAndFrame(standby, 5, standbySequence, restarted);
+    ASSERT_FALSE(restarted.empty());
+    EXPECT_EQ(consumer.applyFrame(restarted[0].frame.data(), restarted[0].frame.size()), FRAME_GAP);
+    consumer.resync(1, {}, {});
+    for (const Published& frame : restarted) {
+        EXPECT_NE(consumer.applyFrame(frame.frame.data(), frame.frame.size()), FRAME_DUPLICATE);
+    }
+    EXPECT_EQ(consumer.getBookHash(1, ORDER_SIDE::BUY), standby.getBookHash(1, ORDER_SIDE::BUY));
+    EXPECT_EQ(consumer.getBookHash(1, ORDER_SIDE::SELL), standby.getBookHash(1, ORDER_SIDE::SELL));
+}
+
+TEST(HotStandbyTest, ChecksumsAreComparedAtTheSameSnapshot) {
+    char wire[WIRE_CHECKSUM_SIZE];
+    serializeChecksum(makeChecksum(1000, 7, 3), wire);
+    BookChecksum decoded;
+    ASSERT_TRUE(deserializeChecksum(wire, sizeof(wire), decoded));
+    EXPECT_EQ(decoded.pairId, 1);
+    EXPECT_EQ(decoded.time, 1000u);
+    EXPECT_EQ(decoded.sellHash, 8u);
+    EXPECT_EQ(decoded.sequence, 3u);
+    EXPECT_FALSE(deserializeChecksum(wire, sizeof(wire) - 1, decoded));
+
+    ChecksumVerifier verifier(3);
+    // Standby ahead: compared with its history
+    EXPECT_EQ(verifier.recordLocal(makeChecksum(1000, 7, 3)), CHECKSUM_RESULT::PENDING);
+    EXPECT_EQ(verifier.recordLocal(makeChecksum(2000, 9, 5)), CHECKSUM_RESULT::PENDING);
+    EXPECT_EQ(verifier.checkRemote(makeChecksum(1000, 7, 3)), CHECKSUM_RESULT::MATCH);
+    EXPECT_EQ(verifier.checkRemote(makeChecksum(2000, 9, 6)), CHECKSUM_RESULT::MISMATCH);
+
+    // Primary ahead: waits for the standby to apply the snapshot
+    EXPECT_EQ(verifier.checkRemote(makeChecksum(3000, 11, 7)), CHECKSUM_RESULT::PENDING);
+    EXPECT_EQ(verifier.recordLocal(makeChecksum(3000, 12, 7)), CHECKSUM_RESULT::MISMATCH);
+    EXPECT_EQ(verifier.checkRemote(makeChecksum(4000, 13, 9)), CHECKSUM_RESULT::PENDING);
+    EXPECT_EQ(verifier.recordLocal(makeChecksum(5000, 15, 11)), CHECKSUM_RESULT::UNMATCHED);
+
+    // Older than the history
+    EXPECT_EQ(verifier.checkRemote(makeChecksum(1000, 7, 3)), CHECKSUM_RESULT::UNMATCHED);
+    EXPECT_EQ(verifier.getStats().matched, 1u);
+    EXPECT_EQ(verifier.getStats().mismatched, 2u);
+    EXPECT_EQ(verifier.getStats().unmatched, 2u);
+}
+
+TEST(HotStandbyTest, NewerEpochWinsBetweenTwoPrimaries) {
+    EXPECT_TRUE(yieldsTo(1, "a", 2, "b"));
+    EXPECT_FALSE(yieldsTo(2, "b", 1, "a"));
+    EXPECT_TRUE(yieldsTo(3, "b", 3, "a"));
+    EXPECT_FALSE(yieldsTo(3, "a", 3, "b"));
+}
@@ -0,0 +1,115 @@
+#include "test_common.h"
+#include <random>
+
+class MarketSweepTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        parser = std::make_unique<SeekerNetBoonSnapshotParserToTBT>(std::vector<PAIR_ID>{1});
+        std::vector<bookElement> bids = {makeBookElement(100.0, 10), makeBookElement(99.0, 20),
+                                         makeBookElement(98.0, 30), makeBookElement(97.0, 40)};
+        std::vector<bookElement> asks = {makeBookElement(101.0, 10), makeBookElement(102.0, 20),
+                                         makeBookElement(103.0, 30)};
+        parser->EmitOrdersAndUpdateOldBuyBook(1, bids, 1000);
+        parser->EmitOrdersAndUpdateOldSellBook(1, asks, 1000);
+        parser->clearEmittedOrders();
+    }
+
+    std::unique_ptr<SeekerNetBoonSnapshotParserToTBT> parser;
+};
+
+TEST_F(MarketSweepTest, SweepsLevelsUntilFilled) {
+    parser->EmitMarketOrderAndUpdateBuyBook(1, 35, 98.0, 2000);
+
+    const auto& emitted = parser->getEmittedOrders();
+    ASSERT_EQ(emitted.size(), 3u);
+    EXPECT_DOUBLE_EQ(emitted[0].price, 100.0);
+    EXPECT_EQ(emitted[0].qty, 10);
+    EXPECT_DOUBLE_EQ(emitted[1].price, 99.0);
+    EXPECT_EQ(emitted[1].qty, 20);
+    EXPECT_DOUBLE_EQ(emitted[2].price, 98.0);
+    EXPECT_EQ(emitted[2].qty, 5);
+    for (const auto& order : emitted) {
+        EXPECT_EQ(order.type, ORDER_TYPE::MARKET);
+        EXPECT_EQ(order.side, ORDER_SIDE::SELL);
+    }
+
+    const auto& side = parser->getBuySide(1);
+    ASSERT_EQ(side.size(), 2u);
+    EXPECT_DOUBLE_EQ(side.front().price, 98.0);
+    EXPECT_EQ(side.front().qty, 25);
+}
+
+TEST_F(MarketSweepTest, SweepEndingExactlyOnLevelRemovesIt) {
+    parser->EmitMarketOrderAndUpdateSellBook(1, 30, 102.0, 2000);
+
+    EXPECT_EQ(parser->getEmittedOrders().size(), 2u);
+    ASSERT_EQ(parser->getSellSide(1).size(), 1u);
+    EXPECT_DOUBLE_EQ(parser->getSellSide(1).front().price, 103.0);
+}
+
+TEST_F(MarketSweepTest, ExcessAtOrderPriceLevelIsIceberg) {
+    parser->EmitMarketOrderAndUpdateBuyBook(1, 45, 99.0, 2000);
+
+    const auto& emitted = parser->getEmittedOrders();
+    ASSERT_EQ(emitted.size(), 3u);
+    EXPECT_EQ(emitted[0].type, ORDER_TYPE::MARKET);
+    EXPECT_EQ(emitted[0].qty, 10);
+    EXPECT_EQ(emitted[1].type, ORDER_TYPE::ICEBERG);
+    EXPECT_EQ(emitted[1].side, ORDER_SIDE::BUY);
+    EXPECT_DOUBLE_EQ(emitted[1].price, 99.0);
+    EXPECT_EQ(emitted[1].qty, 15);
+    EXPECT_EQ(emitted[2].type, ORDER_TYPE::MARKET);
+    EXPECT_EQ(emitted[2].qty, 35);
+
+    EXPECT_DOUBLE_EQ(parser->getBuySide(1).front().price, 98.0);
+}
+
+TEST_F(MarketSweepTest, ExcessBetweenLevelsIsIcebergAtOrderPrice) {
+    parser->EmitMarketOrderAndUpdateBuyBook(1, 40, 98.5, 2000);
+
+    const auto& emitted = parser->getEmittedOrders();
+    ASSERT_EQ(emitted.size(), 4u);
+    EXPECT_EQ(emitted[2].type, ORDER_TYPE::ICEBERG);
+    EXPECT_DOUBLE_EQ(emitted[2].price, 98.5);
+    EXPECT_EQ(emitted[2].qty, 10);
+    EXPECT_EQ(emitted[3].type, ORDER_TYPE::MARKET);
+    EXPECT_EQ(emitted[3].qty, 10);
+
+    EXPECT_DOUBLE_EQ(parser->getBuySide(1).front().price, 98.0);
+    EXPECT_EQ(parser->getBuySide(1).front().qty, 30);
+}
+
+TEST_F(MarketSweepTest, PriceThroughTheSpreadEmitsNothingOnBothSides) {
+    parser->EmitMarketOrderAndUpdateBuyBook(1, 10, 100.5, 2000);
+    parser->EmitMarketOrderAndUpdateSellBook(1, 10, 100.5, 2000);
+
+    EXPECT_TRUE(parser->getEmittedOrders().empty());
+    EXPECT_EQ(parser->getBuySide(1).size(), 4u);
+    EXPECT_EQ(parser->getSellSide(1).size(), 3u);
+}
+
+TEST_F(MarketSweepTest, CumulativeDepthMatchesBookThroughUpdates) {
+    std::mt19937 rng(3);
+    for (int round = 0; round < 300; round++) {
+        if (round % 3 == 0) {
+            std::vector<bookElement> bids;
+            int levels = 1 + static_cast<int>(rng() % 8);
+            for (int i = 0; i < levels; i++) {
+                bids.push_back(makeBookElement(100.0 - i - static_cast<int>(rng() % 2), 1 + static_cast<int>(rng() % 20)));
+            }
+            parser->EmitOrdersAndUpdateOldBuyBook(1, bids, round);
+        } else if (!parser->getBuySide(1).empty()) {
+            const auto& side = parser->getBuySide(1);
+            double worst = side[rng() % side.size()].price;
+            parser->EmitMarketOrderAndUpdateBuyBook(1, 1 + static_cast<int>(rng() % 40), worst, round);
+        }
+
+        const auto& side = parser->getBuySide(1);
+        int64_t running = 0;
+        for (size_t i = 0; i < side.size(); i++) {
+            running += side[i].qty;
+            ASSERT_EQ(parser->getCumulativeDepth(1, ORDER_SIDE::BUY, i + 1), running) << "round " << round;
+        }
+        parser->clearEmittedOrders();
+    }
+}
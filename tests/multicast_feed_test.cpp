@@ -0,0 +1,94 @@
+#include "test_common.h"
+#include "src/multicast_feed.h"
+#include "src/wire_format.h"
+
+TEST(LineArbiterTest, FirstCopyWins) {
+    LineArbiter arbiter;
+    EXPECT_TRUE(arbiter.accept(1, false));
+    EXPECT_FALSE(arbiter.accept(1, true));
+    EXPECT_TRUE(arbiter.accept(2, true));
+    EXPECT_FALSE(arbiter.accept(2, false));
+
+    const ArbitrationStats& stats = arbiter.getStats();
+    EXPECT_EQ(stats.delivered, 2u);
+    EXPECT_EQ(stats.duplicates, 2u);
+    EXPECT_EQ(stats.fromA, 1u);
+    EXPECT_EQ(stats.fromB, 1u);
+}
+
+TEST(LineArbiterTest, GapOnBothLinesIsCountedAndLateCopyDropped) {
+    LineArbiter arbiter;
+    arbiter.accept(1, false);
+    EXPECT_TRUE(arbiter.accept(4, false));
+    EXPECT_EQ(arbiter.getStats().gaps, 2u);
+
+    // A late copy of a skipped snapshot is older than the book we already have
+    EXPECT_FALSE(arbiter.accept(3, true));
+    EXPECT_EQ(arbiter.lastSequence(), 4u);
+}
+
+TEST(MulticastEndpointTest, ParsesGroupPortAndInterface) {
+    MulticastEndpoint endpoint;
+    ASSERT_TRUE(parseMulticastEndpoint("239.1.2.3:5000@127.0.0.1", endpoint));
+    EXPECT_EQ(endpoint.group, "239.1.2.3");
+    EXPECT_EQ(endpoint.port, 5000);
+    EXPECT_EQ(endpoint.iface, "127.0.0.1");
+
+    ASSERT_TRUE(parseMulticastEndpoint("239.1.2.3:5001", endpoint));
+    EXPECT_EQ(endpoint.iface, "0.0.0.0");
+
+    EXPECT_FALSE(parseMulticastEndpoint("239.1.2.3", endpoint));
+    EXPECT_FALSE(parseMulticastEndpoint("239.1.2.3:70000", endpoint));
+    EXPECT_FALSE(parseMulticastEndpoint("239.1.2.3:50x", endpoint));
+}
+
+// A/B lines over loopback multicast into the parser
+TEST(MulticastFeedTest, LoopbackLinesAreArbitratedIntoParser) {
+    MulticastEndpoint lineA, lineB;
+    parseMulticastEndpoint("239.255.42.1:0@127.0.0.1", lineA);
+    parseMulticastEndpoint("239.255.42.2:0@127.0.0.1", lineB);
+
+    MulticastSnapshotFeed feed;
+    if (!feed.open(lineA, &lineB)) {
+        GTEST_SKIP() << "multicast on loopback is not available";
+    }
+    lineA.port = feed.line(false).port();
+    lineB.port = feed.line(true).port();
+
+    MulticastSender senderA, senderB;
+    ASSERT_TRUE(senderA.open(lineA));
+    ASSERT_TRUE(senderB.open(lineB));
+
+    std::vector<bookElement> bids = {makeBookElement(100.0, 10)};
+    std::vector<bookElement> asks = {makeBookElement(101.0, 10)};
+    std::vector<char> first = serializeSnapshot(1, 1000, bids, asks);
+    bids[0].qty = 20;
+    std::vector<char> second = serializeSnapshot(1, 2000, bids, asks);
+
+    // Sequence 1 on both lines, sequence 2 only on B (A dropped it)
+    ASSERT_TRUE(senderA.send(1, first.data(), first.size()));
+    ASSERT_TRUE(senderB.send(1, first.data(), first.size()));
+    ASSERT_TRUE(senderB.send(2, second.data(), second.size()));
+
+    SeekerNetBoonSnapshotParserToTBT parser({1});
+    std::vector<bookElement> buyBook, sellBook;
+    size_t frames = 0;
+    for (int attempt = 0; attempt < 50 && feed.getStats().delivered + feed.getStats().duplicates < 3; attempt++) {
+        frames += feed.poll(20, [&](const char* data, size_t length, uint64_t rxTimeNs) {
+            PAIR_ID pairId;
+            ORDER_TIME time;
+            ASSERT_TRUE(deserializeSnapshot(data, length, pairId, time, buyBook, sellBook));
+            EXPECT_GT(rxTimeNs, 0u);
+            parser.ApplySnapshot(pairId, buyBook, sellBook, time);
+        });
+    }
+
+    if (frames == 0) {
+        GTEST_SKIP() << "no multicast datagrams looped back";
+    }
+    EXPECT_EQ(frames, 2u);
+    EXPECT_EQ(feed.getStats().duplicates, 1u);
+    EXPECT_EQ(feed.getStats().gaps, 0u);
+    ASSERT_EQ(parser.getBuySide(1).size(), 1u);
+    EXPECT_EQ(parser.getBuySide(1).front().qty, 20);
+}
@@ -0,0 +1,174 @@
+#include "test_common.h"
+#include "src/pair_partition.h"
+#include "src/tbt_book_builder.h"
+#include "src/wire_format.h"
+
+namespace {
+std::map<std::string, std::vector<PAIR_ID>> assign(const HashRing& ring, PAIR_ID pairs) {
+    std::map<std::string, std::vector<PAIR_ID>> owned;
+    for (PAIR_ID pairId = 1; pairId <= pairs; pairId++) owned[ring.owner(pairId)].push_back(pairId);
+    return owned;
+}
+
+void expectSameOrders(const std::vector<Order>& a, const std::vector<Order>& b) {
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); i++) {
+        EXPECT_DOUBLE_EQ(a[i].price, b[i].price);
+        EXPECT_EQ(a[i].qty, b[i].qty);
+        EXPECT_EQ(a[i].side, b[i].side);
+        EXPECT_EQ(a[i].action, b[i].action);
+    }
+}
+} // namespace
+
+TEST(PairPartitionTest, RingSpreadsPairsEvenly) {
+    HashRing ring;
+    EXPECT_EQ(ring.owner(1), "");
+    ring.setMembers({"c", "a", "b"});
+    auto owned = assign(ring, 3000);
+    ASSERT_EQ(owned.size(), 3u);
+    for (const auto& member : owned) {
+        EXPECT_GT(member.second.size(), 700u) << member.first;
+        EXPECT_LT(member.second.size(), 1300u) << member.first;
+    }
+
+    HashRing same;
+    same.setMembers({"b", "c", "a"});
+    for (PAIR_ID pairId = 1; pairId <= 3000; pairId++) EXPECT_EQ(ring.owner(pairId), same.owner(pairId));
+}
+
+TEST(PairPartitionTest, MembershipChangeOnlyMovesAffectedPairs) {
+    HashRing before, after;
+    before.setMembers({"a", "b", "c"});
+    after.setMembers({"a", "b", "c", "d"});
+    size_t moved = 0;
+    for (PAIR_ID pairId = 1; pairId <= 3000; pairId++) {
+        if (before.owner(pairId) != after.owner(pairId)) {
+            EXPECT_EQ(after.owner(pairId), "d");
+            moved++;
+        }
+    }
+    EXPECT_GT(moved, 500u);
+    EXPECT_LT(moved, 1000u);
+
+    after.setMembers({"a", "c"});
+    for (PAIR_ID pairId = 1; pairId <= 3000; pairId++) {
+        if (before.owner(pairId) != "b") {
+            EXPECT_EQ(after.owner(pairId), before.owner(pairId));
+        }
+    }
+}
+
+TEST(PairPartitionTest, MembershipFollowsHeartbeats) {
+    ClusterMembership membership("b", 100);
+    EXPECT_EQ(membership.members(), (std::vector<std::string>{"b"}));
+    EXPECT_TRUE(membership.heartbeat("a", 0));
+    EXPECT_TRUE(membership.heartbeat("c", 50));
+    EXPECT_FALSE(membership.heartbeat("a", 60));
+    EXPECT_FALSE(membership.heartbeat("b", 60));
+    EXPECT_EQ(membership.members(), (std::vector<std::string>{"a", "b", "c"}));
+
+    EXPECT_FALSE(membership.expire(149));
+    EXPECT_TRUE(membership.expire(150));   // c last seen at 50
+    EXPECT_EQ(membership.members(), (std::vector<std::string>{"a", "b"}));
+
+    // A heartbeat sent before the leave does not bring the member back
+    EXPECT_TRUE(membership.leave("a", 160));
+    EXPECT_FALSE(membership.heartbeat("a", 170));
+    EXPECT_EQ(membership.members(), (std::vector<std::string>{"b"}));
+    EXPECT_TRUE(membership.heartbeat("a", 260));
+}
+
+TEST(PairPartitionTest, CheckpointHandoffContinuesTheBook) {
+    SeekerNetBoonSnapshotParserToTBT primary({1});
+    std::vector<bookElement> bids = {makeBookElement(100.0, 10, 1), makeBookElement(99.0, 20, 1)};
+    std::vector<bookElement> asks = {makeBookElement(101.0, 10, 1), makeBookElement(102.0, 20, 1)};
+    primary.ApplySnapshot(1, bids, asks, 1000);
+    bids = {makeBookElement(99.5, 15, 2), makeBookElement(99.0, 25, 2)};
+    asks = {makeBookElement(101.5, 5, 2)};
+    primary.ApplySnapshot(1, bids, asks, 2000);
+    primary.clearEmittedOrders();
+
+    PairCheckpoint checkpoint;
+    captureCheckpoint(primary, 1, checkpoint);
+    checkpoint.tbtSequence = 42;
+    std::vector<char> wire = serializeCheckpoint(checkpoint);
+    PairCheckpoint received;
+    ASSERT_TRUE(deserializeCheckpoint(wire.data(), wire.size(), received));
+    EXPECT_EQ(received.pairId, 1);
+    EXPECT_EQ(received.time, 2000u);
+    EXPECT_EQ(received.tbtSequence, 42u);
+    EXPECT_FALSE(deserializeCheckpoint(wire.data(), wire.size() - 1, received));
+
+    // The new owner had an older book of its own; the checkpoint replaces it silently
+    SeekerNetBoonSnapshotParserToTBT secondary({1});
+    std::vector<bookElement> staleBids = {makeBookElement(90.0, 1)};
+    std::vector<bookElement> staleAsks = {makeBookElement(110.0, 1)};
+    secondary.ApplySnapshot(1, staleBids, staleAsks, 500);
+    secondary.clearEmittedOrders();
+    ASSERT_TRUE(deserializeCheckpoint(wire.data(), wire.size(), received));
+    restoreCheckpoint(secondary, received);
+    EXPECT_TRUE(secondary.getEmittedOrders().empty());
+    EXPECT_EQ(secondary.getBookHash(1, ORDER_SIDE::BUY), primary.getBookHash(1, ORDER_SIDE::BUY));
+    EXPECT_EQ(secondary.getBookHash(1, ORDER_SIDE::SELL), primary.getBookHash(1, ORDER_SIDE::SELL));
+    EXPECT_EQ(secondary.getLastSnapshotTime(1), 2000u);
+    EXPECT_DOUBLE_EQ(secondary.getSeekerBounds(1).maxBidSeen, primary.getSeekerBounds(1).maxBidSeen);
+    EXPECT_DOUBLE_EQ(secondary.getSeekerBounds(1).minAskSeen, primary.getSeekerBounds(1).minAskSeen);
+
+    // Same next snapshot, same events
+    for (SeekerNetBoonSnapshotParserToTBT* parser : {&primary, &secondary}) {
+        bids = {makeBookElement(100.5, 7), makeBookElement(99.5, 15)};
+        asks = {makeBookElement(101.5, 5), makeBookElement(103.0, 9)};
+        EXPECT_EQ(parser->ApplySnapshot(1, bids, asks, 3000), SNAPSHOT_RESULT::APPLIED);
+    }
+    expectSameOrders(primary.getEmittedOrders(), secondary.getEmittedOrders());
+
+    // A snapshot the old owner already applied is stale for the new one
+    std::vector<bookElement> late = {makeBookElement(99.0, 1)};
+    EXPECT_EQ(secondary.ApplySnapshot(1, late, late, 1500), SNAPSHOT_RESULT::DROPPED_STALE);
+}
+
+TEST(PairPartitionTest, TakeoverWithoutCheckpointRestartsSequences) {
+    const uint64_t startMs = 1700000000000ull;
+    TbtBookBuilder consumer;
+    auto publish = [&](SeekerNetBoonSnapshotParserToTBT& parser, uint64_t& sequence) {
+        std::vector<char> frame = serializeOrders(parser.getEmittedOrders(), ++sequence);
+        parser.clearEmittedOrders();
+        return consumer.applyFrame(frame.data(), frame.size());
+    };
+
+    // The old owner publishes a few thousand frames, then dies without a handoff
+    SeekerNetBoonSnapshotParserToTBT oldOwner({1});
+    uint64_t oldSequence = restartSequence(0, startMs);
+    for (int i = 0; i < 3000; i++) {
+        std::vector<bookElement> bids = {makeBookElement(100.0, 10 + i % 7)};
+        std::vector<bookElement> asks = {makeBookElement(101.0, 10)};
+        oldOwner.ApplySnapshot(1, bids, asks, 1000 + i);
+        ASSERT_EQ(publish(oldOwner, oldSequence), FRAME_APPLIED);
+    }
+
+    // Its successor starts from an empty book a millisecond later: its
+    // frames are a gap for the consumer, not duplicates it would drop
+    SeekerNetBoonSnapshotParserToTBT newOwner({1});
+    uint64_t newSequence = restartSequence(0, startMs + 1);
+    EXPECT_GT(newSequence, oldSequence);
+    std::vector<bookElement> bids = {makeBookElement(100.0, 12)};
+    std::vector<bookElement> asks = {makeBookElement(101.0, 10)};
+    newOwner.ApplySnapshot(1, bids, asks, 5000);
+    EXPECT_EQ(publish(newOwner, newSequence), FRAME_GAP);
+    EXPECT_FALSE(consumer.isInSync(1));
+    EXPECT_EQ(consumer.getLastSequence(1), newSequence);
+
+    // After a resync from the successor's book the stream is followed again
+    std::vector<bookElement> newBids(newOwner.getBuySide(1).begin(), newOwner.getBuySide(1).end());
+    std::vector<bookElement> newAsks(newOwner.getSellSide(1).begin(), newOwner.getSellSide(1).end());
+    consumer.resync(1, newBids, newAsks);
+    bids = {makeBookElement(100.0, 15), makeBookElement(99.5, 4)};
+    newOwner.ApplySnapshot(1, bids, asks, 5001);
+    EXPECT_EQ(publish(newOwner, newSequence), FRAME_APPLIED);
+    EXPECT_TRUE(consumer.isInSync(1));
+    EXPECT_EQ(consumer.getBookHash(1, ORDER_SIDE::BUY), newOwner.getBookHash(1, ORDER_SIDE::BUY));
+
+    // A sequence already above the clock's is kept
+    EXPECT_EQ(restartSequence(newSequence + 5, startMs), newSequence + 5);
+}
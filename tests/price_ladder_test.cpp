@@ -0,0 +1,238 @@
+#include "test_common.h"
+#include <map>
+#include <random>
+
+namespace {
+struct Change {
+    double price;
+    ORDER_QTY oldQty;
+    ORDER_QTY newQty;
+};
+
+std::vector<Change> applyAndCollect(PriceLadder& ladder, const std::vector<bookElement>& book) {
+    std::vector<Change> changes;
+    EXPECT_TRUE(ladder.applySnapshot(book, [&](ORDER_PRICE p, ORDER_QTY o, ORDER_QTY n) {
+        changes.push_back({p, o, n});
+    }));
+    return changes;
+}
+
+std::map<double, ORDER_QTY> toMap(const BookSide& side) {
+    std::map<double, ORDER_QTY> levels;
+    for (const auto& level : side) levels[level.price] = level.qty;
+    return levels;
+}
+} // namespace
+
+TEST(PriceLadderTest, SetEraseAndBest) {
+    PriceLadder ladder;
+    ladder.configure(0.5, true);
+    ASSERT_TRUE(ladder.set(100.0, 10));
+    ASSERT_TRUE(ladder.set(101.5, 5));
+    ASSERT_TRUE(ladder.set(99.0, 7));
+
+    int64_t tick = 0;
+    ASSERT_TRUE(ladder.toTick(101.5, tick));
+    EXPECT_EQ(ladder.bestTick(), tick);
+    EXPECT_EQ(ladder.qtyAt(tick), 5);
+    EXPECT_EQ(ladder.size(), 3u);
+
+    ladder.erase(101.5);
+    ASSERT_TRUE(ladder.toTick(100.0, tick));
+    EXPECT_EQ(ladder.bestTick(), tick);
+    EXPECT_EQ(ladder.size(), 2u);
+}
+
+TEST(PriceLadderTest, SellSideBestIsLowest) {
+    PriceLadder ladder;
+    ladder.configure(0.01, false);
+    ladder.set(100.02, 1);
+    ladder.set(100.01, 2);
+    ladder.set(100.05, 3);
+
+    int64_t tick = 0;
+    ASSERT_TRUE(ladder.toTick(100.01, tick));
+    EXPECT_EQ(ladder.bestTick(), tick);
+}
+
+TEST(PriceLadderTest, OffGridPriceRejected) {
+    PriceLadder ladder;
+    ladder.configure(0.5, true);
+    std::vector<bookElement> book = {makeBookElement(100.0, 1)};
+    ASSERT_TRUE(ladder.rebuild(book));
+    EXPECT_FALSE(ladder.set(100.3, 1));
+    EXPECT_FALSE(ladder.active());
+
+    std::vector<bookElement> offGrid = {makeBookElement(100.25, 1)};
+    EXPECT_FALSE(ladder.applySnapshot(offGrid, [](ORDER_PRICE, ORDER_QTY, ORDER_QTY) {}));
+}
+
+TEST(PriceLadderTest, ReanchorsWhenPriceDrifts) {
+    PriceLadder ladder;
+    ladder.configure(1.0, true);
+    ladder.set(100.0, 1);
+    ladder.set(100.0 + PriceLadder::DEFAULT_TICKS * 3, 2);   // far outside the first window
+    ladder.set(50.0, 3);
+
+    int64_t tick = 0;
+    ASSERT_TRUE(ladder.toTick(100.0, tick));
+    EXPECT_EQ(ladder.qtyAt(tick), 1);
+    ASSERT_TRUE(ladder.toTick(50.0, tick));
+    EXPECT_EQ(ladder.qtyAt(tick), 3);
+    EXPECT_EQ(ladder.size(), 3u);
+    EXPECT_EQ(ladder.bestTick(), static_cast<int64_t>(100 + PriceLadder::DEFAULT_TICKS * 3));
+}
+
+TEST(PriceLadderTest, ApplySnapshotReportsChanges) {
+    PriceLadder ladder;
+    ladder.configure(1.0, true);
+    std::vector<bookElement> book1 = {makeBookElement(100.0, 10), makeBookElement(99.0, 20), makeBookElement(98.0, 30)};
+    EXPECT_EQ(applyAndCollect(ladder, book1).size(), 3u);
+
+    std::vector<bookElement> book2 = {makeBookElement(101.0, 5), makeBookElement(100.0, 10), makeBookElement(98.0, 25)};
+    std::vector<Change> changes = applyAndCollect(ladder, book2);
+    ASSERT_EQ(changes.size(), 3u);
+    EXPECT_DOUBLE_EQ(changes[0].price, 101.0);
+    EXPECT_EQ(changes[0].oldQty, 0);
+    EXPECT_EQ(changes[0].newQty, 5);
+    EXPECT_DOUBLE_EQ(changes[1].price, 98.0);
+    EXPECT_EQ(changes[1].oldQty, 30);
+    EXPECT_EQ(changes[1].newQty, 25);
+    EXPECT_DOUBLE_EQ(changes[2].price, 99.0);
+    EXPECT_EQ(changes[2].newQty, 0);
+
+    BookSide levels;
+    ladder.copyLevels(levels, 0);
+    ASSERT_EQ(levels.size(), 3u);
+    EXPECT_DOUBLE_EQ(levels[0].price, 101.0);
+    EXPECT_DOUBLE_EQ(levels[2].price, 98.0);
+}
+
+class PriceLadderParserTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        parser = std::make_unique<SeekerNetBoonSnapshotParserToTBT>(std::vector<PAIR_ID>{1, 2});
+        PairConfig config;
+        config.layout = BOOK_LAYOUT::PRICE_LADDER;
+        config.tickSize = 0.5;
+        parser->SetPairConfig(1, config);
+    }
+
+    std::unique_ptr<SeekerNetBoonSnapshotParserToTBT> parser;
+};
+
+TEST_F(PriceLadderParserTest, SelectablePerPair) {
+    EXPECT_TRUE(parser->getLadder(1, ORDER_SIDE::BUY).active());
+    EXPECT_TRUE(parser->getLadder(1, ORDER_SIDE::SELL).active());
+    EXPECT_FALSE(parser->getLadder(2, ORDER_SIDE::BUY).active());
+
+    PairConfig sorted;
+    parser->SetPairConfig(1, sorted);
+    EXPECT_FALSE(parser->getLadder(1, ORDER_SIDE::BUY).active());
+}
+
+TEST_F(PriceLadderParserTest, BookAndEventsFollowSnapshots) {
+    std::mt19937 rng(5);
+    for (int round = 0; round < 500; round++) {
+        bool buySide = (round % 2) == 0;
+        std::vector<bookElement> book;
+        int levels = static_cast<int>(rng() % 10);
+        double price = 100.0 + 0.5 * static_cast<int>(rng() % 8);
+        for (int i = 0; i < levels; i++) {
+            price -= 0.5 * (1 + static_cast<int>(rng() % 2));
+            double p = buySide ? price : 200.0 - price;
+            book.push_back(makeBookElement(p, 1 + static_cast<int>(rng() % 5)));
+        }
+
+        const BookSide& side = buySide ? parser->getBuySide(1) : parser->getSellSide(1);
+        std::map<double, ORDER_QTY> replay = toMap(side);
+
+        parser->clearEmittedOrders();
+        std::vector<bookElement> input = book;
+        if (buySide) parser->EmitOrdersAndUpdateOldBuyBook(1, input, round);
+        else parser->EmitOrdersAndUpdateOldSellBook(1, input, round);
+
+        for (const auto& order : parser->getEmittedOrders()) {
+            if (order.action == ORDER_ACTION::REMOVE) {
+                replay[order.price] -= order.qty;
+                if (replay[order.price] == 0) replay.erase(order.price);
+            } else {
+                replay[order.price] += order.qty;
+            }
+        }
+
+        std::map<double, ORDER_QTY> expected;
+        for (const auto& level : book) expected[level.price] = level.qty;
+        EXPECT_EQ(toMap(side), expected);
+        EXPECT_EQ(replay, expected);
+        EXPECT_EQ(parser->getBookHash(1, buySide ? ORDER_SIDE::BUY : ORDER_SIDE::SELL), bookSideHash(side));
+        ASSERT_TRUE(side.empty() || side.front().price == book.front().price);
+    }
+}
+
+TEST_F(PriceLadderParserTest, NewBestLevelIsSeekerAdd) {
+    std::vector<bookElement> book1 = {makeBookElement(100.0, 10)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book1, 1000);
+    ASSERT_EQ(parser->getEmittedOrders().size(), 1u);
+    EXPECT_EQ(parser->getEmittedOrders()[0].action, ORDER_ACTION::SEEKER_ADD);
+    parser->clearEmittedOrders();
+
+    std::vector<bookElement> book2 = {makeBookElement(100.0, 10), makeBookElement(99.5, 4)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book2, 2000);
+    ASSERT_EQ(parser->getEmittedOrders().size(), 1u);
+    EXPECT_EQ(parser->getEmittedOrders()[0].action, ORDER_ACTION::ADD);
+    EXPECT_EQ(parser->getEmittedOrders()[0].qty, 4);
+}
+
+TEST_F(PriceLadderParserTest, MarketOrderKeepsLadderInSync) {
+    std::vector<bookElement> book = {makeBookElement(100.0, 10), makeBookElement(99.5, 4)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book, 1000);
+    parser->EmitMarketOrderAndUpdateBuyBook(1, 10, 100.0, 1001);
+
+    const PriceLadder& ladder = parser->getLadder(1, ORDER_SIDE::BUY);
+    int64_t tick = 0;
+    ASSERT_TRUE(ladder.toTick(99.5, tick));
+    EXPECT_EQ(ladder.bestTick(), tick);
+    EXPECT_EQ(ladder.size(), 1u);
+}
+
+TEST_F(PriceLadderParserTest, OffGridSnapshotFallsBackToSortedDiff) {
+    std::vector<bookElement> book1 = {makeBookElement(100.0, 10)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book1, 1000);
+    std::vector<bookElement> offGrid = {makeBookElement(100.0, 10), makeBookElement(99.3, 2)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, offGrid, 2000);
+
+    EXPECT_FALSE(parser->getLadder(1, ORDER_SIDE::BUY).active());
+    EXPECT_EQ(parser->getBuySide(1).size(), 2u);
+
+    // Back on the grid: the off-grid level is removed and the ladder resumes
+    parser->clearEmittedOrders();
+    std::vector<bookElement> onGrid = {makeBookElement(100.0, 10), makeBookElement(99.5, 2)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, onGrid, 3000);
+    EXPECT_TRUE(parser->getLadder(1, ORDER_SIDE::BUY).active());
+    ASSERT_EQ(parser->getBuySide(1).size(), 2u);
+    EXPECT_DOUBLE_EQ(parser->getBuySide(1)[1].price, 99.5);
+
+    bool removedOffGrid = false;
+    for (const auto& order : parser->getEmittedOrders()) {
+        if (order.action == ORDER_ACTION::REMOVE && order.price == 99.3) removedOffGrid = true;
+    }
+    EXPECT_TRUE(removedOffGrid);
+}
+
+TEST_F(PriceLadderParserTest, UnchangedLevelsKeepTheirTime) {
+    std::vector<bookElement> book1 = {makeBookElement(100.0, 10), makeBookElement(99.5, 4), makeBookElement(99.0, 2)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book1, 1000);
+    std::vector<bookElement> book2 = {makeBookElement(100.5, 1), makeBookElement(100.0, 10), makeBookElement(99.0, 3)};
+    parser->EmitOrdersAndUpdateOldBuyBook(1, book2, 2000);
+
+    const BookSide& side = parser->getBuySide(1);
+    ASSERT_EQ(side.size(), 3u);
+    EXPECT_DOUBLE_EQ(side[0].price, 100.5);
+    EXPECT_EQ(side[0].time, 2000u);
+    EXPECT_DOUBLE_EQ(side[1].price, 100.0);
+    EXPECT_EQ(side[1].time, 1000u);
+    EXPECT_EQ(side[2].qty, 3);
+    EXPECT_EQ(parser->getBookHash(1, ORDER_SIDE::BUY), bookSideHash(side));
+    EXPECT_EQ(parser->getCumulativeDepth(1, ORDER_SIDE::BUY, 3), 14);
+}
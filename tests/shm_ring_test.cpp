@@ -0,0 +1,115 @@
+#include "test_common.h"
+#include "src/shm_ring.h"
+#include <string>
+#include <unistd.h>
+
+class ShmRingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        name = "buni_test_ring_" + std::to_string(getpid());
+        ASSERT_TRUE(writer.open(name, 8, 64));
+    }
+
+    void TearDown() override {
+        writer.close();
+        ShmRingWriter::unlink(name);
+    }
+
+    void publish(const std::string& frame) {
+        ASSERT_TRUE(writer.publish(frame.data(), frame.size()));
+    }
+
+    std::string name;
+    ShmRingWriter writer;
+    std::vector<char> out;
+};
+
+TEST_F(ShmRingTest, ReaderReceivesFramesInOrder) {
+    ShmRingReader reader;
+    ASSERT_TRUE(reader.open(name));
+    EXPECT_FALSE(reader.poll(out));
+
+    publish("first");
+    publish("second");
+    ASSERT_TRUE(reader.poll(out));
+    EXPECT_EQ(std::string(out.begin(), out.end()), "first");
+    ASSERT_TRUE(reader.poll(out));
+    EXPECT_EQ(std::string(out.begin(), out.end()), "second");
+    EXPECT_FALSE(reader.poll(out));
+    EXPECT_EQ(reader.lost(), 0u);
+}
+
+TEST_F(ShmRingTest, LateReaderStartsAtNextFrame) {
+    publish("old");
+    ShmRingReader reader;
+    ASSERT_TRUE(reader.open(name));
+    EXPECT_FALSE(reader.poll(out));
+
+    publish("new");
+    ASSERT_TRUE(reader.poll(out));
+    EXPECT_EQ(std::string(out.begin(), out.end()), "new");
+}
+
+TEST_F(ShmRingTest, LateReaderCanStartFromOldest) {
+    for (int i = 1; i <= 20; i++) publish(std::to_string(i));
+
+    ShmRingReader reader;
+    ASSERT_TRUE(reader.open(name, true));
+    ASSERT_TRUE(reader.poll(out));
+    EXPECT_EQ(std::string(out.begin(), out.end()), "14");   // 8 slots, one kept as margin
+}
+
+TEST_F(ShmRingTest, LappedReaderSkipsAheadAndCountsLoss) {
+    ShmRingReader reader;
+    ASSERT_TRUE(reader.open(name));
+    for (int i = 1; i <= 20; i++) publish(std::to_string(i));
+
+    EXPECT_FALSE(reader.poll(out));
+    EXPECT_EQ(reader.lost(), 19u);
+    ASSERT_TRUE(reader.poll(out));
+    EXPECT_EQ(std::string(out.begin(), out.end()), "20");
+    EXPECT_FALSE(reader.poll(out));
+}
+
+TEST_F(ShmRingTest, OversizedFrameIsRejected) {
+    std::string big(65, 'x');
+    EXPECT_FALSE(writer.publish(big.data(), big.size()));
+    EXPECT_EQ(writer.published(), 0u);
+}
+
+TEST_F(ShmRingTest, OpenMissingRingFails) {
+    ShmRingReader reader;
+    EXPECT_FALSE(reader.open(name + "_missing"));
+    EXPECT_FALSE(reader.poll(out));
+}
+
+TEST_F(ShmRingTest, ReplacedRingIsRetired) {
+    ShmRingReader reader;
+    ASSERT_TRUE(reader.open(name));
+    publish("before");
+    EXPECT_FALSE(reader.retired());
+
+    ShmRingWriter replacement;
+    ASSERT_TRUE(replacement.open(name, 8, 64));
+    EXPECT_TRUE(reader.retired());
+    // Frames already in the old ring are still delivered
+    ASSERT_TRUE(reader.poll(out));
+    EXPECT_EQ(std::string(out.begin(), out.end()), "before");
+    EXPECT_FALSE(reader.poll(out));
+
+    ShmRingReader fresh;
+    ASSERT_TRUE(fresh.open(name));
+    EXPECT_FALSE(fresh.retired());
+    std::string frame = "after";
+    ASSERT_TRUE(replacement.publish(frame.data(), frame.size()));
+    ASSERT_TRUE(fresh.poll(out));
+    EXPECT_EQ(std::string(out.begin(), out.end()), "after");
+    replacement.close();
+}
+
+TEST_F(ShmRingTest, UnlinkRetiresRing) {
+    ShmRingReader reader;
+    ASSERT_TRUE(reader.open(name));
+    ShmRingWriter::unlink(name);
+    EXPECT_TRUE(reader.retired());
+}
@@ -0,0 +1,159 @@
+#include "test_common.h"
+#include <thread>
+
+class SnapshotConflatorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        conflator = std::make_unique<SnapshotConflator>(std::vector<PAIR_ID>{1, 2});
+    }
+
+    void offer(PAIR_ID pairId, ORDER_TIME time, double bestBid) {
+        std::vector<bookElement> buy = {makeBookElement(bestBid, 10, time)};
+        std::vector<bookElement> sell = {makeBookElement(bestBid + 1.0, 10, time)};
+        ASSERT_TRUE(conflator->Offer(pairId, time, buy, sell));
+    }
+
+    std::unique_ptr<SnapshotConflator> conflator;
+};
+
+TEST_F(SnapshotConflatorTest, UnknownPairRejected) {
+    std::vector<bookElement> buy, sell;
+    EXPECT_FALSE(conflator->Offer(999, 1, buy, sell));
+    EXPECT_THROW(conflator->SetConflation(999, true), std::out_of_range);
+    EXPECT_THROW(conflator->getStats(999), std::out_of_range);
+}
+
+TEST_F(SnapshotConflatorTest, DefaultModeQueuesEverySnapshotInOrder) {
+    offer(1, 1000, 100.0);
+    offer(1, 2000, 101.0);
+    offer(1, 3000, 102.0);
+
+    PendingSnapshot out;
+    for (ORDER_TIME expected : {1000u, 2000u, 3000u}) {
+        ASSERT_TRUE(conflator->Poll(out));
+        EXPECT_EQ(out.time, expected);
+    }
+    EXPECT_FALSE(conflator->Poll(out));
+    EXPECT_EQ(conflator->getStats(1).conflated, 0u);
+    EXPECT_EQ(conflator->getStats(1).delivered, 3u);
+}
+
+TEST_F(SnapshotConflatorTest, DefaultModeQueueIsBounded) {
+    conflator = std::make_unique<SnapshotConflator>(std::vector<PAIR_ID>{1, 2}, 2);
+    offer(1, 1000, 100.0);
+    offer(1, 2000, 101.0);
+    offer(1, 3000, 102.0);   // drops 1000
+    offer(2, 1000, 50.0);
+    EXPECT_EQ(conflator->pendingCount(), 3u);
+    EXPECT_EQ(conflator->getStats(1).dropped, 1u);
+    EXPECT_EQ(conflator->getStats(2).dropped, 0u);
+
+    PendingSnapshot out;
+    std::vector<ORDER_TIME> pair1;
+    while (conflator->Poll(out)) {
+        if (out.pairId == 1) pair1.push_back(out.time);
+    }
+    EXPECT_EQ(pair1, (std::vector<ORDER_TIME>{2000, 3000}));
+    EXPECT_EQ(conflator->getTotalStats().dropped, 1u);
+    EXPECT_EQ(conflator->getTotalStats().delivered, 3u);
+}
+
+TEST_F(SnapshotConflatorTest, ConflatingPairKeepsOnlyLatest) {
+    conflator->SetConflation(1, true);
+    offer(1, 1000, 100.0);
+    offer(1, 2000, 101.0);
+    offer(1, 3000, 102.0);
+
+    PendingSnapshot out;
+    ASSERT_TRUE(conflator->Poll(out));
+    EXPECT_EQ(out.time, 3000u);
+    ASSERT_EQ(out.buyBook.size(), 1u);
+    EXPECT_DOUBLE_EQ(out.buyBook[0].price, 102.0);
+    EXPECT_FALSE(conflator->Poll(out));
+
+    ConflationStats stats = conflator->getStats(1);
+    EXPECT_EQ(stats.offered, 3u);
+    EXPECT_EQ(stats.conflated, 2u);
+    EXPECT_EQ(stats.delivered, 1u);
+}
+
+TEST_F(SnapshotConflatorTest, ConflationIsPerPair) {
+    conflator->SetConflation(1, true);
+    offer(1, 1000, 100.0);
+    offer(2, 1000, 200.0);
+    offer(1, 2000, 101.0);
+    offer(2, 2000, 201.0);
+
+    EXPECT_EQ(conflator->pendingCount(), 3u);
+    EXPECT_EQ(conflator->getStats(1).conflated, 1u);
+    EXPECT_EQ(conflator->getStats(2).conflated, 0u);
+
+    ConflationStats total = conflator->getTotalStats();
+    EXPECT_EQ(total.offered, 4u);
+    EXPECT_EQ(total.conflated, 1u);
+}
+
+TEST_F(SnapshotConflatorTest, PairsAreServedRoundRobin) {
+    offer(1, 1000, 100.0);
+    offer(1, 2000, 101.0);
+    offer(2, 1000, 200.0);
+
+    PendingSnapshot out;
+    ASSERT_TRUE(conflator->Poll(out));
+    EXPECT_EQ(out.pairId, 1);
+    ASSERT_TRUE(conflator->Poll(out));
+    EXPECT_EQ(out.pairId, 2);
+    ASSERT_TRUE(conflator->Poll(out));
+    EXPECT_EQ(out.pairId, 1);
+    EXPECT_EQ(out.time, 2000u);
+}
+
+TEST_F(SnapshotConflatorTest, EnablingConflationCollapsesQueuedBacklog) {
+    offer(1, 1000, 100.0);
+    offer(1, 2000, 101.0);
+    offer(1, 3000, 102.0);
+    conflator->SetConflation(1, true);
+
+    EXPECT_EQ(conflator->pendingCount(), 1u);
+    PendingSnapshot out;
+    ASSERT_TRUE(conflator->Poll(out));
+    EXPECT_EQ(out.time, 3000u);
+    EXPECT_FALSE(conflator->Poll(out));
+}
+
+TEST_F(SnapshotConflatorTest, ConflatedSnapshotDiffsAgainstCurrentBook) {
+    SeekerNetBoonSnapshotParserToTBT parser({1});
+    conflator->SetConflation(1, true);
+
+    std::vector<bookElement> buy = {makeBookElement(100.0, 10)};
+    std::vector<bookElement> sell;
+    parser.EmitOrdersAndUpdateOldBuyBook(1, buy, 1000);
+    parser.clearEmittedOrders();
+
+    offer(1, 2000, 100.0);
+    std::vector<bookElement> latestBuy = {makeBookElement(100.0, 25)};
+    std::vector<bookElement> latestSell;
+    conflator->Offer(1, 3000, latestBuy, latestSell);
+
+    PendingSnapshot out;
+    ASSERT_TRUE(conflator->Poll(out));
+    parser.EmitOrdersAndUpdateOldBuyBook(1, out.buyBook, out.time);
+
+    ASSERT_EQ(parser.getBuySide(1).size(), 1u);
+    EXPECT_EQ(parser.getBuySide(1)[0].qty, 25);
+    ASSERT_EQ(parser.getEmittedOrders().size(), 1u);
+    EXPECT_EQ(parser.getEmittedOrders()[0].action, ORDER_ACTION::ADD);
+    EXPECT_EQ(parser.getEmittedOrders()[0].qty, 15);
+}
+
+TEST_F(SnapshotConflatorTest, WaitForPendingWakesOnOffer) {
+    EXPECT_FALSE(conflator->WaitForPending(1));
+
+    std::thread producer([this]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        std::vector<bookElement> buy, sell;
+        conflator->Offer(1, 1000, buy, sell);
+    });
+    EXPECT_TRUE(conflator->WaitForPending(1000));
+    producer.join();
+}
@@ -0,0 +1,152 @@
+#include "test_common.h"
+#include "src/wire_format.h"
+#include <random>
+
+class TbtBookBuilderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        parser = std::make_unique<SeekerNetBoonSnapshotParserToTBT>(std::vector<PAIR_ID>{1});
+    }
+
+    // Publishes the parser's pending events as the next frame of pair 1
+    FRAME_RESULT forward() {
+        std::vector<char> frame = serializeOrders(parser->getEmittedOrders(), ++sequence);
+        parser->clearEmittedOrders();
+        return builder.applyFrame(frame.data(), frame.size());
+    }
+
+    void expectSameBook() {
+        const BookSide& bids = parser->getBuySide(1);
+        const BookSide& asks = parser->getSellSide(1);
+        ASSERT_EQ(builder.getBuySide(1).size(), bids.size());
+        ASSERT_EQ(builder.getSellSide(1).size(), asks.size());
+        for (size_t i = 0; i < bids.size(); i++) {
+            EXPECT_DOUBLE_EQ(builder.getBuySide(1)[i].price, bids[i].price);
+            EXPECT_EQ(builder.getBuySide(1)[i].qty, bids[i].qty);
+        }
+        for (size_t i = 0; i < asks.size(); i++) {
+            EXPECT_DOUBLE_EQ(builder.getSellSide(1)[i].price, asks[i].price);
+            EXPECT_EQ(builder.getSellSide(1)[i].qty, asks[i].qty);
+        }
+        BookHashes source;
+        source.buy = parser->getBookHash(1, ORDER_SIDE::BUY);
+        source.sell = parser->getBookHash(1, ORDER_SIDE::SELL);
+        EXPECT_TRUE(builder.verifyChecksum(1, source));
+    }
+
+    std::unique_ptr<SeekerNetBoonSnapshotParserToTBT> parser;
+    TbtBookBuilder builder;
+    uint64_t sequence = 0;
+};
+
+TEST_F(TbtBookBuilderTest, FrameViewDecodesInPlace) {
+    std::vector<Order> orders = {
+        {1, 100.5, 1000, 10, ORDER_SIDE::BUY, ORDER_TYPE::LIMIT, ORDER_ACTION::SEEKER_ADD},
+        {1, 101.0, 1001, 7, ORDER_SIDE::SELL, ORDER_TYPE::MARKET, ORDER_ACTION::ADD},
+    };
+    std::vector<char> buf = serializeOrders(orders, 42);
+
+    OrderFrameView frame;
+    ASSERT_TRUE(frame.parse(buf.data(), buf.size()));
+    EXPECT_EQ(frame.pairId(), 1);
+    EXPECT_EQ(frame.sequence(), 42u);
+    ASSERT_EQ(frame.size(), 2u);
+    EXPECT_DOUBLE_EQ(frame[0].price, 100.5);
+    EXPECT_EQ(frame[0].action, ORDER_ACTION::SEEKER_ADD);
+    EXPECT_EQ(frame[1].time, 1001u);
+    EXPECT_EQ(frame[1].type, ORDER_TYPE::MARKET);
+
+    EXPECT_FALSE(frame.parse(buf.data(), buf.size() - 1));
+    buf[0] = 9;
+    EXPECT_FALSE(frame.parse(buf.data(), buf.size()));
+    EXPECT_EQ(builder.applyFrame(buf.data(), buf.size()), FRAME_MALFORMED);
+}
+
+TEST_F(TbtBookBuilderTest, RebuildsParserBook) {
+    std::vector<bookElement> bids = {makeBookElement(100.0, 10), makeBookElement(99.0, 20)};
+    std::vector<bookElement> asks = {makeBookElement(101.0, 15), makeBookElement(102.0, 25)};
+    parser->ApplySnapshot(1, bids, asks, 1000);
+    EXPECT_EQ(forward(), FRAME_APPLIED);
+    expectSameBook();
+
+    parser->EmitMarketOrderAndUpdateBuyBook(1, 15, 99.0, 1001);
+    EXPECT_EQ(forward(), FRAME_APPLIED);
+    expectSameBook();
+    EXPECT_EQ(builder.getCumulativeDepth(1, ORDER_SIDE::BUY, 2), 15);
+}
+
+TEST_F(TbtBookBuilderTest, MatchesParserThroughRandomUpdates) {
+    // The ladder layout diffs both sides exactly; netted events carry MODIFY
+    PairConfig config;
+    config.layout = BOOK_LAYOUT::PRICE_LADDER;
+    config.tickSize = 0.5;
+    config.netEvents = true;
+    parser->SetPairConfig(1, config);
+
+    std::mt19937 rng(29);
+    for (int round = 0; round < 300; round++) {
+        if (rng() % 4 == 0 && !parser->getSellSide(1).empty()) {
+            const auto& side = parser->getSellSide(1);
+            parser->EmitMarketOrderAndUpdateSellBook(1, 1 + static_cast<int>(rng() % 30),
+                                                     side[rng() % side.size()].price, round);
+        } else {
+            double mid = 100.0 + static_cast<int>(rng() % 4);
+            std::vector<bookElement> b, s;
+            double price = mid - 0.5;
+            for (int i = 1 + static_cast<int>(rng() % 8); i > 0; i--) {
+                b.push_back(makeBookElement(price, 1 + static_cast<int>(rng() % 20)));
+                price -= 0.5 * (1 + rng() % 2);
+            }
+            price = mid + 0.5;
+            for (int i = 1 + static_cast<int>(rng() % 8); i > 0; i--) {
+                s.push_back(makeBookElement(price, 1 + static_cast<int>(rng() % 20)));
+                price += 0.5 * (1 + rng() % 2);
+            }
+            parser->ApplySnapshot(1, b, s, round);
+        }
+        SCOPED_TRACE(round);
+        if (parser->getEmittedOrders().empty()) continue;
+        ASSERT_EQ(forward(), FRAME_APPLIED);
+        expectSameBook();
+    }
+    EXPECT_EQ(builder.getSequenceStats(1).unmatched, 0u);
+}
+
+TEST_F(TbtBookBuilderTest, DetectsGapsAndDuplicates) {
+    std::vector<Order> add = {{1, 100.0, 1, 10, ORDER_SIDE::BUY, ORDER_TYPE::LIMIT, ORDER_ACTION::ADD}};
+    std::vector<char> first = serializeOrders(add, 5);
+    std::vector<char> skipped = serializeOrders(add, 8);
+
+    EXPECT_EQ(builder.applyFrame(first.data(), first.size()), FRAME_APPLIED);
+    EXPECT_EQ(builder.applyFrame(first.data(), first.size()), FRAME_DUPLICATE);
+    EXPECT_TRUE(builder.isInSync(1));
+    EXPECT_EQ(builder.applyFrame(skipped.data(), skipped.size()), FRAME_GAP);
+    EXPECT_FALSE(builder.isInSync(1));
+    EXPECT_EQ(builder.getSequenceStats(1).gaps, 2u);
+    EXPECT_EQ(builder.getSequenceStats(1).duplicates, 1u);
+    EXPECT_EQ(builder.getBuySide(1)[0].qty, 20);
+
+    // A snapshot brings the pair back; any sequence follows
+    std::vector<bookElement> bids = {makeBookElement(100.0, 3)};
+    builder.resync(1, bids, {});
+    EXPECT_TRUE(builder.isInSync(1));
+    std::vector<char> next = serializeOrders(add, 20);
+    EXPECT_EQ(builder.applyFrame(next.data(), next.size()), FRAME_APPLIED);
+    EXPECT_EQ(builder.getBuySide(1)[0].qty, 13);
+}
+
+TEST_F(TbtBookBuilderTest, ChecksumHookSeesEveryFrame) {
+    std::vector<std::pair<PAIR_ID, BookHashes>> seen;
+    builder.setChecksumHook([&](PAIR_ID pairId, const BookHashes& hashes) {
+        seen.push_back({pairId, hashes});
+    });
+    std::vector<bookElement> bids = {makeBookElement(100.0, 10)};
+    std::vector<bookElement> asks = {makeBookElement(101.0, 15)};
+    parser->ApplySnapshot(1, bids, asks, 1000);
+    forward();
+
+    ASSERT_EQ(seen.size(), 1u);
+    EXPECT_EQ(seen[0].first, 1);
+    EXPECT_EQ(seen[0].second.buy, parser->getBookHash(1, ORDER_SIDE::BUY));
+    EXPECT_EQ(seen[0].second.sell, parser->getBookHash(1, ORDER_SIDE::SELL));
+}
@@ -0,0 +1,112 @@
+#include "test_common.h"
+#include "src/tbt_routing.h"
+
+namespace {
+Order makeOrder(ORDER_PRICE price, ORDER_SIDE side, ORDER_TYPE type, ORDER_ACTION action) {
+    return Order{1, price, 0, 10, side, type, action};
+}
+} // namespace
+
+TEST(TbtRoutingTest, SubjectsArePerPairAndSide) {
+    EXPECT_EQ(tbtSubject(7, ORDER_SIDE::BUY), "orderbook.tbt.7.buy");
+    EXPECT_EQ(tbtSubject(7, ORDER_SIDE::SELL), "orderbook.tbt.7.sell");
+    EXPECT_EQ(filteredSubject(7), "orderbook.filtered.7");
+    EXPECT_EQ(snapshotSubject(7), "orderbook.snapshots.7");
+    EXPECT_EQ(standbyCheckpointSubject(7), "orderbook.standby.checkpoint.7");
+}
+
+TEST(TbtRoutingTest, SplitBySideKeepsOrder) {
+    std::vector<Order> orders = {
+        makeOrder(100.0, ORDER_SIDE::BUY, ORDER_TYPE::LIMIT, ORDER_ACTION::ADD),
+        makeOrder(101.0, ORDER_SIDE::SELL, ORDER_TYPE::LIMIT, ORDER_ACTION::ADD),
+        makeOrder(99.0, ORDER_SIDE::BUY, ORDER_TYPE::LIMIT, ORDER_ACTION::REMOVE),
+    };
+    std::vector<Order> buys, sells;
+    splitBySide(orders, buys, sells);
+    ASSERT_EQ(buys.size(), 2u);
+    ASSERT_EQ(sells.size(), 1u);
+    EXPECT_DOUBLE_EQ(buys[0].price, 100.0);
+    EXPECT_DOUBLE_EQ(buys[1].price, 99.0);
+}
+
+TEST(TbtRoutingTest, ParsesFilterSpec) {
+    EventFilterConfig config;
+    ASSERT_TRUE(parseEventFilter("top=5,market", config));
+    EXPECT_EQ(config.topLevels, 5u);
+    EXPECT_TRUE(config.marketOrders);
+    EXPECT_FALSE(config.seekerAdds);
+
+    EXPECT_FALSE(parseEventFilter("top=0", config));
+    EXPECT_FALSE(parseEventFilter("top=5x", config));
+    EXPECT_FALSE(parseEventFilter("trades", config));
+}
+
+TEST(TbtRoutingTest, TopLevelsFilterDropsDeepEvents) {
+    BookSide buy = {makeBookElement(100.0, 10), makeBookElement(99.0, 10), makeBookElement(98.0, 10)};
+    BookSide sell = {makeBookElement(101.0, 10), makeBookElement(102.0, 10), makeBookElement(103.0, 10)};
+    std::vector<Order> orders = {
+        makeOrder(99.0, ORDER_SIDE::BUY, ORDER_TYPE::LIMIT, ORDER_ACTION::ADD),
+        makeOrder(98.0, ORDER_SIDE::BUY, ORDER_TYPE::LIMIT, ORDER_ACTION::ADD),
+        makeOrder(102.0, ORDER_SIDE::SELL, ORDER_TYPE::LIMIT, ORDER_ACTION::REMOVE),
+        makeOrder(103.0, ORDER_SIDE::SELL, ORDER_TYPE::LIMIT, ORDER_ACTION::MODIFY),
+        makeOrder(90.0, ORDER_SIDE::SELL, ORDER_TYPE::MARKET, ORDER_ACTION::ADD),
+    };
+
+    EventFilterConfig config;
+    config.topLevels = 2;
+    std::vector<Order> out;
+    filterEvents(config, orders, buy, sell, out);
+    ASSERT_EQ(out.size(), 3u);
+    EXPECT_DOUBLE_EQ(out[0].price, 99.0);
+    EXPECT_DOUBLE_EQ(out[1].price, 102.0);
+    EXPECT_EQ(out[2].type, ORDER_TYPE::MARKET);
+}
+
+TEST(TbtRoutingTest, KindFilterKeepsSeekerAndMarketEvents) {
+    BookSide empty;
+    std::vector<Order> orders = {
+        makeOrder(100.0, ORDER_SIDE::BUY, ORDER_TYPE::LIMIT, ORDER_ACTION::SEEKER_ADD),
+        makeOrder(100.0, ORDER_SIDE::BUY, ORDER_TYPE::LIMIT, ORDER_ACTION::ADD),
+        makeOrder(100.0, ORDER_SIDE::SELL, ORDER_TYPE::MARKET, ORDER_ACTION::ADD),
+        makeOrder(100.0, ORDER_SIDE::BUY, ORDER_TYPE::ICEBERG, ORDER_ACTION::ADD),
+    };
+
+    EventFilterConfig config;
+    config.seekerAdds = true;
+    std::vector<Order> out;
+    filterEvents(config, orders, empty, empty, out);
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_EQ(out[0].action, ORDER_ACTION::SEEKER_ADD);
+
+    config.marketOrders = true;
+    out.clear();
+    filterEvents(config, orders, empty, empty, out);
+    EXPECT_EQ(out.size(), 2u);
+}
+
+TEST(TbtRoutingTest, ParsesConsolidationGroups) {
+    std::vector<ConsolidationSpec> groups;
+    ASSERT_TRUE(parseConsolidationGroups("100=1,2,3;101=4", groups));
+    ASSERT_EQ(groups.size(), 2u);
+    EXPECT_EQ(groups[0].groupId, 100);
+    EXPECT_EQ(groups[0].members, (std::vector<PAIR_ID>{1, 2, 3}));
+    EXPECT_EQ(groups[1].members, (std::vector<PAIR_ID>{4}));
+    EXPECT_EQ(consolidatedSubject(100), "orderbook.consolidated.100");
+    EXPECT_EQ(nbboSubject(100), "orderbook.nbbo.100");
+
+    EXPECT_FALSE(parseConsolidationGroups("100", groups));
+    EXPECT_FALSE(parseConsolidationGroups("100=", groups));
+    EXPECT_FALSE(parseConsolidationGroups("100=1,x", groups));
+}
+
+TEST(TbtRoutingTest, ParsesPairLists) {
+    std::vector<PAIR_ID> pairs{2};
+    ASSERT_TRUE(parsePairList("1,2,10-12", pairs));
+    EXPECT_EQ(pairs, (std::vector<PAIR_ID>{2, 1, 10, 11, 12}));
+
+    std::vector<PAIR_ID> none;
+    EXPECT_FALSE(parsePairList("5-3", none));
+    EXPECT_FALSE(parsePairList("1,", none));
+    EXPECT_FALSE(parsePairList("1;2", none));
+    EXPECT_TRUE(none.empty());
+}
@@ -0,0 +1,242 @@
+package main
+
+import (
+	"log"
+	"math/rand"
+	"os"
+	"os/signal"
+	"runtime"
+	"sync"
+	"sync/atomic"
+	"syscall"
+	"time"
+
+	"github.com/nats-io/nats.go"
+)
+
+// Load mode: LOAD_PAIRS synthetic pairs published at an aggregate
+// LOAD_RATE snapshots/s, for capacity tests of the processor. Each worker
+// owns a NATS connection, a share of the pairs and one frame buffer, so the
+// hot loop does not allocate. Workers follow an absolute schedule (rate x
+// elapsed) and catch up in bursts after a late wakeup; the reporter logs the
+// achieved rate and how far behind the schedule the feeder is, which is the
+// sign that the feeder itself, not the processor, is the limit.
+
+type loadConfig struct {
+	perPair     bool // orderbook.snapshots.<pair> instead of orderbook.snapshots
+	pairs       int
+	firstPair   int64
+	rate        float64 // aggregate snapshots/s
+	duration    time.Duration
+	depth       int
+	workers     int
+	countOutput bool
+}
+
+func loadConfigFromEnv(pairs int) loadConfig {
+	cfg := loadConfig{
+		perPair:     envBool("PER_PAIR_SUBJECTS", false),
+		pairs:       pairs,
+		firstPair:   int64(envInt("LOAD_FIRST_PAIR", 1)),
+		rate:        envFloat("LOAD_RATE", 1000),
+		duration:    time.Duration(envFloat("LOAD_DURATION", 0) * float64(time.Second)),
+		depth:       envInt("LOAD_DEPTH", 20),
+		workers:     envInt("LOAD_WORKERS", runtime.NumCPU()),
+		countOutput: envBool("LOAD_COUNT_OUTPUT", false),
+	}
+	if cfg.workers > pairs {
+		cfg.workers = pairs
+	}
+	return cfg
+}
+
+type loadPair struct {
+	id      int64
+	subject string
+	gen     *MarketGenerator
+	lastTs  uint64
+}
+
+type loadWorker struct {
+	nc    *nats.Conn
+	pairs []loadPair
+	buf   []byte
+}
+
+type loadStats struct {
+	sent   atomic.Uint64
+	bytes  atomic.Uint64
+	errors atomic.Uint64
+	out    atomic.Uint64 // TBT frames seen on orderbook.tbt.<pair>.<side>
+}
+
+func (w *loadWorker) run(rate float64, start time.Time, stats *loadStats, stop <-chan struct{}) {
+	// At most 1ms of the schedule per burst, so a stalled worker does not
+	// flood the server in one go and stop is checked often
+	maxBurst := uint64(rate / 1000)
+	if maxBurst < 1 {
+		maxBurst = 1
+	}
+	var sent uint64
+	next := 0
+	for {
+		select {
+		case <-stop:
+			return
+		default:
+		}
+		elapsed := time.Since(start)
+		due := uint64(elapsed.Seconds() * rate)
+		if sent >= due {
+			wake := time.Duration(float64(sent+1) / rate * float64(time.Second))
+			time.Sleep(wake - elapsed)
+			continue
+		}
+		n := due - sent
+		if n > maxBurst {
+			n = maxBurst
+		}
+		now := uint64(time.Now().UnixNano())
+		var bytes uint64
+		for i := uint64(0); i < n; i++ {
+			p := &w.pairs[next]
+			if next++; next == len(w.pairs) {
+				next = 0
+			}
+			// Timestamps must rise per pair or the processor drops the snapshot as stale
+			if now > p.lastTs {
+				p.lastTs = now
+			} else {
+				p.lastTs++
+			}
+			bids, asks := p.gen.GenerateSnapshot()
+			frame := serializeSnapshotInto(w.buf, p.id, p.lastTs, bids, asks)
+			if err := w.nc.Publish(p.subject, frame); err != nil {
+				stats.errors.Add(1)
+				continue
+			}
+			bytes += uint64(len(frame))
+		}
+		sent += n
+		stats.sent.Add(n)
+		stats.bytes.Add(bytes)
+	}
+}
+
+func runLoad(natsURL string, cfg loadConfig) {
+	workers := make([]*loadWorker, cfg.workers)
+	for i := range workers {
+		nc, err := nats.Connect(natsURL)
+		if err != nil {
+			log.Fatalf("NATS connect: %v", err)
+		}
+		workers[i] = &loadWorker{nc: nc}
+	}
+	for i := 0; i < cfg.pairs; i++ {
+		id := cfg.firstPair + int64(i)
+		gen := NewMarketGenerator(100.0+float64(i%100)*10, 0.15, 0.0003, 0.02, cfg.depth, 5.0)
+		gen.rng = rand.New(rand.NewSource(id))
+		w := workers[i%cfg.workers]
+		w.pairs = append(w.pairs, loadPair{id: id, subject: snapshotSubject(id, cfg.perPair), gen: gen})
+	}
+	frameSize := snapshotSize(make([]BookLevel, cfg.depth), make([]BookLevel, cfg.depth))
+	for _, w := range workers {
+		w.buf = make([]byte, frameSize)
+	}
+
+	stats := &loadStats{}
+	if cfg.countOutput {
+		nc, err := nats.Connect(natsURL)
+		if err != nil {
+			log.Fatalf("NATS connect: %v", err)
+		}
+		defer nc.Close()
+		sub, err := nc.Subscribe("orderbook.tbt.*.*", func(*nats.Msg) { stats.out.Add(1) })
+		if err != nil {
+			log.Fatalf("subscribe: %v", err)
+		}
+		sub.SetPendingLimits(-1, -1)
+	}
+
+	subject := "orderbook.snapshots"
+	if cfg.perPair {
+		subject = "orderbook.snapshots.<pair>"
+	}
+	log.Printf("Load: %d pairs (%d-%d), %.0f snapshots/s, depth %d, %d workers, %d-byte frames to %s",
+		cfg.pairs, cfg.firstPair, cfg.firstPair+int64(cfg.pairs)-1, cfg.rate, cfg.depth, cfg.workers,
+		frameSize, subject)
+	log.Printf("Run the processor with PAIRS=%d-%d", cfg.firstPair, cfg.firstPair+int64(cfg.pairs)-1)
+
+	stop := make(chan struct{})
+	var stopOnce sync.Once
+	halt := func() { stopOnce.Do(func() { close(stop) }) }
+	sig := make(chan os.Signal, 1)
+	signal.Notify(sig, os.Interrupt, syscall.SIGTERM)
+	go func() {
+		<-sig
+		halt()
+	}()
+	if cfg.duration > 0 {
+		time.AfterFunc(cfg.duration, halt)
+	}
+
+	start := time.Now()
+	var wg sync.WaitGroup
+	for _, w := range workers {
+		wg.Add(1)
+		go func(w *loadWorker) {
+			defer wg.Done()
+			w.run(cfg.rate*float64(len(w.pairs))/float64(cfg.pairs), start, stats, stop)
+		}(w)
+	}
+
+	done := make(chan struct{})
+	go func() {
+		wg.Wait()
+		close(done)
+	}()
+	reportLoad(cfg, stats, start, done)
+
+	for _, w := range workers {
+		w.nc.Flush()
+		w.nc.Close()
+	}
+	elapsed := time.Since(start).Seconds()
+	sent := stats.sent.Load()
+	achieved := float64(sent) / elapsed
+	log.Printf("Load: sent %d snapshots in %.1fs: %.0f/s achieved, target %.0f (%.1f%%), %d publish errors",
+		sent, elapsed, achieved, cfg.rate, 100*achieved/cfg.rate, stats.errors.Load())
+	if cfg.countOutput {
+		log.Printf("Load: %d TBT frames received", stats.out.Load())
+	}
+}
+
+// reportLoad logs the rates of the last second until done is closed
+func reportLoad(cfg loadConfig, stats *loadStats, start time.Time, done <-chan struct{}) {
+	ticker := time.NewTicker(time.Second)
+	defer ticker.Stop()
+	last := start
+	var lastSent, lastBytes, lastOut uint64
+	for {
+		select {
+		case <-done:
+			return
+		case now := <-ticker.C:
+			sent, bytes, out := stats.sent.Load(), stats.bytes.Load(), stats.out.Load()
+			secs := now.Sub(last).Seconds()
+			behind := int64(now.Sub(start).Seconds()*cfg.rate) - int64(sent)
+			if behind < 0 {
+				behind = 0
+			}
+			if cfg.countOutput {
+				log.Printf("Load: %.0f snapshots/s (target %.0f), %.1f MB/s, %d behind schedule, %.0f TBT frames/s out",
+					float64(sent-lastSent)/secs, cfg.rate, float64(bytes-lastBytes)/secs/1e6, behind,
+					float64(out-lastOut)/secs)
+			} else {
+				log.Printf("Load: %.0f snapshots/s (target %.0f), %.1f MB/s, %d behind schedule",
+					float64(sent-lastSent)/secs, cfg.rate, float64(bytes-lastBytes)/secs/1e6, behind)
+			}
+			last, lastSent, lastBytes, lastOut = now, sent, bytes, out
+		}
+	}
+}
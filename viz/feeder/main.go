@@ -6,6 +6,7 @@ import (
 	"math"
 	"math/rand"
 	"os"
+	"strconv"
 	"strings"
 	"sync/atomic"
 	"time"
@@ -24,9 +25,16 @@ type MarketGenerator struct {
 	tick      uint64
 	rng       *rand.Rand
 
-	// Persistent book state for smooth evolution
-	prevBids []BookLevel
-	prevAsks []BookLevel
+	// Persistent book state for smooth evolution. Each side has two buffers,
+	// swapped every tick: the slices GenerateSnapshot returns stay valid until
+	// the call after next. Levels sit on the tick grid, so the previous qty
+	// of a price is found by its tick index.
+	bidBuf      [2][]BookLevel
+	askBuf      [2][]BookLevel
+	cur         int
+	hasPrev     bool
+	prevBestBid int64 // tick index of the previous best bid
+	prevBestAsk int64
 }
 
 var orderSeq uint64
@@ -41,6 +49,8 @@ func NewMarketGenerator(basePrice, amplitude, frequency, noise float64, depth in
 		spreadBps: spreadBps,
 		tickSize:  math.Round(basePrice*0.0001*100) / 100, // round to cent
 		rng:       rand.New(rand.NewSource(42)),
+		bidBuf:    [2][]BookLevel{make([]BookLevel, depth), make([]BookLevel, depth)},
+		askBuf:    [2][]BookLevel{make([]BookLevel, depth), make([]BookLevel, depth)},
 	}
 }
 
@@ -49,10 +59,6 @@ type BookLevel struct {
 	Qty   int32
 }
 
-func roundToTick(price, tickSize float64) float64 {
-	return math.Round(price/tickSize) * tickSize
-}
-
 func (g *MarketGenerator) GenerateSnapshot() (bids []BookLevel, asks []BookLevel) {
 	g.tick++
 	sinComponent := g.amplitude * math.Sin(2.0*math.Pi*g.frequency*float64(g.tick))
@@ -60,26 +66,22 @@ func (g *MarketGenerator) GenerateSnapshot() (bids []BookLevel, asks []BookLevel
 	noise := (g.rng.Float64()*2 - 1) * g.noise * 0.1
 	midPrice := g.basePrice + sinComponent + noise
 	halfSpread := midPrice * (g.spreadBps / 10000.0) / 2.0
-	bestBid := roundToTick(midPrice-halfSpread, g.tickSize)
-	bestAsk := roundToTick(midPrice+halfSpread, g.tickSize)
+	bestBid := int64(math.Round((midPrice - halfSpread) / g.tickSize))
+	bestAsk := int64(math.Round((midPrice + halfSpread) / g.tickSize))
 	if bestAsk <= bestBid {
-		bestAsk = bestBid + g.tickSize
+		bestAsk = bestBid + 1
 	}
 
-	bids = make([]BookLevel, g.depth)
+	prevBids, prevAsks := g.bidBuf[g.cur], g.askBuf[g.cur]
+	g.cur ^= 1
+	bids, asks = g.bidBuf[g.cur], g.askBuf[g.cur]
+
 	for i := 0; i < g.depth; i++ {
-		price := bestBid - float64(i)*g.tickSize
+		price := float64(bestBid-int64(i)) * g.tickSize
 		qty := int32(500 + g.rng.Intn(4500))
-		// If we have previous state, evolve smoothly
-		if len(g.prevBids) > 0 {
-			// Find matching price in prev
-			for _, pb := range g.prevBids {
-				if math.Abs(pb.Price-price) < g.tickSize*0.5 {
-					// Evolve qty: keep 80% of prev + 20% new random
-					qty = int32(float64(pb.Qty)*0.8 + float64(qty)*0.2)
-					break
-				}
-			}
+		// If we have previous state, evolve smoothly: keep 80% of prev + 20% new random
+		if j := g.prevBestBid - (bestBid - int64(i)); g.hasPrev && j >= 0 && j < int64(g.depth) {
+			qty = int32(float64(prevBids[j].Qty)*0.8 + float64(qty)*0.2)
 		}
 		if qty < 100 {
 			qty = 100
@@ -87,17 +89,11 @@ func (g *MarketGenerator) GenerateSnapshot() (bids []BookLevel, asks []BookLevel
 		bids[i] = BookLevel{Price: math.Round(price*100) / 100, Qty: qty}
 	}
 
-	asks = make([]BookLevel, g.depth)
 	for i := 0; i < g.depth; i++ {
-		price := bestAsk + float64(i)*g.tickSize
+		price := float64(bestAsk+int64(i)) * g.tickSize
 		qty := int32(500 + g.rng.Intn(4500))
-		if len(g.prevAsks) > 0 {
-			for _, pa := range g.prevAsks {
-				if math.Abs(pa.Price-price) < g.tickSize*0.5 {
-					qty = int32(float64(pa.Qty)*0.8 + float64(qty)*0.2)
-					break
-				}
-			}
+		if j := bestAsk + int64(i) - g.prevBestAsk; g.hasPrev && j >= 0 && j < int64(g.depth) {
+			qty = int32(float64(prevAsks[j].Qty)*0.8 + float64(qty)*0.2)
 		}
 		if qty < 100 {
 			qty = 100
@@ -105,8 +101,8 @@ func (g *MarketGenerator) GenerateSnapshot() (bids []BookLevel, asks []BookLevel
 		asks[i] = BookLevel{Price: math.Round(price*100) / 100, Qty: qty}
 	}
 
-	g.prevBids = bids
-	g.prevAsks = asks
+	g.prevBestBid, g.prevBestAsk = bestBid, bestAsk
+	g.hasPrev = true
 	return bids, asks
 }
 
@@ -171,11 +167,20 @@ type Order struct {
 	Action int32
 }
 
+func snapshotSize(bids, asks []BookLevel) int {
+	return 20 + (len(bids)+len(asks))*12
+}
+
 func serializeSnapshot(pairID int64, timestamp uint64, bids, asks []BookLevel) []byte {
+	return serializeSnapshotInto(make([]byte, snapshotSize(bids, asks)), pairID, timestamp, bids, asks)
+}
+
+// serializeSnapshotInto writes the frame into buf, which must hold
+// snapshotSize(bids, asks) bytes, and returns it resliced to the frame
+func serializeSnapshotInto(buf []byte, pairID int64, timestamp uint64, bids, asks []BookLevel) []byte {
 	numBids := uint16(len(bids))
 	numAsks := uint16(len(asks))
-	totalSize := 20 + int(numBids+numAsks)*12
-	buf := make([]byte, totalSize)
+	buf = buf[:snapshotSize(bids, asks)]
 
 	binary.LittleEndian.PutUint64(buf[0:8], uint64(pairID))
 	binary.LittleEndian.PutUint64(buf[8:16], timestamp)
@@ -240,12 +245,40 @@ func envBool(key string, def bool) bool {
 	}
 }
 
+// snapshotSubject is orderbook.snapshots, or orderbook.snapshots.<pair> for
+// processors in partitioned mode (PER_PAIR_SUBJECTS)
+func snapshotSubject(pairID int64, perPair bool) string {
+	if perPair {
+		return "orderbook.snapshots." + strconv.FormatInt(pairID, 10)
+	}
+	return "orderbook.snapshots"
+}
+
+func envInt(key string, def int) int {
+	if v, err := strconv.Atoi(strings.TrimSpace(os.Getenv(key))); err == nil && v > 0 {
+		return v
+	}
+	return def
+}
+
+func envFloat(key string, def float64) float64 {
+	if v, err := strconv.ParseFloat(strings.TrimSpace(os.Getenv(key)), 64); err == nil && v > 0 {
+		return v
+	}
+	return def
+}
+
 func main() {
 	natsURL := os.Getenv("NATS_URL")
 	if natsURL == "" {
 		natsURL = nats.DefaultURL
 	}
 
+	if pairs := envInt("LOAD_PAIRS", 0); pairs > 0 {
+		runLoad(natsURL, loadConfigFromEnv(pairs))
+		return
+	}
+
 	nc, err := nats.Connect(natsURL)
 	if err != nil {
 		log.Fatalf("NATS connect: %v", err)
@@ -266,27 +299,41 @@ func main() {
 	ticker := time.NewTicker(time.Second / time.Duration(rate))
 	defer ticker.Stop()
 
+	subject := snapshotSubject(1, envBool("PER_PAIR_SUBJECTS", false))
 	publishOrders := envBool("PUBLISH_ORDERS", false)
 	if publishOrders {
-		log.Printf("Publishing snapshots at %d/sec to orderbook.snapshots + orderbook.tbt", rate)
+		log.Printf("Publishing snapshots at %d/sec to %s + orderbook.tbt.1.<side>", rate, subject)
 	} else {
-		log.Printf("Publishing snapshots at %d/sec to orderbook.snapshots", rate)
+		log.Printf("Publishing snapshots at %d/sec to %s", rate, subject)
 	}
 
 	for range ticker.C {
 		bids, asks := gen.GenerateSnapshot()
 
 		snapData := serializeSnapshot(1, gen.tick, bids, asks)
-		if err := nc.Publish("orderbook.snapshots", snapData); err != nil {
+		if err := nc.Publish(subject, snapData); err != nil {
 			log.Printf("publish snapshot error: %v", err)
 			continue
 		}
 
 		if publishOrders {
 			orders := gen.GenerateOrders(bids, asks)
-			if len(orders) > 0 {
-				orderData := serializeOrders(orders)
-				if err := nc.Publish("orderbook.tbt", orderData); err != nil {
+			var buys, sells []Order
+			for _, o := range orders {
+				if o.Side == 1 {
+					buys = append(buys, o)
+				} else {
+					sells = append(sells, o)
+				}
+			}
+			for _, part := range []struct {
+				subject string
+				orders  []Order
+			}{{"orderbook.tbt.1.buy", buys}, {"orderbook.tbt.1.sell", sells}} {
+				if len(part.orders) == 0 {
+					continue
+				}
+				if err := nc.Publish(part.subject, serializeOrders(part.orders)); err != nil {
 					log.Printf("publish orders error: %v", err)
 				}
 			}
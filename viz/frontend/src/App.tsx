@@ -5,7 +5,9 @@ import HeatmapPanel from './components/HeatmapPanel';
 import DepthChartPanel from './components/DepthChartPanel';
 import OrderFlowPanel from './components/OrderFlowPanel';
 
-const wsUrl = `ws://${window.location.host}/ws`;
+// ?format=json switches the stream to JSON for debugging
+const wsFormat = new URLSearchParams(window.location.search).get('format') === 'json' ? '?format=json' : '';
+const wsUrl = `ws://${window.location.host}/ws${wsFormat}`;
 
 function DockApp() {
   const dockRef = useRef<DockLayout>(null);
@@ -1,6 +1,7 @@
 import { useRef, useEffect } from 'react';
 import type { SnapshotMessage } from '../types';
 import { bidColorCSS, askColorCSS } from '../lib/colorScale';
+import { sideLevels } from '../lib/wireDecode';
 
 interface Props {
   snapshot: SnapshotMessage | null;
@@ -31,8 +32,8 @@ export default function DepthChart({ snapshot }: Props) {
     ctx.fillStyle = '#0d0d14';
     ctx.fillRect(0, 0, cw, ch);
 
-    const bids = [...snapshot.bids].sort((a, b) => b.price - a.price);
-    const asks = [...snapshot.asks].sort((a, b) => a.price - b.price);
+    const bids = sideLevels(snapshot.bids).sort((a, b) => b.price - a.price);
+    const asks = sideLevels(snapshot.asks).sort((a, b) => a.price - b.price);
 
     if (bids.length === 0 && asks.length === 0) return;
 
@@ -1,75 +1,53 @@
-import { useRef, useEffect, useCallback } from 'react';
-import type { SnapshotMessage, HeatmapColumn } from '../types';
+import { useRef, useEffect, useCallback, useState } from 'react';
+import { getSharedViewport, type Viewport } from '../lib/heatmapRenderer';
 import {
-  pushColumn,
-  renderHeatmap,
-  getSharedState,
-  getSharedViewport,
-  type Viewport,
-} from '../lib/heatmapRenderer';
+  attachHeatmapCanvas,
+  heatmapRange,
+  postHeatmapResize,
+  postHeatmapViewport,
+} from '../lib/heatmapBridge';
+
+const MAX_COLUMNS = 500; // as in the worker's HeatmapRenderer
 
 interface Props {
-  snapshot: SnapshotMessage | null;
   onViewportChange?: (viewport: Viewport) => void;
 }
 
-export default function Heatmap({ snapshot, onViewportChange }: Props) {
+// The canvas is handed to the heatmap worker, which draws on it directly;
+// this component only reports size and viewport changes
+export default function Heatmap({ onViewportChange }: Props) {
   const canvasRef = useRef<HTMLCanvasElement>(null);
-  const stateRef = useRef(getSharedState());
   const viewportRef = useRef(getSharedViewport());
-  const rafRef = useRef<number>(0);
-  const dirtyRef = useRef(false);
+  const [supported, setSupported] = useState(true);
   const dragRef = useRef<{ startX: number; startY: number; startTimeOffset: number; startPriceMin: number; startPriceMax: number } | null>(null);
 
   const notifyViewport = useCallback(() => {
     onViewportChange?.(viewportRef.current);
   }, [onViewportChange]);
 
-  useEffect(() => {
-    if (!snapshot) return;
-
-    const levels = new Map<number, { qty: number; side: 'bid' | 'ask' }>();
-
-    for (const b of snapshot.bids) {
-      const key = Math.round(b.price * 100) / 100;
-      levels.set(key, { qty: b.qty, side: 'bid' });
-    }
-    for (const a of snapshot.asks) {
-      const key = Math.round(a.price * 100) / 100;
-      levels.set(key, { qty: a.qty, side: 'ask' });
-    }
-
-    const col: HeatmapColumn = { timestamp: snapshot.timestamp, levels };
-    pushColumn(stateRef.current, col);
-    dirtyRef.current = true;
-  }, [snapshot]);
-
-  // Render loop
   useEffect(() => {
     const canvas = canvasRef.current;
     if (!canvas) return;
 
-    const ctx = canvas.getContext('2d', { alpha: false });
-    if (!ctx) return;
-
-    const render = () => {
-      if (dirtyRef.current) {
-        const rect = canvas.getBoundingClientRect();
-        const dpr = window.devicePixelRatio || 1;
-        const w = Math.floor(rect.width * dpr);
-        const h = Math.floor(rect.height * dpr);
-        if (canvas.width !== w || canvas.height !== h) {
-          canvas.width = w;
-          canvas.height = h;
-        }
-        renderHeatmap(ctx, stateRef.current, w, h, viewportRef.current);
-        dirtyRef.current = false;
-      }
-      rafRef.current = requestAnimationFrame(render);
+    const pixelSize = () => {
+      const rect = canvas.getBoundingClientRect();
+      const dpr = window.devicePixelRatio || 1;
+      return [Math.floor(rect.width * dpr), Math.floor(rect.height * dpr)] as const;
     };
-
-    rafRef.current = requestAnimationFrame(render);
-    return () => cancelAnimationFrame(rafRef.current);
+    const [w, h] = pixelSize();
+    if (!attachHeatmapCanvas(canvas, w, h)) {
+      setSupported(false);
+      return;
+    }
+    postHeatmapResize(w, h);
+    postHeatmapViewport(viewportRef.current);
+
+    const observer = new ResizeObserver(() => {
+      const [rw, rh] = pixelSize();
+      postHeatmapResize(rw, rh);
+    });
+    observer.observe(canvas);
+    return () => observer.disconnect();
   }, []);
 
   // Wheel zoom (price axis) — attached via addEventListener for passive:false
@@ -80,13 +58,12 @@ export default function Heatmap({ snapshot, onViewportChange }: Props) {
     const onWheel = (e: WheelEvent) => {
       e.preventDefault();
       const vp = viewportRef.current;
-      const state = stateRef.current;
       const rect = canvas.getBoundingClientRect();
       const mouseY = (e.clientY - rect.top) / rect.height; // 0=top, 1=bottom
 
       // Get current effective bounds
-      const curMin = vp.autoFollow ? state.dataPriceMin : vp.priceMin;
-      const curMax = vp.autoFollow ? state.dataPriceMax : vp.priceMax;
+      const curMin = vp.autoFollow ? heatmapRange.priceMin : vp.priceMin;
+      const curMax = vp.autoFollow ? heatmapRange.priceMax : vp.priceMax;
       const range = curMax - curMin;
 
       // Price at mouse position (top=max, bottom=min)
@@ -102,7 +79,7 @@ export default function Heatmap({ snapshot, onViewportChange }: Props) {
       vp.priceMin = newMin;
       vp.priceMax = newMax;
       vp.autoFollow = false;
-      dirtyRef.current = true;
+      postHeatmapViewport(vp);
       notifyViewport();
     };
 
@@ -117,9 +94,8 @@ export default function Heatmap({ snapshot, onViewportChange }: Props) {
 
     const onMouseDown = (e: MouseEvent) => {
       const vp = viewportRef.current;
-      const state = stateRef.current;
-      const curMin = vp.autoFollow ? state.dataPriceMin : vp.priceMin;
-      const curMax = vp.autoFollow ? state.dataPriceMax : vp.priceMax;
+      const curMin = vp.autoFollow ? heatmapRange.priceMin : vp.priceMin;
+      const curMax = vp.autoFollow ? heatmapRange.priceMax : vp.priceMax;
 
       dragRef.current = {
         startX: e.clientX,
@@ -140,7 +116,7 @@ export default function Heatmap({ snapshot, onViewportChange }: Props) {
       const dy = e.clientY - drag.startY;
 
       // X drag: shift time offset (pixels -> columns)
-      const colWidth = Math.max(1, Math.floor(rect.width / stateRef.current.maxColumns));
+      const colWidth = Math.max(1, Math.floor(rect.width / MAX_COLUMNS));
       vp.timeOffset = drag.startTimeOffset + dx / colWidth;
 
       // Y drag: shift price range
@@ -150,7 +126,7 @@ export default function Heatmap({ snapshot, onViewportChange }: Props) {
       vp.priceMax = drag.startPriceMax + priceDelta;
       vp.autoFollow = false;
 
-      dirtyRef.current = true;
+      postHeatmapViewport(vp);
       notifyViewport();
     };
 
@@ -177,7 +153,7 @@ export default function Heatmap({ snapshot, onViewportChange }: Props) {
       const vp = viewportRef.current;
       vp.autoFollow = true;
       vp.timeOffset = 0;
-      dirtyRef.current = true;
+      postHeatmapViewport(vp);
       notifyViewport();
     };
 
@@ -185,6 +161,14 @@ export default function Heatmap({ snapshot, onViewportChange }: Props) {
     return () => canvas.removeEventListener('dblclick', onDblClick);
   }, [notifyViewport]);
 
+  if (!supported) {
+    return (
+      <div style={{ color: '#555', fontFamily: 'monospace', padding: 24 }}>
+        This browser has no OffscreenCanvas support
+      </div>
+    );
+  }
+
   return (
     <canvas
       ref={canvasRef}
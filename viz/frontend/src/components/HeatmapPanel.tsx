@@ -1,11 +1,12 @@
 import { useState } from 'react';
 import type { Viewport } from '../lib/heatmapRenderer';
 import { getSharedViewport } from '../lib/heatmapRenderer';
+import { postHeatmapViewport } from '../lib/heatmapBridge';
 import { useMarketData } from '../context/MarketDataContext';
 import Heatmap from './Heatmap';
 
 export default function HeatmapPanel() {
-  const { lastSnapshot, connected } = useMarketData();
+  const { connected } = useMarketData();
   const [autoFollow, setAutoFollow] = useState(true);
 
   const handleViewportChange = (vp: Viewport) => {
@@ -16,12 +17,13 @@ export default function HeatmapPanel() {
     const vp = getSharedViewport();
     vp.autoFollow = true;
     vp.timeOffset = 0;
+    postHeatmapViewport(vp);
     setAutoFollow(true);
   };
 
   return (
     <div style={{ width: '100%', height: '100%', position: 'relative', overflow: 'hidden' }}>
-      <Heatmap snapshot={lastSnapshot} onViewportChange={handleViewportChange} />
+      <Heatmap onViewportChange={handleViewportChange} />
       <div style={{
         position: 'absolute',
         top: 6,
@@ -1,5 +1,7 @@
 import { useEffect, useRef, useCallback, useState } from 'react';
-import type { WSMessage, SnapshotMessage, OrderEntry } from '../types';
+import type { SnapshotMessage, OrderEntry } from '../types';
+import { decodeBinary, decodeJson, KIND_HEATMAP } from '../lib/wireDecode';
+import { postHeatmapFrame, postHeatmapSnapshot } from '../lib/heatmapBridge';
 
 interface UseWebSocketReturn {
   connected: boolean;
@@ -7,6 +9,8 @@ interface UseWebSocketReturn {
   orderBuffer: OrderEntry[];
 }
 
+const ORDER_BUFFER = 200;
+
 export function useWebSocket(url: string): UseWebSocketReturn {
   const [connected, setConnected] = useState(false);
   const [lastSnapshot, setLastSnapshot] = useState<SnapshotMessage | null>(null);
@@ -14,10 +18,41 @@ export function useWebSocket(url: string): UseWebSocketReturn {
   const wsRef = useRef<WebSocket | null>(null);
   const reconnectTimer = useRef<number>(0);
 
+  // React state is updated at most once per animation frame, whatever the
+  // message rate: the latest snapshot wins, orders are batched
+  const pendingSnapshot = useRef<SnapshotMessage | null>(null);
+  const pendingOrders = useRef<OrderEntry[]>([]);
+  const flushScheduled = useRef(false);
+  // Set once the server sends heatmap columns: the worker then has no use for snapshots
+  const serverColumns = useRef(false);
+
+  const flush = useCallback(() => {
+    flushScheduled.current = false;
+    if (pendingSnapshot.current) {
+      setLastSnapshot(pendingSnapshot.current);
+      pendingSnapshot.current = null;
+    }
+    if (pendingOrders.current.length > 0) {
+      const batch = pendingOrders.current;
+      pendingOrders.current = [];
+      setOrderBuffer((prev) => {
+        const next = prev.concat(batch);
+        return next.length > ORDER_BUFFER ? next.slice(-ORDER_BUFFER) : next;
+      });
+    }
+  }, []);
+
+  const scheduleFlush = useCallback(() => {
+    if (flushScheduled.current) return;
+    flushScheduled.current = true;
+    requestAnimationFrame(flush);
+  }, [flush]);
+
   const connect = useCallback(() => {
     if (wsRef.current?.readyState === WebSocket.OPEN) return;
 
     const ws = new WebSocket(url);
+    ws.binaryType = 'arraybuffer';
     wsRef.current = ws;
 
     ws.onopen = () => setConnected(true);
@@ -29,18 +64,42 @@ export function useWebSocket(url: string): UseWebSocketReturn {
 
     ws.onmessage = (ev) => {
       try {
-        const msg: WSMessage = JSON.parse(ev.data);
+        if (typeof ev.data === 'string') {
+          const msg = decodeJson(ev.data);
+          if (msg.type === 'snapshot') {
+            postHeatmapSnapshot(msg);
+            pendingSnapshot.current = msg;
+          } else if (msg.type === 'orders') {
+            pendingOrders.current.push(...msg.orders);
+          }
+          scheduleFlush();
+          return;
+        }
+
+        const buf: ArrayBuffer = ev.data;
+        const kind = buf.byteLength > 0 ? new Uint8Array(buf, 0, 1)[0] : 0;
+        if (kind === KIND_HEATMAP) {
+          // Heatmap columns go to the worker without touching the main thread
+          serverColumns.current = true;
+          postHeatmapFrame(buf);
+          return;
+        }
+        const msg = decodeBinary(buf);
+        if (!msg) return;
         if (msg.type === 'snapshot') {
-          setLastSnapshot(msg);
+          // The decoded sides are copies, so the buffer can move to the worker,
+          // which bins it unless the server aggregates the columns
+          pendingSnapshot.current = msg;
+          if (!serverColumns.current) postHeatmapFrame(buf);
         } else if (msg.type === 'orders') {
-          setOrderBuffer((prev) => {
-            const next = [...prev, ...msg.orders];
-            return next.length > 200 ? next.slice(-200) : next;
-          });
+          const orders = pendingOrders.current;
+          for (const o of msg.orders) orders.push(o);
+          if (orders.length > ORDER_BUFFER) orders.splice(0, orders.length - ORDER_BUFFER);
         }
+        scheduleFlush();
       } catch {}
     };
-  }, [url]);
+  }, [url, scheduleFlush]);
 
   useEffect(() => {
     connect();
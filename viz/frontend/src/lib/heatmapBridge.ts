@@ -0,0 +1,60 @@
+import type { SnapshotMessage } from '../types';
+import type { Viewport } from './heatmapRenderer';
+
+// Messages to the heatmap worker (workers/heatmapWorker.ts)
+export type HeatmapWorkerMessage =
+  | { type: 'canvas'; canvas: OffscreenCanvas; width: number; height: number }
+  | { type: 'resize'; width: number; height: number }
+  | { type: 'viewport'; viewport: Viewport }
+  | { type: 'frame'; data: ArrayBuffer } // binary WebSocket message, transferred
+  | { type: 'snapshot'; snapshot: SnapshotMessage }; // JSON mode
+
+// Auto-follow price range last drawn by the worker, for zoom and pan
+export const heatmapRange = { priceMin: 0, priceMax: 0 };
+
+// One worker for the page, so rc-dock remounts keep the column history
+let worker: Worker | null = null;
+
+export function getHeatmapWorker(): Worker {
+  if (!worker) {
+    worker = new Worker(new URL('../workers/heatmapWorker.ts', import.meta.url), { type: 'module' });
+    worker.onmessage = (ev: MessageEvent<{ type: 'range'; priceMin: number; priceMax: number }>) => {
+      heatmapRange.priceMin = ev.data.priceMin;
+      heatmapRange.priceMax = ev.data.priceMax;
+    };
+  }
+  return worker;
+}
+
+function post(msg: HeatmapWorkerMessage, transfer: Transferable[] = []): void {
+  getHeatmapWorker().postMessage(msg, transfer);
+}
+
+// Hands the buffer to the worker; it is detached on this side afterwards
+export function postHeatmapFrame(data: ArrayBuffer): void {
+  post({ type: 'frame', data }, [data]);
+}
+
+export function postHeatmapSnapshot(snapshot: SnapshotMessage): void {
+  post({ type: 'snapshot', snapshot });
+}
+
+export function postHeatmapViewport(viewport: Viewport): void {
+  post({ type: 'viewport', viewport: { ...viewport } });
+}
+
+export function postHeatmapResize(width: number, height: number): void {
+  post({ type: 'resize', width, height });
+}
+
+// A canvas can be transferred only once (StrictMode runs effects twice)
+const transferred = new WeakSet<HTMLCanvasElement>();
+
+export function attachHeatmapCanvas(canvas: HTMLCanvasElement, width: number, height: number): boolean {
+  if (transferred.has(canvas)) return true;
+  if (!('transferControlToOffscreen' in canvas)) return false;
+  const offscreen = canvas.transferControlToOffscreen();
+  transferred.add(canvas);
+  post({ type: 'canvas', canvas: offscreen, width, height }, [offscreen]);
+  return true;
+}
@@ -1,5 +1,5 @@
-import { bidColor, askColor } from './colorScale';
-import type { HeatmapColumn } from '../types';
+import { bidColorCSS, askColorCSS } from './colorScale';
+import type { HeatmapColumn, SnapshotMessage } from '../types';
 
 export interface Viewport {
   priceMin: number;
@@ -8,24 +8,6 @@ export interface Viewport {
   autoFollow: boolean;
 }
 
-export interface HeatmapState {
-  columns: HeatmapColumn[];
-  maxColumns: number;
-  dataPriceMin: number;
-  dataPriceMax: number;
-  maxQty: number;
-}
-
-export function createHeatmapState(maxColumns = 500): HeatmapState {
-  return {
-    columns: [],
-    maxColumns,
-    dataPriceMin: Infinity,
-    dataPriceMax: -Infinity,
-    maxQty: 1,
-  };
-}
-
 export function createViewport(): Viewport {
   return {
     priceMin: 0,
@@ -35,160 +17,317 @@ export function createViewport(): Viewport {
   };
 }
 
-// Module-scoped singletons so rc-dock remounts don't lose accumulated data
-let sharedState: HeatmapState | null = null;
+// Module-scoped singleton so rc-dock remounts don't lose the viewport
 let sharedViewport: Viewport | null = null;
 
-export function getSharedState(): HeatmapState {
-  if (!sharedState) sharedState = createHeatmapState(500);
-  return sharedState;
-}
-
 export function getSharedViewport(): Viewport {
   if (!sharedViewport) sharedViewport = createViewport();
   return sharedViewport;
 }
 
-export function pushColumn(state: HeatmapState, col: HeatmapColumn): void {
-  state.columns.push(col);
-  if (state.columns.length > state.maxColumns) {
-    state.columns.shift();
+// Max over the last `window` pushed values: a monotonic deque of
+// (index, value) with decreasing values, stored in preallocated rings
+export class RunningMax {
+  private idx: Float64Array;
+  private val: Float64Array;
+  private head = 0;
+  private size = 0;
+  private next = 0;
+
+  constructor(private window: number) {
+    this.idx = new Float64Array(window);
+    this.val = new Float64Array(window);
   }
 
-  let pMin = Infinity;
-  let pMax = -Infinity;
-  let mQty = 1;
-
-  // Scan last ~30 columns for price range (smooth tracking)
-  const lookback = Math.min(30, state.columns.length);
-  for (let i = state.columns.length - lookback; i < state.columns.length; i++) {
-    const c = state.columns[i];
-    for (const [price] of c.levels) {
-      if (price < pMin) pMin = price;
-      if (price > pMax) pMax = price;
+  push(v: number): number {
+    const cap = this.window;
+    while (this.size > 0 && this.val[(this.head + this.size - 1) % cap] <= v) this.size--;
+    if (this.size > 0 && this.next - this.idx[this.head] >= cap) {
+      this.head = (this.head + 1) % cap;
+      this.size--;
     }
+    const tail = (this.head + this.size) % cap;
+    this.idx[tail] = this.next++;
+    this.val[tail] = v;
+    this.size++;
+    return this.val[this.head];
   }
+}
 
-  // maxQty from all columns (for consistent color scale)
-  for (const c of state.columns) {
-    for (const [, entry] of c.levels) {
-      if (entry.qty > mQty) mQty = entry.qty;
-    }
+const AXIS_WIDTH = 64; // price labels, right of the scrolling plot
+const PALETTE_STEPS = 64;
+const BACKGROUND = '#0a0a0f';
+const BID_PALETTE = Array.from({ length: PALETTE_STEPS + 1 }, (_, i) => bidColorCSS(i / PALETTE_STEPS));
+const ASK_PALETTE = Array.from({ length: PALETTE_STEPS + 1 }, (_, i) => askColorCSS(i / PALETTE_STEPS));
+
+// Column history and drawing state of the heatmap worker. Columns live in
+// one preallocated Float32Array ring (maxColumns x buckets). A new column
+// scrolls the plot left with drawImage and draws only itself; the whole
+// plot is redrawn only when the mapping changes (resize, viewport, price
+// range leaving the drawn range, color scale moving by more than 25%).
+export class HeatmapRenderer {
+  readonly maxColumns: number;
+  private buckets = 0;
+  private ring = new Float32Array(0);
+  private basePrice: Float64Array;
+  private bucketSize: Float64Array;
+  private colMin: Float64Array; // price range of each slot's non-empty buckets
+  private colMax: Float64Array;
+  private head = 0; // next slot written
+  private count = 0;
+  private localMax: RunningMax;
+  private maxQty = 1;
+
+  // Client-side binning of raw snapshots into the current display frame
+  private slot = new Float32Array(0);
+  private slotBase = 0; // bucket index of slot[0]
+  private slotBucketSize = 0.01;
+  private slotTime = 0;
+  private slotHasData = false;
+  serverColumns = false;
+
+  private ctx: OffscreenCanvasRenderingContext2D | null = null;
+  private width = 0;
+  private height = 0;
+  private viewport: Viewport = createViewport();
+  private drawnMin = 0; // price range and color scale of the pixels on screen
+  private drawnMax = 0;
+  private drawnQty = 1;
+  private pending = 0; // columns pushed since the last draw
+  private fullRedraw = true;
+
+  constructor(maxColumns = 500) {
+    this.maxColumns = maxColumns;
+    this.basePrice = new Float64Array(maxColumns);
+    this.bucketSize = new Float64Array(maxColumns);
+    this.colMin = new Float64Array(maxColumns);
+    this.colMax = new Float64Array(maxColumns);
+    this.localMax = new RunningMax(maxColumns);
   }
 
-  const padding = (pMax - pMin) * 0.1;
-  state.dataPriceMin = pMin - padding;
-  state.dataPriceMax = pMax + padding;
-  state.maxQty = mQty;
-}
+  setCanvas(canvas: OffscreenCanvas): void {
+    this.ctx = canvas.getContext('2d', { alpha: false });
+    this.fullRedraw = true;
+  }
 
-export function renderHeatmap(
-  ctx: CanvasRenderingContext2D,
-  state: HeatmapState,
-  width: number,
-  height: number,
-  viewport: Viewport,
-): void {
-  const { columns, dataPriceMin, dataPriceMax, maxQty } = state;
-
-  // Determine effective price bounds
-  const priceMin = viewport.autoFollow ? dataPriceMin : viewport.priceMin;
-  const priceMax = viewport.autoFollow ? dataPriceMax : viewport.priceMax;
-
-  if (columns.length === 0 || priceMax <= priceMin) {
-    ctx.fillStyle = '#0a0a0f';
-    ctx.fillRect(0, 0, width, height);
-    ctx.fillStyle = '#555';
-    ctx.font = '14px monospace';
-    ctx.textAlign = 'center';
-    ctx.fillText('Waiting for data...', width / 2, height / 2);
-    return;
+  resize(width: number, height: number): void {
+    if (!this.ctx) return;
+    this.ctx.canvas.width = this.width = width;
+    this.ctx.canvas.height = this.height = height;
+    this.fullRedraw = true;
   }
 
-  const imageData = ctx.createImageData(width, height);
-  const data = imageData.data;
+  setViewport(viewport: Viewport): void {
+    this.viewport = viewport;
+    this.fullRedraw = true;
+  }
 
-  // Background fill
-  for (let i = 0; i < data.length; i += 4) {
-    data[i] = 10;
-    data[i + 1] = 10;
-    data[i + 2] = 15;
-    data[i + 3] = 255;
+  private allocate(buckets: number): void {
+    this.buckets = buckets;
+    this.ring = new Float32Array(this.maxColumns * buckets);
+    this.slot = new Float32Array(buckets);
+    this.head = 0;
+    this.count = 0;
+    this.localMax = new RunningMax(this.maxColumns);
+    this.fullRedraw = true;
   }
 
-  const colWidth = Math.max(1, Math.floor(width / state.maxColumns));
-  const priceRange = priceMax - priceMin;
+  pushColumn(col: HeatmapColumn): void {
+    const n = col.values.length;
+    if (n !== this.buckets) this.allocate(n);
+    const slot = this.head;
+    this.ring.set(col.values, slot * n);
+    this.basePrice[slot] = col.basePrice;
+    this.bucketSize[slot] = col.bucketSize;
 
-  const priceToY = (p: number) => Math.floor((1 - (p - priceMin) / priceRange) * height);
+    let cMin = Infinity;
+    let cMax = -Infinity;
+    let colMax = 0;
+    for (let i = 0; i < n; i++) {
+      const q = Math.abs(col.values[i]);
+      if (q === 0) continue;
+      const price = col.basePrice + i * col.bucketSize;
+      if (price < cMin) cMin = price;
+      if (price + col.bucketSize > cMax) cMax = price + col.bucketSize;
+      if (q > colMax) colMax = q;
+    }
+    this.colMin[slot] = cMin;
+    this.colMax[slot] = cMax;
 
-  // Apply time offset: shift columns left/right
-  const timeShift = Math.round(viewport.timeOffset);
+    this.head = (slot + 1) % this.maxColumns;
+    if (this.count < this.maxColumns) this.count++;
+    // The server's running max when it aggregates, otherwise our own
+    const localMax = this.localMax.push(colMax);
+    this.maxQty = Math.max(1, col.maxQty > 0 ? col.maxQty : localMax);
+    this.pending++;
+  }
 
-  for (let ci = 0; ci < columns.length; ci++) {
-    const col = columns[ci];
-    const x0 = width - (columns.length - ci - timeShift) * colWidth;
-    if (x0 + colWidth <= 0 || x0 >= width) continue;
+  // Bins a raw snapshot into the current frame's column (largest qty per
+  // bucket); ignored once the server sends the columns
+  addSnapshot(snapshot: SnapshotMessage, bucketSize = 0.01, buckets = 128): void {
+    if (this.serverColumns) return;
+    const { bids, asks } = snapshot;
+    if (bids.prices.length === 0 && asks.prices.length === 0) return;
+    if (!this.slotHasData) {
+      if (this.slot.length !== buckets) this.slot = new Float32Array(buckets);
+      const mid = bids.prices.length > 0 && asks.prices.length > 0
+        ? (bids.prices[0] + asks.prices[0]) / 2
+        : bids.prices.length > 0 ? bids.prices[0] : asks.prices[0];
+      this.slotBase = Math.floor(mid / bucketSize) - (buckets >> 1);
+      this.slotBucketSize = bucketSize;
+      this.slotHasData = true;
+    }
+    this.slotTime = snapshot.timestamp;
+    const step = this.slotBucketSize;
+    const n = this.slot.length;
+    const bin = (prices: Float64Array, qtys: Int32Array, sign: number) => {
+      for (let i = 0; i < prices.length; i++) {
+        const b = Math.floor(prices[i] / step) - this.slotBase;
+        if (b >= 0 && b < n && qtys[i] > Math.abs(this.slot[b])) this.slot[b] = sign * qtys[i];
+      }
+    };
+    bin(bids.prices, bids.qtys, 1);
+    bin(asks.prices, asks.qtys, -1);
+  }
 
-    // Sort levels by price descending (high to low)
-    const sorted: { price: number; qty: number; side: 'bid' | 'ask' }[] = [];
-    for (const [price, entry] of col.levels) {
-      sorted.push({ price, qty: entry.qty, side: entry.side });
+  // Current auto-follow price range (last ~30 columns, 10% padding)
+  dataRange(): [number, number] {
+    let pMin = Infinity;
+    let pMax = -Infinity;
+    const lookback = Math.min(30, this.count);
+    for (let k = 1; k <= lookback; k++) {
+      const s = (this.head - k + this.maxColumns) % this.maxColumns;
+      if (this.colMin[s] < pMin) pMin = this.colMin[s];
+      if (this.colMax[s] > pMax) pMax = this.colMax[s];
     }
-    sorted.sort((a, b) => b.price - a.price);
-
-    for (let li = 0; li < sorted.length; li++) {
-      const level = sorted[li];
-      const intensity = Math.sqrt(level.qty / maxQty);
-      const [r, g, b] = level.side === 'bid'
-        ? bidColor(intensity)
-        : askColor(intensity);
-
-      let yTop: number;
-      let yBot: number;
-
-      if (sorted.length === 1) {
-        yTop = priceToY(level.price + 0.5);
-        yBot = priceToY(level.price - 0.5);
-      } else if (li === 0) {
-        const gap = sorted[0].price - sorted[1].price;
-        yTop = priceToY(level.price + gap * 0.5);
-        yBot = priceToY((level.price + sorted[1].price) / 2);
-      } else if (li === sorted.length - 1) {
-        const gap = sorted[li - 1].price - sorted[li].price;
-        yTop = priceToY((sorted[li - 1].price + level.price) / 2);
-        yBot = priceToY(level.price - gap * 0.5);
-      } else {
-        yTop = priceToY((sorted[li - 1].price + level.price) / 2);
-        yBot = priceToY((level.price + sorted[li + 1].price) / 2);
+    if (pMin > pMax) return [this.drawnMin, this.drawnMax];
+    const padding = (pMax - pMin) * 0.1;
+    return [pMin - padding, pMax + padding];
+  }
+
+  // Called once per animation frame; returns true if the drawn range changed
+  draw(): boolean {
+    if (this.slotHasData) {
+      // A slot binned before the first server column is dropped
+      if (!this.serverColumns) {
+        this.pushColumn({
+          timestamp: this.slotTime,
+          basePrice: this.slotBase * this.slotBucketSize,
+          bucketSize: this.slotBucketSize,
+          values: this.slot,
+          maxQty: 0,
+        });
       }
+      this.slot.fill(0); // copied into the ring
+      this.slotHasData = false;
+    }
+    const ctx = this.ctx;
+    if (!ctx || this.width === 0 || (!this.fullRedraw && this.pending === 0)) return false;
 
-      const yStart = Math.max(0, Math.min(yTop, yBot));
-      const yEnd = Math.min(height - 1, Math.max(yTop, yBot));
-
-      for (let y = yStart; y <= yEnd; y++) {
-        for (let dx = 0; dx < colWidth; dx++) {
-          const px = x0 + dx;
-          if (px < 0 || px >= width) continue;
-          const idx = (y * width + px) * 4;
-          data[idx] = r;
-          data[idx + 1] = g;
-          data[idx + 2] = b;
-          data[idx + 3] = 255;
-        }
+    let rangeChanged = false;
+    let priceMin = this.viewport.priceMin;
+    let priceMax = this.viewport.priceMax;
+    if (this.viewport.autoFollow) {
+      const [dMin, dMax] = this.dataRange();
+      const drawnSpan = this.drawnMax - this.drawnMin;
+      // Keep the drawn range while the data fits in it and fills at least half of it
+      if (this.fullRedraw || dMin < this.drawnMin || dMax > this.drawnMax || dMax - dMin < drawnSpan * 0.5) {
+        const extra = (dMax - dMin) * 0.15;
+        priceMin = dMin - extra;
+        priceMax = dMax + extra;
+      } else {
+        priceMin = this.drawnMin;
+        priceMax = this.drawnMax;
       }
     }
+    if (priceMin !== this.drawnMin || priceMax !== this.drawnMax) {
+      this.fullRedraw = true;
+      rangeChanged = true;
+    }
+    if (Math.abs(this.maxQty - this.drawnQty) > this.drawnQty * 0.25) this.fullRedraw = true;
+
+    const plotW = Math.max(1, this.width - AXIS_WIDTH);
+    const colWidth = Math.max(1, Math.floor(plotW / this.maxColumns));
+    const shift = Math.round(this.viewport.timeOffset);
+
+    if (this.count === 0 || priceMax <= priceMin) {
+      ctx.fillStyle = BACKGROUND;
+      ctx.fillRect(0, 0, this.width, this.height);
+      ctx.fillStyle = '#555';
+      ctx.font = '14px monospace';
+      ctx.textAlign = 'center';
+      ctx.fillText('Waiting for data...', this.width / 2, this.height / 2);
+      this.fullRedraw = this.count > 0;
+      this.pending = 0;
+      return false;
+    }
+
+    this.drawnMin = priceMin;
+    this.drawnMax = priceMax;
+    let first = 0; // oldest column index (from the oldest) to draw
+    if (this.fullRedraw || this.pending * colWidth >= plotW) {
+      ctx.fillStyle = BACKGROUND;
+      ctx.fillRect(0, 0, plotW, this.height);
+      this.drawnQty = this.maxQty;
+    } else {
+      // Scroll the plot left by the new columns and clear the strip they go in
+      const dx = this.pending * colWidth;
+      ctx.drawImage(ctx.canvas, dx, 0, plotW - dx, this.height, 0, 0, plotW - dx, this.height);
+      ctx.fillStyle = BACKGROUND;
+      ctx.fillRect(plotW - dx, 0, dx, this.height);
+      first = this.count - this.pending - shift;
+    }
+
+    for (let ci = Math.max(0, first); ci < this.count; ci++) {
+      const x0 = plotW - (this.count - ci - shift) * colWidth;
+      if (x0 + colWidth <= 0 || x0 >= plotW) continue;
+      this.drawColumn(ctx, ci, x0, colWidth, priceMin, priceMax);
+    }
+    this.drawAxis(ctx, plotW, priceMin, priceMax);
+
+    this.pending = 0;
+    this.fullRedraw = false;
+    return rangeChanged;
   }
 
-  ctx.putImageData(imageData, 0, 0);
-
-  // Price axis labels
-  ctx.fillStyle = '#888';
-  ctx.font = '11px monospace';
-  ctx.textAlign = 'right';
-  const numLabels = 10;
-  for (let i = 0; i <= numLabels; i++) {
-    const price = priceMin + (priceRange * i) / numLabels;
-    const y = height - (i / numLabels) * height;
-    ctx.fillText(price.toFixed(2), width - 4, y + 4);
+  private drawColumn(
+    ctx: OffscreenCanvasRenderingContext2D,
+    ci: number,
+    x0: number,
+    colWidth: number,
+    priceMin: number,
+    priceMax: number,
+  ): void {
+    const slot = (this.head - this.count + ci + this.maxColumns) % this.maxColumns;
+    const n = this.buckets;
+    const offset = slot * n;
+    const base = this.basePrice[slot];
+    const step = this.bucketSize[slot];
+    const scale = this.height / (priceMax - priceMin);
+    for (let bi = 0; bi < n; bi++) {
+      const q = this.ring[offset + bi];
+      if (q === 0) continue;
+      const yTop = Math.floor((priceMax - (base + (bi + 1) * step)) * scale);
+      const yBot = Math.floor((priceMax - (base + bi * step)) * scale);
+      if (yBot < 0 || yTop >= this.height) continue;
+      const step64 = Math.min(PALETTE_STEPS, Math.round(Math.sqrt(Math.abs(q) / this.drawnQty) * PALETTE_STEPS));
+      ctx.fillStyle = q > 0 ? BID_PALETTE[step64] : ASK_PALETTE[step64];
+      ctx.fillRect(x0, yTop, colWidth, Math.max(1, yBot - yTop));
+    }
+  }
+
+  private drawAxis(ctx: OffscreenCanvasRenderingContext2D, plotW: number, priceMin: number, priceMax: number): void {
+    ctx.fillStyle = BACKGROUND;
+    ctx.fillRect(plotW, 0, this.width - plotW, this.height);
+    ctx.fillStyle = '#888';
+    ctx.font = '11px monospace';
+    ctx.textAlign = 'right';
+    const numLabels = 10;
+    const range = priceMax - priceMin;
+    for (let i = 0; i <= numLabels; i++) {
+      const price = priceMin + (range * i) / numLabels;
+      const y = this.height - (i / numLabels) * this.height;
+      ctx.fillText(price.toFixed(2), this.width - 4, y + 4);
+    }
   }
 }
@@ -0,0 +1,130 @@
+import type {
+  BookLevel,
+  BookSideArrays,
+  HeatmapMessage,
+  JsonWSMessage,
+  OrderEntry,
+  SnapshotMessage,
+  WSMessage,
+} from '../types';
+
+// Binary WebSocket messages: one kind byte, then the wire frame exactly as
+// published on NATS (little endian, see src/wire_format.h)
+export const KIND_SNAPSHOT = 1;
+export const KIND_ORDERS = 2;
+export const KIND_HEATMAP = 3; // server-side heatmap column (viz/server/heatmap.go)
+
+const SNAPSHOT_HEADER = 20; // pairId(8) + timestamp(8) + numBids(2) + numAsks(2)
+const LEVEL_SIZE = 12; // price(8) + qty(4)
+const ORDERS_HEADER = 20; // type(1) + pairId(4) + seq(8) + count(4) + pad(3)
+const ORDER_SIZE = 40; // pairId(8) + price(8) + time(8) + qty(4) + side(4) + type(4) + action(4)
+// kind(1) + pad(3) + numBuckets(4) + basePrice(8) + bucketSize(8) + runningMax(8) + timestamp(8)
+const HEATMAP_HEADER = 40;
+
+const SIDES: OrderEntry['side'][] = ['BUY', 'BUY', 'SELL'];
+const ACTIONS: OrderEntry['action'][] = ['SEEKER_ADD', 'ADD', 'REMOVE', 'MODIFY'];
+const TYPES: OrderEntry['orderType'][] = ['LIMIT', 'LIMIT', 'MARKET', 'ICEBERG', 'STOP'];
+
+function readSide(view: DataView, offset: number, count: number): BookSideArrays {
+  const prices = new Float64Array(count);
+  const qtys = new Int32Array(count);
+  for (let i = 0; i < count; i++, offset += LEVEL_SIZE) {
+    prices[i] = view.getFloat64(offset, true);
+    qtys[i] = view.getInt32(offset + 8, true);
+  }
+  return { prices, qtys };
+}
+
+function decodeSnapshot(view: DataView, base: number): SnapshotMessage | null {
+  if (view.byteLength < base + SNAPSHOT_HEADER) return null;
+  const numBids = view.getUint16(base + 16, true);
+  const numAsks = view.getUint16(base + 18, true);
+  if (view.byteLength < base + SNAPSHOT_HEADER + (numBids + numAsks) * LEVEL_SIZE) return null;
+  const bidsAt = base + SNAPSHOT_HEADER;
+  return {
+    type: 'snapshot',
+    // Nanosecond timestamps exceed 2^53; the heatmap only needs ordering
+    timestamp: Number(view.getBigUint64(base + 8, true)),
+    bids: readSide(view, bidsAt, numBids),
+    asks: readSide(view, bidsAt + numBids * LEVEL_SIZE, numAsks),
+  };
+}
+
+function decodeOrders(view: DataView, base: number): WSMessage | null {
+  if (view.byteLength < base + ORDERS_HEADER) return null;
+  const count = view.getUint32(base + 13, true);
+  if (view.byteLength < base + ORDERS_HEADER + count * ORDER_SIZE) return null;
+  const orders: OrderEntry[] = new Array(count);
+  let offset = base + ORDERS_HEADER;
+  for (let i = 0; i < count; i++, offset += ORDER_SIZE) {
+    orders[i] = {
+      price: view.getFloat64(offset + 8, true),
+      qty: view.getInt32(offset + 24, true),
+      side: SIDES[view.getInt32(offset + 28, true)] ?? 'BUY',
+      orderType: TYPES[view.getInt32(offset + 32, true)] ?? 'LIMIT',
+      action: ACTIONS[view.getInt32(offset + 36, true)] ?? 'ADD',
+    };
+  }
+  return { type: 'orders', orders };
+}
+
+function decodeHeatmap(buf: ArrayBuffer, view: DataView): HeatmapMessage | null {
+  if (view.byteLength < HEATMAP_HEADER) return null;
+  const numBuckets = view.getUint32(4, true);
+  if (view.byteLength < HEATMAP_HEADER + numBuckets * 4) return null;
+  return {
+    type: 'heatmap',
+    column: {
+      timestamp: Number(view.getBigUint64(32, true)),
+      basePrice: view.getFloat64(8, true),
+      bucketSize: view.getFloat64(16, true),
+      // Little-endian hosts only, like the rest of the wire path; the values are 4-byte aligned
+      values: new Float32Array(buf, HEATMAP_HEADER, numBuckets),
+      maxQty: view.getFloat64(24, true),
+    },
+  };
+}
+
+export function decodeBinary(buf: ArrayBuffer): WSMessage | null {
+  if (buf.byteLength < 1) return null;
+  const view = new DataView(buf);
+  switch (view.getUint8(0)) {
+    case KIND_SNAPSHOT:
+      return decodeSnapshot(view, 1);
+    case KIND_ORDERS:
+      return decodeOrders(view, 1);
+    case KIND_HEATMAP:
+      return decodeHeatmap(buf, view);
+  }
+  return null;
+}
+
+function sideFromLevels(levels: BookLevel[]): BookSideArrays {
+  const prices = new Float64Array(levels.length);
+  const qtys = new Int32Array(levels.length);
+  levels.forEach((l, i) => {
+    prices[i] = l.price;
+    qtys[i] = l.qty;
+  });
+  return { prices, qtys };
+}
+
+// JSON fallback (server started with VIZ_FORMAT=json or ?format=json)
+export function decodeJson(text: string): WSMessage {
+  const msg: JsonWSMessage = JSON.parse(text);
+  if (msg.type === 'snapshot') {
+    return {
+      type: 'snapshot',
+      timestamp: msg.timestamp,
+      bids: sideFromLevels(msg.bids),
+      asks: sideFromLevels(msg.asks),
+    };
+  }
+  return msg;
+}
+
+export function sideLevels(side: BookSideArrays): BookLevel[] {
+  const levels: BookLevel[] = new Array(side.prices.length);
+  for (let i = 0; i < levels.length; i++) levels[i] = { price: side.prices[i], qty: side.qtys[i] };
+  return levels;
+}
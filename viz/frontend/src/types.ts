@@ -3,7 +3,21 @@ export interface BookLevel {
   qty: number;
 }
 
+// One book side, best level first, as parallel typed arrays
+export interface BookSideArrays {
+  prices: Float64Array;
+  qtys: Int32Array;
+}
+
 export interface SnapshotMessage {
+  type: 'snapshot';
+  timestamp: number;
+  bids: BookSideArrays;
+  asks: BookSideArrays;
+}
+
+// Snapshot as sent by the server in JSON mode
+export interface JsonSnapshotMessage {
   type: 'snapshot';
   timestamp: number;
   bids: BookLevel[];
@@ -23,9 +37,19 @@ export interface OrderEntry {
   orderType: 'LIMIT' | 'MARKET' | 'ICEBERG' | 'STOP';
 }
 
-export type WSMessage = SnapshotMessage | OrderMessage;
+export type WSMessage = SnapshotMessage | OrderMessage | HeatmapMessage;
+export type JsonWSMessage = JsonSnapshotMessage | OrderMessage;
 
+// One heatmap time slot on a fixed price grid
 export interface HeatmapColumn {
   timestamp: number;
-  levels: Map<number, { qty: number; side: 'bid' | 'ask' }>;
+  basePrice: number; // lower edge of bucket 0
+  bucketSize: number;
+  values: Float32Array; // per bucket from basePrice up: bids > 0, asks < 0
+  maxQty: number; // server running max over recent columns; 0 = compute locally
+}
+
+export interface HeatmapMessage {
+  type: 'heatmap';
+  column: HeatmapColumn;
 }
@@ -0,0 +1,58 @@
+// Heatmap renderer running off the main thread on an OffscreenCanvas. Binary
+// WebSocket frames arrive here untouched (see lib/heatmapBridge.ts): server
+// heatmap columns go straight into the ring, raw snapshots are binned into
+// one column per animation frame until the first server column arrives.
+import { HeatmapRenderer } from '../lib/heatmapRenderer';
+import { decodeBinary } from '../lib/wireDecode';
+import type { HeatmapWorkerMessage } from '../lib/heatmapBridge';
+
+const scope = self as unknown as {
+  onmessage: ((ev: MessageEvent<HeatmapWorkerMessage>) => void) | null;
+  postMessage(msg: unknown): void;
+  requestAnimationFrame?: (cb: () => void) => number;
+};
+
+const renderer = new HeatmapRenderer(500);
+
+scope.onmessage = (ev) => {
+  const msg = ev.data;
+  switch (msg.type) {
+    case 'canvas':
+      renderer.setCanvas(msg.canvas);
+      renderer.resize(msg.width, msg.height);
+      break;
+    case 'resize':
+      renderer.resize(msg.width, msg.height);
+      break;
+    case 'viewport':
+      renderer.setViewport(msg.viewport);
+      break;
+    case 'frame': {
+      const decoded = decodeBinary(msg.data);
+      if (decoded?.type === 'heatmap') {
+        renderer.serverColumns = true;
+        renderer.pushColumn(decoded.column);
+      } else if (decoded?.type === 'snapshot') {
+        renderer.addSnapshot(decoded);
+      }
+      break;
+    }
+    case 'snapshot':
+      renderer.addSnapshot(msg.snapshot);
+      break;
+  }
+};
+
+// requestAnimationFrame exists in dedicated workers on current browsers
+const nextFrame = scope.requestAnimationFrame
+  ? (cb: () => void) => scope.requestAnimationFrame!(cb)
+  : (cb: () => void) => setTimeout(cb, 16);
+
+const loop = () => {
+  if (renderer.draw()) {
+    const [priceMin, priceMax] = renderer.dataRange();
+    scope.postMessage({ type: 'range', priceMin, priceMax });
+  }
+  nextFrame(loop);
+};
+nextFrame(loop);
@@ -0,0 +1,151 @@
+//go:build cgo
+
+// Package buni runs the C++ snapshot parser in-process through its C ABI
+// (src/buni_c.h), as an alternative to consuming orderbook.tbt.* from a
+// separate processor over NATS.
+//
+// Build libbuni_c first (cmake --build build --target buni_c); the package
+// links it from <repo>/build. Every call crosses the cgo boundary once, so
+// pass several snapshot frames per Apply call and read Events once per batch.
+package buni
+
+/*
+#cgo CFLAGS: -I${SRCDIR}/../../../src
+#cgo LDFLAGS: -L${SRCDIR}/../../../build -lbuni_c -Wl,-rpath,${SRCDIR}/../../../build
+#include <stdlib.h>
+#include "buni_c.h"
+*/
+import "C"
+
+import (
+	"errors"
+	"fmt"
+	"unsafe"
+)
+
+// Order mirrors buni_order: one TBT event, same layout as in an orders frame.
+type Order struct {
+	PairID int64
+	Price  float64
+	Time   uint64
+	Qty    int32
+	Side   int32
+	Type   int32
+	Action int32
+}
+
+// PairConfig mirrors buni_pair_config.
+type PairConfig struct {
+	NetEvents     bool
+	MaxDepth      uint32
+	SkipUnchanged bool
+	TickSize      float64 // > 0 keeps the pair in a price ladder
+}
+
+var (
+	ErrMalformed   = errors.New("buni: malformed snapshot frame")
+	ErrUnknownPair = errors.New("buni: unknown pair")
+	ErrExists      = errors.New("buni: pair already registered")
+	ErrArgument    = errors.New("buni: bad argument")
+	ErrNoMemory    = errors.New("buni: out of memory")
+	ErrInternal    = errors.New("buni: internal parser error")
+)
+
+func statusError(code C.int64_t) error {
+	switch code {
+	case C.BUNI_E_MALFORMED:
+		return ErrMalformed
+	case C.BUNI_E_UNKNOWN_PAIR:
+		return ErrUnknownPair
+	case C.BUNI_E_EXISTS:
+		return ErrExists
+	case C.BUNI_E_ARGUMENT:
+		return ErrArgument
+	case C.BUNI_E_NO_MEMORY:
+		return ErrNoMemory
+	case C.BUNI_E_INTERNAL:
+		return ErrInternal
+	}
+	return fmt.Errorf("buni: status %d", int64(code))
+}
+
+// Parser owns one C parser handle. Not safe for concurrent use.
+type Parser struct {
+	h *C.buni_parser
+}
+
+func NewParser(pairIDs ...int64) (*Parser, error) {
+	h := C.buni_parser_create()
+	if h == nil {
+		return nil, ErrNoMemory
+	}
+	p := &Parser{h: h}
+	for _, id := range pairIDs {
+		if err := p.RegisterPair(id); err != nil {
+			p.Close()
+			return nil, err
+		}
+	}
+	return p, nil
+}
+
+func (p *Parser) Close() {
+	if p.h != nil {
+		C.buni_parser_destroy(p.h)
+		p.h = nil
+	}
+}
+
+func (p *Parser) RegisterPair(pairID int64) error {
+	if rc := C.buni_register_pair(p.h, C.int64_t(pairID)); rc < 0 {
+		return statusError(C.int64_t(rc))
+	}
+	return nil
+}
+
+func (p *Parser) ConfigurePair(pairID int64, cfg PairConfig) error {
+	var c C.buni_pair_config
+	if cfg.NetEvents {
+		c.net_events = 1
+	}
+	if cfg.SkipUnchanged {
+		c.skip_unchanged = 1
+	}
+	c.max_depth = C.uint32_t(cfg.MaxDepth)
+	c.tick_size = C.double(cfg.TickSize)
+	if rc := C.buni_configure_pair(p.h, C.int64_t(pairID), &c); rc < 0 {
+		return statusError(C.int64_t(rc))
+	}
+	return nil
+}
+
+// Apply applies back-to-back snapshot frames (as published on
+// orderbook.snapshots) in one call. It returns the number of frames applied,
+// which is less than the number in frames when err is set.
+func (p *Parser) Apply(frames []byte) (int, error) {
+	if len(frames) == 0 {
+		return 0, nil
+	}
+	var applied C.size_t
+	rc := C.buni_apply_snapshots(p.h, unsafe.Pointer(&frames[0]), C.size_t(len(frames)), &applied)
+	if rc < 0 {
+		return int(applied), statusError(rc)
+	}
+	return int(rc), nil
+}
+
+// Events returns the events of every frame applied since the last
+// ClearEvents. The slice aliases parser memory: it is valid until the next
+// Apply or ClearEvents call.
+func (p *Parser) Events() []Order {
+	var count C.size_t
+	ptr := C.buni_events(p.h, &count)
+	if count == 0 {
+		return nil
+	}
+	return unsafe.Slice((*Order)(unsafe.Pointer(ptr)), int(count))
+}
+
+func (p *Parser) ClearEvents() {
+	C.buni_clear_events(p.h)
+}
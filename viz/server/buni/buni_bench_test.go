@@ -0,0 +1,144 @@
+//go:build cgo
+
+package buni
+
+import (
+	"encoding/binary"
+	"math"
+	"math/rand"
+	"os"
+	"testing"
+	"time"
+
+	"github.com/nats-io/nats.go"
+)
+
+const (
+	benchLevels = 20
+	benchBatch  = 64
+)
+
+// snapshotFrame encodes one snapshot in the orderbook.snapshots wire format.
+func snapshotFrame(buf []byte, pairID int64, ts uint64, mid float64, rng *rand.Rand) []byte {
+	buf = binary.LittleEndian.AppendUint64(buf, uint64(pairID))
+	buf = binary.LittleEndian.AppendUint64(buf, ts)
+	buf = binary.LittleEndian.AppendUint16(buf, benchLevels)
+	buf = binary.LittleEndian.AppendUint16(buf, benchLevels)
+	for side := 0; side < 2; side++ {
+		for i := 0; i < benchLevels; i++ {
+			price := mid - 0.5*float64(i+1)
+			if side == 1 {
+				price = mid + 0.5*float64(i+1)
+			}
+			buf = binary.LittleEndian.AppendUint64(buf, math.Float64bits(price))
+			buf = binary.LittleEndian.AppendUint32(buf, uint32(1+rng.Intn(100)))
+		}
+	}
+	return buf
+}
+
+// benchFrames returns n frames of pair 1 walking around a mid of 100.
+func benchFrames(n int) [][]byte {
+	rng := rand.New(rand.NewSource(1))
+	frames := make([][]byte, n)
+	mid := 100.0
+	for i := range frames {
+		mid += 0.5 * float64(rng.Intn(3)-1)
+		frames[i] = snapshotFrame(nil, 1, uint64(i+1), mid, rng)
+	}
+	return frames
+}
+
+// BenchmarkInProcess applies snapshots through the C ABI, benchBatch frames
+// per cgo call, and reads the events of each batch.
+func BenchmarkInProcess(b *testing.B) {
+	p, err := NewParser(1)
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer p.Close()
+
+	frames := benchFrames(4096)
+	batches := make([][]byte, 0, len(frames)/benchBatch)
+	for i := 0; i < len(frames); i += benchBatch {
+		var batch []byte
+		for _, f := range frames[i : i+benchBatch] {
+			batch = append(batch, f...)
+		}
+		batches = append(batches, batch)
+	}
+
+	frameSize := len(frames[0])
+	events := 0
+	ts := uint64(0)
+	b.ResetTimer()
+	for i := 0; i < b.N; i += benchBatch {
+		batch := batches[(i/benchBatch)%len(batches)]
+		// Keep timestamps increasing across rounds: stale snapshots are dropped
+		for off := 0; off < len(batch); off += frameSize {
+			ts++
+			binary.LittleEndian.PutUint64(batch[off+8:], ts)
+		}
+		if _, err := p.Apply(batch); err != nil {
+			b.Fatal(err)
+		}
+		events += len(p.Events())
+		p.ClearEvents()
+	}
+	b.ReportMetric(float64(events)/float64(b.N), "events/snapshot")
+}
+
+// BenchmarkNATS measures the same snapshots through a running processor:
+// publish to orderbook.snapshots and wait for the TBT frames carrying that
+// snapshot's timestamp. Skipped without a server (NATS_URL) and processor.
+func BenchmarkNATS(b *testing.B) {
+	url := os.Getenv("NATS_URL")
+	if url == "" {
+		url = nats.DefaultURL
+	}
+	nc, err := nats.Connect(url, nats.Timeout(time.Second))
+	if err != nil {
+		b.Skipf("no NATS server at %s: %v", url, err)
+	}
+	defer nc.Close()
+
+	const ordersHeader = 20
+	seen := make(chan uint64, 1024)
+	sub, err := nc.Subscribe("orderbook.tbt.>", func(m *nats.Msg) {
+		if len(m.Data) >= ordersHeader+24 {
+			seen <- binary.LittleEndian.Uint64(m.Data[ordersHeader+16:])
+		}
+	})
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer sub.Unsubscribe()
+
+	frames := benchFrames(4096)
+	// Timestamps keep growing across b.N rounds: the processor drops stale snapshots
+	base := uint64(time.Now().UnixNano())
+	wait := func(ts uint64) {
+		timeout := time.After(2 * time.Second)
+		for {
+			select {
+			case got := <-seen:
+				if got >= ts {
+					return
+				}
+			case <-timeout:
+				b.Skip("no TBT output: is the processor running?")
+			}
+		}
+	}
+
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		frame := frames[i%len(frames)]
+		ts := base + uint64(i)
+		binary.LittleEndian.PutUint64(frame[8:], ts)
+		if err := nc.Publish("orderbook.snapshots", frame); err != nil {
+			b.Fatal(err)
+		}
+		wait(ts)
+	}
+}
@@ -0,0 +1,206 @@
+package main
+
+import (
+	"encoding/binary"
+	"math"
+	"sync"
+	"time"
+)
+
+// Server-side heatmap aggregation. Snapshots are binned into fixed price
+// buckets; every frame (1/fps) the buckets seen since the previous frame
+// become one column, sent to every client as a typed-array message. The
+// latest snapshot is forwarded at the same rate for the depth chart, so
+// browsers get at most fps snapshots and fps columns per second whatever the
+// feed rate.
+
+const kindHeatmap byte = 3
+
+// Heatmap column message: kind(1) + pad(3) + numBuckets(4) + basePrice(8) +
+// bucketSize(8) + runningMax(8) + timestamp(8), then numBuckets float32
+// quantities (bids positive, asks negative) from basePrice upwards. The
+// values start 4-byte aligned so the client can view them in place.
+const heatmapHeaderSize = 40
+
+type HeatmapConfig struct {
+	FPS        int     // frames per second; 0 disables aggregation
+	BucketSize float64 // price per bucket
+	Buckets    int     // buckets per column, centred on the mid
+	Window     int     // columns the running max covers
+	Pair       int64   // pair to bin; 0 follows the first pair seen
+}
+
+// runningMax is the max over the last window pushed values: a monotonic
+// deque of (index, value) with decreasing values
+type runningMax struct {
+	window int
+	next   uint64
+	idx    []uint64
+	val    []float32
+	head   int
+}
+
+func (r *runningMax) push(v float32) float32 {
+	for len(r.val) > r.head && r.val[len(r.val)-1] <= v {
+		r.idx = r.idx[:len(r.idx)-1]
+		r.val = r.val[:len(r.val)-1]
+	}
+	r.idx = append(r.idx, r.next)
+	r.val = append(r.val, v)
+	for r.next-r.idx[r.head] >= uint64(r.window) {
+		r.head++
+	}
+	r.next++
+	// Compact once the dead prefix dominates
+	if r.head > 64 && r.head*2 > len(r.val) {
+		n := copy(r.idx, r.idx[r.head:])
+		copy(r.val, r.val[r.head:])
+		r.idx, r.val, r.head = r.idx[:n], r.val[:n], 0
+	}
+	return r.val[r.head]
+}
+
+type HeatmapAggregator struct {
+	cfg HeatmapConfig
+	hub *Hub
+
+	mu        sync.Mutex
+	pair      int64     // the one pair binned; columns never mix books
+	column    []float32 // current slot, max |qty| per bucket
+	scratch   []float32 // one snapshot's binned book
+	baseIndex int64     // bucket index of column[0]
+	hasData   bool
+	timestamp uint64
+	snapshot  *message // latest snapshot, forwarded on the next frame
+	max       runningMax
+}
+
+func NewHeatmapAggregator(cfg HeatmapConfig, hub *Hub) *HeatmapAggregator {
+	return &HeatmapAggregator{
+		cfg:     cfg,
+		hub:     hub,
+		pair:    cfg.Pair,
+		column:  make([]float32, cfg.Buckets),
+		scratch: make([]float32, cfg.Buckets),
+		max:     runningMax{window: cfg.Window},
+	}
+}
+
+// Add bins one snapshot frame (already size-checked) into the current slot.
+// Frames of any other pair than the one followed are ignored.
+func (a *HeatmapAggregator) Add(frame []byte, m *message) {
+	numBids := int(binary.LittleEndian.Uint16(frame[16:18]))
+	numAsks := int(binary.LittleEndian.Uint16(frame[18:20]))
+	levelPrice := func(i int) float64 {
+		off := wireSnapshotSize + i*wireBookLevelSize
+		return math.Float64frombits(binary.LittleEndian.Uint64(frame[off : off+8]))
+	}
+	levelQty := func(i int) float32 {
+		off := wireSnapshotSize + i*wireBookLevelSize
+		return float32(int32(binary.LittleEndian.Uint32(frame[off+8 : off+12])))
+	}
+
+	a.mu.Lock()
+	defer a.mu.Unlock()
+	pair := snapshotPair(frame)
+	if a.pair == 0 {
+		a.pair = pair
+	} else if pair != a.pair {
+		return
+	}
+	a.snapshot = m
+	a.timestamp = binary.LittleEndian.Uint64(frame[8:16])
+	if numBids+numAsks == 0 {
+		return
+	}
+
+	// The first snapshot of a slot centres the column's grid on its mid
+	if !a.hasData {
+		mid := levelPrice(0) // best bid, or best ask of a one-sided book
+		if numBids > 0 && numAsks > 0 {
+			mid = (levelPrice(0) + levelPrice(numBids)) / 2
+		}
+		a.baseIndex = int64(math.Floor(mid/a.cfg.BucketSize)) - int64(a.cfg.Buckets/2)
+		a.hasData = true
+	}
+
+	for i := range a.scratch {
+		a.scratch[i] = 0
+	}
+	for i := 0; i < numBids+numAsks; i++ {
+		b := int64(math.Floor(levelPrice(i)/a.cfg.BucketSize)) - a.baseIndex
+		if b < 0 || b >= int64(len(a.scratch)) {
+			continue
+		}
+		q := levelQty(i)
+		if i >= numBids {
+			q = -q
+		}
+		a.scratch[b] += q
+	}
+	for i, q := range a.scratch {
+		if q != 0 && abs32(q) > abs32(a.column[i]) {
+			a.column[i] = q
+		}
+	}
+}
+
+func abs32(v float32) float32 {
+	if v < 0 {
+		return -v
+	}
+	return v
+}
+
+// flush builds the current slot's column message and resets the slot
+func (a *HeatmapAggregator) flush() (column, snapshot *message) {
+	a.mu.Lock()
+	defer a.mu.Unlock()
+	snapshot, a.snapshot = a.snapshot, nil
+	if !a.hasData {
+		return nil, snapshot
+	}
+
+	var colMax float32
+	for _, q := range a.column {
+		if abs32(q) > colMax {
+			colMax = abs32(q)
+		}
+	}
+	running := a.max.push(colMax)
+
+	buf := make([]byte, heatmapHeaderSize+4*len(a.column))
+	buf[0] = kindHeatmap
+	binary.LittleEndian.PutUint32(buf[4:8], uint32(len(a.column)))
+	binary.LittleEndian.PutUint64(buf[8:16], math.Float64bits(float64(a.baseIndex)*a.cfg.BucketSize))
+	binary.LittleEndian.PutUint64(buf[16:24], math.Float64bits(a.cfg.BucketSize))
+	binary.LittleEndian.PutUint64(buf[24:32], math.Float64bits(float64(running)))
+	binary.LittleEndian.PutUint64(buf[32:40], a.timestamp)
+	for i, q := range a.column {
+		binary.LittleEndian.PutUint32(buf[heatmapHeaderSize+4*i:], math.Float32bits(q))
+		a.column[i] = 0
+	}
+	a.hasData = false
+	// JSON clients get the raw snapshots' JSON; columns are binary only
+	return &message{kind: kindHeatmap, binary: buf, toJSON: func() ([]byte, error) { return nil, nil }}, snapshot
+}
+
+// Run emits one frame per 1/fps until stop is closed
+func (a *HeatmapAggregator) Run(stop <-chan struct{}) {
+	ticker := time.NewTicker(time.Second / time.Duration(a.cfg.FPS))
+	defer ticker.Stop()
+	for {
+		select {
+		case <-ticker.C:
+			column, snapshot := a.flush()
+			if snapshot != nil {
+				a.hub.Broadcast(snapshot)
+			}
+			if column != nil {
+				a.hub.Broadcast(column)
+			}
+		case <-stop:
+			return
+		}
+	}
+}
@@ -0,0 +1,116 @@
+package main
+
+import (
+	"encoding/binary"
+	"math"
+	"math/rand"
+	"testing"
+)
+
+func TestRunningMaxMatchesNaive(t *testing.T) {
+	rng := rand.New(rand.NewSource(1))
+	r := runningMax{window: 7}
+	var values []float32
+	for i := 0; i < 1000; i++ {
+		v := float32(rng.Intn(50))
+		values = append(values, v)
+		want := float32(0)
+		for j := len(values) - 1; j >= 0 && j > len(values)-1-7; j-- {
+			if values[j] > want {
+				want = values[j]
+			}
+		}
+		if got := r.push(v); got != want {
+			t.Fatalf("push %d: max %v, want %v", i, got, want)
+		}
+	}
+}
+
+func snapshotBytes(ts uint64, bids, asks [][2]float64) []byte {
+	return pairSnapshotBytes(1, ts, bids, asks)
+}
+
+func pairSnapshotBytes(pair int64, ts uint64, bids, asks [][2]float64) []byte {
+	buf := make([]byte, 0, wireSnapshotSize+(len(bids)+len(asks))*wireBookLevelSize)
+	buf = binary.LittleEndian.AppendUint64(buf, uint64(pair))
+	buf = binary.LittleEndian.AppendUint64(buf, ts)
+	buf = binary.LittleEndian.AppendUint16(buf, uint16(len(bids)))
+	buf = binary.LittleEndian.AppendUint16(buf, uint16(len(asks)))
+	for _, l := range append(bids, asks...) {
+		buf = binary.LittleEndian.AppendUint64(buf, math.Float64bits(l[0]))
+		buf = binary.LittleEndian.AppendUint32(buf, uint32(l[1]))
+	}
+	return buf
+}
+
+func TestAggregatorBinsSnapshots(t *testing.T) {
+	agg := NewHeatmapAggregator(HeatmapConfig{FPS: 30, BucketSize: 0.5, Buckets: 8, Window: 10}, NewHub(4))
+
+	first := snapshotBytes(1, [][2]float64{{100.0, 10}, {99.75, 5}}, [][2]float64{{101.0, 7}})
+	second := snapshotBytes(2, [][2]float64{{100.0, 4}}, [][2]float64{{101.0, 9}})
+	agg.Add(first, nil)
+	agg.Add(second, nil)
+
+	column, _ := agg.flush()
+	if column == nil {
+		t.Fatal("no column")
+	}
+	buf := column.binary
+	n := int(binary.LittleEndian.Uint32(buf[4:8]))
+	base := math.Float64frombits(binary.LittleEndian.Uint64(buf[8:16]))
+	running := math.Float64frombits(binary.LittleEndian.Uint64(buf[24:32]))
+	if buf[0] != kindHeatmap || n != 8 || len(buf) != heatmapHeaderSize+4*n {
+		t.Fatalf("bad header: kind %d, %d buckets, %d bytes", buf[0], n, len(buf))
+	}
+	if binary.LittleEndian.Uint64(buf[32:40]) != 2 {
+		t.Error("column should carry the last snapshot's timestamp")
+	}
+
+	values := make(map[float64]float32)
+	for i := 0; i < n; i++ {
+		if q := math.Float32frombits(binary.LittleEndian.Uint32(buf[heatmapHeaderSize+4*i:])); q != 0 {
+			values[base+float64(i)*0.5] = q
+		}
+	}
+	// 99.75 shares the 99.5 bucket; per bucket the larger of the two snapshots wins
+	want := map[float64]float32{99.5: 5, 100.0: 10, 101.0: -9}
+	if len(values) != len(want) {
+		t.Fatalf("buckets %v, want %v", values, want)
+	}
+	for price, q := range want {
+		if values[price] != q {
+			t.Errorf("bucket %v = %v, want %v", price, values[price], q)
+		}
+	}
+	if running != 10 {
+		t.Errorf("running max %v, want 10", running)
+	}
+
+	if column, _ = agg.flush(); column != nil {
+		t.Error("empty slot produced a column")
+	}
+}
+
+func TestAggregatorBinsOnePair(t *testing.T) {
+	for _, pair := range []int64{0, 2} {
+		agg := NewHeatmapAggregator(HeatmapConfig{FPS: 30, BucketSize: 0.5, Buckets: 8, Window: 10, Pair: pair}, NewHub(4))
+		// With no pair configured the first one seen is followed
+		if pair == 0 {
+			agg.Add(pairSnapshotBytes(2, 1, [][2]float64{{100.0, 10}}, nil), nil)
+		}
+		agg.Add(pairSnapshotBytes(2, 2, [][2]float64{{100.0, 4}}, [][2]float64{{101.0, 9}}), nil)
+		agg.Add(pairSnapshotBytes(3, 3, [][2]float64{{5000.0, 80}}, [][2]float64{{5001.0, 90}}), nil)
+
+		column, _ := agg.flush()
+		if column == nil {
+			t.Fatalf("pair %d: no column", pair)
+		}
+		buf := column.binary
+		if ts := binary.LittleEndian.Uint64(buf[32:40]); ts != 2 {
+			t.Errorf("pair %d: column timestamp %d, want 2 (pair 3 ignored)", pair, ts)
+		}
+		if running := math.Float64frombits(binary.LittleEndian.Uint64(buf[24:32])); running != 9 && running != 10 {
+			t.Errorf("pair %d: running max %v includes another pair", pair, running)
+		}
+	}
+}
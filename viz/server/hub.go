@@ -0,0 +1,204 @@
+package main
+
+import (
+	"log"
+	"sync"
+	"time"
+
+	"github.com/gorilla/websocket"
+)
+
+// WebSocket hub. Broadcast only queues: every client has its own sender
+// goroutine, so a slow browser falls behind on its own instead of stalling
+// the NATS callback and the other clients. A client that falls behind is
+// conflated: only its latest pending snapshot is kept, and order batches
+// beyond the queue bound are dropped oldest first.
+
+const (
+	defaultQueueLen = 256
+	writeTimeout    = 5 * time.Second
+)
+
+// wsConn is the part of *websocket.Conn the hub uses
+type wsConn interface {
+	WriteMessage(messageType int, data []byte) error
+	SetWriteDeadline(t time.Time) error
+	Close() error
+}
+
+// message is one NATS frame, encoded once and shared by every client queue
+type message struct {
+	kind     byte
+	binary   []byte // kind byte + wire frame
+	toJSON   func() ([]byte, error)
+	jsonOnce sync.Once
+	json     []byte
+}
+
+func newMessage(kind byte, frame []byte, toJSON func() ([]byte, error)) *message {
+	binary := make([]byte, 1+len(frame))
+	binary[0] = kind
+	copy(binary[1:], frame)
+	return &message{kind: kind, binary: binary, toJSON: toJSON}
+}
+
+// JSON encodes the message on first use; nil if it cannot be encoded
+func (m *message) JSON() []byte {
+	m.jsonOnce.Do(func() {
+		var err error
+		if m.json, err = m.toJSON(); err != nil {
+			log.Printf("encode json: %v", err)
+			m.json = nil
+		}
+	})
+	return m.json
+}
+
+type client struct {
+	conn     wsConn
+	json     bool // JSON text messages instead of binary frames
+	queueLen int
+
+	mu       sync.Mutex
+	snapshot *message   // latest undelivered snapshot
+	orders   []*message // undelivered order batches, oldest first
+	dropped  uint64     // order batches conflated away
+	closed   bool
+
+	wake chan struct{}
+}
+
+// enqueue never blocks
+func (c *client) enqueue(m *message) {
+	c.mu.Lock()
+	if c.closed {
+		c.mu.Unlock()
+		return
+	}
+	if m.kind == kindSnapshot {
+		c.snapshot = m
+	} else {
+		if len(c.orders) == c.queueLen {
+			copy(c.orders, c.orders[1:])
+			c.orders = c.orders[:len(c.orders)-1]
+			c.dropped++
+		}
+		c.orders = append(c.orders, m)
+	}
+	// Under mu: close() closes wake
+	select {
+	case c.wake <- struct{}{}:
+	default:
+	}
+	c.mu.Unlock()
+}
+
+// run writes queued messages until the connection fails or the client is closed
+func (c *client) run(h *Hub) {
+	var batch []*message
+	for range c.wake {
+		c.mu.Lock()
+		if c.closed {
+			c.mu.Unlock()
+			return
+		}
+		batch = batch[:0]
+		if c.snapshot != nil {
+			batch = append(batch, c.snapshot)
+			c.snapshot = nil
+		}
+		batch = append(batch, c.orders...)
+		for i := range c.orders {
+			c.orders[i] = nil
+		}
+		c.orders = c.orders[:0]
+		c.mu.Unlock()
+
+		for i, m := range batch {
+			if err := c.write(m); err != nil {
+				h.Remove(c)
+				return
+			}
+			batch[i] = nil
+		}
+	}
+}
+
+func (c *client) write(m *message) error {
+	msgType, data := websocket.BinaryMessage, m.binary
+	if c.json {
+		if data = m.JSON(); data == nil {
+			return nil
+		}
+		msgType = websocket.TextMessage
+	}
+	c.conn.SetWriteDeadline(time.Now().Add(writeTimeout))
+	return c.conn.WriteMessage(msgType, data)
+}
+
+// close stops the sender and returns the number of conflated order batches
+func (c *client) close() uint64 {
+	c.mu.Lock()
+	if !c.closed {
+		c.closed = true
+		close(c.wake)
+	}
+	dropped := c.dropped
+	c.mu.Unlock()
+	c.conn.Close()
+	return dropped
+}
+
+type Hub struct {
+	mu       sync.RWMutex
+	clients  map[*client]struct{}
+	queueLen int
+}
+
+// NewHub buffers up to queueLen order batches per client
+func NewHub(queueLen int) *Hub {
+	return &Hub{clients: make(map[*client]struct{}), queueLen: queueLen}
+}
+
+func (h *Hub) Add(conn wsConn, useJSON bool) *client {
+	c := &client{
+		conn:     conn,
+		json:     useJSON,
+		queueLen: h.queueLen,
+		orders:   make([]*message, 0, h.queueLen),
+		wake:     make(chan struct{}, 1),
+	}
+	h.mu.Lock()
+	h.clients[c] = struct{}{}
+	h.mu.Unlock()
+	go c.run(h)
+	return c
+}
+
+// Remove closes the client's connection; safe to call more than once
+func (h *Hub) Remove(c *client) {
+	h.mu.Lock()
+	_, ok := h.clients[c]
+	delete(h.clients, c)
+	h.mu.Unlock()
+	if ok {
+		if dropped := c.close(); dropped > 0 {
+			log.Printf("client disconnected, %d order batches conflated", dropped)
+		}
+	}
+}
+
+func (h *Hub) Len() int {
+	h.mu.RLock()
+	defer h.mu.RUnlock()
+	return len(h.clients)
+}
+
+// Broadcast queues m for every client and returns without writing
+func (h *Hub) Broadcast(m *message) {
+	h.mu.RLock()
+	for c := range h.clients {
+		c.enqueue(m)
+	}
+	h.mu.RUnlock()
+}
@@ -0,0 +1,166 @@
+package main
+
+import (
+	"fmt"
+	"sync"
+	"sync/atomic"
+	"testing"
+	"time"
+)
+
+// fakeConn counts writes and remembers the last one; block, when set,
+// holds every write until closed
+type fakeConn struct {
+	writes atomic.Int64
+	last   atomic.Pointer[byte]
+	block  chan struct{}
+}
+
+func (f *fakeConn) WriteMessage(messageType int, data []byte) error {
+	if f.block != nil {
+		<-f.block
+	}
+	f.writes.Add(1)
+	f.last.Store(&data[0])
+	return nil
+}
+
+// waitFor waits until m is the last message written to f
+func (f *fakeConn) waitFor(m *message, timeout time.Duration) bool {
+	deadline := time.Now().Add(timeout)
+	for f.last.Load() != &m.binary[0] {
+		if time.Now().After(deadline) {
+			return false
+		}
+		time.Sleep(10 * time.Microsecond)
+	}
+	return true
+}
+
+func (f *fakeConn) SetWriteDeadline(t time.Time) error { return nil }
+func (f *fakeConn) Close() error                       { return nil }
+
+func testMessage(kind byte) *message {
+	return newMessage(kind, make([]byte, 500), func() ([]byte, error) { return []byte("{}"), nil })
+}
+
+func TestSlowClientIsConflated(t *testing.T) {
+	hub := NewHub(4)
+	slow := &fakeConn{block: make(chan struct{})}
+	fast := &fakeConn{}
+	slowClient := hub.Add(slow, false)
+	hub.Add(fast, false)
+
+	// The slow client's sender is stuck in its first write; Broadcast must not wait for it
+	done := make(chan struct{})
+	go func() {
+		for i := 0; i < 100; i++ {
+			hub.Broadcast(testMessage(kindOrders))
+			hub.Broadcast(testMessage(kindSnapshot))
+		}
+		close(done)
+	}()
+	select {
+	case <-done:
+	case <-time.After(2 * time.Second):
+		t.Fatal("Broadcast blocked on a slow client")
+	}
+
+	slowClient.mu.Lock()
+	pending, dropped, snapshot := len(slowClient.orders), slowClient.dropped, slowClient.snapshot
+	slowClient.mu.Unlock()
+	if pending > 4 {
+		t.Errorf("slow client holds %d order batches, bound is 4", pending)
+	}
+	if dropped == 0 {
+		t.Error("slow client dropped no order batches")
+	}
+	if snapshot == nil {
+		t.Error("slow client has no pending snapshot")
+	}
+
+	last := testMessage(kindOrders)
+	hub.Broadcast(last)
+	if !fast.waitFor(last, 2*time.Second) {
+		t.Error("fast client did not catch up")
+	}
+	close(slow.block)
+	hub.Remove(slowClient)
+}
+
+func TestMessageEncodesJSONOnce(t *testing.T) {
+	var calls atomic.Int32
+	m := newMessage(kindOrders, []byte{1, 2, 3}, func() ([]byte, error) {
+		calls.Add(1)
+		return []byte("{}"), nil
+	})
+	var wg sync.WaitGroup
+	for i := 0; i < 8; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			m.JSON()
+		}()
+	}
+	wg.Wait()
+	if calls.Load() != 1 {
+		t.Errorf("toJSON ran %d times", calls.Load())
+	}
+	if m.binary[0] != kindOrders || len(m.binary) != 4 {
+		t.Errorf("binary message %v", m.binary)
+	}
+}
+
+// BenchmarkBroadcast measures Broadcast plus delivery to every client, one
+// snapshot and one order batch per iteration. "slow" adds clients whose
+// writes never complete: the other clients and Broadcast must not notice.
+func BenchmarkBroadcast(b *testing.B) {
+	for _, clients := range []int{1, 10, 100, 1000} {
+		for _, slow := range []bool{false, true} {
+			name := fmt.Sprintf("clients=%d", clients)
+			if slow {
+				name += "/slow=10%"
+			}
+			b.Run(name, func(b *testing.B) {
+				hub := NewHub(defaultQueueLen)
+				conns := make([]*fakeConn, clients)
+				for i := range conns {
+					conns[i] = &fakeConn{}
+					hub.Add(conns[i], false)
+				}
+				var stuck []*fakeConn
+				if slow {
+					for i := 0; i < clients/10+1; i++ {
+						c := &fakeConn{block: make(chan struct{})}
+						stuck = append(stuck, c)
+						hub.Add(c, false)
+					}
+				}
+				snapshot, orders := testMessage(kindSnapshot), testMessage(kindOrders)
+				var written int64
+
+				b.ResetTimer()
+				for i := 0; i < b.N; i++ {
+					hub.Broadcast(snapshot)
+					hub.Broadcast(orders)
+				}
+				// Delivered once every fast client has written the final batch
+				last := testMessage(kindOrders)
+				hub.Broadcast(last)
+				for _, c := range conns {
+					if !c.waitFor(last, 10*time.Second) {
+						b.Fatal("client did not catch up")
+					}
+				}
+				b.StopTimer()
+				for _, c := range conns {
+					written += c.writes.Load()
+				}
+				b.ReportMetric(float64(written)/float64(b.N*clients), "writes/client/op")
+				for _, c := range stuck {
+					close(c.block)
+				}
+			})
+		}
+	}
+}
@@ -8,7 +8,8 @@ import (
 	"math"
 	"net/http"
 	"os"
-	"sync"
+	"strconv"
+	"strings"
 
 	"github.com/gorilla/websocket"
 	"github.com/nats-io/nats.go"
@@ -36,6 +37,13 @@ const wireOrdersHeaderSize = 20 // type(1) + pairId(4) + seq(8) + count(4) + pad
 // Order struct: 40 bytes (8+8+8+4+4+4+4)
 const wireOrderSize = 40
 
+// Binary WebSocket messages are one kind byte followed by the wire frame as
+// received from NATS; the frontend decodes them in place (lib/wireDecode.ts)
+const (
+	kindSnapshot byte = 1
+	kindOrders   byte = 2
+)
+
 // JSON output types
 
 type BookLevel struct {
@@ -67,21 +75,49 @@ var sideNames = map[int32]string{1: "BUY", 2: "SELL"}
 var actionNames = map[int32]string{0: "SEEKER_ADD", 1: "ADD", 2: "REMOVE", 3: "MODIFY"}
 var typeNames = map[int32]string{1: "LIMIT", 2: "MARKET", 3: "ICEBERG", 4: "STOP"}
 
-func decodeSnapshot(data []byte) (*SnapshotMsg, error) {
+// checkSnapshot validates a snapshot frame's declared size without decoding it
+func checkSnapshot(data []byte) error {
 	if len(data) < wireSnapshotSize {
-		return nil, fmt.Errorf("snapshot too short: %d", len(data))
+		return fmt.Errorf("snapshot too short: %d", len(data))
 	}
-
-	pairID := int64(binary.LittleEndian.Uint64(data[0:8]))
-	_ = pairID
-	timestamp := binary.LittleEndian.Uint64(data[8:16])
 	numBids := binary.LittleEndian.Uint16(data[16:18])
 	numAsks := binary.LittleEndian.Uint16(data[18:20])
+	expected := wireSnapshotSize + (int(numBids)+int(numAsks))*wireBookLevelSize
+	if len(data) < expected {
+		return fmt.Errorf("snapshot data too short: got %d, need %d", len(data), expected)
+	}
+	return nil
+}
 
-	expected := wireSnapshotSize + int(numBids+numAsks)*wireBookLevelSize
+// snapshotPair is the pairId of a size-checked snapshot frame
+func snapshotPair(data []byte) int64 {
+	return int64(binary.LittleEndian.Uint64(data[0:8]))
+}
+
+// checkOrders validates an orders frame's header and declared size
+func checkOrders(data []byte) error {
+	if len(data) < wireOrdersHeaderSize {
+		return fmt.Errorf("orders too short: %d", len(data))
+	}
+	if data[0] != 1 {
+		return fmt.Errorf("unexpected orders msgType: %d", data[0])
+	}
+	count := binary.LittleEndian.Uint32(data[13:17])
+	expected := wireOrdersHeaderSize + int(count)*wireOrderSize
 	if len(data) < expected {
-		return nil, fmt.Errorf("snapshot data too short: got %d, need %d", len(data), expected)
+		return fmt.Errorf("orders data too short: got %d, need %d", len(data), expected)
 	}
+	return nil
+}
+
+func decodeSnapshot(data []byte) (*SnapshotMsg, error) {
+	if err := checkSnapshot(data); err != nil {
+		return nil, err
+	}
+
+	timestamp := binary.LittleEndian.Uint64(data[8:16])
+	numBids := binary.LittleEndian.Uint16(data[16:18])
+	numAsks := binary.LittleEndian.Uint16(data[18:20])
 
 	msg := &SnapshotMsg{
 		Type:      "snapshot",
@@ -108,22 +144,11 @@ func decodeSnapshot(data []byte) (*SnapshotMsg, error) {
 }
 
 func decodeOrders(data []byte) (*OrdersMsg, error) {
-	if len(data) < wireOrdersHeaderSize {
-		return nil, fmt.Errorf("orders too short: %d", len(data))
+	if err := checkOrders(data); err != nil {
+		return nil, err
 	}
 
-	msgType := data[0]
-	_ = binary.LittleEndian.Uint32(data[1:5])
-	_ = binary.LittleEndian.Uint64(data[5:13])
 	count := binary.LittleEndian.Uint32(data[13:17])
-	if msgType != 1 {
-		return nil, fmt.Errorf("unexpected orders msgType: %d", msgType)
-	}
-
-	expected := wireOrdersHeaderSize + int(count)*wireOrderSize
-	if len(data) < expected {
-		return nil, fmt.Errorf("orders data too short: got %d, need %d", len(data), expected)
-	}
 
 	msg := &OrdersMsg{
 		Type:   "orders",
@@ -154,48 +179,22 @@ func decodeOrders(data []byte) (*OrdersMsg, error) {
 	return msg, nil
 }
 
-// WebSocket hub
-
 var upgrader = websocket.Upgrader{
 	CheckOrigin: func(r *http.Request) bool { return true },
 }
 
-type client struct {
-	conn *websocket.Conn
-	mu   sync.Mutex
-}
-
-type Hub struct {
-	mu      sync.RWMutex
-	clients map[*client]struct{}
-}
-
-func (h *Hub) Add(conn *websocket.Conn) *client {
-	c := &client{conn: conn}
-	h.mu.Lock()
-	h.clients[c] = struct{}{}
-	h.mu.Unlock()
-	return c
-}
-
-func (h *Hub) Remove(c *client) {
-	h.mu.Lock()
-	delete(h.clients, c)
-	h.mu.Unlock()
+func envInt(key string, def int) int {
+	if v, err := strconv.Atoi(strings.TrimSpace(os.Getenv(key))); err == nil && v > 0 {
+		return v
+	}
+	return def
 }
 
-func (h *Hub) Broadcast(data []byte) {
-	h.mu.RLock()
-	defer h.mu.RUnlock()
-	for c := range h.clients {
-		c.mu.Lock()
-		err := c.conn.WriteMessage(websocket.TextMessage, data)
-		c.mu.Unlock()
-		if err != nil {
-			c.conn.Close()
-			go h.Remove(c)
-		}
+func envFloat(key string, def float64) float64 {
+	if v, err := strconv.ParseFloat(strings.TrimSpace(os.Getenv(key)), 64); err == nil && v > 0 {
+		return v
 	}
+	return def
 }
 
 func main() {
@@ -211,31 +210,87 @@ func main() {
 	defer nc.Close()
 	log.Printf("Connected to NATS at %s", natsURL)
 
-	hub := &Hub{clients: make(map[*client]struct{})}
+	hub := NewHub(envInt("VIZ_CLIENT_QUEUE", defaultQueueLen))
 
-	// Subscribe to snapshots
-	_, err = nc.Subscribe("orderbook.snapshots", func(msg *nats.Msg) {
-		snap, err := decodeSnapshot(msg.Data)
-		if err != nil {
+	// Clients get binary frames unless they connect with ?format=json;
+	// VIZ_FORMAT=json makes JSON the default
+	defaultJSON := os.Getenv("VIZ_FORMAT") == "json"
+
+	// One pair (VIZ_PAIR, default all) for snapshots and trade-by-trade orders
+	pair := os.Getenv("VIZ_PAIR")
+	var pairID int64
+	if pair == "" {
+		pair = "*"
+	} else if pairID, err = strconv.ParseInt(pair, 10, 64); err != nil || pairID <= 0 {
+		log.Fatalf("bad VIZ_PAIR %q", pair)
+	}
+
+	// Heatmap columns at VIZ_HEATMAP_FPS (default 30, "off" forwards every
+	// snapshot instead): VIZ_HEATMAP_BUCKETS buckets of VIZ_HEATMAP_BUCKET price
+	// each, for VIZ_PAIR or else the first pair seen
+	var heatmap *HeatmapAggregator
+	if os.Getenv("VIZ_HEATMAP_FPS") != "off" {
+		heatmap = NewHeatmapAggregator(HeatmapConfig{
+			FPS:        envInt("VIZ_HEATMAP_FPS", 30),
+			BucketSize: envFloat("VIZ_HEATMAP_BUCKET", 0.01),
+			Buckets:    envInt("VIZ_HEATMAP_BUCKETS", 128),
+			Window:     500,
+			Pair:       pairID,
+		}, hub)
+		go heatmap.Run(make(chan struct{}))
+		log.Printf("Heatmap columns at %d fps", heatmap.cfg.FPS)
+	}
+
+	// Subscribe to snapshots, on the shared subject or per pair (the feeder's
+	// PER_PAIR_SUBJECTS, for partitioned processors). The shared subject
+	// carries every pair, so frames are filtered by their own pairId.
+	onSnapshot := func(msg *nats.Msg) {
+		if err := checkSnapshot(msg.Data); err != nil {
 			log.Printf("decode snapshot: %v", err)
 			return
 		}
-		data, _ := json.Marshal(snap)
-		hub.Broadcast(data)
-	})
-	if err != nil {
-		log.Fatalf("subscribe snapshots: %v", err)
+		if pairID != 0 && snapshotPair(msg.Data) != pairID {
+			return
+		}
+		m := newMessage(kindSnapshot, msg.Data, func() ([]byte, error) {
+			snap, err := decodeSnapshot(msg.Data)
+			if err != nil {
+				return nil, err
+			}
+			return json.Marshal(snap)
+		})
+		if heatmap != nil {
+			heatmap.Add(msg.Data, m)
+		} else {
+			hub.Broadcast(m)
+		}
+	}
+	for _, subject := range []string{"orderbook.snapshots", "orderbook.snapshots." + pair} {
+		if _, err = nc.Subscribe(subject, onSnapshot); err != nil {
+			log.Fatalf("subscribe snapshots: %v", err)
+		}
 	}
 
-	// Subscribe to trade-by-trade orders
-	_, err = nc.Subscribe("orderbook.tbt", func(msg *nats.Msg) {
-		orders, err := decodeOrders(msg.Data)
-		if err != nil {
+	// Subscribe to trade-by-trade orders from orderbook.tbt.<pair>.<side>, or
+	// the filtered derived stream (VIZ_STREAM=filtered) published on
+	// orderbook.filtered.<pair>
+	tbtSubject := "orderbook.tbt." + pair + ".*"
+	if os.Getenv("VIZ_STREAM") == "filtered" {
+		tbtSubject = "orderbook.filtered." + pair
+	}
+	log.Printf("Subscribing to %s", tbtSubject)
+	_, err = nc.Subscribe(tbtSubject, func(msg *nats.Msg) {
+		if err := checkOrders(msg.Data); err != nil {
 			log.Printf("decode orders: %v", err)
 			return
 		}
-		data, _ := json.Marshal(orders)
-		hub.Broadcast(data)
+		hub.Broadcast(newMessage(kindOrders, msg.Data, func() ([]byte, error) {
+			orders, err := decodeOrders(msg.Data)
+			if err != nil {
+				return nil, err
+			}
+			return json.Marshal(orders)
+		}))
 	})
 	if err != nil {
 		log.Fatalf("subscribe tbt: %v", err)
@@ -248,14 +303,20 @@ func main() {
 			log.Printf("ws upgrade: %v", err)
 			return
 		}
-		c := hub.Add(conn)
-		log.Printf("client connected (%d total)", len(hub.clients))
+		useJSON := defaultJSON
+		switch r.URL.Query().Get("format") {
+		case "json":
+			useJSON = true
+		case "binary":
+			useJSON = false
+		}
+		c := hub.Add(conn, useJSON)
+		log.Printf("client connected (%d total)", hub.Len())
 
 		// Read loop to detect disconnects
 		for {
 			if _, _, err := conn.ReadMessage(); err != nil {
 				hub.Remove(c)
-				conn.Close()
 				break
 			}
 		}